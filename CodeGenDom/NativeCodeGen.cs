@@ -48,6 +48,19 @@ private static void GenerateFileProlog(StringBuilder sb, string codeNamespace, s
 
             WriteLine(sb, "namespace {0}", codeNamespace);
             WriteLine(sb, "{{");
+            WriteLine(sb, "");
+            WriteLine(sb, "// the bridge whose set functions apply the initial states.");
+            WriteLine(sb, "static GobBridge* s_bridge = NULL;");
+            WriteLine(sb, "");
+            WriteLine(sb, "//-----------------------------------------------------------------------------");
+            WriteLine(sb, "// applies the initial state packed by the editor, the property writes of the");
+            WriteLine(sb, "// new object, before the object is added to its parent.");
+            WriteLine(sb, "static Object* SetInitialState(Object* instance, void* data, int size)");
+            WriteLine(sb, "{{");
+            WriteLine(sb, "    if(instance && data && size > 0)");
+            WriteLine(sb, "        CommandBuffer::ExecuteInitialState(*s_bridge, instance->GetInstanceId(), data, size);");
+            WriteLine(sb, "    return instance;");
+            WriteLine(sb, "}}");
         }
 
         private static void GenerateFileEpilog(StringBuilder sb, string codeNamespace)
@@ -87,6 +100,7 @@ private static void GenerateFunctionRegistration(StringBuilder sb, List<NativeCl
             WriteLine(sb, "//-----------------------------------------------------------------------------");
             WriteLine(sb, "void InitGobBridge(GobBridge& bridge)");
             WriteLine(sb, "{{");
+            WriteLine(sb, "  s_bridge = &bridge;");
             foreach (NativeClassInfo classInfo in classes)
             {
                 GenerateClassRegistration(sb, classInfo);
@@ -123,7 +137,7 @@ private static void GenerateClassDefinition(StringBuilder sb, NativeClassInfo cl
             }
             else
             {
-                WriteLine(sb, "    return new {0}();", classInfo.NativeName);
+                WriteLine(sb, "    return SetInitialState(new {0}(), data, size);", classInfo.NativeName);
             }
             WriteLine(sb, "}}");
         }
@@ -143,7 +157,7 @@ private static void GeneratePropertyDefinition(StringBuilder sb, NativeClassInfo
                 WriteLine(sb, "void {0}_{1}_Set({2} instanceId, void* data, int size)", classInfo.NativeName, info.NativeName, ConstStrings.ObjectID);
                 WriteLine(sb, "{{");
                 WriteLine(sb, "    assert((data && size > 0) || (!data && size == 0));");
-                WriteLine(sb, "    {0}* instance = reinterpret_cast<{0}*>(instanceId);", classInfo.NativeName);
+                WriteLine(sb, "    {0}* instance = ObjectTable::Inst()->GetAs<{0}>(instanceId);", classInfo.NativeName);
                 switch (info.NativeType)
                 {                    
                     case "Matrix":
@@ -171,7 +185,8 @@ private static void GeneratePropertyDefinition(StringBuilder sb, NativeClassInfo
                         WriteLine(sb, "    instance->Set{0}(localData);", info.NativeName);
                         break;
                     default:
-                        WriteLine(sb, "    {0} localData = reinterpret_cast<{0}>(data);", info.NativeType);
+                        // references to other objects, data is the instance id of the target.
+                        WriteLine(sb, "    {0} localData = ObjectTable::Inst()->GetAs<{1}>(({2})data);", info.NativeType, info.NativeType.TrimEnd('*'), ConstStrings.ObjectID);
                         WriteLine(sb, "    instance->Set{0}(localData, size);", info.NativeName);
                         break;
 
@@ -183,7 +198,7 @@ private static void GeneratePropertyDefinition(StringBuilder sb, NativeClassInfo
                 WriteLine(sb, "//-----------------------------------------------------------------------------");
                 WriteLine(sb, "void {0}_{1}_Get({2} instanceId, void** data, int* size)", classInfo.NativeName, info.NativeName, ConstStrings.ObjectID);
                 WriteLine(sb, "{{");
-                WriteLine(sb, "    {0}* instance = reinterpret_cast<{0}*>(instanceId);", classInfo.NativeName);
+                WriteLine(sb, "    {0}* instance = ObjectTable::Inst()->GetAs<{0}>(instanceId);", classInfo.NativeName);
                 WriteLine(sb, "    static {0} localData;", info.NativeType);
                 WriteLine(sb, "    localData = instance->Get{0}();", info.NativeName);
                 WriteLine(sb, "    *data = (void*)&localData;");
@@ -202,16 +217,16 @@ private static void GenerateListDefinition(StringBuilder sb, NativeClassInfo cla
             WriteLine(sb, "//-----------------------------------------------------------------------------");
             WriteLine(sb, "void {0}_{1}_Add({2} parentId, {2} childId, int index)", classInfo.NativeName, info.NativeName, ConstStrings.ObjectID);
             WriteLine(sb, "{{");
-            WriteLine(sb, "    {0}* parent = reinterpret_cast<{0}*>(parentId);", classInfo.NativeName);
-            WriteLine(sb, "    {0}* child = reinterpret_cast<{0}*>(childId);", info.NativeType);
+            WriteLine(sb, "    {0}* parent = ObjectTable::Inst()->GetAs<{0}>(parentId);", classInfo.NativeName);
+            WriteLine(sb, "    {0}* child = ObjectTable::Inst()->GetAs<{0}>(childId);", info.NativeType);
             WriteLine(sb, "    parent->Add{0}(child, index);", info.NativeName);
             WriteLine(sb, "}}");
             WriteLine(sb, "");
             WriteLine(sb, "//-----------------------------------------------------------------------------");
             WriteLine(sb, "void {0}_{1}_Remove({2} parentId, {2} childId)", classInfo.NativeName, info.NativeName, ConstStrings.ObjectID);
             WriteLine(sb, "{{");
-            WriteLine(sb, "    {0}* parent = reinterpret_cast<{0}*>(parentId);", classInfo.NativeName);
-            WriteLine(sb, "    {0}* child = reinterpret_cast<{0}*>(childId);", info.NativeType);
+            WriteLine(sb, "    {0}* parent = ObjectTable::Inst()->GetAs<{0}>(parentId);", classInfo.NativeName);
+            WriteLine(sb, "    {0}* child = ObjectTable::Inst()->GetAs<{0}>(childId);", info.NativeType);
             WriteLine(sb, "    parent->Remove{0}(child);", info.NativeName);
             WriteLine(sb, "}}");
         }
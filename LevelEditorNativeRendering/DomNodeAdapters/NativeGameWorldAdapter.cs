@@ -1,5 +1,8 @@
 ﻿//Copyright © 2014 Sony Computer Entertainment America LLC. See License.txt.
 
+using System;
+
+using Sce.Atf;
 using Sce.Atf.Dom;
 using Sce.Atf.Adaptation;
 
@@ -15,6 +18,25 @@ protected override void OnNodeSet()
             node.ChildInserted += node_ChildInserted;
             node.ChildRemoved += node_ChildRemoved;
             ManageNativeObjectLifeTime = true;
+
+            // the property writes of a transaction are sent to the native side in one call when it ends.
+            IValidationContext validationContext = node.As<IValidationContext>();
+            if (validationContext != null)
+            {
+                validationContext.Beginning += validationContext_Beginning;
+                validationContext.Ended += validationContext_Ended;
+                validationContext.Cancelled += validationContext_Ended;
+            }
+        }
+
+        void validationContext_Beginning(object sender, EventArgs e)
+        {
+            GameEngine.BeginPropertyBatch();
+        }
+
+        void validationContext_Ended(object sender, EventArgs e)
+        {
+            GameEngine.EndPropertyBatch();
         }
 
         void node_ChildInserted(object sender, ChildEventArgs e)
@@ -74,7 +96,6 @@ public void Insert(DomNode parent, DomNode child, ChildInfo chInfo, int index)
             if (ManageNativeObjectLifeTime)
             {
                 GameEngine.CreateObject(childObject);
-                childObject.UpdateNativeOjbect();
             }
             System.Diagnostics.Debug.Assert(childObject.InstanceId != 0);
 
@@ -27,32 +27,35 @@ protected override void OnNodeSet()
         void node_AttributeChanged(object sender, AttributeEventArgs e)
         {
             // process events only for the DomNode attached to this adapter.
-            if (this.DomNode != e.DomNode)
+            if (this.DomNode != e.DomNode || this.InstanceId == 0)
                 return;
-            UpdateNativeProperty(e.AttributeInfo);
+            // the writes of a transaction go to the open batch, see GameEngine.BeginPropertyBatch().
+            UpdateNativeProperty(e.AttributeInfo, GameEngine.PropertyBatch);
         }
 
         
         /// <summary>
-        /// Updates all the shared properties  
-        /// between this and native object 
-        /// only call onece.
-        /// </summary>
-        public void UpdateNativeOjbect()
+        /// Adds all the shared properties to commands,
+        /// they are applied by the native creation of this object.
+        /// this method is exclusively used by GameEngine class.</summary>
+        internal void PackInitialState(CommandBuffer commands)
         {
+            System.Diagnostics.Debug.Assert(InstanceId == 0);
             foreach (AttributeInfo attribInfo in this.DomNode.Type.Attributes)
             {
-                UpdateNativeProperty(attribInfo);
+                UpdateNativeProperty(attribInfo, commands);
             }
         }
 
       
-        unsafe private void UpdateNativeProperty(AttributeInfo attribInfo)
+        // the property is added to commands, or set right away if commands is null.
+        unsafe private void UpdateNativeProperty(AttributeInfo attribInfo, CommandBuffer commands)
         {
             object idObj = attribInfo.GetTag(NativeAnnotations.NativeProperty);
             if (idObj == null) return;
             uint id = (uint)idObj;
-            if (this.InstanceId == 0)
+            // before the creation the properties can only be packed.
+            if (this.InstanceId == 0 && commands == null)
                 return;
 
             AttributeInfo mappedAttribute = attribInfo.GetTag(NativeAnnotations.MappedAttribute) as AttributeInfo;
@@ -72,7 +75,7 @@ unsafe private void UpdateNativeProperty(AttributeInfo attribInfo)
                     pinHandle = GCHandle.Alloc(data, GCHandleType.Pinned);
                     IntPtr ptr = pinHandle.AddrOfPinnedObject();
                     int sz = Marshal.SizeOf(elmentType);
-                    GameEngine.SetObjectProperty(typeId, InstanceId, id, ptr, sz * attribInfo.Type.Length);
+                    SetNativeProperty(commands, typeId, id, ptr, sz * attribInfo.Type.Length);
 
                 }
                 finally
@@ -94,7 +97,7 @@ unsafe private void UpdateNativeProperty(AttributeInfo attribInfo)
                         {
                             ptr = new IntPtr((void*)chptr);
                             sz = str.Length * 2;
-                            GameEngine.SetObjectProperty(typeId, InstanceId, id, ptr, sz);
+                            SetNativeProperty(commands, typeId, id, ptr, sz);
                         }
                         return;
                     }
@@ -184,7 +187,7 @@ unsafe private void UpdateNativeProperty(AttributeInfo attribInfo)
                         {
                             ptr = new IntPtr((void*)chptr);
                             sz = str.Length * 2;
-                            GameEngine.SetObjectProperty(typeId, InstanceId, id, ptr, sz);
+                            SetNativeProperty(commands, typeId, id, ptr, sz);
                         }
                         return;
                     }
@@ -194,6 +197,11 @@ unsafe private void UpdateNativeProperty(AttributeInfo attribInfo)
                     // this is a 'reference' to an object
                     DomNode node = (DomNode)data;
                     NativeObjectAdapter nativeGob = node.As<NativeObjectAdapter>();
+                    if (commands != null)
+                    {
+                        commands.SetReference(typeId, InstanceId, id, nativeGob != null ? nativeGob.InstanceId : 0);
+                        return;
+                    }
                     if(nativeGob != null)
                     {
                         ptr = new IntPtr((void*)nativeGob.InstanceId);
@@ -201,10 +209,18 @@ unsafe private void UpdateNativeProperty(AttributeInfo attribInfo)
                     }                    
                 }
 
-                GameEngine.SetObjectProperty(typeId, InstanceId, id, ptr, sz);
+                SetNativeProperty(commands, typeId, id, ptr, sz);
             }
         }
 
+        private void SetNativeProperty(CommandBuffer commands, uint typeId, uint propId, IntPtr data, int size)
+        {
+            if (commands != null)
+                commands.SetProperty(typeId, InstanceId, propId, data, size);
+            else
+                GameEngine.SetObjectProperty(typeId, InstanceId, propId, data, size);
+        }
+
         public uint TypeId
         {
             get;
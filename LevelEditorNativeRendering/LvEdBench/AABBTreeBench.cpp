@@ -0,0 +1,168 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times the ray and frustum queries of DynamicAABBTree on 100k proxies against
+// a linear test of every fat bounds, and checks that both find the same proxies.
+
+#include <vector>
+#include <algorithm>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/VectorMath/DynamicAABBTree.h"
+
+namespace LvEdEngine
+{
+    typedef std::vector<uint64_t> ProxyList;
+
+    // collects the proxies reported by the queries.
+    struct ProxyCollector
+    {
+        ProxyList* proxies;
+        void operator()(uint64_t userData, float* /*maxDist*/) { proxies->push_back(userData); }
+        void operator()(uint64_t userData) { proxies->push_back(userData); }
+    };
+
+    // ----------------------------------------------------------------------------------
+    // the slab test of the tree.
+    static bool RayHitsBox(const Ray& ray, const float3& invDir, const AABB& box)
+    {
+        const float3& bmin = box.Min();
+        const float3& bmax = box.Max();
+        float tx1 = (bmin.x - ray.pos.x) * invDir.x;
+        float tx2 = (bmax.x - ray.pos.x) * invDir.x;
+        float tmin = minimize(tx1, tx2);
+        float tmax = maximize(tx1, tx2);
+        float ty1 = (bmin.y - ray.pos.y) * invDir.y;
+        float ty2 = (bmax.y - ray.pos.y) * invDir.y;
+        tmin = maximize(tmin, minimize(ty1, ty2));
+        tmax = minimize(tmax, maximize(ty1, ty2));
+        float tz1 = (bmin.z - ray.pos.z) * invDir.z;
+        float tz2 = (bmax.z - ray.pos.z) * invDir.z;
+        tmin = maximize(tmin, minimize(tz1, tz2));
+        tmax = minimize(tmax, maximize(tz1, tz2));
+        return tmax >= tmin && tmax >= 0.0f;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool AABBTreeBench()
+    {
+        const uint32_t proxyCount = 100000;
+        const uint32_t rayCount = 2000;
+        const uint32_t frustumCount = 50;
+        const float3 levelMin(-500.0f, 0.0f, -500.0f);
+        const float3 levelMax(500.0f, 50.0f, 500.0f);
+
+        BenchRandom rnd;
+        std::vector<AABB> bounds(proxyCount);
+        for(uint32_t i = 0; i < proxyCount; i++)
+        {
+            float3 center(rnd.Float(levelMin.x, levelMax.x), rnd.Float(levelMin.y, levelMax.y), rnd.Float(levelMin.z, levelMax.z));
+            float3 extent(rnd.Float(0.5f, 4.0f), rnd.Float(0.5f, 4.0f), rnd.Float(0.5f, 4.0f));
+            bounds[i] = AABB(center - extent, center + extent);
+        }
+
+        PerfTimer timer;
+        timer.Start();
+        DynamicAABBTree tree;
+        std::vector<int32_t> proxyIds(proxyCount);
+        for(uint32_t i = 0; i < proxyCount; i++)
+            proxyIds[i] = tree.CreateProxy(bounds[i], i);
+        timer.Stop();
+        double buildMs = timer.ElapsedTimeMS();
+
+        // the queries test the fat bounds, so does the linear scan.
+        std::vector<AABB> fatBounds(proxyCount);
+        for(uint32_t i = 0; i < proxyCount; i++)
+            fatBounds[i] = tree.GetFatBounds(proxyIds[i]);
+
+        // picking rays from above the level, and cameras over it looking down ahead.
+        std::vector<Ray> rays(rayCount);
+        for(uint32_t r = 0; r < rayCount; r++)
+        {
+            float3 from(rnd.Float(levelMin.x, levelMax.x), 200.0f, rnd.Float(levelMin.z, levelMax.z));
+            float3 to(rnd.Float(levelMin.x, levelMax.x), 0.0f, rnd.Float(levelMin.z, levelMax.z));
+            rays[r] = Ray(from, to - from);
+        }
+        std::vector<Frustum> frustums(frustumCount);
+        Matrix proj = Matrix::CreatePerspectiveFieldOfView(0.8f, 16.0f / 9.0f, 1.0f, 250.0f);
+        for(uint32_t f = 0; f < frustumCount; f++)
+        {
+            float angle = rnd.Float(0.0f, 6.2831853f);
+            float3 eye(rnd.Float(levelMin.x, levelMax.x), 60.0f, rnd.Float(levelMin.z, levelMax.z));
+            float3 at = eye + float3(cosf(angle) * 100.0f, -30.0f, sinf(angle) * 100.0f);
+            Matrix view = Matrix::CreateLookAtRH(eye, at, float3(0.0f, 1.0f, 0.0f));
+            frustums[f].InitFromMatrix(view * proj);
+        }
+
+        ProxyList treeHits;
+        ProxyList linearHits;
+        ProxyCollector collector;
+        uint64_t rayHitCount = 0;
+        uint64_t frustumHitCount = 0;
+
+        double treeRayMs = 0.0;
+        double linearRayMs = 0.0;
+        for(uint32_t r = 0; r < rayCount; r++)
+        {
+            const Ray& ray = rays[r];
+            treeHits.clear();
+            collector.proxies = &treeHits;
+            float maxDist = FLT_MAX;
+            timer.Start();
+            tree.RayQuery(ray, &maxDist, collector);
+            timer.Stop();
+            treeRayMs += timer.ElapsedTimeMS();
+
+            linearHits.clear();
+            timer.Start();
+            float3 invDir;
+            invDir.x = ray.direction.x != 0.0f ? 1.0f / ray.direction.x : FLT_MAX;
+            invDir.y = ray.direction.y != 0.0f ? 1.0f / ray.direction.y : FLT_MAX;
+            invDir.z = ray.direction.z != 0.0f ? 1.0f / ray.direction.z : FLT_MAX;
+            for(uint32_t i = 0; i < proxyCount; i++)
+            {
+                if(RayHitsBox(ray, invDir, fatBounds[i]))
+                    linearHits.push_back(i);
+            }
+            timer.Stop();
+            linearRayMs += timer.ElapsedTimeMS();
+
+            std::sort(treeHits.begin(), treeHits.end());
+            BENCH_CHECK(treeHits == linearHits);
+            rayHitCount += treeHits.size();
+        }
+
+        double treeFrustumMs = 0.0;
+        double linearFrustumMs = 0.0;
+        for(uint32_t f = 0; f < frustumCount; f++)
+        {
+            const Frustum& frustum = frustums[f];
+            treeHits.clear();
+            collector.proxies = &treeHits;
+            timer.Start();
+            tree.FrustumQuery(frustum, collector);
+            timer.Stop();
+            treeFrustumMs += timer.ElapsedTimeMS();
+
+            linearHits.clear();
+            timer.Start();
+            for(uint32_t i = 0; i < proxyCount; i++)
+            {
+                if(FrustumAABBIntersect(frustum, fatBounds[i]) != 0)
+                    linearHits.push_back(i);
+            }
+            timer.Stop();
+            linearFrustumMs += timer.ElapsedTimeMS();
+
+            std::sort(treeHits.begin(), treeHits.end());
+            BENCH_CHECK(treeHits == linearHits);
+            frustumHitCount += treeHits.size();
+        }
+        BENCH_CHECK(rayHitCount > 0 && frustumHitCount > 0);
+
+        printf("    %u proxies, height %d, built in %.1f ms\n", proxyCount, tree.GetHeight(), buildMs);
+        printf("    %u rays, %.1f proxies each: tree %.2f ms, linear %.1f ms\n",
+            rayCount, (double)rayHitCount / rayCount, treeRayMs, linearRayMs);
+        printf("    %u frustums, %.0f proxies each: tree %.2f ms, linear %.1f ms\n",
+            frustumCount, (double)frustumHitCount / frustumCount, treeFrustumMs, linearFrustumMs);
+        return true;
+    }
+}
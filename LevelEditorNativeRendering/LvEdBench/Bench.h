@@ -0,0 +1,51 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+// stand-alone tests and benchmarks of the engine code that runs without a device.
+// the engine sources they need are compiled into LvEdBench, see LvEdBench.vcxproj.
+
+#include <stdio.h>
+#include "../LvEdRenderingEngine/Core/WinHeaders.h"
+#include "../LvEdRenderingEngine/Core/PerfTimer.h"
+
+namespace LvEdEngine
+{
+    // returns false if one of its checks failed.
+    typedef bool (*BenchFncPtr)();
+
+    // ----------------------------------------------------------------------------
+    // xorshift generator, the runs are repeatable.
+    class BenchRandom
+    {
+    public:
+        BenchRandom(uint32_t seed = 0x9e3779b9) : m_state(seed ? seed : 1) {}
+
+        uint32_t Next()
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        // in [0, count)
+        uint32_t Below(uint32_t count)
+        {
+            return (uint32_t)(((uint64_t)Next() * count) >> 32);
+        }
+
+        // in [min, max)
+        float Float(float min, float max)
+        {
+            return min + (max - min) * (float)(Next() >> 8) * (1.0f / 16777216.0f);
+        }
+
+    private:
+        uint32_t m_state;
+    };
+}
+
+// logs the failed check and fails the bench.
+#define BENCH_CHECK(cond) \
+    do { if(!(cond)) { printf("    check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); return false; } } while(0)
@@ -0,0 +1,179 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times the collection of the retained render packets of 100k objects as
+// GameLevel::AddCandidateRenderables() does it, on the calling thread and in
+// chunks of 256 objects on the worker pool, and checks that both collect the
+// same packets in the same order. the packets are relit before, as by Update(),
+// and the lighting state is read-only during the collection.
+
+#include <vector>
+#include <algorithm>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Renderer/Lights.h"
+#include "../LvEdRenderingEngine/Core/WorkerPool.h"
+
+namespace LvEdEngine
+{
+    // the part of the retained RenderableNode that the collection reads.
+    struct CollectPacket
+    {
+        Matrix   world;
+        AABB     bounds;
+        float4   diffuse;
+        const LightEnvironment* lighting;
+    };
+
+    struct CollectObject
+    {
+        bool             visible;
+        CollectPacket    packet;
+        LightEnvironment lighting;
+    };
+
+    struct CollectEntry
+    {
+        const CollectPacket* packet;
+        bool alphaBlend;
+    };
+
+    typedef std::vector<CollectEntry> CollectList;
+
+    static const uint32_t CollectChunkSize = 256;
+
+    // ----------------------------------------------------------------------------------
+    // the objects of [first, end) that pass the frustum test, as GetOwnRenderables().
+    static void CollectRange(const std::vector<CollectObject>& objects, uint32_t first, uint32_t end,
+        const Frustum& frustum, CollectList& list)
+    {
+        for(uint32_t i = first; i < end; i++)
+        {
+            const CollectObject& obj = objects[i];
+            if(!obj.visible || !TestFrustumAABB(frustum, obj.packet.bounds))
+                continue;
+            CollectEntry entry;
+            entry.packet = &obj.packet;
+            entry.alphaBlend = obj.packet.diffuse.w < 0.996f;
+            list.push_back(entry);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    class CollectChunkJob : public ParallelJob
+    {
+    public:
+        CollectChunkJob(const std::vector<CollectObject>& objects, const Frustum& frustum, std::vector<CollectList>& lists)
+            : m_objects(objects), m_frustum(frustum), m_lists(lists) {}
+
+        virtual void Execute(uint32_t index)
+        {
+            uint32_t first = index * CollectChunkSize;
+            uint32_t end = std::min(first + CollectChunkSize, (uint32_t)m_objects.size());
+            m_lists[index].clear();
+            CollectRange(m_objects, first, end, m_frustum, m_lists[index]);
+        }
+
+    private:
+        const std::vector<CollectObject>& m_objects;
+        const Frustum& m_frustum;
+        std::vector<CollectList>& m_lists;
+    };
+
+    // ----------------------------------------------------------------------------------
+    bool CollectBench()
+    {
+        const uint32_t objectCount = 100000;
+        const uint32_t pointLightCount = 400;
+        const float3 levelMin(-500.0f, 0.0f, -500.0f);
+        const float3 levelMax(500.0f, 50.0f, 500.0f);
+        const int runCount = 5;
+
+        BenchRandom rnd;
+        LightingState* lights = LightingState::Inst();
+        std::vector<PointLight*> pointLights;
+        for(uint32_t i = 0; i < pointLightCount; i++)
+        {
+            PointLight* light = lights->CreatePointLight();
+            light->diffuse = float3(1.0f, 1.0f, 1.0f);
+            light->attenuation = float4(0.0f, 1.0f, 0.0f, 0.0f);
+            light->position = float4(rnd.Float(levelMin.x, levelMax.x), rnd.Float(levelMin.y, levelMax.y),
+                rnd.Float(levelMin.z, levelMax.z), rnd.Float(4.0f, 20.0f));
+            lights->UpdatePointLight(light);
+            pointLights.push_back(light);
+        }
+
+        std::vector<CollectObject> objects(objectCount);
+        for(uint32_t i = 0; i < objectCount; i++)
+        {
+            CollectObject& obj = objects[i];
+            float3 center(rnd.Float(levelMin.x, levelMax.x), rnd.Float(levelMin.y, levelMax.y), rnd.Float(levelMin.z, levelMax.z));
+            float3 extent(rnd.Float(0.5f, 4.0f), rnd.Float(0.5f, 4.0f), rnd.Float(0.5f, 4.0f));
+            obj.visible = rnd.Below(50) != 0;
+            obj.packet.world = Matrix::CreateTranslation(center);
+            obj.packet.bounds = AABB(center - extent, center + extent);
+            obj.packet.diffuse = float4(1.0f, 1.0f, 1.0f, rnd.Below(10) == 0 ? 0.5f : 1.0f);
+            obj.packet.lighting = &obj.lighting;
+        }
+
+        // the packets are relit on the main thread by Update(), before the collection.
+        PerfTimer timer;
+        timer.Start();
+        for(uint32_t i = 0; i < objectCount; i++)
+            lights->UpdateLightEnvironment(objects[i].lighting, objects[i].packet.bounds);
+        timer.Stop();
+        double relightMs = timer.ElapsedTimeMS();
+
+        // a camera at the edge of the level that sees about half of it.
+        Matrix view = Matrix::CreateLookAtRH(float3(0.0f, 40.0f, -520.0f), float3(0.0f, 0.0f, 0.0f), float3(0.0f, 1.0f, 0.0f));
+        Matrix proj = Matrix::CreatePerspectiveFieldOfView(0.6f, 16.0f / 9.0f, 1.0f, 1200.0f);
+        Frustum frustum;
+        frustum.InitFromMatrix(view * proj);
+
+        uint32_t chunkCount = (objectCount + CollectChunkSize - 1) / CollectChunkSize;
+        std::vector<CollectList> chunkLists(chunkCount);
+        CollectList serialList;
+        CollectList parallelList;
+        serialList.reserve(objectCount);
+        parallelList.reserve(objectCount);
+        CollectChunkJob job(objects, frustum, chunkLists);
+
+        double serialMs = 0.0;
+        double parallelMs = 0.0;
+        lights->BeginReadOnly();
+        for(int run = 0; run < runCount; run++)
+        {
+            timer.Start();
+            serialList.clear();
+            CollectRange(objects, 0, objectCount, frustum, serialList);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < serialMs)
+                serialMs = timer.ElapsedTimeMS();
+
+            // each chunk fills its own list, the lists are appended in chunk order.
+            timer.Start();
+            WorkerPool::Inst()->ParallelFor(&job, chunkCount);
+            parallelList.clear();
+            for(uint32_t i = 0; i < chunkCount; i++)
+                parallelList.insert(parallelList.end(), chunkLists[i].begin(), chunkLists[i].end());
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < parallelMs)
+                parallelMs = timer.ElapsedTimeMS();
+        }
+        lights->EndReadOnly();
+
+        BENCH_CHECK(!serialList.empty() && serialList.size() < objectCount);
+        BENCH_CHECK(parallelList.size() == serialList.size());
+        for(size_t i = 0; i < serialList.size(); i++)
+        {
+            BENCH_CHECK(parallelList[i].packet == serialList[i].packet);
+            BENCH_CHECK(parallelList[i].alphaBlend == serialList[i].alphaBlend);
+        }
+
+        for(size_t i = 0; i < pointLights.size(); i++)
+            lights->DestroyPointLight(pointLights[i]);
+
+        printf("    relight %u objects in update: %.2f ms\n", objectCount, relightMs);
+        printf("    collect %u of %u objects: 1 thread %.2f ms, %u threads %.2f ms\n",
+            (uint32_t)serialList.size(), objectCount, serialMs, WorkerPool::Inst()->GetThreadCount(), parallelMs);
+        return true;
+    }
+}
@@ -0,0 +1,347 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// records the property writes of an editing session on 10k objects of its own,
+// then replays them with CommandBuffer::Execute() and with one GobBridge::SetProperty()
+// per write, as LvEd_SetObjectProperty() did, and checks that both leave the
+// objects in the same state. the timings do not include the P/Invoke call of each
+// LvEd_SetObjectProperty(), only the native side of both paths.
+
+#include <vector>
+#include <string.h>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Core/Object.h"
+#include "../LvEdRenderingEngine/Core/ObjectTable.h"
+#include "../LvEdRenderingEngine/Core/Logger.h"
+#include "../LvEdRenderingEngine/Bridge/GobBridge.h"
+#include "../LvEdRenderingEngine/Bridge/CommandBuffer.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    struct NodeState
+    {
+        float translate[3];
+        uint32_t color;
+        ObjectGUID target;
+
+        bool operator==(const NodeState& other) const
+        {
+            return memcmp(translate, other.translate, sizeof(translate)) == 0
+                && color == other.color && target == other.target;
+        }
+    };
+
+    // ----------------------------------------------------------------------------------
+    class BenchNode : public Object
+    {
+    public:
+        BenchNode() { Reset(); }
+        virtual const char* ClassName() const { return "BenchNode"; }
+
+        void Reset()
+        {
+            memset(&state, 0, sizeof(state));
+            setCount = 0;
+        }
+
+        NodeState state;
+        uint32_t setCount;
+
+        static Object* Create(ObjectTypeGUID /*tid*/, void* /*data*/, int /*size*/)
+        {
+            return new BenchNode();
+        }
+
+        static void SetTranslate(ObjectGUID instanceId, void* data, int size)
+        {
+            BenchNode* node = ObjectTable::Inst()->GetAs<BenchNode>(instanceId);
+            if(size == sizeof(node->state.translate))
+                memcpy(node->state.translate, data, size);
+            node->setCount++;
+        }
+
+        static void SetColor(ObjectGUID instanceId, void* data, int size)
+        {
+            BenchNode* node = ObjectTable::Inst()->GetAs<BenchNode>(instanceId);
+            if(size == sizeof(node->state.color))
+                node->state.color = *(uint32_t*)data;
+            node->setCount++;
+        }
+
+        // reference property, data is the instance id of the target.
+        static void SetTarget(ObjectGUID instanceId, void* data, int /*size*/)
+        {
+            BenchNode* node = ObjectTable::Inst()->GetAs<BenchNode>(instanceId);
+            node->state.target = (ObjectGUID)data;
+            node->setCount++;
+        }
+    };
+
+    // ----------------------------------------------------------------------------------
+    // one property write of the session, the data is at offset in the write data.
+    struct RecordedWrite
+    {
+        ObjectGUID instanceId;
+        ObjectTypeGUID typeId;
+        ObjectPropertyUID propId;
+        uint32_t size;
+        uint32_t flags;
+        uint32_t offset;
+    };
+
+    // ----------------------------------------------------------------------------------
+    // the writes of the session, and the command buffers the editor would have sent.
+    class SessionRecorder
+    {
+    public:
+        SessionRecorder() : m_bufferStart(0) {}
+
+        void Write(ObjectGUID instanceId, ObjectTypeGUID typeId, ObjectPropertyUID propId, const void* data, uint32_t size, uint32_t flags)
+        {
+            RecordedWrite write = { instanceId, typeId, propId, size, flags, (uint32_t)m_data.size() };
+            m_writes.push_back(write);
+            m_data.insert(m_data.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+
+            CommandHeader header = { instanceId, typeId, propId, size, flags };
+            m_commands.insert(m_commands.end(), (const uint8_t*)&header, (const uint8_t*)(&header + 1));
+            m_commands.insert(m_commands.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+            m_commands.resize((m_commands.size() + CommandBuffer::Alignment - 1) & ~(size_t)(CommandBuffer::Alignment - 1), 0);
+        }
+
+        // ends the current command buffer, as the editor does once per frame.
+        void Flush()
+        {
+            if(m_commands.size() == m_bufferStart)
+                return;
+            m_buffers.push_back(std::make_pair(m_bufferStart, (uint32_t)(m_commands.size() - m_bufferStart)));
+            m_bufferStart = (uint32_t)m_commands.size();
+        }
+
+        // one SetProperty() per write.
+        void ReplayWrites(GobBridge& bridge) const
+        {
+            for(size_t i = 0; i < m_writes.size(); i++)
+            {
+                const RecordedWrite& w = m_writes[i];
+                void* data = (void*)&m_data[w.offset];
+                if(w.flags & CommandFlags::Reference)
+                    data = (void*)*(const ObjectGUID*)data;
+                bridge.SetProperty(w.typeId, w.propId, w.instanceId, data, (int)w.size);
+            }
+        }
+
+        // one Execute() per buffer, returns the number of writes applied.
+        int ReplayBuffers(GobBridge& bridge) const
+        {
+            int applied = 0;
+            for(size_t i = 0; i < m_buffers.size(); i++)
+            {
+                int count = CommandBuffer::Execute(bridge, &m_commands[m_buffers[i].first], m_buffers[i].second);
+                if(count < 0)
+                    return -1;
+                applied += count;
+            }
+            return applied;
+        }
+
+        uint32_t GetWriteCount() const { return (uint32_t)m_writes.size(); }
+        uint32_t GetBufferCount() const { return (uint32_t)m_buffers.size(); }
+        uint32_t GetByteCount() const { return (uint32_t)m_commands.size(); }
+
+    private:
+        std::vector<RecordedWrite> m_writes;
+        std::vector<uint8_t> m_data;
+        std::vector<uint8_t> m_commands;
+        std::vector<std::pair<uint32_t, uint32_t> > m_buffers;
+        uint32_t m_bufferStart;
+    };
+
+    // ----------------------------------------------------------------------------------
+    static uint32_t s_errorCount = 0;
+
+    static void __stdcall CountErrors(int messageType, wchar_t* /*text*/)
+    {
+        if(messageType == OutputMessageType::Error)
+            s_errorCount++;
+    }
+
+    // ----------------------------------------------------------------------------------
+    static void ResetNodes(std::vector<BenchNode*>& nodes)
+    {
+        for(size_t i = 0; i < nodes.size(); i++)
+            nodes[i]->Reset();
+    }
+
+    // ----------------------------------------------------------------------------------
+    static uint32_t CountSets(const std::vector<BenchNode*>& nodes)
+    {
+        uint32_t count = 0;
+        for(size_t i = 0; i < nodes.size(); i++)
+            count += nodes[i]->setCount;
+        return count;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // frames of the session: drags of a selection, which write the translation of each
+    // selected node every mouse move, color edits and target links.
+    static void RecordSession(BenchRandom& rnd, GobBridge& bridge, const std::vector<BenchNode*>& nodes, SessionRecorder& session)
+    {
+        const uint32_t frameCount = 300;
+        ObjectTypeGUID tid = bridge.GetTypeId("BenchNode");
+        ObjectPropertyUID translateId = bridge.GetPropertyId(tid, "translate");
+        ObjectPropertyUID colorId = bridge.GetPropertyId(tid, "color");
+        ObjectPropertyUID targetId = bridge.GetPropertyId(tid, "target");
+        uint32_t nodeCount = (uint32_t)nodes.size();
+        for(uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            uint32_t first = rnd.Below(nodeCount);
+            uint32_t selected = 1 + rnd.Below(200);
+            uint32_t moves = 1 + rnd.Below(8);
+            for(uint32_t m = 0; m < moves; m++)
+            {
+                for(uint32_t s = 0; s < selected; s++)
+                {
+                    ObjectGUID id = nodes[(first + s) % nodeCount]->GetInstanceId();
+                    float translate[3] = { rnd.Float(-100.0f, 100.0f), rnd.Float(0.0f, 10.0f), rnd.Float(-100.0f, 100.0f) };
+                    session.Write(id, tid, translateId, translate, sizeof(translate), CommandFlags::None);
+                }
+            }
+            for(uint32_t e = rnd.Below(16); e > 0; e--)
+            {
+                ObjectGUID id = nodes[rnd.Below(nodeCount)]->GetInstanceId();
+                uint32_t color = rnd.Next();
+                session.Write(id, tid, colorId, &color, sizeof(color), CommandFlags::None);
+            }
+            if(frame % 4 == 0)
+            {
+                ObjectGUID id = nodes[rnd.Below(nodeCount)]->GetInstanceId();
+                ObjectGUID target = nodes[rnd.Below(nodeCount)]->GetInstanceId();
+                session.Write(id, tid, targetId, &target, sizeof(target), CommandFlags::Reference);
+            }
+            session.Flush();
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    // a truncated write rejects the whole buffer, writes to stale ids are skipped.
+    static bool CheckErrors(GobBridge& bridge, std::vector<BenchNode*>& nodes)
+    {
+        ObjectTypeGUID tid = bridge.GetTypeId("BenchNode");
+        ObjectPropertyUID colorId = bridge.GetPropertyId(tid, "color");
+        ObjectGUID deadId = bridge.CreateObject(tid, NULL, 0);
+        bridge.DestroyObject(tid, deadId);
+
+        SessionRecorder session;
+        uint32_t color = 0xff00ff00;
+        session.Write(nodes[0]->GetInstanceId(), tid, colorId, &color, sizeof(color), CommandFlags::None);
+        session.Write(deadId, tid, colorId, &color, sizeof(color), CommandFlags::None);
+        session.Write(nodes[1]->GetInstanceId(), tid, colorId, &color, sizeof(color), CommandFlags::None);
+        session.Flush();
+
+        ResetNodes(nodes);
+        s_errorCount = 0;
+        BENCH_CHECK(session.ReplayBuffers(bridge) == 2);
+        BENCH_CHECK(s_errorCount == 1);
+        BENCH_CHECK(nodes[0]->state.color == color && nodes[1]->state.color == color);
+
+        // the last write is cut short.
+        ResetNodes(nodes);
+        std::vector<uint8_t> buffer(2 * (sizeof(CommandHeader) + CommandBuffer::Alignment));
+        CommandHeader* header = (CommandHeader*)&buffer[0];
+        header->instanceId = nodes[0]->GetInstanceId();
+        header->typeId = tid;
+        header->propId = colorId;
+        header->size = sizeof(color);
+        header->flags = CommandFlags::None;
+        header = (CommandHeader*)&buffer[sizeof(CommandHeader) + CommandBuffer::Alignment];
+        *header = *(CommandHeader*)&buffer[0];
+        header->size = 64;
+        BENCH_CHECK(CommandBuffer::Execute(bridge, &buffer[0], (uint32_t)buffer.size()) == -1);
+        BENCH_CHECK(CommandBuffer::Execute(bridge, &buffer[0], 4) == -1);
+        BENCH_CHECK(CountSets(nodes) == 0);
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // the buffers leave the nodes in the state of the writes, with one set call per
+    // property of each node and buffer.
+    static bool CheckReplay(GobBridge& bridge, std::vector<BenchNode*>& nodes, const SessionRecorder& session, int* applied)
+    {
+        ResetNodes(nodes);
+        session.ReplayWrites(bridge);
+        BENCH_CHECK(CountSets(nodes) == session.GetWriteCount());
+        std::vector<NodeState> expected(nodes.size());
+        for(size_t i = 0; i < nodes.size(); i++)
+            expected[i] = nodes[i]->state;
+
+        ResetNodes(nodes);
+        *applied = session.ReplayBuffers(bridge);
+        BENCH_CHECK(*applied > 0 && (uint32_t)*applied == CountSets(nodes));
+        BENCH_CHECK((uint32_t)*applied < session.GetWriteCount());
+        for(size_t i = 0; i < nodes.size(); i++)
+            BENCH_CHECK(nodes[i]->state == expected[i]);
+        BENCH_CHECK(s_errorCount == 0);
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool CommandBufferBench()
+    {
+        const uint32_t nodeCount = 10000;
+        const int runCount = 5;
+
+        // the log goes to CountErrors() until the nodes are destroyed.
+        Logger::SetLogCallback(&CountErrors);
+        s_errorCount = 0;
+
+        GobBridge bridge;
+        bridge.RegisterObject("BenchNode", &BenchNode::Create);
+        bridge.RegisterProperty("BenchNode", "translate", &BenchNode::SetTranslate, NULL);
+        bridge.RegisterProperty("BenchNode", "color", &BenchNode::SetColor, NULL);
+        bridge.RegisterProperty("BenchNode", "target", &BenchNode::SetTarget, NULL);
+        bridge.BuildDispatchTables();
+
+        ObjectTypeGUID tid = bridge.GetTypeId("BenchNode");
+        std::vector<BenchNode*> nodes(nodeCount);
+        for(uint32_t i = 0; i < nodeCount; i++)
+            nodes[i] = ObjectTable::Inst()->GetAs<BenchNode>(bridge.CreateObject(tid, NULL, 0));
+
+        BenchRandom rnd;
+        SessionRecorder session;
+        RecordSession(rnd, bridge, nodes, session);
+
+        int applied = 0;
+        bool passed = CheckReplay(bridge, nodes, session, &applied);
+
+        PerfTimer timer;
+        double writesMs = 0.0;
+        double buffersMs = 0.0;
+        for(int run = 0; run < runCount && passed; run++)
+        {
+            ResetNodes(nodes);
+            timer.Start();
+            session.ReplayWrites(bridge);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < writesMs)
+                writesMs = timer.ElapsedTimeMS();
+
+            ResetNodes(nodes);
+            timer.Start();
+            session.ReplayBuffers(bridge);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < buffersMs)
+                buffersMs = timer.ElapsedTimeMS();
+        }
+
+        passed = passed && CheckErrors(bridge, nodes);
+        for(uint32_t i = 0; i < nodeCount; i++)
+            bridge.DestroyObject(tid, nodes[i]->GetInstanceId());
+        Logger::SetLogCallback(NULL);
+        if(!passed)
+            return false;
+
+        printf("    %u writes in %u buffers of %u bytes, %d applied, best of %d: one call per write %.2f ms, command buffers %.2f ms\n",
+            session.GetWriteCount(), session.GetBufferCount(), session.GetByteCount(), applied, runCount, writesMs, buffersMs);
+        return true;
+    }
+}
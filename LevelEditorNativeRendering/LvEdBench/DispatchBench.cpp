@@ -0,0 +1,114 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times 10M GobBridge::SetProperty() calls on a bridge with as many properties as
+// the schema registers, with the registration maps and with the dispatch tables
+// of BuildDispatchTables(), and checks that both find the same set functions.
+
+#include <vector>
+#include <string>
+#include <string.h>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Core/Object.h"
+#include "../LvEdRenderingEngine/Core/Hasher.h"
+#include "../LvEdRenderingEngine/Bridge/GobBridge.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    class DispatchNode : public Object
+    {
+    public:
+        virtual const char* ClassName() const { return "DispatchNode"; }
+    };
+
+    // the set functions count their calls, a few of them so that a wrong slot shows.
+    static const uint32_t SetterCount = 4;
+    static uint32_t s_setCounts[SetterCount];
+
+    template<uint32_t N>
+    static void CountSet(ObjectGUID /*instanceId*/, void* /*data*/, int /*size*/)
+    {
+        s_setCounts[N]++;
+    }
+
+    static const SetPropertyFncPtr s_setters[SetterCount] =
+    {
+        &CountSet<0>, &CountSet<1>, &CountSet<2>, &CountSet<3>,
+    };
+
+    // ----------------------------------------------------------------------------------
+    static uint32_t TotalSets()
+    {
+        uint32_t total = 0;
+        for(uint32_t i = 0; i < SetterCount; i++)
+            total += s_setCounts[i];
+        return total;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // count SetProperty() calls over the ids, in a scattered order like the writes of a level.
+    static double TimeSets(GobBridge& bridge, const std::vector<std::pair<ObjectTypeGUID, ObjectPropertyUID> >& ids,
+        ObjectGUID instanceId, uint32_t count)
+    {
+        uint32_t idCount = (uint32_t)ids.size();
+        PerfTimer timer;
+        timer.Start();
+        for(uint32_t i = 0; i < count; i++)
+        {
+            const std::pair<ObjectTypeGUID, ObjectPropertyUID>& id = ids[(i * 7919u) % idCount];
+            bridge.SetProperty(id.first, id.second, instanceId, NULL, 0);
+        }
+        timer.Stop();
+        return timer.ElapsedTimeMS();
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool DispatchBench()
+    {
+        const uint32_t typeCount = 17;
+        const uint32_t propsPerType = 5;
+        const uint32_t setCount = 10000000;
+
+        GobBridge bridge;
+        std::vector<std::pair<ObjectTypeGUID, ObjectPropertyUID> > ids;
+        for(uint32_t t = 0; t < typeCount; t++)
+        {
+            std::string typeName = std::string("DispatchType") + (char)('A' + t);
+            for(uint32_t p = 0; p < propsPerType; p++)
+            {
+                std::string propName = std::string("property") + (char)('0' + p);
+                bridge.RegisterProperty(typeName.c_str(), propName.c_str(), s_setters[(t + p) % SetterCount], NULL);
+                ids.push_back(std::make_pair(Hash32(typeName.c_str()), Hash32(propName.c_str())));
+            }
+        }
+
+        // the functions found with the maps, then with the tables.
+        std::vector<SetPropertyFncPtr> mapFuncs(ids.size());
+        for(size_t i = 0; i < ids.size(); i++)
+            mapFuncs[i] = bridge.GetSetPropertyFunction(ids[i].first, ids[i].second);
+
+        DispatchNode node;
+        memset(s_setCounts, 0, sizeof(s_setCounts));
+        double mapMs = TimeSets(bridge, ids, node.GetInstanceId(), setCount);
+        uint32_t mapCounts[SetterCount];
+        memcpy(mapCounts, s_setCounts, sizeof(s_setCounts));
+
+        bridge.BuildDispatchTables();
+        for(size_t i = 0; i < ids.size(); i++)
+        {
+            BENCH_CHECK(mapFuncs[i] != NULL);
+            BENCH_CHECK(bridge.GetSetPropertyFunction(ids[i].first, ids[i].second) == mapFuncs[i]);
+        }
+        BENCH_CHECK(bridge.GetSetPropertyFunction(Hash32("DispatchTypeA"), Hash32("unknown")) == NULL);
+        BENCH_CHECK(bridge.GetSetPropertyFunction(Hash32("unknown"), Hash32("property0")) == NULL);
+
+        memset(s_setCounts, 0, sizeof(s_setCounts));
+        double tableMs = TimeSets(bridge, ids, node.GetInstanceId(), setCount);
+        BENCH_CHECK(TotalSets() == setCount);
+        BENCH_CHECK(memcmp(mapCounts, s_setCounts, sizeof(s_setCounts)) == 0);
+
+        printf("    %u property sets over %u ids: maps %.1f ms, dispatch tables %.1f ms\n",
+            setCount, (uint32_t)ids.size(), mapMs, tableMs);
+        return true;
+    }
+}
@@ -0,0 +1,222 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times LightingState::UpdateLightEnvironment() on a level of 10k objects
+// with 400 point and 100 box lights against the loops over all the lights
+// it replaced, and checks that both assign the same number of lights.
+// the environments are also updated on the worker pool, the light grids
+// are only read, and must match.
+
+#include <vector>
+#include <set>
+#include <string.h>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Renderer/Lights.h"
+#include "../LvEdRenderingEngine/Core/WorkerPool.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    // the light assignment before LightGrid: the first lights found in the sets.
+    static void AssignLinear(const std::set<BoxLight*>& boxLights, const std::set<PointLight*>& pointLights,
+        LightEnvironment& env, const AABB& bounds)
+    {
+        env.numBoxLights = 0;
+        env.numPointLights = 0;
+        for(auto it = boxLights.begin(); it != boxLights.end(); ++it)
+        {
+            BoxLight light = *(*it);
+            AABB lightBounds(light.min, light.max);
+            if(TestAABBAABB(bounds, lightBounds))
+            {
+                env.box[env.numBoxLights++] = light;
+                if(env.numBoxLights >= MAX_BOX_LIGHTS)
+                    break;
+            }
+        }
+        for(auto it = pointLights.begin(); it != pointLights.end(); ++it)
+        {
+            PointLight light = *(*it);
+            float3 pos(light.position.x, light.position.y, light.position.z);
+            float radius = light.position.w;
+            AABB sphereBounds(float3(pos.x - radius, pos.y - radius, pos.z - radius),
+                float3(pos.x + radius, pos.y + radius, pos.z + radius));
+            if(TestAABBAABB(bounds, sphereBounds))
+            {
+                env.point[env.numPointLights++] = light;
+                if(env.numPointLights >= MAX_POINT_LIGHTS)
+                    break;
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    static void RandomColor(BenchRandom& rnd, Light* light)
+    {
+        light->ambient = float3(rnd.Float(0.0f, 0.1f), rnd.Float(0.0f, 0.1f), rnd.Float(0.0f, 0.1f));
+        light->diffuse = float3(rnd.Float(0.0f, 1.0f), rnd.Float(0.0f, 1.0f), rnd.Float(0.0f, 1.0f));
+        light->specular = light->diffuse;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // the lights of the env are the ones of the level that touch the bounds.
+    static bool CheckAssigned(const LightEnvironment& env, const LightEnvironment& linearEnv, const AABB& bounds)
+    {
+        BENCH_CHECK(env.numBoxLights == linearEnv.numBoxLights);
+        BENCH_CHECK(env.numPointLights == linearEnv.numPointLights);
+        for(uint32_t i = 0; i < env.numBoxLights; i++)
+            BENCH_CHECK(TestAABBAABB(bounds, AABB(env.box[i].min, env.box[i].max)));
+        for(uint32_t i = 0; i < env.numPointLights; i++)
+        {
+            const float4& p = env.point[i].position;
+            BENCH_CHECK(TestAABBAABB(bounds, AABB(float3(p.x - p.w, p.y - p.w, p.z - p.w), float3(p.x + p.w, p.y + p.w, p.z + p.w))));
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    class RelightJob : public ParallelJob
+    {
+    public:
+        RelightJob(const std::vector<AABB>& objects, std::vector<LightEnvironment>& envs)
+            : m_objects(objects), m_envs(envs) {}
+
+        virtual void Execute(uint32_t index)
+        {
+            LightingState::Inst()->UpdateLightEnvironment(m_envs[index], m_objects[index]);
+        }
+
+    private:
+        const std::vector<AABB>& m_objects;
+        std::vector<LightEnvironment>& m_envs;
+    };
+
+    // ----------------------------------------------------------------------------------
+    static bool SameLights(const LightEnvironment& env1, const LightEnvironment& env2)
+    {
+        BENCH_CHECK(env1.numBoxLights == env2.numBoxLights && env1.numPointLights == env2.numPointLights);
+        BENCH_CHECK(memcmp(env1.box, env2.box, env1.numBoxLights * sizeof(BoxLight)) == 0);
+        BENCH_CHECK(memcmp(env1.point, env2.point, env1.numPointLights * sizeof(PointLight)) == 0);
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool LightAssignBench()
+    {
+        const uint32_t objectCount = 10000;
+        const uint32_t pointLightCount = 400;
+        const uint32_t boxLightCount = 100;
+        const float3 levelMin(-250.0f, 0.0f, -250.0f);
+        const float3 levelMax(250.0f, 50.0f, 250.0f);
+        const int runCount = 5;
+
+        BenchRandom rnd;
+        LightingState* lights = LightingState::Inst();
+        std::set<BoxLight*> boxLights;
+        std::set<PointLight*> pointLights;
+        for(uint32_t i = 0; i < pointLightCount; i++)
+        {
+            PointLight* light = lights->CreatePointLight();
+            RandomColor(rnd, light);
+            light->attenuation = float4(0.0f, 1.0f, 0.0f, 0.0f);
+            light->position = float4(rnd.Float(levelMin.x, levelMax.x), rnd.Float(levelMin.y, levelMax.y),
+                rnd.Float(levelMin.z, levelMax.z), rnd.Float(4.0f, 20.0f));
+            lights->UpdatePointLight(light);
+            pointLights.insert(light);
+        }
+        for(uint32_t i = 0; i < boxLightCount; i++)
+        {
+            BoxLight* light = lights->CreateBoxLight();
+            RandomColor(rnd, light);
+            light->dir = float3(0.0f, -1.0f, 0.0f);
+            light->attenuation = float4(0.0f, 1.0f, 0.0f, 0.0f);
+            float3 center(rnd.Float(levelMin.x, levelMax.x), rnd.Float(levelMin.y, levelMax.y), rnd.Float(levelMin.z, levelMax.z));
+            float3 extent(rnd.Float(4.0f, 20.0f), rnd.Float(4.0f, 20.0f), rnd.Float(4.0f, 20.0f));
+            light->min = center - extent;
+            light->max = center + extent;
+            lights->UpdateBoxLight(light);
+            boxLights.insert(light);
+        }
+
+        std::vector<AABB> objects(objectCount);
+        for(uint32_t i = 0; i < objectCount; i++)
+        {
+            float3 center(rnd.Float(levelMin.x, levelMax.x), rnd.Float(levelMin.y, levelMax.y), rnd.Float(levelMin.z, levelMax.z));
+            float3 extent(rnd.Float(0.5f, 4.0f), rnd.Float(0.5f, 4.0f), rnd.Float(0.5f, 4.0f));
+            objects[i] = AABB(center - extent, center + extent);
+        }
+
+        std::vector<LightEnvironment> envs(objectCount);
+        std::vector<LightEnvironment> linearEnvs(objectCount);
+        PerfTimer timer;
+        double linearMs = 0.0;
+        double gridMs = 0.0;
+        for(int run = 0; run < runCount; run++)
+        {
+            timer.Start();
+            for(uint32_t i = 0; i < objectCount; i++)
+                AssignLinear(boxLights, pointLights, linearEnvs[i], objects[i]);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < linearMs)
+                linearMs = timer.ElapsedTimeMS();
+
+            timer.Start();
+            for(uint32_t i = 0; i < objectCount; i++)
+                lights->UpdateLightEnvironment(envs[i], objects[i]);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < gridMs)
+                gridMs = timer.ElapsedTimeMS();
+        }
+
+        uint32_t assigned = 0;
+        for(uint32_t i = 0; i < objectCount; i++)
+        {
+            if(!CheckAssigned(envs[i], linearEnvs[i], objects[i]))
+                return false;
+            assigned += envs[i].numBoxLights + envs[i].numPointLights;
+        }
+
+        // the same environments, updated from all the threads at once.
+        std::vector<LightEnvironment> parallelEnvs(objectCount);
+        RelightJob job(objects, parallelEnvs);
+        timer.Start();
+        WorkerPool::Inst()->ParallelFor(&job, objectCount);
+        timer.Stop();
+        double parallelMs = timer.ElapsedTimeMS();
+        for(uint32_t i = 0; i < objectCount; i++)
+        {
+            if(!SameLights(parallelEnvs[i], envs[i]))
+                return false;
+        }
+
+        // small moves of all the point lights, most stay in the same cells.
+        timer.Start();
+        for(auto it = pointLights.begin(); it != pointLights.end(); ++it)
+        {
+            PointLight* light = *it;
+            light->position.x += rnd.Float(-0.5f, 0.5f);
+            light->position.z += rnd.Float(-0.5f, 0.5f);
+            lights->UpdatePointLight(light);
+        }
+        timer.Stop();
+        double moveMs = timer.ElapsedTimeMS();
+
+        for(uint32_t i = 0; i < objectCount; i++)
+        {
+            AssignLinear(boxLights, pointLights, linearEnvs[i], objects[i]);
+            lights->UpdateLightEnvironment(envs[i], objects[i]);
+            if(!CheckAssigned(envs[i], linearEnvs[i], objects[i]))
+                return false;
+        }
+
+        for(auto it = pointLights.begin(); it != pointLights.end(); ++it)
+            lights->DestroyPointLight(*it);
+        for(auto it = boxLights.begin(); it != boxLights.end(); ++it)
+            lights->DestroyBoxLight(*it);
+
+        printf("    relight %u objects, %u point and %u box lights, best of %d: all lights %.2f ms, light grid %.2f ms, %u lights assigned by both\n",
+            objectCount, pointLightCount, boxLightCount, runCount, linearMs, gridMs, assigned);
+        printf("    light grid on %u threads: %.2f ms, same lights\n", WorkerPool::Inst()->GetThreadCount(), parallelMs);
+        printf("    move %u point lights: %.3f ms\n", pointLightCount, moveMs);
+        return true;
+    }
+}
@@ -0,0 +1,84 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// LvEdBench [name...]
+// runs the named benches, all of them when no name is given.
+// the exit code is the number of failed benches.
+
+#include <string.h>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Core/WorkerPool.h"
+
+namespace LvEdEngine
+{
+    bool TriangleStreamBench();
+    bool RenderSortBench();
+    bool LightAssignBench();
+    bool CollectBench();
+    bool CommandBufferBench();
+    bool DispatchBench();
+    bool MeshBVHBench();
+    bool RetainedBench();
+    bool NodeCopyBench();
+    bool AABBTreeBench();
+}
+
+using namespace LvEdEngine;
+
+struct BenchEntry
+{
+    const char* name;
+    BenchFncPtr func;
+};
+
+static const BenchEntry s_benches[] =
+{
+    { "TriangleStream", &TriangleStreamBench },
+    { "RenderSort",     &RenderSortBench },
+    { "LightAssign",    &LightAssignBench },
+    { "Collect",        &CollectBench },
+    { "CommandBuffer",  &CommandBufferBench },
+    { "Dispatch",       &DispatchBench },
+    { "MeshBVH",        &MeshBVHBench },
+    { "Retained",       &RetainedBench },
+    { "NodeCopy",       &NodeCopyBench },
+    { "AABBTree",       &AABBTreeBench },
+};
+
+static const int BenchCount = sizeof(s_benches) / sizeof(s_benches[0]);
+
+// ----------------------------------------------------------------------------------
+static bool IsSelected(const char* name, int argc, char* argv[])
+{
+    if(argc < 2)
+        return true;
+    for(int i = 1; i < argc; i++)
+    {
+        if(_stricmp(argv[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    // the benches of the parallel code run on the same pool as the engine.
+    WorkerPool::InitInstance();
+
+    int failed = 0;
+    for(int i = 0; i < BenchCount; i++)
+    {
+        const BenchEntry& bench = s_benches[i];
+        if(!IsSelected(bench.name, argc, argv))
+            continue;
+
+        printf("%s\n", bench.name);
+        bool passed = bench.func();
+        printf("%s: %s\n\n", bench.name, passed ? "passed" : "FAILED");
+        if(!passed)
+            failed++;
+    }
+
+    WorkerPool::DestroyInstance();
+    return failed;
+}
@@ -0,0 +1,230 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// loads the triangles of the sample .atgi models, builds the BVH of each mesh as
+// Mesh::BuildBVH() does, and checks that MeshIntersects() finds the same hits
+// with and without it on random rays aimed at the mesh. then times both.
+
+#include <vector>
+#include <string>
+#include <string.h>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Core/FileUtils.h"
+#include "../LvEdRenderingEngine/Model3d/rapidxmlhelpers.h"
+#include "../LvEdRenderingEngine/VectorMath/BVH.h"
+
+namespace LvEdEngine
+{
+    // the models are looked for in these folders, relative to the project folder,
+    // the output folder and the repository root.
+    static const wchar_t* s_assetFolders[] =
+    {
+        L"../../AssetRoot/",
+        L"../../../../AssetRoot/",
+        L"AssetRoot/",
+    };
+
+    static const wchar_t* s_modelFiles[] =
+    {
+        L"Rocks/rock03.atgi",
+        L"Rocks/rock04.atgi",
+        L"Trees/tree_03_flattened.atgi",
+        L"Trees/tree_04_flattened.atgi",
+    };
+
+    // the positions and triangle list indices of one primitives element,
+    // the engine makes a mesh of each.
+    struct BenchMesh
+    {
+        std::string name;
+        std::vector<float3> pos;
+        std::vector<uint32_t> indices;
+    };
+
+    // ----------------------------------------------------------------------------------
+    // the polygons of the primitives are split in fans as by Model3dBuilder::Mesh_AddPolys().
+    static void LoadPrimitives(xml_node* xmlPrim, const std::vector<float3>& pos, BenchMesh* mesh)
+    {
+        uint32_t stride = 0;
+        uint32_t posOffset = 0;
+        for(xml_node* input = FindChildByName(xmlPrim, "binding"); input != NULL; input = FindNextByName(input, "binding"))
+        {
+            const char* source = GetAttributeText(input, "source", false);
+            if(!source) continue;
+            if(strcmp(source, "position") == 0)
+                posOffset = stride;
+            stride++;
+        }
+
+        std::vector<unsigned int> sizes;
+        std::vector<unsigned int> indices;
+        ParseUINTArray(FindChildByName(xmlPrim, "sizes"), &sizes);
+        ParseUINTArray(FindChildByName(xmlPrim, "indices"), &indices);
+
+        mesh->pos = pos;
+        uint32_t current = 0;
+        for(size_t i = 0; i < sizes.size(); i++)
+        {
+            for(uint32_t v = 2; v < sizes[i]; v++)
+            {
+                mesh->indices.push_back(indices[current + posOffset]);
+                mesh->indices.push_back(indices[current + (v - 1) * stride + posOffset]);
+                mesh->indices.push_back(indices[current + v * stride + posOffset]);
+            }
+            current += sizes[i] * stride;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    static bool LoadModel(const std::wstring& filename, std::vector<BenchMesh>* meshes)
+    {
+        UINT size;
+        BYTE* data = FileUtils::LoadFile(filename.c_str(), &size);
+        if(!data)
+            return false;
+
+        xml_document doc;
+        doc.parse<0>((char*)data);
+
+        std::vector<xml_node*> xmlMeshes;
+        FindAllByName(doc.first_node(), "mesh", true, &xmlMeshes);
+        for(size_t m = 0; m < xmlMeshes.size(); m++)
+        {
+            xml_node* vertexArray = FindChildByName(xmlMeshes[m], "vertexArray");
+            if(!vertexArray) continue;
+
+            std::vector<float3> pos;
+            for(xml_node* source = FindChildByName(vertexArray, "array"); source != NULL; source = FindNextByName(source, "array"))
+            {
+                const char* name = GetAttributeText(source, "name", false);
+                if(name && strcmp(name, "position") == 0)
+                    ParseVector3Array(source, &pos);
+            }
+
+            for(xml_node* xmlPrim = FindChildByName(vertexArray, "primitives"); xmlPrim != NULL; xmlPrim = FindNextByName(xmlPrim, "primitives"))
+            {
+                BenchMesh mesh;
+                const char* shader = GetAttributeText(xmlPrim, "shader", false);
+                mesh.name = shader ? shader : "";
+                LoadPrimitives(xmlPrim, pos, &mesh);
+                if(mesh.indices.size() >= 3)
+                    meshes->push_back(mesh);
+            }
+        }
+        delete[] data;
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // a ray from outside the bounds aimed at a point inside them, as the picking rays.
+    static Ray RandomMeshRay(BenchRandom& rnd, const AABB& bounds)
+    {
+        float3 center = (bounds.Min() + bounds.Max()) * 0.5f;
+        float3 extent = (bounds.Max() - bounds.Min()) * 0.5f;
+        float radius = length(extent) * 2.0f;
+        float3 from(rnd.Float(-1.0f, 1.0f), rnd.Float(-1.0f, 1.0f), rnd.Float(-1.0f, 1.0f));
+        from = center + normalize(from) * radius;
+        float3 to(rnd.Float(bounds.Min().x, bounds.Max().x), rnd.Float(bounds.Min().y, bounds.Max().y),
+            rnd.Float(bounds.Min().z, bounds.Max().z));
+        return Ray(from, to - from);
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool MeshBVHBench()
+    {
+        const uint32_t rayCount = 5000;
+        const bool backfaceCull = true;
+
+        std::wstring folder;
+        for(size_t i = 0; i < sizeof(s_assetFolders) / sizeof(s_assetFolders[0]); i++)
+        {
+            if(FileUtils::Exists((std::wstring(s_assetFolders[i]) + s_modelFiles[0]).c_str()))
+            {
+                folder = s_assetFolders[i];
+                break;
+            }
+        }
+        if(folder.empty())
+            printf("    the sample models are not found, run from the project or the output folder.\n");
+        BENCH_CHECK(!folder.empty());
+
+        BenchRandom rnd;
+        double totalLinearMs = 0.0;
+        double totalBVHMs = 0.0;
+        for(size_t f = 0; f < sizeof(s_modelFiles) / sizeof(s_modelFiles[0]); f++)
+        {
+            std::vector<BenchMesh> meshes;
+            BENCH_CHECK(LoadModel(folder + s_modelFiles[f], &meshes));
+            BENCH_CHECK(!meshes.empty());
+
+            for(size_t m = 0; m < meshes.size(); m++)
+            {
+                BenchMesh& mesh = meshes[m];
+                uint32_t posCount = (uint32_t)mesh.pos.size();
+                uint32_t indexCount = (uint32_t)mesh.indices.size();
+
+                PerfTimer timer;
+                timer.Start();
+                BVH bvh;
+                bvh.BuildFromTriangles(&mesh.pos[0], &mesh.indices[0], indexCount);
+                timer.Stop();
+                double buildMs = timer.ElapsedTimeMS();
+
+                AABB bounds(bvh.Nodes()[0].min, bvh.Nodes()[0].max);
+                std::vector<Ray> rays(rayCount);
+                for(uint32_t r = 0; r < rayCount; r++)
+                    rays[r] = RandomMeshRay(rnd, bounds);
+
+                // the hits must match the linear loop exactly, vertex snapping depends on them.
+                uint32_t hitCount = 0;
+                for(uint32_t r = 0; r < rayCount; r++)
+                {
+                    float t0 = 0, t1 = 0;
+                    float3 p0, p1, n0, n1, v0, v1;
+                    bool hit0 = MeshIntersects(rays[r], &mesh.pos[0], posCount, &mesh.indices[0], indexCount,
+                        backfaceCull, &t0, &p0, &n0, &v0);
+                    bool hit1 = MeshIntersects(rays[r], &mesh.pos[0], posCount, &mesh.indices[0], indexCount,
+                        backfaceCull, &t1, &p1, &n1, &v1, &bvh);
+                    BENCH_CHECK(hit0 == hit1);
+                    if(!hit0) continue;
+                    hitCount++;
+                    BENCH_CHECK(t0 == t1);
+                    BENCH_CHECK(p0 == p1 && n0 == n1 && v0 == v1);
+                }
+                BENCH_CHECK(hitCount > 0);
+
+                float t;
+                float3 p, n, v;
+                uint32_t linearHits = 0;
+                timer.Start();
+                for(uint32_t r = 0; r < rayCount; r++)
+                {
+                    if(MeshIntersects(rays[r], &mesh.pos[0], posCount, &mesh.indices[0], indexCount,
+                        backfaceCull, &t, &p, &n, &v))
+                        linearHits++;
+                }
+                timer.Stop();
+                double linearMs = timer.ElapsedTimeMS();
+
+                uint32_t bvhHits = 0;
+                timer.Start();
+                for(uint32_t r = 0; r < rayCount; r++)
+                {
+                    if(MeshIntersects(rays[r], &mesh.pos[0], posCount, &mesh.indices[0], indexCount,
+                        backfaceCull, &t, &p, &n, &v, &bvh))
+                        bvhHits++;
+                }
+                timer.Stop();
+                double bvhMs = timer.ElapsedTimeMS();
+                BENCH_CHECK(linearHits == hitCount && bvhHits == hitCount);
+
+                totalLinearMs += linearMs;
+                totalBVHMs += bvhMs;
+                printf("    %ls %s: %u triangles, %u nodes built in %.2f ms, %u rays %u hits: linear %.1f ms, bvh %.1f ms\n",
+                    s_modelFiles[f], mesh.name.c_str(), indexCount / 3, (uint32_t)bvh.Nodes().size(), buildMs,
+                    rayCount, hitCount, linearMs, bvhMs);
+            }
+        }
+        printf("    all meshes: linear %.1f ms, bvh %.1f ms\n", totalLinearMs, totalBVHMs);
+        return true;
+    }
+}
@@ -0,0 +1,116 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times the collection of 100k temporary nodes by RenderableNodeSorter, which
+// copies them into its frame pages, and by RenderableNodeSet, the pick set, which
+// copies them into its list. the same copies are timed with the node layout that
+// kept its material and light environment inline, before they were split out.
+
+#include <vector>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Renderer/RenderableNodeSorter.h"
+#include "../LvEdRenderingEngine/Renderer/RenderableNodeSet.h"
+#include "../LvEdRenderingEngine/Renderer/RenderContext.h"
+#include "../LvEdRenderingEngine/Renderer/RenderState.h"
+#include "../LvEdRenderingEngine/Renderer/Model.h"
+
+namespace LvEdEngine
+{
+    // the node before NodeMaterial, with its material and lighting copied along.
+    struct InlineNode
+    {
+        RenderableNode   node;
+        NodeMaterial     material;
+        LightEnvironment lighting;
+    };
+
+    // ----------------------------------------------------------------------------------
+    bool NodeCopyBench()
+    {
+        const uint32_t nodeCount = 100000;
+        const int runCount = 5;
+
+        RenderContext::InitInstance(NULL);
+        RenderState state;
+        RenderContext::Inst()->SetState(&state);
+
+        // Mesh::~Mesh() releases the GPU buffers and is not part of the bench, the mesh is leaked.
+        static Mesh* s_mesh = new Mesh();
+        NodeMaterial material;
+        LightEnvironment lighting = LightEnvironment();
+
+        BenchRandom rnd;
+        RenderNodeList nodes(nodeCount);
+        for(uint32_t i = 0; i < nodeCount; i++)
+        {
+            RenderableNode& r = nodes[i];
+            float3 center(rnd.Float(-500.0f, 500.0f), rnd.Float(0.0f, 50.0f), rnd.Float(-500.0f, 500.0f));
+            r.mesh = s_mesh;
+            r.WorldXform = Matrix::CreateTranslation(center);
+            r.bounds = AABB(center - float3(1.0f, 1.0f, 1.0f), center + float3(1.0f, 1.0f, 1.0f));
+            r.material = &material;
+            r.lighting = &lighting;
+        }
+
+        RenderableNodeSorter sorter;
+        sorter.SetFlags((GlobalRenderFlagsEnum)(GlobalRenderFlags::Solid | GlobalRenderFlags::Textured | GlobalRenderFlags::Lit));
+        RenderableNodeSet pickSet;
+        std::vector<InlineNode> inlineNodes;
+        inlineNodes.reserve(nodeCount);
+        InlineNode inlineNode;
+        inlineNode.material = material;
+        inlineNode.lighting = lighting;
+
+        double sorterMs = 0.0;
+        double pickMs = 0.0;
+        double inlineMs = 0.0;
+        PerfTimer timer;
+        for(int run = 0; run < runCount; run++)
+        {
+            // the lists keep their capacity between frames, as in the engine.
+            timer.Start();
+            sorter.ClearLists();
+            for(uint32_t i = 0; i < nodeCount; i++)
+                sorter.Add(nodes[i], RenderFlags::Textured, Shaders::TexturedShader);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < sorterMs)
+                sorterMs = timer.ElapsedTimeMS();
+
+            timer.Start();
+            pickSet.ClearLists();
+            pickSet.Add(nodes.begin(), nodes.end(), RenderFlags::None, Shaders::TexturedShader);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < pickMs)
+                pickMs = timer.ElapsedTimeMS();
+
+            timer.Start();
+            inlineNodes.clear();
+            for(uint32_t i = 0; i < nodeCount; i++)
+            {
+                inlineNode.node = nodes[i];
+                inlineNodes.push_back(inlineNode);
+            }
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < inlineMs)
+                inlineMs = timer.ElapsedTimeMS();
+        }
+
+        uint32_t sorterCopies = sorter.Debug_GetCopyCount();
+        uint32_t pickCopies = (uint32_t)pickSet.GetList().size();
+        BENCH_CHECK(sorterCopies == nodeCount);
+        BENCH_CHECK(pickCopies == nodeCount);
+        BENCH_CHECK(pickSet.GetList()[nodeCount - 1].material == &material);
+        sorter.ClearLists();
+        pickSet.ClearLists();
+        RenderContext::DestroyInstance();
+
+        printf("    node %u bytes, with its material and lighting inline %u bytes\n",
+            (uint32_t)sizeof(RenderableNode), (uint32_t)sizeof(InlineNode));
+        printf("    sorter:   %u nodes, %u KB copied, %.2f ms\n", sorterCopies,
+            (uint32_t)(sorterCopies * sizeof(RenderableNode) / 1024), sorterMs);
+        printf("    pick set: %u nodes, %u KB copied, %.2f ms\n", pickCopies,
+            (uint32_t)(pickCopies * sizeof(RenderableNode) / 1024), pickMs);
+        printf("    inline:   %u nodes, %u KB copied, %.2f ms\n", nodeCount,
+            (uint32_t)(nodeCount * sizeof(InlineNode) / 1024), inlineMs);
+        return true;
+    }
+}
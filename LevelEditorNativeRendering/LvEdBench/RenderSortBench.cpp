@@ -0,0 +1,257 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times the DrawKeys sort of RenderableNodeSorter on 100k nodes against the
+// std::map buckets it replaced, and checks that both give the same draw order.
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/VectorMath/V3dMath.h"
+#include "../LvEdRenderingEngine/Renderer/RenderEnums.h"
+#include "../LvEdRenderingEngine/Renderer/DrawKeys.h"
+
+namespace LvEdEngine
+{
+    struct SortNode
+    {
+        float3   center;
+        uint32_t renderFlags;
+        uint32_t shaderId;
+        float    distance;  // scratch of the map buckets, as the old RenderableNode::Distance.
+    };
+
+    struct SortBucket
+    {
+        uint32_t renderFlags;
+        uint32_t shaderId;
+        std::vector<SortNode*> nodes;
+    };
+
+    // the flags and shader of the nodes, about one in ten is blended.
+    static const uint32_t s_nodeKinds[][2] =
+    {
+        { RenderFlags::Textured | RenderFlags::Lit, 3 },
+        { RenderFlags::Textured | RenderFlags::Lit, 3 },
+        { RenderFlags::Textured | RenderFlags::Lit | RenderFlags::RenderBackFace, 3 },
+        { RenderFlags::Lit, 2 },
+        { RenderFlags::None, 1 },
+        { RenderFlags::Textured | RenderFlags::Lit, 3 },
+        { RenderFlags::Textured | RenderFlags::Lit, 3 },
+        { RenderFlags::Lit, 2 },
+        { RenderFlags::Textured | RenderFlags::Lit, 3 },
+        { RenderFlags::Textured | RenderFlags::Lit | RenderFlags::AlphaBlend, 3 },
+    };
+
+    // ----------------------------------------------------------------------------------
+    // the sorter before DrawKeys: one vector per (flags << 10 | shader) key,
+    // then the blended buckets sorted by distance.
+    class MapSorter
+    {
+    public:
+        void Sort(std::vector<SortNode>& nodes, const float3& camPos, const float3& camLook)
+        {
+            for(auto it = m_buckets.begin(); it != m_buckets.end(); ++it)
+                it->second.nodes.clear();
+
+            for(size_t i = 0; i < nodes.size(); i++)
+            {
+                SortNode& n = nodes[i];
+                uint32_t key = (n.renderFlags << 10) | n.shaderId;
+                auto it = m_buckets.find(key);
+                if(it == m_buckets.end())
+                {
+                    SortBucket bucket;
+                    bucket.renderFlags = n.renderFlags;
+                    bucket.shaderId = n.shaderId;
+                    it = m_buckets.insert(std::make_pair(key, bucket)).first;
+                }
+                it->second.nodes.push_back(&n);
+            }
+
+            for(auto it = m_buckets.begin(); it != m_buckets.end(); ++it)
+            {
+                SortBucket& bucket = it->second;
+                if(bucket.nodes.empty() || !(bucket.renderFlags & RenderFlags::AlphaBlend))
+                    continue;
+                for(size_t i = 0; i < bucket.nodes.size(); i++)
+                    bucket.nodes[i]->distance = dot(camLook, bucket.nodes[i]->center - camPos);
+                std::sort(bucket.nodes.begin(), bucket.nodes.end(), &MapSorter::Greater);
+            }
+        }
+
+        // the buckets of the opaque pass, then the ones of the blended pass,
+        // as LvEd_RenderGame draws them.
+        void GetDrawOrder(std::vector<const SortBucket*>& order) const
+        {
+            order.clear();
+            for(int pass = 0; pass < 2; pass++)
+            {
+                for(auto it = m_buckets.begin(); it != m_buckets.end(); ++it)
+                {
+                    bool blended = (it->second.renderFlags & RenderFlags::AlphaBlend) != 0;
+                    if(!it->second.nodes.empty() && blended == (pass == 1))
+                        order.push_back(&it->second);
+                }
+            }
+        }
+
+    private:
+        static bool Greater(const SortNode* n1, const SortNode* n2)
+        {
+            return n1->distance > n2->distance;
+        }
+
+        std::map<uint32_t, SortBucket> m_buckets;
+    };
+
+    // ----------------------------------------------------------------------------------
+    // AddEntry() and Sort() of RenderableNodeSorter.
+    class KeySorter
+    {
+    public:
+        KeySorter() : m_bucketCount(0) {}
+
+        void Sort(std::vector<SortNode>& nodes, const float3& camPos, const float3& camLook)
+        {
+            m_entries.clear();
+            for(size_t i = 0; i < nodes.size(); i++)
+            {
+                const SortNode& n = nodes[i];
+                bool blended = (n.renderFlags & RenderFlags::AlphaBlend) != 0;
+                float depth = blended ? dot(camLook, n.center - camPos) : 0.0f;
+                m_entries.push_back(DrawKeys::MakeEntry(n.renderFlags, n.shaderId, blended, depth, (uint32_t)i));
+            }
+
+            m_keys.Sort(m_entries);
+
+            for(uint32_t b = 0; b < m_bucketCount; b++)
+                m_buckets[b].nodes.clear();
+            m_bucketCount = 0;
+            uint32_t bucketKey = ~0u;
+            SortBucket* bucket = NULL;
+            for(size_t i = 0; i < m_entries.size(); i++)
+            {
+                uint32_t key = DrawKeys::GetBucket(m_entries[i]);
+                if(key != bucketKey)
+                {
+                    bucketKey = key;
+                    if(m_bucketCount == m_buckets.size())
+                        m_buckets.push_back(SortBucket());
+                    bucket = &m_buckets[m_bucketCount++];
+                    bucket->shaderId = key & ((1 << DrawKeys::ShaderBits) - 1);
+                    bucket->renderFlags = key >> DrawKeys::ShaderBits;
+                }
+                bucket->nodes.push_back(&nodes[DrawKeys::GetIndex(m_entries[i])]);
+            }
+        }
+
+        uint32_t GetBucketCount() const { return m_bucketCount; }
+        const SortBucket& GetBucket(uint32_t index) const { return m_buckets[index]; }
+
+    private:
+        std::vector<uint64_t> m_entries;
+        DrawKeys m_keys;
+        std::vector<SortBucket> m_buckets;
+        uint32_t m_bucketCount;
+    };
+
+    // ----------------------------------------------------------------------------------
+    static void BuildNodes(BenchRandom& rnd, uint32_t count, std::vector<SortNode>& nodes)
+    {
+        const uint32_t kindCount = sizeof(s_nodeKinds) / sizeof(s_nodeKinds[0]);
+        nodes.resize(count);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            SortNode& n = nodes[i];
+            n.center = float3(rnd.Float(-500.0f, 500.0f), rnd.Float(-50.0f, 50.0f), rnd.Float(-500.0f, 500.0f));
+            // every 64th node repeats the position of the previous one, to check the ties.
+            if(i % 64 == 63)
+                n.center = nodes[i - 1].center;
+            const uint32_t* kind = s_nodeKinds[rnd.Below(kindCount)];
+            n.renderFlags = kind[0];
+            n.shaderId = kind[1];
+            n.distance = 0.0f;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    // same buckets in the same order, the opaque nodes in the same order and the
+    // blended ones back to front, nodes at the same depth in the order they were added.
+    static bool CheckOrder(const MapSorter& mapSorter, const KeySorter& keySorter, const float3& camPos, const float3& camLook)
+    {
+        std::vector<const SortBucket*> order;
+        mapSorter.GetDrawOrder(order);
+        BENCH_CHECK(order.size() == keySorter.GetBucketCount());
+        for(uint32_t b = 0; b < keySorter.GetBucketCount(); b++)
+        {
+            const SortBucket& expected = *order[b];
+            const SortBucket& actual = keySorter.GetBucket(b);
+            BENCH_CHECK(expected.renderFlags == actual.renderFlags && expected.shaderId == actual.shaderId);
+            BENCH_CHECK(expected.nodes.size() == actual.nodes.size());
+            if(!(actual.renderFlags & RenderFlags::AlphaBlend))
+            {
+                BENCH_CHECK(std::equal(expected.nodes.begin(), expected.nodes.end(), actual.nodes.begin()));
+                continue;
+            }
+
+            std::vector<const SortNode*> expectedSet(expected.nodes.begin(), expected.nodes.end());
+            std::vector<const SortNode*> actualSet(actual.nodes.begin(), actual.nodes.end());
+            std::sort(expectedSet.begin(), expectedSet.end());
+            std::sort(actualSet.begin(), actualSet.end());
+            BENCH_CHECK(expectedSet == actualSet);
+            for(size_t i = 1; i < actual.nodes.size(); i++)
+            {
+                float d0 = dot(camLook, actual.nodes[i - 1]->center - camPos);
+                float d1 = dot(camLook, actual.nodes[i]->center - camPos);
+                // the depth in the key keeps 15 bits of the mantissa.
+                BENCH_CHECK(d0 >= d1 - fabsf(d1) * (1.0f / 16384.0f));
+                if(d0 == d1)
+                    BENCH_CHECK(actual.nodes[i - 1] < actual.nodes[i]);
+            }
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool RenderSortBench()
+    {
+        const uint32_t nodeCount = 100000;
+        const int runCount = 30;
+
+        BenchRandom rnd;
+        std::vector<SortNode> nodes;
+        BuildNodes(rnd, nodeCount, nodes);
+
+        MapSorter mapSorter;
+        KeySorter keySorter;
+        PerfTimer timer;
+        double mapMs = 0.0;
+        double keyMs = 0.0;
+        for(int run = 0; run < runCount; run++)
+        {
+            // a new view each run, as when the camera moves.
+            float3 camPos(rnd.Float(-600.0f, 600.0f), rnd.Float(0.0f, 100.0f), rnd.Float(-600.0f, 600.0f));
+            float3 camLook = normalize(float3(rnd.Float(-1.0f, 1.0f), rnd.Float(-0.5f, 0.0f), rnd.Float(-1.0f, 1.0f)));
+
+            timer.Start();
+            mapSorter.Sort(nodes, camPos, camLook);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < mapMs)
+                mapMs = timer.ElapsedTimeMS();
+
+            timer.Start();
+            keySorter.Sort(nodes, camPos, camLook);
+            timer.Stop();
+            if(run == 0 || timer.ElapsedTimeMS() < keyMs)
+                keyMs = timer.ElapsedTimeMS();
+
+            if(!CheckOrder(mapSorter, keySorter, camPos, camLook))
+                return false;
+        }
+
+        printf("    %u nodes, %u buckets, best of %d: map buckets %.3f ms, draw keys %.3f ms, same draw order\n",
+            nodeCount, keySorter.GetBucketCount(), runCount, mapMs, keyMs);
+        return true;
+    }
+}
@@ -0,0 +1,148 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// times a frame of RenderableNodeSorter over the render packets of 50k primitive
+// shapes, added as temporary nodes, the way every node was copied into its bucket
+// before the packets were retained, and with AddRetained(). reports the nodes and
+// bytes copied by each and checks that both draw the same nodes in the same order.
+
+#include <vector>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/Core/ObjectTable.h"
+#include "../LvEdRenderingEngine/Renderer/RenderableNodeSorter.h"
+#include "../LvEdRenderingEngine/Renderer/RenderContext.h"
+#include "../LvEdRenderingEngine/Renderer/RenderState.h"
+#include "../LvEdRenderingEngine/Renderer/Model.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    // a primitive shape and its retained render packet.
+    class RetainedShape : public Object
+    {
+    public:
+        virtual const char* ClassName() const { return "RetainedShape"; }
+        RenderableNode packet;
+        RenderFlagsEnum flags;
+    };
+
+    // ----------------------------------------------------------------------------------
+    // one frame: clear, add the packets of all the shapes, sort.
+    static double TimeFrame(RenderableNodeSorter& sorter, std::vector<RetainedShape*>& shapes, bool retained)
+    {
+        PerfTimer timer;
+        timer.Start();
+        sorter.ClearLists();
+        for(size_t i = 0; i < shapes.size(); i++)
+        {
+            RetainedShape* shape = shapes[i];
+            if(retained)
+                sorter.AddRetained(&shape->packet, shape->flags, Shaders::TexturedShader);
+            else
+                sorter.Add(shape->packet, shape->flags, Shaders::TexturedShader);
+        }
+        sorter.Sort();
+        timer.Stop();
+        return timer.ElapsedTimeMS();
+    }
+
+    // ----------------------------------------------------------------------------------
+    // the object ids of the nodes in draw order.
+    static void GetDrawOrder(RenderableNodeSorter& sorter, std::vector<ObjectGUID>& order)
+    {
+        order.clear();
+        for(uint32_t b = 0; b < sorter.GetBucketCount(); b++)
+        {
+            RenderNodeRefList& nodes = sorter.GetBucket(b)->renderables;
+            for(auto it = nodes.begin(); it != nodes.end(); ++it)
+                order.push_back((*it)->objectId);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool RetainedBench()
+    {
+        const uint32_t shapeCount = 50000;
+        const uint32_t selectedCount = 500;
+        const int runCount = 5;
+
+        RenderContext::InitInstance(NULL);
+        RenderState state;
+        state.SetSelectionColor(float4(1.0f, 1.0f, 0.0f, 1.0f));
+        state.SetWireframeColor(float4(0.0f, 0.0f, 0.0f, 1.0f));
+        RenderContext::Inst()->SetState(&state);
+        RenderContext::Inst()->Cam().SetViewProj(
+            Matrix::CreateLookAtRH(float3(0.0f, 40.0f, -520.0f), float3(0.0f, 0.0f, 0.0f), float3(0.0f, 1.0f, 0.0f)),
+            Matrix::CreatePerspectiveFieldOfView(0.6f, 16.0f / 9.0f, 1.0f, 1200.0f));
+
+        // Mesh::~Mesh() releases the GPU buffers and is not part of the bench, the mesh is leaked.
+        static Mesh* s_mesh = new Mesh();
+
+        BenchRandom rnd;
+        std::vector<RetainedShape*> shapes(shapeCount);
+        std::vector<ObjectGUID> selection;
+        for(uint32_t i = 0; i < shapeCount; i++)
+        {
+            RetainedShape* shape = new RetainedShape();
+            float3 center(rnd.Float(-500.0f, 500.0f), rnd.Float(0.0f, 50.0f), rnd.Float(-500.0f, 500.0f));
+            shape->packet.mesh = s_mesh;
+            shape->packet.objectId = shape->GetInstanceId();
+            shape->packet.WorldXform = Matrix::CreateTranslation(center);
+            shape->packet.bounds = AABB(center - float3(1.0f, 1.0f, 1.0f), center + float3(1.0f, 1.0f, 1.0f));
+            // about one in ten is blended.
+            uint32_t flags = RenderFlags::Textured | RenderFlags::Lit;
+            if(rnd.Below(10) == 0)
+            {
+                flags |= RenderFlags::AlphaBlend;
+                shape->packet.diffuse.w = 0.5f;
+            }
+            shape->flags = (RenderFlagsEnum)flags;
+            shapes[i] = shape;
+            if(i % (shapeCount / selectedCount) == 0)
+                selection.push_back(shape->GetInstanceId());
+        }
+        ObjectTable::Inst()->SetSelection(&selection[0], (int)selection.size());
+
+        RenderableNodeSorter sorter;
+        sorter.SetFlags((GlobalRenderFlagsEnum)(GlobalRenderFlags::Solid | GlobalRenderFlags::Textured | GlobalRenderFlags::Lit));
+
+        double copiedMs = 0.0;
+        double retainedMs = 0.0;
+        for(int run = 0; run < runCount; run++)
+        {
+            double ms = TimeFrame(sorter, shapes, false);
+            if(run == 0 || ms < copiedMs)
+                copiedMs = ms;
+            ms = TimeFrame(sorter, shapes, true);
+            if(run == 0 || ms < retainedMs)
+                retainedMs = ms;
+        }
+
+        std::vector<ObjectGUID> copiedOrder;
+        std::vector<ObjectGUID> retainedOrder;
+        TimeFrame(sorter, shapes, false);
+        uint32_t copiedCount = sorter.Debug_GetCopyCount();
+        GetDrawOrder(sorter, copiedOrder);
+        TimeFrame(sorter, shapes, true);
+        uint32_t retainedCount = sorter.Debug_GetCopyCount();
+        GetDrawOrder(sorter, retainedOrder);
+        sorter.ClearLists();
+
+        // the selected shapes are drawn again in wireframe, from a copy with the selection color.
+        BENCH_CHECK(copiedOrder.size() == shapeCount + selection.size());
+        BENCH_CHECK(copiedOrder == retainedOrder);
+        BENCH_CHECK(copiedCount == shapeCount + selection.size());
+        BENCH_CHECK(retainedCount == selection.size());
+
+        ObjectTable::Inst()->ClearSelection();
+        for(uint32_t i = 0; i < shapeCount; i++)
+            delete shapes[i];
+        RenderContext::DestroyInstance();
+
+        printf("    %u shapes, %u selected, node %u bytes\n", shapeCount, (uint32_t)selection.size(), (uint32_t)sizeof(RenderableNode));
+        printf("    copied:   %u nodes, %u KB copied, %.2f ms\n", copiedCount,
+            (uint32_t)(copiedCount * sizeof(RenderableNode) / 1024), copiedMs);
+        printf("    retained: %u nodes, %u KB copied, %.2f ms\n", retainedCount,
+            (uint32_t)(retainedCount * sizeof(RenderableNode) / 1024), retainedMs);
+        return true;
+    }
+}
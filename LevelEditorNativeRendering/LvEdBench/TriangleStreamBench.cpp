@@ -0,0 +1,250 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+// checks TriangleStream against the scalar IntersectionRayTriangle and
+// FrustumTriangleIntersect on random triangles, rays and frustums, then times
+// the ray kernel against the scalar loop it replaces.
+
+#include <vector>
+#include <algorithm>
+#include "Bench.h"
+#include "../LvEdRenderingEngine/VectorMath/TriangleStream.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    // random triangle soup, every 16th triangle repeats the previous one to check
+    // the tie-break on equal distances.
+    struct TriangleSoup
+    {
+        std::vector<float3> pos;
+        std::vector<uint32_t> indices;
+
+        void Build(BenchRandom& rnd, uint32_t triCount, float extent, float triSize)
+        {
+            pos.clear();
+            indices.clear();
+            for(uint32_t t = 0; t < triCount; t++)
+            {
+                if(t % 16 == 15)
+                {
+                    uint32_t prev = (uint32_t)pos.size() - 3;
+                    for(uint32_t k = 0; k < 3; k++)
+                        pos.push_back(pos[prev + k]);
+                }
+                else
+                {
+                    float3 center(rnd.Float(-extent, extent), rnd.Float(-extent, extent), rnd.Float(-extent, extent));
+                    for(uint32_t k = 0; k < 3; k++)
+                    {
+                        float3 offset(rnd.Float(-triSize, triSize), rnd.Float(-triSize, triSize), rnd.Float(-triSize, triSize));
+                        pos.push_back(center + offset);
+                    }
+                }
+                indices.push_back(3 * t);
+                indices.push_back(3 * t + 1);
+                indices.push_back(3 * t + 2);
+            }
+        }
+
+        Triangle GetTriangle(uint32_t tri) const
+        {
+            Triangle t;
+            t.A = pos[indices[3 * tri]];
+            t.B = pos[indices[3 * tri + 1]];
+            t.C = pos[indices[3 * tri + 2]];
+            return t;
+        }
+    };
+
+    // ----------------------------------------------------------------------------------
+    static Ray RandomRay(BenchRandom& rnd, float extent)
+    {
+        float3 from(rnd.Float(-1.5f * extent, 1.5f * extent), rnd.Float(-1.5f * extent, 1.5f * extent), rnd.Float(-1.5f * extent, 1.5f * extent));
+        float3 to(rnd.Float(-extent, extent), rnd.Float(-extent, extent), rnd.Float(-extent, extent));
+        return Ray(from, to - from);
+    }
+
+    // ----------------------------------------------------------------------------------
+    // the scalar loop TriangleStream::IntersectRay() replaces, the stream positions
+    // [first, first + count) hold the triangles order[first], ...
+    static void IntersectRayScalar(const TriangleSoup& soup, const uint32_t* order, const Ray& ray,
+        bool backfaceCull, uint32_t first, uint32_t count, TriangleHit* hit)
+    {
+        float dist;
+        float3 p, n;
+        for(uint32_t i = first; i < first + count; i++)
+        {
+            uint32_t tri = order ? order[i] : i;
+            Triangle t = soup.GetTriangle(tri);
+            if(IntersectionRayTriangle(ray, t, backfaceCull, &dist, &p, &n))
+            {
+                if(!hit->hit || dist < hit->dist || (dist == hit->dist && tri < hit->tri))
+                {
+                    hit->hit = true;
+                    hit->tri = tri;
+                    hit->dist = dist;
+                    hit->pos = p;
+                    hit->nor = n;
+                    hit->triangle = t;
+                }
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    static bool SameHit(const TriangleHit& h1, const TriangleHit& h2)
+    {
+        if(h1.hit != h2.hit)
+            return false;
+        if(!h1.hit)
+            return true;
+        return h1.tri == h2.tri && h1.dist == h2.dist
+            && h1.pos.x == h2.pos.x && h1.pos.y == h2.pos.y && h1.pos.z == h2.pos.z
+            && h1.nor.x == h2.nor.x && h1.nor.y == h2.nor.y && h1.nor.z == h2.nor.z;
+    }
+
+    // ----------------------------------------------------------------------------------
+    static bool CheckRays(BenchRandom& rnd, const TriangleSoup& soup, const TriangleStream& stream,
+        const uint32_t* order, uint32_t rayCount, float extent, uint32_t* hitCount)
+    {
+        uint32_t triCount = stream.GetTriangleCount();
+        for(uint32_t r = 0; r < rayCount; r++)
+        {
+            Ray ray = RandomRay(rnd, extent);
+            bool backfaceCull = (r & 1) != 0;
+
+            // whole stream, then a random range as a BVH leaf walk would test it.
+            uint32_t first = 0;
+            uint32_t count = triCount;
+            if(r & 2)
+            {
+                first = rnd.Below(triCount);
+                count = 1 + rnd.Below(triCount - first);
+            }
+
+            // half the tests start from the hit of an earlier range.
+            TriangleHit start;
+            if(r & 4)
+            {
+                start.hit = true;
+                start.tri = rnd.Below(triCount);
+                start.dist = rnd.Float(0.0f, 3.0f * extent);
+            }
+
+            TriangleHit expected = start;
+            IntersectRayScalar(soup, order, ray, backfaceCull, first, count, &expected);
+            TriangleHit actual = start;
+            stream.IntersectRay(ray, backfaceCull, first, count, &actual);
+            BENCH_CHECK(SameHit(expected, actual));
+            if(!SameHit(start, expected))
+                (*hitCount)++;
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    static bool CheckFrustums(BenchRandom& rnd, const TriangleSoup& soup, const TriangleStream& stream,
+        const uint32_t* order, uint32_t frustumCount, float extent, uint32_t* hitCount)
+    {
+        uint32_t triCount = stream.GetTriangleCount();
+        for(uint32_t f = 0; f < frustumCount; f++)
+        {
+            float3 eye(rnd.Float(-2.0f * extent, 2.0f * extent), rnd.Float(-2.0f * extent, 2.0f * extent), rnd.Float(-2.0f * extent, 2.0f * extent));
+            float3 at(rnd.Float(-extent, extent), rnd.Float(-extent, extent), rnd.Float(-extent, extent));
+            Matrix view = Matrix::CreateLookAtRH(eye, at, float3(0, 1, 0));
+            Matrix proj = Matrix::CreatePerspectiveFieldOfView(rnd.Float(0.02f, 1.0f), rnd.Float(0.5f, 2.0f), 0.1f, rnd.Float(extent, 4.0f * extent));
+            Frustum fr;
+            fr.InitFromMatrix(view * proj);
+
+            uint32_t first = 0;
+            uint32_t count = triCount;
+            if(f & 1)
+            {
+                first = rnd.Below(triCount);
+                count = 1 + rnd.Below(triCount - first);
+            }
+
+            bool expected = false;
+            for(uint32_t i = first; i < first + count && !expected; i++)
+                expected = FrustumTriangleIntersect(fr, soup.GetTriangle(order ? order[i] : i));
+            BENCH_CHECK(stream.IntersectFrustum(fr, first, count) == expected);
+            if(expected)
+                (*hitCount)++;
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool TriangleStreamBench()
+    {
+        printf("    SIMD kernels %s\n", TriangleStream::UseSIMD() ? "enabled" : "disabled");
+
+        // equivalence, in source order and in a shuffled order like the BVH leaves.
+        const float extent = 10.0f;
+        BenchRandom rnd;
+        TriangleSoup soup;
+        for(int pass = 0; pass < 4; pass++)
+        {
+            uint32_t triCount = 1 + rnd.Below(600);
+            soup.Build(rnd, triCount, extent, pass < 2 ? 2.0f : 8.0f);
+
+            std::vector<uint32_t> order(triCount);
+            for(uint32_t i = 0; i < triCount; i++)
+                order[i] = i;
+            for(uint32_t i = triCount - 1; i > 0; i--)
+                std::swap(order[i], order[rnd.Below(i + 1)]);
+            const uint32_t* streamOrder = (pass & 1) ? &order[0] : NULL;
+
+            TriangleStream stream;
+            stream.Build(&soup.pos[0], &soup.indices[0], (uint32_t)soup.indices.size(), streamOrder);
+            BENCH_CHECK(stream.GetTriangleCount() == triCount);
+
+            uint32_t rayHits = 0;
+            uint32_t frustumHits = 0;
+            if(!CheckRays(rnd, soup, stream, streamOrder, 4000, extent, &rayHits))
+                return false;
+            if(!CheckFrustums(rnd, soup, stream, streamOrder, 1000, extent, &frustumHits))
+                return false;
+            printf("    %u triangles%s: %u of 4000 rays found a closer hit, %u of 1000 frustums hit, same as scalar\n",
+                triCount, streamOrder ? " shuffled" : "", rayHits, frustumHits);
+        }
+
+        // timing of the closest hit over a whole stream, as for a mesh without BVH.
+        const uint32_t triCount = 4096;
+        const uint32_t rayCount = 4096;
+        soup.Build(rnd, triCount, extent, 1.0f);
+        TriangleStream stream;
+        stream.Build(&soup.pos[0], &soup.indices[0], (uint32_t)soup.indices.size());
+        std::vector<Ray> rays(rayCount);
+        for(uint32_t r = 0; r < rayCount; r++)
+            rays[r] = RandomRay(rnd, extent);
+
+        PerfTimer timer;
+        uint32_t scalarHits = 0;
+        timer.Start();
+        for(uint32_t r = 0; r < rayCount; r++)
+        {
+            TriangleHit hit;
+            IntersectRayScalar(soup, NULL, rays[r], false, 0, triCount, &hit);
+            scalarHits += hit.hit ? 1 : 0;
+        }
+        timer.Stop();
+        double scalarMs = timer.ElapsedTimeMS();
+
+        uint32_t streamHits = 0;
+        timer.Start();
+        for(uint32_t r = 0; r < rayCount; r++)
+        {
+            TriangleHit hit;
+            stream.IntersectRay(rays[r], false, &hit);
+            streamHits += hit.hit ? 1 : 0;
+        }
+        timer.Stop();
+        double streamMs = timer.ElapsedTimeMS();
+        BENCH_CHECK(scalarHits == streamHits);
+
+        printf("    %u rays x %u triangles: scalar %.2f ms, stream %.2f ms, %.1fx\n",
+            rayCount, triCount, scalarMs, streamMs, streamMs > 0.0 ? scalarMs / streamMs : 0.0);
+        return true;
+    }
+}
@@ -0,0 +1,194 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "CommandBuffer.h"
+#include <vector>
+#include "GobBridge.h"
+#include "../Core/ObjectTable.h"
+#include "../Core/Logger.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    // the object and property written by a command.
+    struct CommandKey
+    {
+        ObjectGUID instanceId;
+        uint64_t typePropId;
+
+        bool operator==(const CommandKey& other) const
+        {
+            return instanceId == other.instanceId && typePropId == other.typePropId;
+        }
+    };
+
+    // ----------------------------------------------------------------------------------
+    // open addressing table of the last write to each key, so the repeated
+    // writes are found in one pass over the buffer.
+    class LastWriteTable
+    {
+    public:
+        static const uint32_t Empty = 0xffffffff;
+
+        LastWriteTable(const std::vector<CommandKey>& keys) : m_keys(keys)
+        {
+            // at most half full.
+            uint32_t slotCount = 16;
+            while(slotCount < keys.size() * 2)
+                slotCount *= 2;
+            m_slots.assign(slotCount, Empty);
+            m_mask = slotCount - 1;
+        }
+
+        // makes index the last write of its key,
+        // returns the index of the previous write of the key, Empty if there is none.
+        uint32_t Insert(uint32_t index)
+        {
+            const CommandKey& key = m_keys[index];
+            uint64_t h = key.instanceId * 0x9e3779b97f4a7c15ULL ^ key.typePropId * 0xc2b2ae3d27d4eb4fULL;
+            uint32_t slot = (uint32_t)(h ^ (h >> 32)) & m_mask;
+            while(m_slots[slot] != Empty)
+            {
+                uint32_t prev = m_slots[slot];
+                if(m_keys[prev] == key)
+                {
+                    m_slots[slot] = index;
+                    return prev;
+                }
+                slot = (slot + 1) & m_mask;
+            }
+            m_slots[slot] = index;
+            return Empty;
+        }
+
+    private:
+        const std::vector<CommandKey>& m_keys;
+        std::vector<uint32_t> m_slots;
+        uint32_t m_mask;
+    };
+
+    // ----------------------------------------------------------------------------------
+    static uint32_t AlignSize(uint32_t size)
+    {
+        return (size + CommandBuffer::Alignment - 1) & ~(CommandBuffer::Alignment - 1);
+    }
+
+    // ----------------------------------------------------------------------------------
+    // collects the headers of the writes, false if a write does not fit in the buffer.
+    static bool ParseCommands(const uint8_t* buffer, uint32_t size, std::vector<const CommandHeader*>& commands)
+    {
+        if(size % CommandBuffer::Alignment != 0)
+            return false;
+
+        // size and offset are multiples of the alignment, so the padding always fits.
+        uint32_t offset = 0;
+        while(offset < size)
+        {
+            if(size - offset < sizeof(CommandHeader))
+                return false;
+            const CommandHeader* header = (const CommandHeader*)(buffer + offset);
+            offset += sizeof(CommandHeader);
+            if(header->size > size - offset)
+                return false;
+            if((header->flags & CommandFlags::Reference) && header->size != 0 && header->size != sizeof(ObjectGUID))
+                return false;
+            offset += AlignSize(header->size);
+            commands.push_back(header);
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // applies the last write to each property of each object in the order of the buffer.
+    // a non zero instanceId replaces the instance ids of the writes.
+    static int ApplyCommands(GobBridge& bridge, ObjectGUID instanceId, const std::vector<const CommandHeader*>& commands)
+    {
+        // keep the last write to each property of each object.
+        std::vector<CommandKey> keys(commands.size());
+        for(size_t i = 0; i < commands.size(); i++)
+        {
+            keys[i].instanceId = instanceId != 0 ? instanceId : commands[i]->instanceId;
+            keys[i].typePropId = (uint64_t)commands[i]->typeId << 32 | commands[i]->propId;
+        }
+
+        std::vector<bool> isLast(commands.size(), true);
+        LastWriteTable lastWrites(keys);
+        for(uint32_t i = 0; i < (uint32_t)keys.size(); i++)
+        {
+            uint32_t prev = lastWrites.Insert(i);
+            if(prev != LastWriteTable::Empty)
+                isLast[prev] = false;
+        }
+
+        // the set functions only flag the objects, the bounds, transforms and
+        // lighting are updated once by the next update.
+        ObjectTable* table = ObjectTable::Inst();
+        SetPropertyFncPtr func = NULL;
+        const CommandHeader* prev = NULL;
+        int applied = 0;
+        for(size_t i = 0; i < commands.size(); i++)
+        {
+            if(!isLast[i])
+                continue;
+
+            const CommandHeader* header = commands[i];
+            ObjectGUID id = instanceId != 0 ? instanceId : header->instanceId;
+            if(table->Get(id) == NULL)
+            {
+                Logger::Log(OutputMessageType::Error, "%s: invalid instance id 0x%llx\n", __FUNCTION__, id);
+                continue;
+            }
+
+            // consecutive writes are usually to the same type and property.
+            if(prev == NULL || prev->typeId != header->typeId || prev->propId != header->propId)
+            {
+                func = bridge.GetSetPropertyFunction(header->typeId, header->propId);
+                prev = header;
+            }
+            if(func == NULL)
+            {
+                Logger::Log(OutputMessageType::Error, "%s: failed to set property tid(0x%08x), pid(0x%08x)\n",
+                    __FUNCTION__, header->typeId, header->propId);
+                continue;
+            }
+
+            void* data = NULL;
+            if(header->size > 0)
+            {
+                const void* payload = header + 1;
+                data = (header->flags & CommandFlags::Reference)
+                    ? (void*)*(const ObjectGUID*)payload
+                    : const_cast<void*>(payload);
+            }
+            func(id, data, (int)header->size);
+            applied++;
+        }
+        return applied;
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    int CommandBuffer::Execute(GobBridge& bridge, const void* buffer, uint32_t size)
+    {
+        std::vector<const CommandHeader*> commands;
+        if(buffer == NULL || !ParseCommands((const uint8_t*)buffer, size, commands))
+        {
+            Logger::Log(OutputMessageType::Error, "%s: malformed command buffer, %u bytes\n", __FUNCTION__, size);
+            return -1;
+        }
+
+        return ApplyCommands(bridge, 0, commands);
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    int CommandBuffer::ExecuteInitialState(GobBridge& bridge, ObjectGUID instanceId, const void* buffer, uint32_t size)
+    {
+        std::vector<const CommandHeader*> commands;
+        if(buffer == NULL || !ParseCommands((const uint8_t*)buffer, size, commands))
+        {
+            Logger::Log(OutputMessageType::Error, "%s: malformed initial state, %u bytes\n", __FUNCTION__, size);
+            return -1;
+        }
+        return ApplyCommands(bridge, instanceId, commands);
+    }
+}
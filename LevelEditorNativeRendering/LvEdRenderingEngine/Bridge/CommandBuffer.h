@@ -0,0 +1,54 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+#include <stdint.h>
+#include "../Core/typedefs.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    class GobBridge;
+
+    // ----------------------------------------------------------------------------
+    // header of one property write of a command buffer, followed by size bytes
+    // of data. the next header starts at the next multiple of 8 bytes.
+    struct CommandHeader
+    {
+        ObjectGUID instanceId;
+        ObjectTypeGUID typeId;
+        ObjectPropertyUID propId;
+        uint32_t size;
+        uint32_t flags;     // CommandFlags
+    };
+
+    namespace CommandFlags
+    {
+        enum CommandFlags
+        {
+            None = 0,
+            // the data is the instance id of the referenced object, it is passed to
+            // the set function in place of the data pointer like LvEd_SetObjectProperty.
+            Reference = 1,
+        };
+    };
+
+    // ----------------------------------------------------------------------------
+    // applies the property writes packed by the editor in one call.
+    // only the last write to each property of each object is applied, the
+    // writes are applied in the order of the buffer.
+    class CommandBuffer : public NonCopyable
+    {
+    public:
+        static const uint32_t Alignment = 8;
+
+        // returns the number of writes applied, -1 if the buffer is malformed,
+        // nothing is applied in that case.
+        static int Execute(GobBridge& bridge, const void* buffer, uint32_t size);
+
+        // applies the initial state of a new object, a buffer of the same layout
+        // whose writes all go to instanceId, the instance ids of the writes are ignored.
+        // returns the number of writes applied, -1 if the buffer is malformed.
+        static int ExecuteInitialState(GobBridge& bridge, ObjectGUID instanceId, const void* buffer, uint32_t size);
+    };
+}
@@ -3,6 +3,7 @@
 #include "GobBridge.h"
 #include <cassert>
 #include "../Core/Object.h"
+#include "../Core/ObjectTable.h"
 #include "../Core/Hasher.h"
 #include "../Core/Logger.h"
 
@@ -18,7 +19,18 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
 }
 
 // ------------------------------------------------------------------------------------------------
-GobBridge::GobBridge()
+// stale or unknown ids are rejected here, the registered functions can
+// assume their ids refer to live objects.
+static bool IsLive(ObjectGUID instanceId, const char* fn)
+{
+    if(ObjectTable::Inst()->Get(instanceId))
+        return true;
+    Logger::Log(OutputMessageType::Error, "%s: invalid instance id 0x%llx\n", fn, instanceId);
+    return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+GobBridge::GobBridge() : m_tablesBuilt(false)
 {
 }
 
@@ -42,6 +54,7 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
     uint64_t tidpid = MakePair(tid, pid);
     assert(m_propertyFunctions.find(tidpid) == m_propertyFunctions.end()); // double registration.
     m_propertyFunctions[tidpid] = PropertyFunc(set, get);
+    m_tablesBuilt = false;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -52,8 +65,69 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
     uint64_t tidlid = MakePair(tid, lid);
     assert(m_childListFunctions.find(tid) == m_childListFunctions.end()); // double registration.
     m_childListFunctions[tidlid] = ChildListFunc(add, remove);
+    m_tablesBuilt = false;
 }
 
+// ------------------------------------------------------------------------------------------------
+void GobBridge::BuildDispatchTables()
+{
+    m_tablesBuilt = false;
+
+    std::vector<uint64_t> keys;
+    keys.reserve(m_propertyFunctions.size());
+    for(auto it = m_propertyFunctions.begin(); it != m_propertyFunctions.end(); ++it)
+        keys.push_back(it->first);
+    if(!m_propertyHash.Build(keys.empty() ? NULL : &keys[0], (uint32_t)keys.size()))
+    {
+        Logger::Log(OutputMessageType::Error, "%s: failed to hash %u property ids\n", __FUNCTION__, (uint32_t)keys.size());
+        return;
+    }
+    m_propertyTable.resize(keys.size());
+    for(auto it = m_propertyFunctions.begin(); it != m_propertyFunctions.end(); ++it)
+        m_propertyTable[m_propertyHash.Find(it->first)] = it->second;
+
+    keys.clear();
+    for(auto it = m_childListFunctions.begin(); it != m_childListFunctions.end(); ++it)
+        keys.push_back(it->first);
+    if(!m_childListHash.Build(keys.empty() ? NULL : &keys[0], (uint32_t)keys.size()))
+    {
+        Logger::Log(OutputMessageType::Error, "%s: failed to hash %u child list ids\n", __FUNCTION__, (uint32_t)keys.size());
+        return;
+    }
+    m_childListTable.resize(keys.size());
+    for(auto it = m_childListFunctions.begin(); it != m_childListFunctions.end(); ++it)
+        m_childListTable[m_childListHash.Find(it->first)] = it->second;
+
+    m_tablesBuilt = true;
+    Logger::Log(OutputMessageType::Debug, "dispatch tables: %u properties, %u child lists\n",
+        (uint32_t)m_propertyTable.size(), (uint32_t)m_childListTable.size());
+}
+
+// ------------------------------------------------------------------------------------------------
+const PropertyFunc* GobBridge::FindProperty(ObjectTypeGUID tid, ObjectPropertyUID pid) const
+{
+    uint64_t tidpid = MakePair(tid, pid);
+    if(m_tablesBuilt)
+    {
+        uint32_t slot = m_propertyHash.Find(tidpid);
+        return slot != PerfectHash::NotFound ? &m_propertyTable[slot] : NULL;
+    }
+    auto it = m_propertyFunctions.find(tidpid);
+    return it != m_propertyFunctions.end() ? &it->second : NULL;
+}
+
+// ------------------------------------------------------------------------------------------------
+const ChildListFunc* GobBridge::FindChildList(ObjectTypeGUID tid, ObjectListUID lid) const
+{
+    uint64_t tidlid = MakePair(tid, lid);
+    if(m_tablesBuilt)
+    {
+        uint32_t slot = m_childListHash.Find(tidlid);
+        return slot != PerfectHash::NotFound ? &m_childListTable[slot] : NULL;
+    }
+    auto it = m_childListFunctions.find(tidlid);
+    return it != m_childListFunctions.end() ? &it->second : NULL;
+}
 
 // ------------------------------------------------------------------------------------------------
 ObjectTypeGUID GobBridge::GetTypeId(const char* typeName)
@@ -121,22 +195,16 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
 // ------------------------------------------------------------------------------------------------
 void GobBridge::DestroyObject(ObjectTypeGUID tid, ObjectGUID instanceId)
 {
-
-    if(instanceId != 0)
+    Object* obj = ObjectTable::Inst()->Get(instanceId);
+    if(obj)
     {
-        Object* obj = reinterpret_cast<Object*>(instanceId);
         const char * cname  = obj->ClassName();
         Logger::Log(OutputMessageType::Debug, "Destroying %s\n", cname);
+        delete obj;
     }
     else
     {
-        Logger::Log(OutputMessageType::Error, "failed to destroy object tid(0x%08x)\n", tid);
-    }
-
-    if(instanceId != 0)
-    {
-        Object* obj = reinterpret_cast<Object*>(instanceId);
-        delete obj;
+        Logger::Log(OutputMessageType::Error, "failed to destroy object tid(0x%08x) id(0x%llx)\n", tid, instanceId);
     }
 }
 
@@ -144,17 +212,14 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
 // ------------------------------------------------------------------------------------------------
 void GobBridge::SetProperty(ObjectTypeGUID tid, ObjectPropertyUID pid, ObjectGUID instanceId, void* data, int size)
 {
-    SetPropertyFncPtr func = NULL;
-    uint64_t tidpid = MakePair(tid, pid);
-    auto it = m_propertyFunctions.find(tidpid);
-    if(it != m_propertyFunctions.end())
+    if(!IsLive(instanceId, __FUNCTION__))
+        return;
+
+    const PropertyFunc* funcs = FindProperty(tid, pid);
+    SetPropertyFncPtr func = funcs ? funcs->first : NULL;
+    if(func)
     {
-        PropertyFunc& pair = it->second;
-        func = pair.first;
-        if(func)
-        {
-            func(instanceId, data, size);
-        }
+        func(instanceId, data, size);
     }
 
     if(!func)
@@ -170,18 +235,14 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
     // default to null,zero
     *data = NULL;
     *size = 0;
+    if(!IsLive(instanceId, __FUNCTION__))
+        return;
 
-    GetPropertyFncPtr func = NULL;
-    uint64_t tidpid = MakePair(tid, pid);
-    auto it = m_propertyFunctions.find(tidpid);
-    if(it != m_propertyFunctions.end())
+    const PropertyFunc* funcs = FindProperty(tid, pid);
+    GetPropertyFncPtr func = funcs ? funcs->second : NULL;
+    if(func)
     {
-        PropertyFunc& pair = it->second;
-        func = pair.second;
-        if(func)
-        {
-            func(instanceId, data, size);
-        }
+        func(instanceId, data, size);
     }
     if(!func)
     {
@@ -189,16 +250,23 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
     }
 }
 
+// ------------------------------------------------------------------------------------------------
+SetPropertyFncPtr GobBridge::GetSetPropertyFunction(ObjectTypeGUID tid, ObjectPropertyUID pid) const
+{
+    const PropertyFunc* funcs = FindProperty(tid, pid);
+    return funcs ? funcs->first : NULL;
+}
+
 // ------------------------------------------------------------------------------------------------
 void GobBridge::AddChild(ObjectTypeGUID tid, ObjectListUID lid, ObjectGUID parent, ObjectGUID child, int index)
 {
-    AddChildFncPtr func = NULL;
-    uint64_t tidpid = MakePair(tid, lid);
-    auto it = m_childListFunctions.find(tidpid);
-    if(it != m_childListFunctions.end())
+    if(!IsLive(parent, __FUNCTION__) || !IsLive(child, __FUNCTION__))
+        return;
+
+    const ChildListFunc* funcs = FindChildList(tid, lid);
+    AddChildFncPtr func = funcs ? funcs->first : NULL;
+    if(func)
     {
-        ChildListFunc& pair = it->second;
-        func = pair.first;
         func(parent, child, index);
     }
 
@@ -212,13 +280,13 @@ static uint64_t MakePair( uint32_t p1, uint32_t p2)
 // ------------------------------------------------------------------------------------------------
 void GobBridge::RemoveChild(ObjectTypeGUID tid, ObjectListUID lid, ObjectGUID parent, ObjectGUID child)
 {
-    RemoveChildFncPtr func = NULL;
-    uint64_t tidpid = MakePair(tid, lid);
-    auto it = m_childListFunctions.find(tidpid);
-    if(it != m_childListFunctions.end())
+    if(!IsLive(parent, __FUNCTION__) || !IsLive(child, __FUNCTION__))
+        return;
+
+    const ChildListFunc* funcs = FindChildList(tid, lid);
+    RemoveChildFncPtr func = funcs ? funcs->second : NULL;
+    if(func)
     {
-        std::pair<AddChildFncPtr, RemoveChildFncPtr>& pair = it->second;
-        func = pair.second;
         func(parent, child);
     }
 
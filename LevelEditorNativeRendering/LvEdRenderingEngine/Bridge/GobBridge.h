@@ -4,9 +4,11 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include "../Core/WinHeaders.h"
 #include "../Core/typedefs.h"
 #include "../Core/NonCopyable.h"
+#include "../Core/PerfectHash.h"
 
 
 namespace LvEdEngine
@@ -31,6 +33,8 @@ class Object;
     // You use it by registering object creation functions for all the possible objects C# my require
     // and by registering 'set property' functions for all the attributes exposed to the C# code by the 
     // schema.
+    // Once all the functions are registered, BuildDispatchTables() copies the property and child
+    // list functions to arrays indexed by a perfect hash of their ids, used by the set and get calls.
     //-------------------------------------------------------------------------------------------------
     class GobBridge : public NonCopyable
     {
@@ -42,6 +46,10 @@ class GobBridge : public NonCopyable
         void RegisterProperty(const char* typeName, const char* propName, SetPropertyFncPtr set, GetPropertyFncPtr get);
         void RegisterChildList(const char* typeName, const char* listName, AddChildFncPtr add, RemoveChildFncPtr remove);
 
+        // called after the last registration, registering more functions drops the tables
+        // and the lookups use the maps until the tables are built again.
+        void BuildDispatchTables();
+
         ObjectTypeGUID GetTypeId(const char* typeName);
         ObjectPropertyUID GetPropertyId(ObjectTypeGUID tid, const char* propName);
         ObjectListUID GetChildListId(ObjectTypeGUID tid, const char* listName);
@@ -53,9 +61,21 @@ class GobBridge : public NonCopyable
         void AddChild(ObjectTypeGUID tid, ObjectListUID lid, ObjectGUID parent, ObjectGUID child, int index);
         void RemoveChild(ObjectTypeGUID tid, ObjectListUID lid, ObjectGUID parent, ObjectGUID child);
 
+        // NULL if the property has no set function.
+        SetPropertyFncPtr GetSetPropertyFunction(ObjectTypeGUID tid, ObjectPropertyUID propId) const;
+
     protected:
+        const PropertyFunc* FindProperty(ObjectTypeGUID tid, ObjectPropertyUID pid) const;
+        const ChildListFunc* FindChildList(ObjectTypeGUID tid, ObjectListUID lid) const;
+
         ObjectCreationMap m_createObjectFunctions;
         PropertyMap m_propertyFunctions;
         ChildListMap m_childListFunctions;
+
+        bool m_tablesBuilt;
+        PerfectHash m_propertyHash;
+        std::vector<PropertyFunc> m_propertyTable;
+        PerfectHash m_childListHash;
+        std::vector<ChildListFunc> m_childListTable;
     };
 };
@@ -6,6 +6,7 @@
 #include "../Renderer/DeviceManager.h"
 #include "../Renderer/TextureRenderSurface.h"
 #include "../Core/ImageData.h"
+#include "../Core/ObjectTable.h"
 #include "../DirectX/DXUtil.h"
 #include "../DirectX/DirectXTex/DirectXTex.h"
 
@@ -35,7 +36,7 @@ namespace SwapChainBridge
         static void SetSize(ObjectGUID instanceId, void* data, int size)
         {
             assert(size == sizeof(SIZE));
-            SwapChain* instance = reinterpret_cast<SwapChain*>(instanceId);
+            SwapChain* instance = ObjectTable::Inst()->GetAs<SwapChain>(instanceId);
             SIZE s= *((SIZE*)data);         
             instance->Resize(s.cx,s.cy);
         }
@@ -44,7 +45,7 @@ static void SetSize(ObjectGUID instanceId, void* data, int size)
         static void SetBkgColor(ObjectGUID instanceId, void* data, int size)
         {
             assert(size == sizeof(float4));
-            SwapChain* instance = reinterpret_cast<SwapChain*>(instanceId);
+            SwapChain* instance = ObjectTable::Inst()->GetAs<SwapChain>(instanceId);
             float4 color = (float*)data;            
             instance->SetBkgColor(color);
         }
@@ -60,7 +61,7 @@ namespace RenderStateBridge
         static void SetGlobalRenderFlags(ObjectGUID instanceId, void* data, int size)
         {
             assert(sizeof(GlobalRenderFlagsEnum) == size);
-            RenderState* instance = reinterpret_cast<RenderState*>(instanceId);
+            RenderState* instance = ObjectTable::Inst()->GetAs<RenderState>(instanceId);
             GlobalRenderFlagsEnum rf = *((GlobalRenderFlagsEnum*)data);
             instance->SetGlobalRenderFlags(rf);            
         }
@@ -68,7 +69,7 @@ static void SetGlobalRenderFlags(ObjectGUID instanceId, void* data, int size)
         static void SetWireColor(ObjectGUID instanceId, void* data, int size)
         {
             assert(sizeof(float4) == size);
-            RenderState* instance = reinterpret_cast<RenderState*>(instanceId);
+            RenderState* instance = ObjectTable::Inst()->GetAs<RenderState>(instanceId);
             float4 color = (float*)data;
             instance->SetWireframeColor(color);        
         }
@@ -76,7 +77,7 @@ static void SetWireColor(ObjectGUID instanceId, void* data, int size)
         static void SetSelectionColor(ObjectGUID instanceId, void* data, int size)
         {
             assert(sizeof(float4) == size);
-            RenderState* instance = reinterpret_cast<RenderState*>(instanceId);
+            RenderState* instance = ObjectTable::Inst()->GetAs<RenderState>(instanceId);
             float4 color = (float*)data;
             instance->SetSelectionColor(color);
         }
@@ -107,7 +108,7 @@ namespace TextureRenderSurfaceBridge
         static void SetBkgColor(ObjectGUID instanceId, void* data, int size)
         {
             assert(size == sizeof(float4));
-            TextureRenderSurface* instance = reinterpret_cast<TextureRenderSurface*>(instanceId);
+            TextureRenderSurface* instance = ObjectTable::Inst()->GetAs<TextureRenderSurface>(instanceId);
             float4 color = (float*)data;            
             instance->SetBkgColor(color);
         }
@@ -127,7 +128,7 @@ void Convert(ObjectGUID instanceId, void* data, int size)
             assert(instanceId);
             if(instanceId == 0) return;
 
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             uint32_t format = *((uint32_t*)data);
             instance->Convert(format);
         }
@@ -138,20 +139,20 @@ void LoadFromFile(ObjectGUID instanceId, void* data, int size)
             assert(size == sz);
             if(!path || sz == 0 || instanceId == 0) return;
 
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             instance->LoadFromFile(path);
         }
 
         void GetBufferPointer(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             *data = instance->GetBufferPointer();
             *size = sizeof(intptr_t);
         }
 
         void GetBufferSize(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             static size_t localData;
             localData = instance->GetBufferSize();
             *data = (void*)&localData;
@@ -160,7 +161,7 @@ void GetBufferSize(ObjectGUID instanceId, void** data, int* size)
 
         void GetWidth(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             static size_t localData;
             localData = instance->GetWidth();
             *data = (void*)&localData;
@@ -170,7 +171,7 @@ void GetWidth(ObjectGUID instanceId, void** data, int* size)
 
         void GetHeight(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             static size_t localData;
             localData = instance->GetHeight();
             *data = (void*)&localData;
@@ -180,7 +181,7 @@ void GetHeight(ObjectGUID instanceId, void** data, int* size)
 
         void GetRowPitch(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             static size_t localData;
             localData = instance->GetRowPitch();
             *data = (void*)&localData;
@@ -190,7 +191,7 @@ void GetRowPitch(ObjectGUID instanceId, void** data, int* size)
 
         void GetBytesPerPixel(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             static size_t localData;
             localData = instance->GetBytesPerPixel();
             *data = (void*)&localData;
@@ -199,7 +200,7 @@ void GetBytesPerPixel(ObjectGUID instanceId, void** data, int* size)
 
         void GetFormat(ObjectGUID instanceId, void** data, int* size)
         {
-            ImageData* instance = reinterpret_cast<ImageData*>(instanceId);
+            ImageData* instance = ObjectTable::Inst()->GetAs<ImageData>(instanceId);
             static uint32_t localData;
             localData = instance->GetFormat();
             *data = (void*)&localData;
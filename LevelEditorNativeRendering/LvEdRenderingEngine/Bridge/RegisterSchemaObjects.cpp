@@ -9,6 +9,19 @@
 namespace LvEdEngine
 {
 
+// the bridge whose set functions apply the initial states.
+static GobBridge* s_bridge = NULL;
+
+//-----------------------------------------------------------------------------
+// applies the initial state packed by the editor, the property writes of the
+// new object, before the object is added to its parent.
+static Object* SetInitialState(Object* instance, void* data, int size)
+{
+    if(instance && data && size > 0)
+        CommandBuffer::ExecuteInitialState(*s_bridge, instance->GetInstanceId(), data, size);
+    return instance;
+}
+
 //-----------------------------------------------------------------------------
 // DEFINITIONS
 //-----------------------------------------------------------------------------
@@ -17,14 +30,14 @@ namespace LvEdEngine
 //-----------------------------------------------------------------------------
 Object* GameLevel_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new GameLevel();
+    return SetInitialState(new GameLevel(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void GameLevel_Name_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameLevel* instance = reinterpret_cast<GameLevel*>(instanceId);
+    GameLevel* instance = ObjectTable::Inst()->GetAs<GameLevel>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetName(localData);
 }
@@ -33,7 +46,7 @@ void GameLevel_Name_Set(ObjectGUID instanceId, void* data, int size)
 void GameLevel_FogEnabled_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameLevel* instance = reinterpret_cast<GameLevel*>(instanceId);
+    GameLevel* instance = ObjectTable::Inst()->GetAs<GameLevel>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetFogEnabled(localData);
 }
@@ -42,7 +55,7 @@ void GameLevel_FogEnabled_Set(ObjectGUID instanceId, void* data, int size)
 void GameLevel_FogColor_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameLevel* instance = reinterpret_cast<GameLevel*>(instanceId);
+    GameLevel* instance = ObjectTable::Inst()->GetAs<GameLevel>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetFogColor(localData);
 }
@@ -51,7 +64,7 @@ void GameLevel_FogColor_Set(ObjectGUID instanceId, void* data, int size)
 void GameLevel_FogRange_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameLevel* instance = reinterpret_cast<GameLevel*>(instanceId);
+    GameLevel* instance = ObjectTable::Inst()->GetAs<GameLevel>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetFogRange(localData);
 }
@@ -60,7 +73,7 @@ void GameLevel_FogRange_Set(ObjectGUID instanceId, void* data, int size)
 void GameLevel_FogDensity_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameLevel* instance = reinterpret_cast<GameLevel*>(instanceId);
+    GameLevel* instance = ObjectTable::Inst()->GetAs<GameLevel>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetFogDensity(localData);
 }
@@ -70,14 +83,14 @@ void GameLevel_FogDensity_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* GameObject_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new GameObject();
+    return SetInitialState(new GameObject(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void GameObject_Transform_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameObject* instance = reinterpret_cast<GameObject*>(instanceId);
+    GameObject* instance = ObjectTable::Inst()->GetAs<GameObject>(instanceId);
     Matrix localData = *reinterpret_cast<Matrix*>(data);
     instance->SetTransform(localData);
 }
@@ -86,7 +99,7 @@ void GameObject_Transform_Set(ObjectGUID instanceId, void* data, int size)
 void GameObject_Name_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameObject* instance = reinterpret_cast<GameObject*>(instanceId);
+    GameObject* instance = ObjectTable::Inst()->GetAs<GameObject>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetName(localData);
 }
@@ -95,14 +108,14 @@ void GameObject_Name_Set(ObjectGUID instanceId, void* data, int size)
 void GameObject_Visible_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameObject* instance = reinterpret_cast<GameObject*>(instanceId);
+    GameObject* instance = ObjectTable::Inst()->GetAs<GameObject>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetVisible(localData);
 }
 //-----------------------------------------------------------------------------
 void GameObject_Visible_Get(ObjectGUID instanceId, void** data, int* size)
 {
-    GameObject* instance = reinterpret_cast<GameObject*>(instanceId);
+    GameObject* instance = ObjectTable::Inst()->GetAs<GameObject>(instanceId);
     static bool localData;
     localData = instance->GetVisible();
     *data = (void*)&localData;
@@ -112,7 +125,7 @@ void GameObject_Visible_Get(ObjectGUID instanceId, void** data, int* size)
 //-----------------------------------------------------------------------------
 void GameObject_Bounds_Get(ObjectGUID instanceId, void** data, int* size)
 {
-    GameObject* instance = reinterpret_cast<GameObject*>(instanceId);
+    GameObject* instance = ObjectTable::Inst()->GetAs<GameObject>(instanceId);
     static AABB localData;
     localData = instance->GetBounds();
     *data = (void*)&localData;
@@ -122,7 +135,7 @@ void GameObject_Bounds_Get(ObjectGUID instanceId, void** data, int* size)
 //-----------------------------------------------------------------------------
 void GameObject_LocalBounds_Get(ObjectGUID instanceId, void** data, int* size)
 {
-    GameObject* instance = reinterpret_cast<GameObject*>(instanceId);
+    GameObject* instance = ObjectTable::Inst()->GetAs<GameObject>(instanceId);
     static AABB localData;
     localData = instance->GetLocalBounds();
     *data = (void*)&localData;
@@ -132,16 +145,16 @@ void GameObject_LocalBounds_Get(ObjectGUID instanceId, void** data, int* size)
 //-----------------------------------------------------------------------------
 void GameObject_Component_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    GameObject* parent = reinterpret_cast<GameObject*>(parentId);
-    GameObjectComponent* child = reinterpret_cast<GameObjectComponent*>(childId);
+    GameObject* parent = ObjectTable::Inst()->GetAs<GameObject>(parentId);
+    GameObjectComponent* child = ObjectTable::Inst()->GetAs<GameObjectComponent>(childId);
     parent->AddComponent(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void GameObject_Component_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    GameObject* parent = reinterpret_cast<GameObject*>(parentId);
-    GameObjectComponent* child = reinterpret_cast<GameObjectComponent*>(childId);
+    GameObject* parent = ObjectTable::Inst()->GetAs<GameObject>(parentId);
+    GameObjectComponent* child = ObjectTable::Inst()->GetAs<GameObjectComponent>(childId);
     parent->RemoveComponent(child);
 }
 
@@ -158,7 +171,7 @@ void GameObject_Component_Remove(ObjectGUID parentId, ObjectGUID childId)
 void GameObjectComponent_Name_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameObjectComponent* instance = reinterpret_cast<GameObjectComponent*>(instanceId);
+    GameObjectComponent* instance = ObjectTable::Inst()->GetAs<GameObjectComponent>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetName(localData);
 }
@@ -167,7 +180,7 @@ void GameObjectComponent_Name_Set(ObjectGUID instanceId, void* data, int size)
 void GameObjectComponent_Active_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameObjectComponent* instance = reinterpret_cast<GameObjectComponent*>(instanceId);
+    GameObjectComponent* instance = ObjectTable::Inst()->GetAs<GameObjectComponent>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetActive(localData);
 }
@@ -177,15 +190,15 @@ void GameObjectComponent_Active_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* GameObjectReference_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new GameObjectReference();
+    return SetInitialState(new GameObjectReference(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void GameObjectReference_Target_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    GameObjectReference* instance = reinterpret_cast<GameObjectReference*>(instanceId);
-    GameObject* localData = reinterpret_cast<GameObject*>(data);
+    GameObjectReference* instance = ObjectTable::Inst()->GetAs<GameObjectReference>(instanceId);
+    GameObject* localData = ObjectTable::Inst()->GetAs<GameObject>((ObjectGUID)data);
     instance->SetTarget(localData, size);
 }
 
@@ -194,14 +207,14 @@ void GameObjectReference_Target_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* ResourceReference_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new ResourceReference();
+    return SetInitialState(new ResourceReference(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void ResourceReference_Target_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    ResourceReference* instance = reinterpret_cast<ResourceReference*>(instanceId);
+    ResourceReference* instance = ObjectTable::Inst()->GetAs<ResourceReference>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetTarget(localData);
 }
@@ -211,14 +224,14 @@ void ResourceReference_Target_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* TransformComponent_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new TransformComponent();
+    return SetInitialState(new TransformComponent(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void TransformComponent_Translation_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TransformComponent* instance = reinterpret_cast<TransformComponent*>(instanceId);
+    TransformComponent* instance = ObjectTable::Inst()->GetAs<TransformComponent>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetTranslation(localData);
 }
@@ -227,7 +240,7 @@ void TransformComponent_Translation_Set(ObjectGUID instanceId, void* data, int s
 void TransformComponent_Rotation_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TransformComponent* instance = reinterpret_cast<TransformComponent*>(instanceId);
+    TransformComponent* instance = ObjectTable::Inst()->GetAs<TransformComponent>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetRotation(localData);
 }
@@ -236,7 +249,7 @@ void TransformComponent_Rotation_Set(ObjectGUID instanceId, void* data, int size
 void TransformComponent_Scale_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TransformComponent* instance = reinterpret_cast<TransformComponent*>(instanceId);
+    TransformComponent* instance = ObjectTable::Inst()->GetAs<TransformComponent>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetScale(localData);
 }
@@ -246,22 +259,22 @@ void TransformComponent_Scale_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* GameObjectGroup_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new GameObjectGroup();
+    return SetInitialState(new GameObjectGroup(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void GameObjectGroup_Child_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    GameObjectGroup* parent = reinterpret_cast<GameObjectGroup*>(parentId);
-    GameObject* child = reinterpret_cast<GameObject*>(childId);
+    GameObjectGroup* parent = ObjectTable::Inst()->GetAs<GameObjectGroup>(parentId);
+    GameObject* child = ObjectTable::Inst()->GetAs<GameObject>(childId);
     parent->AddChild(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void GameObjectGroup_Child_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    GameObjectGroup* parent = reinterpret_cast<GameObjectGroup*>(parentId);
-    GameObject* child = reinterpret_cast<GameObject*>(childId);
+    GameObjectGroup* parent = ObjectTable::Inst()->GetAs<GameObjectGroup>(parentId);
+    GameObject* child = ObjectTable::Inst()->GetAs<GameObject>(childId);
     parent->RemoveChild(child);
 }
 
@@ -278,7 +291,7 @@ void GameObjectGroup_Child_Remove(ObjectGUID parentId, ObjectGUID childId)
 void RenderComponent_Visible_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    RenderComponent* instance = reinterpret_cast<RenderComponent*>(instanceId);
+    RenderComponent* instance = ObjectTable::Inst()->GetAs<RenderComponent>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetVisible(localData);
 }
@@ -287,7 +300,7 @@ void RenderComponent_Visible_Set(ObjectGUID instanceId, void* data, int size)
 void RenderComponent_CastShadow_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    RenderComponent* instance = reinterpret_cast<RenderComponent*>(instanceId);
+    RenderComponent* instance = ObjectTable::Inst()->GetAs<RenderComponent>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetCastShadow(localData);
 }
@@ -296,7 +309,7 @@ void RenderComponent_CastShadow_Set(ObjectGUID instanceId, void* data, int size)
 void RenderComponent_ReceiveShadow_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    RenderComponent* instance = reinterpret_cast<RenderComponent*>(instanceId);
+    RenderComponent* instance = ObjectTable::Inst()->GetAs<RenderComponent>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetReceiveShadow(localData);
 }
@@ -305,7 +318,7 @@ void RenderComponent_ReceiveShadow_Set(ObjectGUID instanceId, void* data, int si
 void RenderComponent_DrawDistance_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    RenderComponent* instance = reinterpret_cast<RenderComponent*>(instanceId);
+    RenderComponent* instance = ObjectTable::Inst()->GetAs<RenderComponent>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetDrawDistance(localData);
 }
@@ -315,14 +328,14 @@ void RenderComponent_DrawDistance_Set(ObjectGUID instanceId, void* data, int siz
 //-----------------------------------------------------------------------------
 Object* MeshComponent_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new MeshComponent();
+    return SetInitialState(new MeshComponent(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void MeshComponent_Ref_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    MeshComponent* instance = reinterpret_cast<MeshComponent*>(instanceId);
+    MeshComponent* instance = ObjectTable::Inst()->GetAs<MeshComponent>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetRef(localData);
 }
@@ -332,14 +345,14 @@ void MeshComponent_Ref_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* SpinnerComponent_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new SpinnerComponent();
+    return SetInitialState(new SpinnerComponent(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void SpinnerComponent_RPS_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    SpinnerComponent* instance = reinterpret_cast<SpinnerComponent*>(instanceId);
+    SpinnerComponent* instance = ObjectTable::Inst()->GetAs<SpinnerComponent>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetRPS(localData);
 }
@@ -349,22 +362,22 @@ void SpinnerComponent_RPS_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* Locator_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new Locator();
+    return SetInitialState(new Locator(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void Locator_Resource_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    Locator* parent = reinterpret_cast<Locator*>(parentId);
-    ResourceReference* child = reinterpret_cast<ResourceReference*>(childId);
+    Locator* parent = ObjectTable::Inst()->GetAs<Locator>(parentId);
+    ResourceReference* child = ObjectTable::Inst()->GetAs<ResourceReference>(childId);
     parent->AddResource(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void Locator_Resource_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    Locator* parent = reinterpret_cast<Locator*>(parentId);
-    ResourceReference* child = reinterpret_cast<ResourceReference*>(childId);
+    Locator* parent = ObjectTable::Inst()->GetAs<Locator>(parentId);
+    ResourceReference* child = ObjectTable::Inst()->GetAs<ResourceReference>(childId);
     parent->RemoveResource(child);
 }
 
@@ -373,14 +386,14 @@ void Locator_Resource_Remove(ObjectGUID parentId, ObjectGUID childId)
 //-----------------------------------------------------------------------------
 Object* DirLightGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new DirLightGob();
+    return SetInitialState(new DirLightGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void DirLightGob_Ambient_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DirLightGob* instance = reinterpret_cast<DirLightGob*>(instanceId);
+    DirLightGob* instance = ObjectTable::Inst()->GetAs<DirLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetAmbient(localData);
 }
@@ -389,7 +402,7 @@ void DirLightGob_Ambient_Set(ObjectGUID instanceId, void* data, int size)
 void DirLightGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DirLightGob* instance = reinterpret_cast<DirLightGob*>(instanceId);
+    DirLightGob* instance = ObjectTable::Inst()->GetAs<DirLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetDiffuse(localData);
 }
@@ -398,7 +411,7 @@ void DirLightGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 void DirLightGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DirLightGob* instance = reinterpret_cast<DirLightGob*>(instanceId);
+    DirLightGob* instance = ObjectTable::Inst()->GetAs<DirLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetSpecular(localData);
 }
@@ -407,7 +420,7 @@ void DirLightGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 void DirLightGob_Direction_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DirLightGob* instance = reinterpret_cast<DirLightGob*>(instanceId);
+    DirLightGob* instance = ObjectTable::Inst()->GetAs<DirLightGob>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetDirection(localData);
 }
@@ -417,14 +430,14 @@ void DirLightGob_Direction_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* BoxLightGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new BoxLightGob();
+    return SetInitialState(new BoxLightGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void BoxLightGob_Ambient_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BoxLightGob* instance = reinterpret_cast<BoxLightGob*>(instanceId);
+    BoxLightGob* instance = ObjectTable::Inst()->GetAs<BoxLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetAmbient(localData);
 }
@@ -433,7 +446,7 @@ void BoxLightGob_Ambient_Set(ObjectGUID instanceId, void* data, int size)
 void BoxLightGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BoxLightGob* instance = reinterpret_cast<BoxLightGob*>(instanceId);
+    BoxLightGob* instance = ObjectTable::Inst()->GetAs<BoxLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetDiffuse(localData);
 }
@@ -442,7 +455,7 @@ void BoxLightGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 void BoxLightGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BoxLightGob* instance = reinterpret_cast<BoxLightGob*>(instanceId);
+    BoxLightGob* instance = ObjectTable::Inst()->GetAs<BoxLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetSpecular(localData);
 }
@@ -451,14 +464,14 @@ void BoxLightGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 void BoxLightGob_Direction_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BoxLightGob* instance = reinterpret_cast<BoxLightGob*>(instanceId);
+    BoxLightGob* instance = ObjectTable::Inst()->GetAs<BoxLightGob>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetDirection(localData);
 }
 //-----------------------------------------------------------------------------
 void BoxLightGob_Direction_Get(ObjectGUID instanceId, void** data, int* size)
 {
-    BoxLightGob* instance = reinterpret_cast<BoxLightGob*>(instanceId);
+    BoxLightGob* instance = ObjectTable::Inst()->GetAs<BoxLightGob>(instanceId);
     static float3 localData;
     localData = instance->GetDirection();
     *data = (void*)&localData;
@@ -469,7 +482,7 @@ void BoxLightGob_Direction_Get(ObjectGUID instanceId, void** data, int* size)
 void BoxLightGob_Attenuation_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BoxLightGob* instance = reinterpret_cast<BoxLightGob*>(instanceId);
+    BoxLightGob* instance = ObjectTable::Inst()->GetAs<BoxLightGob>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetAttenuation(localData);
 }
@@ -479,14 +492,14 @@ void BoxLightGob_Attenuation_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* PointLightGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new PointLightGob();
+    return SetInitialState(new PointLightGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void PointLightGob_Ambient_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PointLightGob* instance = reinterpret_cast<PointLightGob*>(instanceId);
+    PointLightGob* instance = ObjectTable::Inst()->GetAs<PointLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetAmbient(localData);
 }
@@ -495,7 +508,7 @@ void PointLightGob_Ambient_Set(ObjectGUID instanceId, void* data, int size)
 void PointLightGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PointLightGob* instance = reinterpret_cast<PointLightGob*>(instanceId);
+    PointLightGob* instance = ObjectTable::Inst()->GetAs<PointLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetDiffuse(localData);
 }
@@ -504,7 +517,7 @@ void PointLightGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 void PointLightGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PointLightGob* instance = reinterpret_cast<PointLightGob*>(instanceId);
+    PointLightGob* instance = ObjectTable::Inst()->GetAs<PointLightGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetSpecular(localData);
 }
@@ -513,7 +526,7 @@ void PointLightGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 void PointLightGob_Attenuation_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PointLightGob* instance = reinterpret_cast<PointLightGob*>(instanceId);
+    PointLightGob* instance = ObjectTable::Inst()->GetAs<PointLightGob>(instanceId);
     float3 localData = *reinterpret_cast<float3*>(data);
     instance->SetAttenuation(localData);
 }
@@ -522,7 +535,7 @@ void PointLightGob_Attenuation_Set(ObjectGUID instanceId, void* data, int size)
 void PointLightGob_Range_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PointLightGob* instance = reinterpret_cast<PointLightGob*>(instanceId);
+    PointLightGob* instance = ObjectTable::Inst()->GetAs<PointLightGob>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetRange(localData);
 }
@@ -532,7 +545,7 @@ void PointLightGob_Range_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* ControlPointGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new ControlPointGob();
+    return SetInitialState(new ControlPointGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -540,14 +553,14 @@ void PointLightGob_Range_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* CurveGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new CurveGob();
+    return SetInitialState(new CurveGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void CurveGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    CurveGob* instance = reinterpret_cast<CurveGob*>(instanceId);
+    CurveGob* instance = ObjectTable::Inst()->GetAs<CurveGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetColor(localData);
 }
@@ -556,7 +569,7 @@ void CurveGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 void CurveGob_Closed_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    CurveGob* instance = reinterpret_cast<CurveGob*>(instanceId);
+    CurveGob* instance = ObjectTable::Inst()->GetAs<CurveGob>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetClosed(localData);
 }
@@ -565,7 +578,7 @@ void CurveGob_Closed_Set(ObjectGUID instanceId, void* data, int size)
 void CurveGob_Steps_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    CurveGob* instance = reinterpret_cast<CurveGob*>(instanceId);
+    CurveGob* instance = ObjectTable::Inst()->GetAs<CurveGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetSteps(localData);
 }
@@ -574,7 +587,7 @@ void CurveGob_Steps_Set(ObjectGUID instanceId, void* data, int size)
 void CurveGob_InterpolationType_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    CurveGob* instance = reinterpret_cast<CurveGob*>(instanceId);
+    CurveGob* instance = ObjectTable::Inst()->GetAs<CurveGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetInterpolationType(localData);
 }
@@ -582,16 +595,16 @@ void CurveGob_InterpolationType_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 void CurveGob_Point_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    CurveGob* parent = reinterpret_cast<CurveGob*>(parentId);
-    ControlPointGob* child = reinterpret_cast<ControlPointGob*>(childId);
+    CurveGob* parent = ObjectTable::Inst()->GetAs<CurveGob>(parentId);
+    ControlPointGob* child = ObjectTable::Inst()->GetAs<ControlPointGob>(childId);
     parent->AddPoint(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void CurveGob_Point_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    CurveGob* parent = reinterpret_cast<CurveGob*>(parentId);
-    ControlPointGob* child = reinterpret_cast<ControlPointGob*>(childId);
+    CurveGob* parent = ObjectTable::Inst()->GetAs<CurveGob>(parentId);
+    ControlPointGob* child = ObjectTable::Inst()->GetAs<ControlPointGob>(childId);
     parent->RemovePoint(child);
 }
 
@@ -600,14 +613,14 @@ void CurveGob_Point_Remove(ObjectGUID parentId, ObjectGUID childId)
 //-----------------------------------------------------------------------------
 Object* SkyDome_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new SkyDome();
+    return SetInitialState(new SkyDome(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void SkyDome_CubeMap_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    SkyDome* instance = reinterpret_cast<SkyDome*>(instanceId);
+    SkyDome* instance = ObjectTable::Inst()->GetAs<SkyDome>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetCubeMap(localData);
 }
@@ -625,7 +638,7 @@ void SkyDome_CubeMap_Set(ObjectGUID instanceId, void* data, int size)
 void PrimitiveShapeGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetColor(localData);
 }
@@ -634,7 +647,7 @@ void PrimitiveShapeGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 void PrimitiveShapeGob_Emissive_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetEmissive(localData);
 }
@@ -643,7 +656,7 @@ void PrimitiveShapeGob_Emissive_Set(ObjectGUID instanceId, void* data, int size)
 void PrimitiveShapeGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetSpecular(localData);
 }
@@ -652,7 +665,7 @@ void PrimitiveShapeGob_Specular_Set(ObjectGUID instanceId, void* data, int size)
 void PrimitiveShapeGob_SpecularPower_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetSpecularPower(localData);
 }
@@ -661,7 +674,7 @@ void PrimitiveShapeGob_SpecularPower_Set(ObjectGUID instanceId, void* data, int
 void PrimitiveShapeGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetDiffuse(localData);
 }
@@ -670,7 +683,7 @@ void PrimitiveShapeGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 void PrimitiveShapeGob_Normal_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetNormal(localData);
 }
@@ -679,7 +692,7 @@ void PrimitiveShapeGob_Normal_Set(ObjectGUID instanceId, void* data, int size)
 void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    PrimitiveShapeGob* instance = reinterpret_cast<PrimitiveShapeGob*>(instanceId);
+    PrimitiveShapeGob* instance = ObjectTable::Inst()->GetAs<PrimitiveShapeGob>(instanceId);
     Matrix localData = *reinterpret_cast<Matrix*>(data);
     instance->SetTextureTransform(localData);
 }
@@ -689,7 +702,7 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* CubeGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new CubeGob();
+    return SetInitialState(new CubeGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -697,7 +710,7 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* TorusGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new TorusGob();
+    return SetInitialState(new TorusGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -705,7 +718,7 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* SphereGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new SphereGob();
+    return SetInitialState(new SphereGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -713,7 +726,7 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* ConeGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new ConeGob();
+    return SetInitialState(new ConeGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -721,7 +734,7 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* CylinderGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new CylinderGob();
+    return SetInitialState(new CylinderGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -729,7 +742,7 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* PlaneGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new PlaneGob();
+    return SetInitialState(new PlaneGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
@@ -737,14 +750,14 @@ void PrimitiveShapeGob_TextureTransform_Set(ObjectGUID instanceId, void* data, i
 //-----------------------------------------------------------------------------
 Object* BillboardGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new BillboardGob();
+    return SetInitialState(new BillboardGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void BillboardGob_Intensity_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BillboardGob* instance = reinterpret_cast<BillboardGob*>(instanceId);
+    BillboardGob* instance = ObjectTable::Inst()->GetAs<BillboardGob>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetIntensity(localData);
 }
@@ -753,7 +766,7 @@ void BillboardGob_Intensity_Set(ObjectGUID instanceId, void* data, int size)
 void BillboardGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BillboardGob* instance = reinterpret_cast<BillboardGob*>(instanceId);
+    BillboardGob* instance = ObjectTable::Inst()->GetAs<BillboardGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetColor(localData);
 }
@@ -762,7 +775,7 @@ void BillboardGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 void BillboardGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BillboardGob* instance = reinterpret_cast<BillboardGob*>(instanceId);
+    BillboardGob* instance = ObjectTable::Inst()->GetAs<BillboardGob>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetDiffuse(localData);
 }
@@ -771,7 +784,7 @@ void BillboardGob_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 void BillboardGob_TextureTransform_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    BillboardGob* instance = reinterpret_cast<BillboardGob*>(instanceId);
+    BillboardGob* instance = ObjectTable::Inst()->GetAs<BillboardGob>(instanceId);
     Matrix localData = *reinterpret_cast<Matrix*>(data);
     instance->SetTextureTransform(localData);
 }
@@ -781,14 +794,14 @@ void BillboardGob_TextureTransform_Set(ObjectGUID instanceId, void* data, int si
 //-----------------------------------------------------------------------------
 Object* OrcGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new OrcGob();
+    return SetInitialState(new OrcGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Weight_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    OrcGob* instance = reinterpret_cast<OrcGob*>(instanceId);
+    OrcGob* instance = ObjectTable::Inst()->GetAs<OrcGob>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetWeight(localData);
 }
@@ -797,7 +810,7 @@ void OrcGob_Weight_Set(ObjectGUID instanceId, void* data, int size)
 void OrcGob_Emotion_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    OrcGob* instance = reinterpret_cast<OrcGob*>(instanceId);
+    OrcGob* instance = ObjectTable::Inst()->GetAs<OrcGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetEmotion(localData);
 }
@@ -806,7 +819,7 @@ void OrcGob_Emotion_Set(ObjectGUID instanceId, void* data, int size)
 void OrcGob_Goals_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    OrcGob* instance = reinterpret_cast<OrcGob*>(instanceId);
+    OrcGob* instance = ObjectTable::Inst()->GetAs<OrcGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetGoals(localData);
 }
@@ -815,7 +828,7 @@ void OrcGob_Goals_Set(ObjectGUID instanceId, void* data, int size)
 void OrcGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    OrcGob* instance = reinterpret_cast<OrcGob*>(instanceId);
+    OrcGob* instance = ObjectTable::Inst()->GetAs<OrcGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetColor(localData);
 }
@@ -824,7 +837,7 @@ void OrcGob_Color_Set(ObjectGUID instanceId, void* data, int size)
 void OrcGob_ToeColor_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    OrcGob* instance = reinterpret_cast<OrcGob*>(instanceId);
+    OrcGob* instance = ObjectTable::Inst()->GetAs<OrcGob>(instanceId);
     int localData = *reinterpret_cast<int*>(data);
     instance->SetToeColor(localData);
 }
@@ -832,80 +845,80 @@ void OrcGob_ToeColor_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 void OrcGob_Geometry_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    ResourceReference* child = reinterpret_cast<ResourceReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    ResourceReference* child = ObjectTable::Inst()->GetAs<ResourceReference>(childId);
     parent->AddGeometry(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Geometry_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    ResourceReference* child = reinterpret_cast<ResourceReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    ResourceReference* child = ObjectTable::Inst()->GetAs<ResourceReference>(childId);
     parent->RemoveGeometry(child);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Animation_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    ResourceReference* child = reinterpret_cast<ResourceReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    ResourceReference* child = ObjectTable::Inst()->GetAs<ResourceReference>(childId);
     parent->AddAnimation(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Animation_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    ResourceReference* child = reinterpret_cast<ResourceReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    ResourceReference* child = ObjectTable::Inst()->GetAs<ResourceReference>(childId);
     parent->RemoveAnimation(child);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Target_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    GameObjectReference* child = reinterpret_cast<GameObjectReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    GameObjectReference* child = ObjectTable::Inst()->GetAs<GameObjectReference>(childId);
     parent->AddTarget(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Target_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    GameObjectReference* child = reinterpret_cast<GameObjectReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    GameObjectReference* child = ObjectTable::Inst()->GetAs<GameObjectReference>(childId);
     parent->RemoveTarget(child);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Friends_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    GameObjectReference* child = reinterpret_cast<GameObjectReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    GameObjectReference* child = ObjectTable::Inst()->GetAs<GameObjectReference>(childId);
     parent->AddFriends(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Friends_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    GameObjectReference* child = reinterpret_cast<GameObjectReference*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    GameObjectReference* child = ObjectTable::Inst()->GetAs<GameObjectReference>(childId);
     parent->RemoveFriends(child);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Children_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    OrcGob* child = reinterpret_cast<OrcGob*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    OrcGob* child = ObjectTable::Inst()->GetAs<OrcGob>(childId);
     parent->AddChildren(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void OrcGob_Children_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    OrcGob* parent = reinterpret_cast<OrcGob*>(parentId);
-    OrcGob* child = reinterpret_cast<OrcGob*>(childId);
+    OrcGob* parent = ObjectTable::Inst()->GetAs<OrcGob>(parentId);
+    OrcGob* child = ObjectTable::Inst()->GetAs<OrcGob>(childId);
     parent->RemoveChildren(child);
 }
 
@@ -922,7 +935,7 @@ void OrcGob_Children_Remove(ObjectGUID parentId, ObjectGUID childId)
 void TerrainMap_Name_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetName(localData);
 }
@@ -931,7 +944,7 @@ void TerrainMap_Name_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_Visible_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetVisible(localData);
 }
@@ -940,7 +953,7 @@ void TerrainMap_Visible_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_MinHeight_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetMinHeight(localData);
 }
@@ -949,7 +962,7 @@ void TerrainMap_MinHeight_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_MaxHeight_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetMaxHeight(localData);
 }
@@ -958,7 +971,7 @@ void TerrainMap_MaxHeight_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetDiffuse(localData);
 }
@@ -967,7 +980,7 @@ void TerrainMap_Diffuse_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_Normal_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetNormal(localData);
 }
@@ -976,7 +989,7 @@ void TerrainMap_Normal_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_Specular_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetSpecular(localData);
 }
@@ -985,7 +998,7 @@ void TerrainMap_Specular_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainMap_Mask_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainMap* instance = reinterpret_cast<TerrainMap*>(instanceId);
+    TerrainMap* instance = ObjectTable::Inst()->GetAs<TerrainMap>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetMask(localData);
 }
@@ -995,14 +1008,14 @@ void TerrainMap_Mask_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* DecorationMap_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new DecorationMap();
+    return SetInitialState(new DecorationMap(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void DecorationMap_Scale_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DecorationMap* instance = reinterpret_cast<DecorationMap*>(instanceId);
+    DecorationMap* instance = ObjectTable::Inst()->GetAs<DecorationMap>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetScale(localData);
 }
@@ -1011,7 +1024,7 @@ void DecorationMap_Scale_Set(ObjectGUID instanceId, void* data, int size)
 void DecorationMap_NumOfDecorators_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DecorationMap* instance = reinterpret_cast<DecorationMap*>(instanceId);
+    DecorationMap* instance = ObjectTable::Inst()->GetAs<DecorationMap>(instanceId);
     int32_t localData = *reinterpret_cast<int32_t*>(data);
     instance->SetNumOfDecorators(localData);
 }
@@ -1020,7 +1033,7 @@ void DecorationMap_NumOfDecorators_Set(ObjectGUID instanceId, void* data, int si
 void DecorationMap_LodDistance_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DecorationMap* instance = reinterpret_cast<DecorationMap*>(instanceId);
+    DecorationMap* instance = ObjectTable::Inst()->GetAs<DecorationMap>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetLodDistance(localData);
 }
@@ -1029,7 +1042,7 @@ void DecorationMap_LodDistance_Set(ObjectGUID instanceId, void* data, int size)
 void DecorationMap_UseBillboard_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    DecorationMap* instance = reinterpret_cast<DecorationMap*>(instanceId);
+    DecorationMap* instance = ObjectTable::Inst()->GetAs<DecorationMap>(instanceId);
     bool localData = *reinterpret_cast<bool*>(data);
     instance->SetUseBillboard(localData);
 }
@@ -1039,14 +1052,14 @@ void DecorationMap_UseBillboard_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* LayerMap_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new LayerMap();
+    return SetInitialState(new LayerMap(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void LayerMap_LodTexture_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    LayerMap* instance = reinterpret_cast<LayerMap*>(instanceId);
+    LayerMap* instance = ObjectTable::Inst()->GetAs<LayerMap>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetLodTexture(localData);
 }
@@ -1055,7 +1068,7 @@ void LayerMap_LodTexture_Set(ObjectGUID instanceId, void* data, int size)
 void LayerMap_TextureScale_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    LayerMap* instance = reinterpret_cast<LayerMap*>(instanceId);
+    LayerMap* instance = ObjectTable::Inst()->GetAs<LayerMap>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetTextureScale(localData);
 }
@@ -1065,14 +1078,14 @@ void LayerMap_TextureScale_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 Object* TerrainGob_Create(ObjectTypeGUID tid, void* data, int size)
 {
-    return new TerrainGob();
+    return SetInitialState(new TerrainGob(), data, size);
 }
 
 //-----------------------------------------------------------------------------
 void TerrainGob_CellSize_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainGob* instance = reinterpret_cast<TerrainGob*>(instanceId);
+    TerrainGob* instance = ObjectTable::Inst()->GetAs<TerrainGob>(instanceId);
     float localData = *reinterpret_cast<float*>(data);
     instance->SetCellSize(localData);
 }
@@ -1081,7 +1094,7 @@ void TerrainGob_CellSize_Set(ObjectGUID instanceId, void* data, int size)
 void TerrainGob_HeightMap_Set(ObjectGUID instanceId, void* data, int size)
 {
     assert((data && size > 0) || (!data && size == 0));
-    TerrainGob* instance = reinterpret_cast<TerrainGob*>(instanceId);
+    TerrainGob* instance = ObjectTable::Inst()->GetAs<TerrainGob>(instanceId);
     wchar_t* localData = reinterpret_cast<wchar_t*>(data);
     instance->SetHeightMap(localData);
 }
@@ -1089,32 +1102,32 @@ void TerrainGob_HeightMap_Set(ObjectGUID instanceId, void* data, int size)
 //-----------------------------------------------------------------------------
 void TerrainGob_LayerMap_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    TerrainGob* parent = reinterpret_cast<TerrainGob*>(parentId);
-    LayerMap* child = reinterpret_cast<LayerMap*>(childId);
+    TerrainGob* parent = ObjectTable::Inst()->GetAs<TerrainGob>(parentId);
+    LayerMap* child = ObjectTable::Inst()->GetAs<LayerMap>(childId);
     parent->AddLayerMap(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void TerrainGob_LayerMap_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    TerrainGob* parent = reinterpret_cast<TerrainGob*>(parentId);
-    LayerMap* child = reinterpret_cast<LayerMap*>(childId);
+    TerrainGob* parent = ObjectTable::Inst()->GetAs<TerrainGob>(parentId);
+    LayerMap* child = ObjectTable::Inst()->GetAs<LayerMap>(childId);
     parent->RemoveLayerMap(child);
 }
 
 //-----------------------------------------------------------------------------
 void TerrainGob_DecorationMap_Add(ObjectGUID parentId, ObjectGUID childId, int index)
 {
-    TerrainGob* parent = reinterpret_cast<TerrainGob*>(parentId);
-    DecorationMap* child = reinterpret_cast<DecorationMap*>(childId);
+    TerrainGob* parent = ObjectTable::Inst()->GetAs<TerrainGob>(parentId);
+    DecorationMap* child = ObjectTable::Inst()->GetAs<DecorationMap>(childId);
     parent->AddDecorationMap(child, index);
 }
 
 //-----------------------------------------------------------------------------
 void TerrainGob_DecorationMap_Remove(ObjectGUID parentId, ObjectGUID childId)
 {
-    TerrainGob* parent = reinterpret_cast<TerrainGob*>(parentId);
-    DecorationMap* child = reinterpret_cast<DecorationMap*>(childId);
+    TerrainGob* parent = ObjectTable::Inst()->GetAs<TerrainGob>(parentId);
+    DecorationMap* child = ObjectTable::Inst()->GetAs<DecorationMap>(childId);
     parent->RemoveDecorationMap(child);
 }
 
@@ -1127,6 +1140,7 @@ void TerrainGob_DecorationMap_Remove(ObjectGUID parentId, ObjectGUID childId)
 //-----------------------------------------------------------------------------
 void InitGobBridge(GobBridge& bridge)
 {
+  s_bridge = &bridge;
   bridge.RegisterObject( "GameLevel", &GameLevel_Create );
   bridge.RegisterProperty( "GameLevel", "Name", &GameLevel_Name_Set, NULL );
   bridge.RegisterProperty( "GameLevel", "FogEnabled", &GameLevel_FogEnabled_Set, NULL );
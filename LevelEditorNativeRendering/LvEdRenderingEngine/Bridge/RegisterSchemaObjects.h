@@ -1,7 +1,9 @@
 //Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
 #pragma once
 #include "GobBridge.h"
+#include "CommandBuffer.h"
 #include "../Core/Object.h"
+#include "../Core/ObjectTable.h"
 
 #include "../GobSystem/BillboardGob.h"
 #include "../GobSystem/BoxLightGob.h"
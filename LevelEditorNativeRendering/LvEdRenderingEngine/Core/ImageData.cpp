@@ -7,7 +7,6 @@
 #include "../DirectX/DXUtil.h"
 #include "../DirectX/DirectXTex/DirectXTex.h"
 #include "FileUtils.h"
-#include "StringUtils.h"
 
 
 using namespace DirectX;
@@ -22,17 +21,16 @@ namespace LvEdEngine
 }
 
 
-void ImageData::Invoke(wchar_t* fn, const void* arg, void** retVal)
+void ImageData::Invoke(MemberFnEnum fn, const void* arg, void** retVal)
 {
-     if(fn == NULL || wcslen(fn) == 0) return;
-     if( wcscmp(fn,L"CreateNew") == 0)
+     if(fn == MemberFn::CreateNew)
      {
         // size_t argsize = 3 * sizeof(int32_t);
          assert(arg);
          int32_t* args = (int32_t*) arg;
          CreateNew(args[0],args[1],(uint32_t)args[2]);
      }
-     else if(StrUtils::Equal(fn,L"SaveToFile"))
+     else if(fn == MemberFn::SaveToFile)
      {
          assert(arg);
          wchar_t* file = (wchar_t*)arg;
@@ -27,7 +27,7 @@ class ImageData : public Object
     ImageData();    
     ~ImageData();
 
-    void Invoke(wchar_t* fn, const void* arg, void** retVal);
+    void Invoke(MemberFnEnum fn, const void* arg, void** retVal);
 
     void CreateNew(int32_t width, int32_t height, uint32_t format);
     void LoadFromFile(wchar_t* file);
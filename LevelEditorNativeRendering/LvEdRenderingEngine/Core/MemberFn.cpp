@@ -0,0 +1,38 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "MemberFn.h"
+#include <wchar.h>
+
+namespace LvEdEngine
+{
+    // in the order of the enum.
+    static const wchar_t* s_memberFnNames[MemberFn::Count] =
+    {
+        L"RayPick",
+        L"DrawBrush",
+        L"ApplyDirtyRegion",
+        L"GetHeightMapInstanceId",
+        L"GetMaskMapInstanceId",
+        L"CreateNew",
+        L"SaveToFile",
+    };
+
+    // ----------------------------------------------------------------------------------
+    MemberFnEnum GetMemberFnId(const wchar_t* name)
+    {
+        if(name == NULL)
+            return MemberFn::Invalid;
+        for(int i = 0; i < MemberFn::Count; i++)
+        {
+            if(wcscmp(name, s_memberFnNames[i]) == 0)
+                return (MemberFnEnum)i;
+        }
+        return MemberFn::Invalid;
+    }
+
+    // ----------------------------------------------------------------------------------
+    const wchar_t* GetMemberFnName(int fn)
+    {
+        return fn >= 0 && fn < MemberFn::Count ? s_memberFnNames[fn] : NULL;
+    }
+}
@@ -0,0 +1,31 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+// member functions the editor calls through LvEd_InvokeMemberFn().
+// the names are resolved to ids once, Object::Invoke() gets the id.
+namespace MemberFn
+{
+    enum MemberFn
+    {
+        Invalid = -1,
+        RayPick = 0,
+        DrawBrush,
+        ApplyDirtyRegion,
+        GetHeightMapInstanceId,
+        GetMaskMapInstanceId,
+        CreateNew,
+        SaveToFile,
+        Count
+    };
+}
+typedef MemberFn::MemberFn MemberFnEnum;
+
+namespace LvEdEngine
+{
+    // returns MemberFn::Invalid for NULL or unknown names.
+    MemberFnEnum GetMemberFnId(const wchar_t* name);
+
+    // returns NULL for invalid ids.
+    const wchar_t* GetMemberFnName(int fn);
+}
@@ -1,2 +1,19 @@
 //Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
 
+#include "Object.h"
+#include "ObjectTable.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------------
+    Object::Object()
+    {
+        m_instanceId = ObjectTable::Inst()->Add(this);
+    }
+
+    // ----------------------------------------------------------------------------------
+    Object::~Object()
+    {
+        ObjectTable::Inst()->Remove(m_instanceId);
+    }
+}
@@ -4,21 +4,28 @@
 
 #include "typedefs.h"
 #include "NonCopyable.h"
+#include "MemberFn.h"
 #include <stdint.h>
 
 namespace LvEdEngine
 {    
     // base class for all object types, GameLevel, GameObject, etc.
+    // every object is registered in the ObjectTable, the instance id is
+    // the handle of the object in the table.
     class Object : public NonCopyable
     {
     public:
         virtual const char* ClassName()  const  = 0;
         ObjectGUID GetInstanceId() const
         {
-            return (ObjectGUID)this;
+            return m_instanceId;
         }
-        virtual ~Object(void){}
+        Object();
+        virtual ~Object(void);
 
-        virtual void Invoke(wchar_t* /*fn*/, const void* /*arg*/, void** /*retVal*/) {}
+        virtual void Invoke(MemberFnEnum /*fn*/, const void* /*arg*/, void** /*retVal*/) {}
+
+    private:
+        ObjectGUID m_instanceId;
     };
 }
@@ -0,0 +1,225 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "ObjectPool.h"
+#include <algorithm>
+#include <new>
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include "Logger.h"
+
+namespace LvEdEngine
+{
+    static const uint32_t SlabSize = 64 * 1024;
+
+    // block sizes are multiples of the granularity, so all the blocks
+    // have the same alignment as the heap.
+    static const uint32_t Granularity = 16;
+    static const uint32_t MaxPooledSize = 4096;
+    static const uint32_t PoolCount = MaxPooledSize / Granularity;
+
+    // created on first use and never destroyed, so objects can be freed at any time.
+    static ObjectPool* s_pools[PoolCount];
+
+    // ----------------------------------------------------------------------------------
+    ObjectPool::ObjectPool(uint32_t blockSize)
+        : m_blockSize(blockSize),
+          m_blocksPerSlab(std::max<uint32_t>(1, SlabSize / blockSize)),
+          m_freeList(NULL),
+          m_liveBlocks(0),
+          m_peakBlocks(0),
+          m_allocCount(0),
+          m_freeCount(0)
+    {
+        assert(blockSize >= sizeof(FreeBlock) && blockSize % Granularity == 0);
+    }
+
+    // ----------------------------------------------------------------------------------
+    ObjectPool::~ObjectPool()
+    {
+        assert(m_liveBlocks == 0);
+        for(auto it = m_slabs.begin(); it != m_slabs.end(); ++it)
+        {
+            _aligned_free(*it);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    void* ObjectPool::Allocate()
+    {
+        if(m_freeList == NULL)
+            AddSlab();
+
+        FreeBlock* block = m_freeList;
+        m_freeList = block->next;
+        m_liveBlocks++;
+        m_allocCount++;
+        m_peakBlocks = std::max(m_peakBlocks, m_liveBlocks);
+        return block;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectPool::Free(void* p)
+    {
+        assert(p && m_liveBlocks > 0);
+        FreeBlock* block = (FreeBlock*)p;
+        block->next = m_freeList;
+        m_freeList = block;
+        m_liveBlocks--;
+        m_freeCount++;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectPool::AddSlab()
+    {
+        uint8_t* slab = (uint8_t*)_aligned_malloc(m_blocksPerSlab * m_blockSize, Granularity);
+        if(slab == NULL)
+            throw std::bad_alloc();
+        m_slabs.push_back(slab);
+
+        // link the blocks in address order, objects created one after
+        // the other end up next to each other in memory.
+        for(uint32_t i = m_blocksPerSlab; i > 0; i--)
+        {
+            FreeBlock* block = (FreeBlock*)(slab + (i - 1) * m_blockSize);
+            block->next = m_freeList;
+            m_freeList = block;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectPool::Trim()
+    {
+        if(m_liveBlocks == 0)
+        {
+            // bulk release, no need to look at the free list.
+            for(auto it = m_slabs.begin(); it != m_slabs.end(); ++it)
+            {
+                _aligned_free(*it);
+            }
+            m_slabs.clear();
+            m_freeList = NULL;
+            return;
+        }
+
+        // count the free blocks of each slab.
+        std::sort(m_slabs.begin(), m_slabs.end());
+        std::vector<uint32_t> freeCount(m_slabs.size(), 0);
+        for(FreeBlock* block = m_freeList; block; block = block->next)
+        {
+            auto it = std::upper_bound(m_slabs.begin(), m_slabs.end(), (uint8_t*)block) - 1;
+            freeCount[it - m_slabs.begin()]++;
+        }
+
+        // rebuild the free list without the blocks of the empty slabs.
+        FreeBlock* freeList = NULL;
+        FreeBlock** tail = &freeList;
+        for(FreeBlock* block = m_freeList; block; block = block->next)
+        {
+            auto it = std::upper_bound(m_slabs.begin(), m_slabs.end(), (uint8_t*)block) - 1;
+            if(freeCount[it - m_slabs.begin()] == m_blocksPerSlab)
+                continue;
+            *tail = block;
+            tail = &block->next;
+        }
+        *tail = NULL;
+        m_freeList = freeList;
+
+        size_t kept = 0;
+        for(size_t i = 0; i < m_slabs.size(); i++)
+        {
+            if(freeCount[i] == m_blocksPerSlab)
+                _aligned_free(m_slabs[i]);
+            else
+                m_slabs[kept++] = m_slabs[i];
+        }
+        m_slabs.resize(kept);
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectPool::GetStats(Stats& stats) const
+    {
+        stats.allocCount = m_allocCount;
+        stats.freeCount = m_freeCount;
+        stats.liveBlocks = m_liveBlocks;
+        stats.peakBlocks = m_peakBlocks;
+        stats.slabCount = (uint32_t)m_slabs.size();
+        stats.reservedBytes = (uint64_t)m_slabs.size() * m_blocksPerSlab * m_blockSize;
+        stats.usedBytes = (uint64_t)m_liveBlocks * m_blockSize;
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void* ObjectPool::AllocateObject(size_t size)
+    {
+        if(size == 0 || size > MaxPooledSize)
+            return ::operator new(size);
+
+        uint32_t index = (uint32_t)((size + Granularity - 1) / Granularity) - 1;
+        if(s_pools[index] == NULL)
+            s_pools[index] = new ObjectPool((index + 1) * Granularity);
+        return s_pools[index]->Allocate();
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void ObjectPool::FreeObject(void* p, size_t size)
+    {
+        if(p == NULL)
+            return;
+        if(size == 0 || size > MaxPooledSize)
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        uint32_t index = (uint32_t)((size + Granularity - 1) / Granularity) - 1;
+        assert(s_pools[index]);
+        s_pools[index]->Free(p);
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void ObjectPool::TrimAll()
+    {
+        for(uint32_t i = 0; i < PoolCount; i++)
+        {
+            if(s_pools[i])
+                s_pools[i]->Trim();
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void ObjectPool::Debug_GetStats(Stats& stats)
+    {
+        memset(&stats, 0, sizeof(stats));
+        for(uint32_t i = 0; i < PoolCount; i++)
+        {
+            if(s_pools[i] == NULL)
+                continue;
+            Stats poolStats;
+            s_pools[i]->GetStats(poolStats);
+            stats.allocCount += poolStats.allocCount;
+            stats.freeCount += poolStats.freeCount;
+            stats.liveBlocks += poolStats.liveBlocks;
+            stats.peakBlocks += poolStats.peakBlocks;
+            stats.slabCount += poolStats.slabCount;
+            stats.reservedBytes += poolStats.reservedBytes;
+            stats.usedBytes += poolStats.usedBytes;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void ObjectPool::Debug_LogStats(const char* label)
+    {
+        Stats stats;
+        Debug_GetStats(stats);
+        float used = stats.reservedBytes ? 100.0f * (float)stats.usedBytes / (float)stats.reservedBytes : 100.0f;
+        Logger::Log(OutputMessageType::Info,
+            "%s: object pools: %llu allocs, %llu frees, %u live, %u slabs, %llu KB reserved, %.1f%% used\n",
+            label, stats.allocCount, stats.freeCount, stats.liveBlocks, stats.slabCount,
+            stats.reservedBytes / 1024, used);
+    }
+}
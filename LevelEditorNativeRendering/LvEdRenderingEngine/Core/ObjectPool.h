@@ -0,0 +1,74 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "NonCopyable.h"
+
+namespace LvEdEngine
+{
+
+// ----------------------------------------------------------------------------
+// fixed size block allocator.
+// blocks are carved from 64KB slabs, freed blocks are kept in a free list
+// and reused first. the slabs are only released by Trim(), all at once when
+// the pool is empty.
+// not thread safe, the objects are created and destroyed by the bridge
+// on the main thread.
+class ObjectPool : public NonCopyable
+{
+public:
+    struct Stats
+    {
+        uint64_t allocCount;    // number of Allocate() calls.
+        uint64_t freeCount;     // number of Free() calls.
+        uint32_t liveBlocks;
+        uint32_t peakBlocks;
+        uint32_t slabCount;
+        uint64_t reservedBytes; // size of all the slabs.
+        uint64_t usedBytes;     // size of the live blocks.
+    };
+
+    ObjectPool(uint32_t blockSize);
+    ~ObjectPool();
+
+    void* Allocate();
+    void  Free(void* p);
+
+    // releases the slabs that have no live block.
+    void  Trim();
+
+    uint32_t GetBlockSize() const { return m_blockSize; }
+    void     GetStats(Stats& stats) const;
+
+    // size segregated pools used by the operator new and delete of the pooled
+    // object classes, the size is the size of the most derived class.
+    // objects larger than the largest pool use the heap.
+    static void* AllocateObject(size_t size);
+    static void  FreeObject(void* p, size_t size);
+    static void  TrimAll();
+    // sum of the stats of all the pools.
+    static void  Debug_GetStats(Stats& stats);
+    static void  Debug_LogStats(const char* label);
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    void AddSlab();
+
+    uint32_t m_blockSize;
+    uint32_t m_blocksPerSlab;
+    FreeBlock* m_freeList;
+    std::vector<uint8_t*> m_slabs;
+    uint32_t m_liveBlocks;
+    uint32_t m_peakBlocks;
+    uint64_t m_allocCount;
+    uint64_t m_freeCount;
+};
+
+}
@@ -0,0 +1,166 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "ObjectTable.h"
+#include <new>
+#include <string.h>
+#include <assert.h>
+#include "Logger.h"
+
+namespace LvEdEngine
+{
+    ObjectTable* ObjectTable::s_inst = NULL;
+
+    // ----------------------------------------------------------------------------------
+    // the first object is created by the main thread during initialization,
+    // before the loader thread is started.
+    //static
+    ObjectTable* ObjectTable::Inst()
+    {
+        if(s_inst == NULL)
+            s_inst = new ObjectTable();
+        return s_inst;
+    }
+
+    // ----------------------------------------------------------------------------------
+    ObjectTable::ObjectTable()
+        : m_chunkCount(0),
+          m_freeHead(NullSlot),
+          m_objectCount(0)
+    {
+        memset(m_chunks, 0, sizeof(m_chunks));
+        InitializeCriticalSection(&m_criticalSection);
+    }
+
+    // ----------------------------------------------------------------------------------
+    ObjectTable::~ObjectTable()
+    {
+        for(uint32_t i = 0; i < m_chunkCount; i++)
+        {
+            delete m_chunks[i];
+        }
+        DeleteCriticalSection(&m_criticalSection);
+    }
+
+    // ----------------------------------------------------------------------------------
+    ObjectGUID ObjectTable::Add(Object* obj)
+    {
+        assert(obj);
+        EnterCriticalSection(&m_criticalSection);
+        if(m_freeHead == NullSlot)
+        {
+            if(m_chunkCount == MaxChunks)
+            {
+                LeaveCriticalSection(&m_criticalSection);
+                Logger::Log(OutputMessageType::Error, "object table is full, %u objects\n", m_objectCount);
+                throw std::bad_alloc();
+            }
+
+            // link the new slots in index order, generations start at 1 so no id is 0.
+            Chunk* chunk = new Chunk(); // zero initialized.
+            uint32_t base = m_chunkCount * ChunkSize;
+            for(uint32_t i = 0; i < ChunkSize; i++)
+            {
+                chunk->slots[i].generation = 1;
+                chunk->slots[i].nextFree = i + 1 < ChunkSize ? base + i + 1 : NullSlot;
+            }
+            m_chunks[m_chunkCount++] = chunk;
+            m_freeHead = base;
+        }
+
+        uint32_t index = m_freeHead;
+        Slot& slot = m_chunks[index >> ChunkShift]->slots[index & ChunkMask];
+        m_freeHead = slot.nextFree;
+        slot.object = obj;
+        slot.nextFree = NullSlot;
+        m_objectCount++;
+        ObjectGUID id = ((ObjectGUID)slot.generation << 32) | index;
+        LeaveCriticalSection(&m_criticalSection);
+        return id;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectTable::Remove(ObjectGUID id)
+    {
+        EnterCriticalSection(&m_criticalSection);
+        Slot* slot = GetSlot(id);
+        assert(slot);
+        if(slot)
+        {
+            // the bits are only written when set, objects destroyed on the
+            // loader thread are never selected or hidden.
+            WriteBit(id, &Chunk::selected, false);
+            WriteBit(id, &Chunk::hidden, false);
+
+            slot->object = NULL;
+            slot->generation++;
+            if(slot->generation == 0)
+                slot->generation = 1;
+            slot->nextFree = m_freeHead;
+            m_freeHead = SlotIndex(id);
+            m_objectCount--;
+        }
+        LeaveCriticalSection(&m_criticalSection);
+    }
+
+    // ----------------------------------------------------------------------------------
+    ObjectTable::Slot* ObjectTable::GetSlot(ObjectGUID id)
+    {
+        if(Get(id) == NULL)
+            return NULL;
+        uint32_t index = SlotIndex(id);
+        return &m_chunks[index >> ChunkShift]->slots[index & ChunkMask];
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectTable::WriteBit(ObjectGUID id, uint64_t (Chunk::*bits)[ChunkSize / 64], bool value)
+    {
+        uint32_t index = SlotIndex(id);
+        Chunk* chunk = m_chunks[index >> ChunkShift];
+        uint32_t bit = index & ChunkMask;
+        uint64_t& word = (chunk->*bits)[bit >> 6];
+        uint64_t mask = 1ull << (bit & 63);
+        if(((word & mask) != 0) != value)
+            word ^= mask;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectTable::SetSelection(const ObjectGUID* ids, int count)
+    {
+        ClearSelection();
+        m_selection.reserve(count);
+        for(int i = 0; i < count; i++)
+        {
+            ObjectGUID id = ids[i];
+            if(Get(id) == NULL)
+            {
+                Logger::Log(OutputMessageType::Warning, "ignored stale selection id 0x%llx\n", id);
+                continue;
+            }
+            if(IsSelected(id))
+                continue;
+            WriteBit(id, &Chunk::selected, true);
+            m_selection.push_back(id);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectTable::ClearSelection()
+    {
+        // only the slots of the selected objects are touched.
+        // the bit of a destroyed object is already cleared by Remove().
+        for(auto it = m_selection.begin(); it != m_selection.end(); ++it)
+        {
+            if(Get(*it))
+                WriteBit(*it, &Chunk::selected, false);
+        }
+        m_selection.clear();
+    }
+
+    // ----------------------------------------------------------------------------------
+    void ObjectTable::SetHidden(ObjectGUID id, bool hidden)
+    {
+        if(Get(id) == NULL)
+            return;
+        WriteBit(id, &Chunk::hidden, hidden);
+    }
+}
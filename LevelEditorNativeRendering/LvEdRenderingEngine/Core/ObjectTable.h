@@ -0,0 +1,114 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "WinHeaders.h"
+#include "typedefs.h"
+#include "NonCopyable.h"
+
+namespace LvEdEngine
+{
+    class Object;
+
+    // ----------------------------------------------------------------------------
+    // generational handle table, maps the instance ids given to the editor to the objects.
+    // an id is the slot index in the low 32 bits and the generation of the slot in
+    // the high 32 bits. the generation is bumped when the object is destroyed, so
+    // the ids of destroyed objects are rejected by Get() and the slot can be reused.
+    // the slots live in fixed size chunks that never move, Add() and Remove() are
+    // locked because resources are created on the loader thread, Get() is not.
+    // the selection and the hidden flags are bitsets indexed by slot.
+    class ObjectTable : public NonCopyable
+    {
+    public:
+        // created on first use and never destroyed, objects can be destroyed at any time.
+        static ObjectTable* Inst();
+
+        // called by Object, returns the id of the object, never 0.
+        ObjectGUID Add(Object* obj);
+        void Remove(ObjectGUID id);
+
+        // returns NULL for 0, unknown or stale ids.
+        Object* Get(ObjectGUID id) const
+        {
+            uint32_t index = SlotIndex(id);
+            uint32_t chunkIndex = index >> ChunkShift;
+            if(chunkIndex >= MaxChunks || m_chunks[chunkIndex] == NULL)
+                return NULL;
+            const Slot& slot = m_chunks[chunkIndex]->slots[index & ChunkMask];
+            return slot.generation == (uint32_t)(id >> 32) ? slot.object : NULL;
+        }
+
+        // as Get(), and NULL if the object is not a T, so an id of the wrong type
+        // passed by the editor is rejected instead of being used as a T.
+        template<typename T>
+        T* GetAs(ObjectGUID id) const
+        {
+            return dynamic_cast<T*>(Get(id));
+        }
+
+        static uint32_t SlotIndex(ObjectGUID id) { return (uint32_t)id; }
+
+        // selection, set by the editor. stale ids are ignored.
+        void SetSelection(const ObjectGUID* ids, int count);
+        void ClearSelection();
+        uint32_t GetSelectionCount() const { return (uint32_t)m_selection.size(); }
+
+        // false for 0, unknown or stale ids, as Get().
+        bool IsSelected(ObjectGUID id) const { return TestBit(id, &Chunk::selected); }
+
+        void SetHidden(ObjectGUID id, bool hidden);
+        bool IsHidden(ObjectGUID id) const { return TestBit(id, &Chunk::hidden); }
+
+        uint32_t GetObjectCount() const { return m_objectCount; }
+
+    private:
+        static const uint32_t ChunkShift = 12;
+        static const uint32_t ChunkSize = 1 << ChunkShift;
+        static const uint32_t ChunkMask = ChunkSize - 1;
+        static const uint32_t MaxChunks = 4096;
+        static const uint32_t NullSlot = 0xffffffff;
+
+        struct Slot
+        {
+            Object* object;
+            uint32_t generation;
+            uint32_t nextFree;
+        };
+
+        struct Chunk
+        {
+            Slot slots[ChunkSize];
+            uint64_t selected[ChunkSize / 64];
+            uint64_t hidden[ChunkSize / 64];
+        };
+
+        ObjectTable();
+        ~ObjectTable();
+
+        Slot* GetSlot(ObjectGUID id);
+
+        bool TestBit(ObjectGUID id, uint64_t (Chunk::*bits)[ChunkSize / 64]) const
+        {
+            uint32_t index = SlotIndex(id);
+            uint32_t chunkIndex = index >> ChunkShift;
+            if(chunkIndex >= MaxChunks || m_chunks[chunkIndex] == NULL)
+                return false;
+            uint32_t bit = index & ChunkMask;
+            if(m_chunks[chunkIndex]->slots[bit].generation != (uint32_t)(id >> 32))
+                return false;
+            return ((m_chunks[chunkIndex]->*bits)[bit >> 6] & (1ull << (bit & 63))) != 0;
+        }
+        void WriteBit(ObjectGUID id, uint64_t (Chunk::*bits)[ChunkSize / 64], bool value);
+
+        Chunk* m_chunks[MaxChunks];
+        uint32_t m_chunkCount;
+        uint32_t m_freeHead;
+        uint32_t m_objectCount;
+        std::vector<ObjectGUID> m_selection;
+        CRITICAL_SECTION m_criticalSection;
+        static ObjectTable* s_inst;
+    };
+}
@@ -0,0 +1,111 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "PerfectHash.h"
+#include <algorithm>
+#include <assert.h>
+
+namespace LvEdEngine
+{
+    // no seed is found for a bucket only if it has duplicate keys.
+    static const uint32_t MaxSeed = 1 << 20;
+
+    // ----------------------------------------------------------------------------------
+    // the largest buckets are placed first, while most of the slots are free.
+    class BucketSizeGreater
+    {
+    public:
+        BucketSizeGreater(const std::vector<std::vector<uint64_t> >& buckets) : m_buckets(buckets) {}
+        bool operator()(uint32_t b1, uint32_t b2) const
+        {
+            return m_buckets[b1].size() > m_buckets[b2].size();
+        }
+    private:
+        const std::vector<std::vector<uint64_t> >& m_buckets;
+    };
+
+    // ----------------------------------------------------------------------------------
+    bool PerfectHash::Build(const uint64_t* keys, uint32_t count)
+    {
+        Clear();
+        if(count == 0)
+            return true;
+        if(count >= DirectSlot)
+            return false;
+
+        uint32_t bucketCount = 1;
+        while(bucketCount * 2 < count)
+            bucketCount <<= 1;
+        m_bucketMask = bucketCount - 1;
+        m_seeds.assign(bucketCount, 0);
+        m_keys.assign(count, 0);
+
+        std::vector<std::vector<uint64_t> > buckets(bucketCount);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            uint64_t h = Mix(keys[i]);
+            buckets[(uint32_t)(h >> 32) & m_bucketMask].push_back(keys[i]);
+        }
+
+        std::vector<uint32_t> order(bucketCount);
+        for(uint32_t b = 0; b < bucketCount; b++)
+            order[b] = b;
+        std::stable_sort(order.begin(), order.end(), BucketSizeGreater(buckets));
+
+        std::vector<bool> used(count, false);
+        std::vector<uint32_t> slots;
+        auto it = order.begin();
+        for(; it != order.end() && buckets[*it].size() > 1; ++it)
+        {
+            const std::vector<uint64_t>& bucket = buckets[*it];
+
+            // find a seed that sends all the keys of the bucket to distinct free slots.
+            uint32_t seed = 1;
+            for(; seed < MaxSeed; seed++)
+            {
+                slots.clear();
+                for(auto key = bucket.begin(); key != bucket.end(); ++key)
+                {
+                    uint32_t slot = SlotOf(Mix(*key), seed);
+                    if(used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end())
+                        break;
+                    slots.push_back(slot);
+                }
+                if(slots.size() == bucket.size())
+                    break;
+            }
+            if(seed == MaxSeed)
+            {
+                assert(!"duplicate keys");
+                Clear();
+                return false;
+            }
+
+            m_seeds[*it] = seed;
+            for(size_t i = 0; i < slots.size(); i++)
+            {
+                used[slots[i]] = true;
+                m_keys[slots[i]] = bucket[i];
+            }
+        }
+
+        // the single keys take the free slots in order.
+        uint32_t freeSlot = 0;
+        for(; it != order.end() && buckets[*it].size() == 1; ++it)
+        {
+            while(used[freeSlot])
+                freeSlot++;
+            used[freeSlot] = true;
+            m_seeds[*it] = DirectSlot | freeSlot;
+            m_keys[freeSlot] = buckets[*it][0];
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void PerfectHash::Clear()
+    {
+        m_keys.clear();
+        m_seeds.clear();
+        m_bucketMask = 0;
+    }
+}
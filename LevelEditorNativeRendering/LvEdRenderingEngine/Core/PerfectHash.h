@@ -0,0 +1,70 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "NonCopyable.h"
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------
+    // minimal perfect hash of a fixed set of 64 bit keys, built once.
+    // each key maps to its own slot in [0, count), so the values can be kept in
+    // a plain array indexed by slot.
+    // the keys are hashed to buckets of about two keys, each bucket gets the
+    // seed of a second hash that sends its keys to free slots (hash and displace).
+    // the buckets of one key store their slot instead of a seed, they are placed
+    // last when few slots are free.
+    // a lookup is two hashes and one key compare, no probing.
+    class PerfectHash : public NonCopyable
+    {
+    public:
+        static const uint32_t NotFound = 0xffffffff;
+
+        PerfectHash() : m_bucketMask(0) {}
+
+        // the keys must be unique. returns false if no seed was found for a bucket,
+        // the hash is empty in that case.
+        bool Build(const uint64_t* keys, uint32_t count);
+        void Clear();
+
+        // the slot of the key, NotFound if the key is not in the set.
+        uint32_t Find(uint64_t key) const
+        {
+            if(m_keys.empty())
+                return NotFound;
+            uint64_t h = Mix(key);
+            uint32_t seed = m_seeds[(uint32_t)(h >> 32) & m_bucketMask];
+            uint32_t slot = (seed & DirectSlot) ? seed & ~DirectSlot : SlotOf(h, seed);
+            return m_keys[slot] == key ? slot : NotFound;
+        }
+
+        uint32_t GetCount() const { return (uint32_t)m_keys.size(); }
+
+    private:
+        static const uint32_t DirectSlot = 0x80000000;
+
+        // 64 bit finalizer of MurmurHash3.
+        static uint64_t Mix(uint64_t x)
+        {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ull;
+            x ^= x >> 33;
+            return x;
+        }
+
+        // maps the seeded hash to [0, count) without a division.
+        uint32_t SlotOf(uint64_t h, uint32_t seed) const
+        {
+            uint32_t x = (uint32_t)Mix(h + seed);
+            return (uint32_t)(((uint64_t)x * m_keys.size()) >> 32);
+        }
+
+        std::vector<uint64_t> m_keys;   // key of each slot.
+        std::vector<uint32_t> m_seeds;  // seed of each bucket.
+        uint32_t m_bucketMask;
+    };
+}
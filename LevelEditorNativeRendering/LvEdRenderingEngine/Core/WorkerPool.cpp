@@ -0,0 +1,150 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "WorkerPool.h"
+#include <assert.h>
+#include "Utils.h"
+
+namespace LvEdEngine
+{
+
+WorkerPool* WorkerPool::s_inst = NULL;
+
+// upper limit, more threads don't help the editor workloads.
+static const uint32_t MaxWorkerThreads = 15;
+
+// ----------------------------------------------------------------------------------------------
+//static
+void WorkerPool::InitInstance()
+{
+    assert(s_inst == NULL);
+    if(s_inst) return;
+    s_inst = new WorkerPool();
+}
+
+// ----------------------------------------------------------------------------------------------
+//static
+void WorkerPool::DestroyInstance()
+{
+    assert(s_inst);
+    SAFE_DELETE(s_inst);
+}
+
+// ----------------------------------------------------------------------------------------------
+WorkerPool::WorkerPool()
+    : m_busy(0),
+      m_pending(0),
+      m_nextIndex(0),
+      m_count(0),
+      m_job(NULL),
+      m_exitRequested(false)
+{
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    uint32_t numWorkers = sysInfo.dwNumberOfProcessors > 1 ? sysInfo.dwNumberOfProcessors - 1 : 0;
+    if(numWorkers > MaxWorkerThreads)
+        numWorkers = MaxWorkerThreads;
+
+    m_doneEvent = CreateEvent(NULL, false, false, NULL);
+    for(uint32_t i = 0; i < numWorkers; i++)
+    {
+        Worker* worker = new Worker();
+        worker->pool = this;
+        worker->startEvent = CreateEvent(NULL, false, false, NULL);
+        worker->thread = CreateThread(NULL, 0, &WorkerPool::ThreadProc, worker, 0, NULL);
+        if(worker->thread == NULL)
+        {
+            CloseHandle(worker->startEvent);
+            delete worker;
+            break;
+        }
+        m_workers.push_back(worker);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------
+WorkerPool::~WorkerPool()
+{
+    m_exitRequested = true;
+    for(auto it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        SetEvent((*it)->startEvent);
+    }
+    for(auto it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        Worker* worker = (*it);
+        WaitForSingleObject(worker->thread, INFINITE);
+        CloseHandle(worker->thread);
+        CloseHandle(worker->startEvent);
+        delete worker;
+    }
+    m_workers.clear();
+    CloseHandle(m_doneEvent);
+}
+
+// ----------------------------------------------------------------------------------------------
+// worker thread, runs the jobs of each ParallelFor() until exit is requested.
+DWORD WINAPI WorkerPool::ThreadProc(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    WorkerPool* pool = worker->pool;
+    while(true)
+    {
+        WaitForSingleObject(worker->startEvent, INFINITE);
+        if(pool->m_exitRequested)
+            break;
+
+        pool->RunJobs();
+        if(InterlockedDecrement(&pool->m_pending) == 0)
+        {
+            SetEvent(pool->m_doneEvent);
+        }
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------------------------
+void WorkerPool::RunJobs()
+{
+    while(true)
+    {
+        uint32_t index = (uint32_t)InterlockedIncrement(&m_nextIndex) - 1;
+        if(index >= m_count)
+            break;
+        m_job->Execute(index);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------
+void WorkerPool::ParallelFor(ParallelJob* job, uint32_t count)
+{
+    if(count == 0) return;
+
+    // run on the calling thread if there is nothing to split
+    // or if the workers are already used by another ParallelFor().
+    if(count == 1 || m_workers.empty() || InterlockedCompareExchange(&m_busy, 1, 0) != 0)
+    {
+        for(uint32_t i = 0; i < count; i++)
+        {
+            job->Execute(i);
+        }
+        return;
+    }
+
+    m_job = job;
+    m_count = count;
+    m_nextIndex = 0;
+    m_pending = (LONG)m_workers.size();
+    for(auto it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        SetEvent((*it)->startEvent);
+    }
+
+    RunJobs();
+    WaitForSingleObject(m_doneEvent, INFINITE);
+
+    m_job = NULL;
+    m_count = 0;
+    InterlockedExchange(&m_busy, 0);
+}
+
+}; // namespace LvEdEngine
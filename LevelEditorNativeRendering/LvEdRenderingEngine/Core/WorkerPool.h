@@ -0,0 +1,68 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+#include <vector>
+#include "WinHeaders.h"
+#include "NonCopyable.h"
+
+namespace LvEdEngine
+{
+
+// ----------------------------------------------------------------------------
+// work executed by WorkerPool::ParallelFor()
+class ParallelJob
+{
+public:
+    virtual ~ParallelJob() {}
+
+    // called once for each index, from any of the threads.
+    virtual void Execute(uint32_t index) = 0;
+};
+
+// ----------------------------------------------------------------------------
+// fixed set of worker threads, one per extra cpu core,
+// used to split cpu heavy work such as picking.
+class WorkerPool : public NonCopyable
+{
+public:
+    static void        InitInstance();
+    static void        DestroyInstance();
+    static WorkerPool* Inst() { return s_inst; }
+
+    // number of threads that execute the jobs, including the calling thread.
+    uint32_t GetThreadCount() const { return (uint32_t)m_workers.size() + 1; }
+
+    // calls job->Execute(i) for each i in [0, count) and returns when all of them are done.
+    // the calling thread executes jobs too.
+    // If the pool is already busy, for example when called from a job,
+    // all the indices are executed on the calling thread.
+    void ParallelFor(ParallelJob* job, uint32_t count);
+
+private:
+    WorkerPool();
+    ~WorkerPool();
+
+    struct Worker
+    {
+        WorkerPool* pool;
+        HANDLE thread;
+        HANDLE startEvent;
+    };
+
+    static DWORD WINAPI ThreadProc(void* arg);
+    void RunJobs();
+
+    static WorkerPool* s_inst;
+
+    std::vector<Worker*> m_workers;
+    HANDLE m_doneEvent;
+    volatile LONG m_busy;
+    volatile LONG m_pending;     // workers that have not finished the current ParallelFor.
+    volatile LONG m_nextIndex;
+    uint32_t m_count;
+    ParallelJob* m_job;
+    volatile bool m_exitRequested;
+};
+
+}; // namespace LvEdEngine
@@ -20,9 +20,13 @@ namespace LvEdEngine
 		if (!IsVisible(context->Cam().GetFrustum()))
 			return;
 
+    // the quad faces the camera, so the matrix and the bounds of the render packet
+    // change with every view. that is the only state collection writes, and only
+    // of the billboard itself. the rest of the packet is built by Update().
+    if(m_renderable.mesh != NULL)
+        UpdateBillboard(&m_renderable, context);
+
 		super::GetRenderables(collector, context);
-    RenderableNode renderable;
-    SetupRenderable(&renderable, context);
 
     //  // test     
     //Mesh* quad = ShapeLibGetMesh(RenderShape::Quad);
@@ -36,31 +40,38 @@ namespace LvEdEngine
 
 
     RenderFlagsEnum flags = RenderFlags::Textured;
-    collector->Add( renderable, flags, Shaders::BillboardShader );
+    collector->AddRetained( &m_renderable, flags, Shaders::BillboardShader );
 }
 
 // ---------------------------------------------------------------------------------------------
 void BillboardGob::SetupRenderable(RenderableNode* r, RenderContext* context)
 {
-    Matrix billboard = m_world;
+    m_intensity = clamp(m_intensity, 0.0f, 1.0f);
+    PrimitiveShapeGob::SetupRenderable(r, context);    
+    float3 color = m_color.xyz() * m_intensity;
+    color = saturate(color);   
+    r->diffuse = float4(color,m_color.w);
+}
+
+// ---------------------------------------------------------------------------------------------
+// set the camera facing matrix and bounds of the render packet.
+void BillboardGob::UpdateBillboard(RenderableNode* r, RenderContext* context)
+{
+    const Matrix& world = GetWorldTransform();
+    Matrix billboard = world;
     {        
-        float sx = length( float3(&m_world.M11) );
-        float sy = length( float3(&m_world.M21) );
-        float sz = length( float3(&m_world.M31) );
+        float sx = length( float3(&world.M11) );
+        float sy = length( float3(&world.M21) );
+        float sz = length( float3(&world.M31) );
         Matrix scaleM = Matrix::CreateScale(sx,sy,sz);
 
-        float3 objectPos = &m_world.M41;
+        float3 objectPos = &world.M41;
         Camera& cam = context->Cam();
         Matrix b = Matrix::CreateBillboard(objectPos,cam.CamPos(),cam.CamUp(),cam.CamLook());        
         billboard = scaleM * b;
     }
    
-    m_intensity = clamp(m_intensity, 0.0f, 1.0f);
-    PrimitiveShapeGob::SetupRenderable(r, context);    
     r->WorldXform = billboard;
-    float3 color = m_color.xyz() * m_intensity;
-    color = saturate(color);   
-    r->diffuse = float4(color,m_color.w);
     // special case compute AABB
     m_localBounds = AABB(float3(-0.5f,-0.5f,-0.5f),float3(0.5f,0.5f,0.5f));
     m_bounds = m_localBounds;
@@ -68,4 +79,20 @@ namespace LvEdEngine
     r->bounds = m_bounds;    
 }
 
+// ---------------------------------------------------------------------------------------------
+// the quad always faces the camera, so use the bounds of the sphere
+// that contains the quad for any orientation.
+//virtual
+AABB BillboardGob::GetSpatialBounds() const
+{
+    const Matrix& world = GetWorldTransform();
+    float sx = length( float3(&world.M11) );
+    float sy = length( float3(&world.M21) );
+    float sz = length( float3(&world.M31) );
+    float radius = 0.5f * sqrt(sx*sx + sy*sy + sz*sz);
+    float3 center = &world.M41;
+    float3 extent(radius, radius, radius);
+    return AABB(center - extent, center + extent);
+}
+
 }; // namespace
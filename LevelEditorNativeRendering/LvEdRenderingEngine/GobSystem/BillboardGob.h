@@ -19,8 +19,11 @@ class BillboardGob : public PrimitiveShapeGob // note: in the schema, billboard
         void SetIntensity(float intensity)
         {
             m_intensity = clamp(intensity, 0.0f, 1.0f);
+            m_renderableDirty = true;
         };
     protected:        
+        virtual AABB GetSpatialBounds() const;
+        void UpdateBillboard(RenderableNode* r, RenderContext* context);
         float m_intensity;
     private:
         typedef PrimitiveShapeGob super;
@@ -31,20 +31,24 @@ namespace LvEdEngine
 void BoxLightGob::SetAmbient(int color)
 {
     ConvertColor(color, &m_light->ambient);
+    LightingState::Inst()->InvalidateBoxLight(m_light);
 }
 
 void BoxLightGob::SetDiffuse(int color)
 {
     ConvertColor(color, &m_light->diffuse);
+    LightingState::Inst()->InvalidateBoxLight(m_light);
 }
 
 void BoxLightGob::SetSpecular(int color)
 {
     ConvertColor(color, &m_light->specular);
+    LightingState::Inst()->InvalidateBoxLight(m_light);
 }
 void BoxLightGob::SetDirection(const float3& v)
 {
     m_light->dir = normalize(v);
+    LightingState::Inst()->InvalidateBoxLight(m_light);
 }
 
 float3 BoxLightGob::GetDirection()
@@ -55,6 +59,7 @@ namespace LvEdEngine
 void BoxLightGob::SetAttenuation(const float3& atten)
 {
     m_light->attenuation = float4(atten.x,atten.y,atten.z,1);
+    LightingState::Inst()->InvalidateBoxLight(m_light);
 }
 
 void BoxLightGob::GetRenderables(RenderableNodeCollector* collector, RenderContext* context)
@@ -71,9 +76,9 @@ namespace LvEdEngine
     RenderableNode renderable;
     GameObject::SetupRenderable(&renderable,context);
     renderable.mesh = m_mesh;
-    renderable.textures[TextureType::DIFFUSE] =  TextureLib::Inst()->GetByName(L"Light.png");
+    renderable.material = &m_material;
     
-    float3 objectPos = &m_world.M41;
+    float3 objectPos = &GetWorldTransform().M41;
     Camera& cam = context->Cam();    
     Matrix billboard = Matrix::CreateBillboard(objectPos,cam.CamPos(),cam.CamUp(),cam.CamLook());       
     
@@ -89,6 +94,7 @@ namespace LvEdEngine
     super::Update(fr,updateType);
     m_light->min = m_bounds.Min();
     m_light->max = m_bounds.Max();
+    LightingState::Inst()->UpdateBoxLight(m_light);
 }
 
 };
@@ -21,11 +21,12 @@ namespace LvEdEngine
     m_localBounds = mesh->bounds;
 
     const float pointSize = 8; // control point size in pixels
-    float upp = context->Cam().ComputeUnitPerPixel(float3(&m_world.M41),
+    const Matrix& world = GetWorldTransform();
+    float upp = context->Cam().ComputeUnitPerPixel(float3(&world.M41),
         context->ViewPort().y);
     float scale = pointSize * upp;        
     Matrix scaleM = Matrix::CreateScale(scale);
-    float3 objectPos = float3(m_world.M41,m_world.M42,m_world.M43);
+    float3 objectPos = float3(world.M41,world.M42,world.M43);
     Matrix b = Matrix::CreateBillboard(objectPos,context->Cam().CamPos(),context->Cam().CamUp(),context->Cam().CamLook());
     Matrix billboard = scaleM * b;
 
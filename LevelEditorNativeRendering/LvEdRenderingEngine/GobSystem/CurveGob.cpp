@@ -20,6 +20,7 @@ namespace LvEdEngine
     m_closed = false;
     m_steps = 10;    
     m_mesh.primitiveType = PrimitiveType::LineStrip;
+    m_segmentsDirty = true;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------
@@ -80,17 +81,6 @@ namespace LvEdEngine
 }
 
 
-// ----------------------------------------------------------------------------------
-void CurveGob::InvalidateWorld()
-{
-    // if the groups world is dirty, so are all the children's
-    m_worldDirty = true;
-    for( auto it = m_points.begin(); it != m_points.end(); ++it)
-    {
-        (*it)->InvalidateWorld();
-    }
-}
-
 //-----------------------------------------------------------------------------------------------------------------------------------
 // push Renderable nodes
 //virtual
@@ -108,7 +98,8 @@ namespace LvEdEngine
     r.SetFlag( RenderableNode::kShadowCaster, false );
     r.SetFlag( RenderableNode::kShadowReceiver, false );
     r.bounds = m_bounds;
-    r.WorldXform = m_world;       
+    r.WorldXform = GetWorldTransform();       
+    r.lineSegments = &m_segments;
     collector->Add( r, RenderFlags::None, Shaders::BasicShader );
 
     // draw control points.
@@ -126,11 +117,16 @@ namespace LvEdEngine
 {
     bool boundDirty = m_boundsDirty;
     super::Update(fr,updateType);
-    m_boundsDirty = boundDirty;
+    m_boundsDirty = boundDirty || m_worldXformUpdated;
 
-    if(!m_boundsDirty) return;
+    if(!m_boundsDirty)
+    {
+        UpdateSegments();
+        return;
+    }
 
     m_mesh.pos.clear();    
+    m_segmentsDirty = true;
     if(m_needsRebuild)
     {        
         SAFE_DELETE(m_mesh.vertexBuffer);
@@ -140,6 +136,7 @@ namespace LvEdEngine
     {
         m_localBounds = AABB(float3(-0.5f,-0.5f,-0.5f), float3(0.5f,0.5f,0.5f));
         UpdateWorldAABB();       
+        UpdateSegments();
         return;
     }
 
@@ -165,6 +162,7 @@ namespace LvEdEngine
     }
     m_bounds = AABB(min,max);                    
     m_boundsDirty = false;
+    UpdateSpatialProxy();
     std::vector<float3> verts;
     switch(m_type)
     {
@@ -292,6 +290,21 @@ namespace LvEdEngine
     }    
     
     m_needsRebuild = false;    
+    UpdateSegments();
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+void CurveGob::UpdateSegments()
+{
+    if(!m_segmentsDirty && m_segmentsWorld == GetWorldTransform())
+        return;
+
+    if(m_mesh.pos.size() >= 2)
+        m_segments.Build(&m_mesh.pos[0], (uint32_t)m_mesh.pos.size(), GetWorldTransform());
+    else
+        m_segments.Clear();
+    m_segmentsWorld = GetWorldTransform();
+    m_segmentsDirty = false;
 }
 
 }; // namespace
@@ -5,6 +5,7 @@
 #include "ControlPointGob.h"
 #include "../Renderer/Resource.h"
 #include "../Renderer/Model.h"
+#include "../VectorMath/SegmentBVH.h"
 
 namespace LvEdEngine
 {
@@ -39,9 +40,10 @@ enum InterpolationType
 
         void AddPoint(ControlPointGob* point, int index);
         void RemovePoint(ControlPointGob* point);
-        virtual void InvalidateWorld();
 
     protected:
+        // rebuild m_segments if the points or the world transform changed.
+        void UpdateSegments();
 
         bool m_needsRebuild;
         bool m_closed;
@@ -52,6 +54,11 @@ enum InterpolationType
         std::vector<ControlPointGob*> m_points;       
         Mesh m_mesh;
 
+        // m_mesh.pos in world space, used for picking.
+        SegmentBVH m_segments;
+        Matrix m_segmentsWorld;
+        bool m_segmentsDirty;
+
     private:
         typedef GameObject super;
     };
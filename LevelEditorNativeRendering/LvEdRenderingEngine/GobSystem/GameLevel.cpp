@@ -1,8 +1,139 @@
 //Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
 
 #include "GameLevel.h"
+#include <algorithm>
+#include "../Core/WorkerPool.h"
+#include "../Renderer/Lights.h"
 
 namespace LvEdEngine
 {
+    // number of candidates collected by a single job,
+    // smaller candidate lists are collected on the calling thread.
+    static const uint32_t CollectChunkSize = 256;
 
-}
\ No newline at end of file
+    // collects the objects found by spatial tree queries.
+    class CandidateCollector
+    {
+    public:
+        CandidateCollector(std::vector<GameObject*>* candidates) : m_candidates(candidates) {}
+        void operator()(uint64_t userData, float* /*maxDist*/)
+        {
+            m_candidates->push_back(reinterpret_cast<GameObject*>(userData));
+        }
+        void operator()(uint64_t userData)
+        {
+            m_candidates->push_back(reinterpret_cast<GameObject*>(userData));
+        }
+    private:
+        std::vector<GameObject*>* m_candidates;
+    };
+
+    // ----------------------------------------------------------------------------------
+    // collects the renderables of a chunk of the candidates into the collector of the chunk.
+    // the objects build their render packets and relight in Update(), GetOwnRenderables()
+    // only reads them, except the camera facing matrix of the billboards which is written
+    // to the packet of the billboard itself. so the chunks can run on any thread.
+    // LightingState asserts that nothing relights or changes the lights meanwhile.
+    class GameLevel::CollectJob : public ParallelJob
+    {
+    public:
+        CollectJob(GameLevel* level, RenderableNodeCollector* collector, RenderContext* context)
+            : m_level(level), m_collector(collector), m_context(context)
+        {
+        }
+
+        virtual void Execute(uint32_t index)
+        {
+            uint32_t first = index * CollectChunkSize;
+            uint32_t end = std::min(first + CollectChunkSize, (uint32_t)m_level->m_candidates.size());
+            m_level->AddCandidateRenderables(first, end, m_collector->GetParallelCollector(index), m_context);
+        }
+
+    private:
+        GameLevel* m_level;
+        RenderableNodeCollector* m_collector;
+        RenderContext* m_context;
+    };
+
+    // ----------------------------------------------------------------------------------
+    GameLevel::~GameLevel()
+    {
+        // the children need to be removed from m_objectTree
+        // before it is destroyed.
+        for(auto it = m_children.begin(); it != m_children.end(); ++it)
+        {
+            delete (*it);
+        }
+        m_children.clear();
+    }
+
+    // ----------------------------------------------------------------------------------
+    //virtual
+    void GameLevel::GetRenderables(RenderableNodeCollector* collector, RenderContext* context)
+    {
+        GetRenderables(context->Cam().GetFrustum(), collector, context);
+    }
+
+    // ----------------------------------------------------------------------------------
+    void GameLevel::GetRenderables(const Ray& ray, RenderableNodeCollector* collector, RenderContext* context)
+    {
+        m_candidates.clear();
+        CandidateCollector candidates(&m_candidates);
+        float maxDist = FLT_MAX;
+        m_objectTree.RayQuery(ray, &maxDist, candidates);
+        AddCandidateRenderables(collector, context);
+    }
+
+    // ----------------------------------------------------------------------------------
+    void GameLevel::GetRenderables(const Frustum& frustum, RenderableNodeCollector* collector, RenderContext* context)
+    {
+        m_candidates.clear();
+        CandidateCollector candidates(&m_candidates);
+        m_objectTree.FrustumQuery(frustum, candidates);
+        AddCandidateRenderables(collector, context);
+    }
+
+    // ----------------------------------------------------------------------------------
+    void GameLevel::AddCandidateRenderables(RenderableNodeCollector* collector, RenderContext* context)
+    {
+        LightingState::Inst()->BeginReadOnly();
+        GetOwnRenderables(collector, context);
+
+        uint32_t count = (uint32_t)m_candidates.size();
+        uint32_t chunkCount = (count + CollectChunkSize - 1) / CollectChunkSize;
+        if(chunkCount > 1 && WorkerPool::Inst() && collector->BeginParallel(chunkCount))
+        {
+            CollectJob job(this, collector, context);
+            WorkerPool::Inst()->ParallelFor(&job, chunkCount);
+            collector->EndParallel();
+        }
+        else
+        {
+            AddCandidateRenderables(0, count, collector, context);
+        }
+        LightingState::Inst()->EndReadOnly();
+    }
+
+    // ----------------------------------------------------------------------------------
+    void GameLevel::AddCandidateRenderables(uint32_t first, uint32_t end, RenderableNodeCollector* collector, RenderContext* context)
+    {
+        for(auto it = m_candidates.begin() + first; it != m_candidates.begin() + end; ++it)
+        {
+            // GetRenderables() skips the children of hidden and culled groups.
+            // The bounds of a group contain the bounds of its visible children,
+            // so the ancestors of an object that passes its own frustum test
+            // in GetOwnRenderables() pass it too, only their visibility flag is checked.
+            GameObject* gob = (*it);
+            bool visible = true;
+            for(GameObject* parent = gob->Parent(); parent != NULL && visible; parent = parent->Parent())
+            {
+                visible = parent->IsVisible();
+            }
+
+            if(visible)
+            {
+                gob->GetOwnRenderables(collector, context);
+            }
+        }
+    }
+}
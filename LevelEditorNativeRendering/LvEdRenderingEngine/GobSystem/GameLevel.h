@@ -3,6 +3,7 @@
 #pragma once
 #include "GameObjectGroup.h"
 #include "../Renderer/RenderUtil.h"
+#include "../VectorMath/DynamicAABBTree.h"
 
 namespace LvEdEngine
 {
@@ -14,6 +15,7 @@ class GameLevel : public GameObjectGroup
 	public:   
 
         GameLevel(): m_activeskyeDome(NULL) {}
+        virtual ~GameLevel();
         virtual const char* ClassName() const {return StaticClassName();}
         static const char* StaticClassName(){return "GameLevel";}
                
@@ -26,8 +28,32 @@ class GameLevel : public GameObjectGroup
         void SetFogDensity(float density) { m_fog.density = density;  }       
 
         const ExpFog& GetFog() const {return m_fog;}
+
+        // all the objects of the level are indexed by this tree.
+        virtual DynamicAABBTree* GetChildSpatialTree() { return &m_objectTree; }
+
+        // push the renderables of the objects whose bounds intersect the camera frustum.
+        // the tree rejects and accepts whole subtrees, so the cost depends
+        // on the number of visible objects rather than on the size of the level.
+        virtual void GetRenderables(RenderableNodeCollector* collector, RenderContext* context);
+
+        // push the renderables of the objects whose bounds are hit by the ray.
+        // gives the same renderables as GetRenderables() minus the ones that can't be hit.
+        void GetRenderables(const Ray& ray, RenderableNodeCollector* collector, RenderContext* context);
+
+        // push the renderables of the objects whose bounds intersect the frustum.
+        void GetRenderables(const Frustum& frustum, RenderableNodeCollector* collector, RenderContext* context);
+
     private:
+        // collects the candidates in chunks, on the worker threads
+        // when the collector supports it.
+        class CollectJob;
+        void AddCandidateRenderables(RenderableNodeCollector* collector, RenderContext* context);
+        void AddCandidateRenderables(uint32_t first, uint32_t end, RenderableNodeCollector* collector, RenderContext* context);
+
         ExpFog m_fog;     
+        DynamicAABBTree m_objectTree;
+        std::vector<GameObject*> m_candidates;
     private:
         typedef GameObjectGroup super;
 
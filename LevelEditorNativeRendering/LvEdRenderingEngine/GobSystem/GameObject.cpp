@@ -3,6 +3,7 @@
 #include <D3D11.h>
 #include "GameObject.h"
 #include "GameObjectComponent.h"
+#include "../VectorMath/DynamicAABBTree.h"
 #include <algorithm>
 
 namespace LvEdEngine
@@ -12,9 +13,16 @@ namespace LvEdEngine
     GameObject::GameObject()
     {
         m_parent = NULL;
-        m_visible = true;
         m_castsShadows = true;
         m_receivesShadows = true;
+        m_spatialTree = NULL;
+        m_proxyId = DynamicAABBTree::NullNode;
+        m_transform = TransformStore::Inst()->Create();
+        m_worldStamp = 0;
+        m_boundsDirty = true;
+        m_inParentBounds = false;
+        m_indexInParent = NullIndex;
+        m_refitIndex = NullIndex;
 
         m_localBounds = AABB(float3(-0.5f,-0.5f,-0.5f), float3(0.5f,0.5f,0.5f));
         m_bounds = m_localBounds;
@@ -24,11 +32,16 @@ namespace LvEdEngine
     //virtual
     GameObject::~GameObject()
     {
+         SetSpatialTree(NULL);
          for(auto it = m_components.begin(); it != m_components.end(); it++)
          {
              delete (*it);
          }
          m_components.clear();
+
+         // the store is destroyed after the level on shutdown.
+         if(TransformStore::Inst())
+             TransformStore::Inst()->Destroy(m_transform);
     }
 
     // ----------------------------------------------------------------------------------
@@ -49,15 +62,14 @@ namespace LvEdEngine
     // ----------------------------------------------------------------------------------
     void GameObject::SetTransform(const Matrix& xform)
     {
-        m_local = xform;
+        TransformStore::Inst()->SetLocal(m_transform, xform);
         InvalidateWorld();
-        InvalidateBounds();
     }
 
     // ----------------------------------------------------------------------------------
     const Matrix& GameObject::GetTransform() const
     {
-        return m_local;
+        return TransformStore::Inst()->GetLocal(m_transform);
     }
 
     // ----------------------------------------------------------------------------------
@@ -74,20 +86,21 @@ namespace LvEdEngine
 
     void GameObject::UpdateWorldTransform()
     {
-         // update world transform
-        if(m_worldDirty)
+        // world transforms are updated by TransformStore::UpdateWorld() before the level update,
+        // only the changes made since then, for example by components, are done here.
+        // the parent updated before this object, so only the node itself is checked.
+        TransformStore* store = TransformStore::Inst();
+        if(store->IsStale(m_transform))
         {
-            if(m_parent)
-            {
-                m_world = m_local * m_parent->m_world;
-            }
-            else
-            {
-                m_world = m_local;
-            }
-            m_worldDirty = false;
+            store->UpdateNode(m_transform);
+        }
+
+        uint32_t stamp = store->GetStamp(m_transform);
+        if(stamp != m_worldStamp)
+        {
+            m_worldStamp = stamp;
             m_worldXformUpdated = true;
-        
+            m_boundsDirty = true;
         }
     }
 
@@ -97,12 +110,45 @@ namespace LvEdEngine
         if(m_boundsDirty)
         {            
             m_bounds = m_localBounds;
-            m_bounds.Transform(m_world);            
+            m_bounds.Transform(GetWorldTransform());            
             m_boundsDirty = false;
             m_worldBoundUpdated = true;
+            UpdateSpatialProxy();
         }
     }
 
+    // ----------------------------------------------------------------------------------
+    void GameObject::UpdateSpatialProxy()
+    {
+        if(m_spatialTree == NULL)
+            return;
+
+        if(m_proxyId == DynamicAABBTree::NullNode)
+        {
+            m_proxyId = m_spatialTree->CreateProxy(GetSpatialBounds(), (uint64_t)this);
+        }
+        else
+        {
+            m_spatialTree->MoveProxy(m_proxyId, GetSpatialBounds());
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    //virtual
+    void GameObject::SetSpatialTree(DynamicAABBTree* tree)
+    {
+        if(m_spatialTree == tree)
+            return;
+
+        if(m_spatialTree && m_proxyId != DynamicAABBTree::NullNode)
+        {
+            m_spatialTree->DestroyProxy(m_proxyId);
+        }
+        m_proxyId = DynamicAABBTree::NullNode;
+        m_spatialTree = tree;
+        UpdateSpatialProxy();
+    }
+
     void GameObject::Update(const FrameTime& fr, UpdateTypeEnum updateType)
     {        
         m_worldXformUpdated = false;
@@ -118,42 +164,36 @@ namespace LvEdEngine
     
 
     // ----------------------------------------------------------------------------------
+    // only the parent is told, groups forward the change to their own parent
+    // when their bounds are refit and did change, see GameObjectGroup::Update().
     void GameObject::InvalidateBounds()
     {
         m_boundsDirty = true;
-        if(m_parent)
-        {
-            m_parent->InvalidateBounds();
-        }
+        InvalidateParentBounds();
     }
 
     // ----------------------------------------------------------------------------------
+    // the world transforms of the children are invalidated by the store.
     void GameObject::InvalidateWorld()
     {
-        m_worldDirty = true;
+        TransformStore::Inst()->Invalidate(m_transform);
         InvalidateBounds();
     }
 
     // ----------------------------------------------------------------------------------
     void GameObject::SetParent(GameObject* parent)
     {
-        InvalidateBounds(); // mark 'old' ancestors as dirty.
+        // the old parent removes the bounds of this object itself.
         m_parent = parent;
-        InvalidateBounds(); // mark 'new' ancestors as dirty.
-        InvalidateWorld();  // mark world as dirty.
-    }
-
-    // ----------------------------------------------------------------------------------
-    bool GameObject::IsVisible() const
-    {
-        return m_visible;
+        TransformStore::Inst()->SetParent(m_transform, parent ? parent->m_transform : TransformStore::NullHandle);
+        InvalidateWorld();  // mark world and the bounds of the new parent as dirty.
     }
 
     // ----------------------------------------------------------------------------------
     bool GameObject::IsVisible(const Frustum& frustum) const
     {
-        bool visible = m_visible;
-        if(m_visible)
+        bool visible = IsVisible();
+        if(visible)
         {
             visible = TestFrustumAABB(frustum, m_bounds);
         }
@@ -164,8 +204,8 @@ namespace LvEdEngine
     // ----------------------------------------------------------------------------------
     void GameObject::SetVisible(bool visible)
     {
-        InvalidateBounds(); // mark 'old' ancestors as dirty.
-        m_visible = visible;
+        ObjectTable::Inst()->SetHidden(GetInstanceId(), !visible);
+        InvalidateBounds(); // the parent bounds only include the visible children.
     }
 
    
@@ -186,10 +226,9 @@ namespace LvEdEngine
     {
         r->objectId = GetInstanceId();
         r->bounds = m_bounds;
-        r->WorldXform = m_world;
+        r->WorldXform = GetWorldTransform();
         r->SetFlag( RenderableNode::kShadowCaster, GetCastsShadows() );
         r->SetFlag( RenderableNode::kShadowReceiver, GetReceivesShadows() );
-        LightingState::Inst()->UpdateLightEnvironment( *r );
     }
 
 
@@ -227,13 +266,13 @@ namespace LvEdEngine
     // -----------------------------------------------------------------------------------------------
     GameObjectReference::GameObjectReference()
     {
-        m_target = NULL;
+        m_targetId = 0;
     }
 
     // -----------------------------------------------------------------------------------------------
     GameObjectReference::GameObjectReference(GameObject* r)
     {
-        m_target = r;
+        m_targetId = r ? r->GetInstanceId() : 0;
     }
 
     // -----------------------------------------------------------------------------------------------
@@ -244,12 +283,12 @@ namespace LvEdEngine
     // -----------------------------------------------------------------------------------------------
     GameObject * GameObjectReference::GetTarget()
     {
-        return m_target;
+        return ObjectTable::Inst()->GetAs<GameObject>(m_targetId);
     }
 
     // -----------------------------------------------------------------------------------------------
     void GameObjectReference::SetTarget(GameObject* r, int /*size*/)
     {
-        m_target = r;
+        m_targetId = r ? r->GetInstanceId() : 0;
     }
 }
@@ -3,6 +3,8 @@
 #pragma once
 #include <string>
 #include "../Core/Object.h"
+#include "../Core/ObjectPool.h"
+#include "../Core/ObjectTable.h"
 #include "../VectorMath/V3dMath.h"
 #include "../VectorMath/CollisionPrimitives.h"
 #include "../Renderer/Renderable.h"
@@ -10,12 +12,14 @@
 #include "../Renderer/RenderState.h"
 #include "../Renderer/RenderableNodeSorter.h"
 #include "../FrameTime.h"
+#include "TransformStore.h"
 
 
 namespace LvEdEngine
 {
     
     class GameObjectComponent;
+    class DynamicAABBTree;
     class QueryFunctor
     {
     public:
@@ -28,6 +32,10 @@ class GameObject : public Object
         virtual const char* ClassName() const {return StaticClassName();}
         static const char* StaticClassName(){return "GameObject";}
 
+        // allocated from the object pools, see ObjectPool.
+        static void* operator new(size_t size) { return ObjectPool::AllocateObject(size); }
+        static void operator delete(void* p, size_t size) { ObjectPool::FreeObject(p, size); }
+
         GameObject();
         virtual ~GameObject();
 
@@ -35,13 +43,14 @@ class GameObject : public Object
         const wchar_t* const GetName() const;
 		void SetTransform(const Matrix& xform);
 		const Matrix& GetTransform() const;        
-        const Matrix& GetWorldTransform() const  { return m_world; }
+        const Matrix& GetWorldTransform() const  { return TransformStore::Inst()->GetWorld(m_transform); }
         const AABB& GetBounds() const;
         const AABB& GetLocalBounds() const;
-        bool IsVisible() const;
+        // the hidden flag is kept in the ObjectTable.
+        bool IsVisible() const { return !ObjectTable::Inst()->IsHidden(GetInstanceId()); }
         bool IsVisible(const Frustum& frustum) const;
         void SetVisible(bool visible);
-        bool GetVisible(){return m_visible;}
+        bool GetVisible(){return IsVisible();}
         bool GetCastsShadows(){return m_castsShadows;}
         void SetCastsShadows(bool castsShadows){m_castsShadows = castsShadows;}
         bool GetReceivesShadows(){return m_receivesShadows;}
@@ -55,6 +64,17 @@ class GameObject : public Object
         virtual void GetRenderables(RenderableNodeCollector* collector, RenderContext* context);
         virtual void SetupRenderable(RenderableNode* r, RenderContext* context);
 
+        // push the Renderable nodes of this object but not the ones of its children.
+        // used when objects are found through the spatial tree instead of the hierarchy.
+        virtual void GetOwnRenderables(RenderableNodeCollector* collector, RenderContext* context)
+        {
+            GetRenderables(collector, context);
+        }
+
+        // set the tree used to index the world bounds of this object.
+        // a proxy is kept in the tree until the object is removed from it.
+        virtual void SetSpatialTree(DynamicAABBTree* tree);
+
 
         void UpdateWorldTransform();
         void UpdateWorldAABB();
@@ -62,18 +82,34 @@ class GameObject : public Object
         virtual void InvalidateBounds();
         virtual void InvalidateWorld();
 
+        // called when the bounds of the child, or its transform or visibility, changed.
+        // The default recomputes the bounds of this object.
+        virtual void OnChildBoundsChanged(GameObject* /*child*/) { InvalidateBounds(); }
+
         void SetParent(GameObject* parent);
         virtual void Query(QueryFunctor& func) { func(this);}
     protected:
+        // tell the parent that the bounds of this object in parent space may have changed.
+        void InvalidateParentBounds()
+        {
+            if(m_parent) m_parent->OnChildBoundsChanged(this);
+        }
+
+        // bounds stored in the spatial tree, must contain the bounds
+        // of all the Renderable nodes of this object.
+        virtual AABB GetSpatialBounds() const { return m_bounds; }
+
+        // update the proxy of this object in the spatial tree.
+        // called whenever m_bounds is recomputed.
+        void UpdateSpatialProxy();
 
         GameObject * m_parent;
-		Matrix m_local;		
-		Matrix m_world;
+        TransformHandle m_transform; // local and world matrices, stored in TransformStore.
+        uint32_t m_worldStamp;       // stamp of the world matrix used by the last Update().
         AABB m_bounds;  // AABB in world space.
         AABB m_localBounds; // AABB in local space.
         std::wstring m_name;
         bool m_boundsDirty;
-        bool m_worldDirty;
 
         // temp solution.
         bool m_worldXformUpdated;
@@ -81,8 +117,18 @@ class GameObject : public Object
 
 		std::vector<GameObjectComponent*> m_components;
 
+        DynamicAABBTree* m_spatialTree;
+        int32_t m_proxyId;
+
+        // child list and bounds refit state, owned by the parent group.
+        friend class GameObjectGroup;
+        static const uint32_t NullIndex = 0xffffffff;
+        uint32_t m_indexInParent; // index in the child list of the parent group, NullIndex if not in a group.
+        uint32_t m_refitIndex;    // index in the refit queue of the parent, NullIndex if not queued.
+        AABB m_parentSpaceBounds; // local bounds transformed by the local transform, as last merged by the parent.
+        bool m_inParentBounds;    // m_parentSpaceBounds is part of the parent bounds.
+
     private:
-        bool m_visible;
         bool m_castsShadows;
         bool m_receivesShadows;
         
@@ -96,14 +142,18 @@ class GameObjectReference : public Object
     public:
         virtual const char* ClassName() const {return StaticClassName();}
         static const char* StaticClassName(){return "GameObjectReference";}
+        // allocated from the object pools, see ObjectPool.
+        static void* operator new(size_t size) { return ObjectPool::AllocateObject(size); }
+        static void operator delete(void* p, size_t size) { ObjectPool::FreeObject(p, size); }
         GameObjectReference();
         GameObjectReference(GameObject* r);
         ~GameObjectReference();
+        // NULL once the target is destroyed.
         GameObject * GetTarget();
         void SetTarget(GameObject* r, int size=0);
 
     protected:
-        GameObject* m_target;
+        ObjectGUID m_targetId;
     };
 
 }
@@ -3,6 +3,7 @@
 #pragma once
 #include <string>
 #include "../Core/Object.h"
+#include "../Core/ObjectPool.h"
 #include "../VectorMath/V3dMath.h"
 #include "../FrameTime.h"
 
@@ -17,6 +18,9 @@ class GameObjectComponent : public Object
     public:
         virtual const char* ClassName() const {return StaticClassName();}
         static const char* StaticClassName(){return "GameObjectComponent";}
+        // allocated from the object pools, see ObjectPool.
+        static void* operator new(size_t size) { return ObjectPool::AllocateObject(size); }
+        static void operator delete(void* p, size_t size) { ObjectPool::FreeObject(p, size); }
 
 		
 		virtual void Update(const FrameTime& fr, UpdateTypeEnum updateType) {}
@@ -2,13 +2,32 @@
 
 #include "GameObjectGroup.h"
 #include <algorithm>
+#include <assert.h>
 #include "../Renderer/LineRenderer.h"
 
 namespace LvEdEngine
 {
+    // bounds refit counters, see Debug_GetBoundsStats().
+    static uint32_t s_refitQueued = 0;
+    static uint32_t s_refitMerged = 0;
+    static uint32_t s_refitPropagated = 0;
+
+    static bool SameBounds(const AABB& a, const AABB& b)
+    {
+        return a.Min() == b.Min() && a.Max() == b.Max();
+    }
+
+    // true if removing box from bounds could make bounds smaller.
+    static bool TouchesBounds(const AABB& box, const AABB& bounds)
+    {
+        return box.Min().x <= bounds.Min().x || box.Min().y <= bounds.Min().y || box.Min().z <= bounds.Min().z
+            || box.Max().x >= bounds.Max().x || box.Max().y >= bounds.Max().y || box.Max().z >= bounds.Max().z;
+    }
 
     GameObjectGroup::GameObjectGroup()
     {
+        m_remergeChildBounds = false;
+        m_firstHole = GameObject::NullIndex;
     }
     
     //virtual 
@@ -31,7 +50,8 @@ namespace LvEdEngine
 
           for(auto it = m_children.begin(); it != m_children.end(); ++it)
           {
-              (*it)->GetRenderables(collector,context);
+              if(*it)
+                  (*it)->GetRenderables(collector,context);
           }
 
          // draw a line from the center of this group to the center of each child.
@@ -45,19 +65,35 @@ namespace LvEdEngine
          
     }
 
+    //virtual 
+    void GameObjectGroup::GetOwnRenderables(RenderableNodeCollector* collector, RenderContext* context)
+    {
+        if (!IsVisible(context->Cam().GetFrustum()))
+            return;
+
+        super::GetRenderables(collector, context);
+    }
+
+    //virtual 
+    void GameObjectGroup::SetSpatialTree(DynamicAABBTree* tree)
+    {
+        super::SetSpatialTree(tree);
+        DynamicAABBTree* childTree = GetChildSpatialTree();
+        for(auto it = m_children.begin(); it != m_children.end(); ++it)
+        {
+            if(*it)
+                (*it)->SetSpatialTree(childTree);
+        }
+    }
+
     void GameObjectGroup::AddChild(GameObject* child, int index)
     {
         if(child)
         {
-            child->SetParent(this);
-            if(index == -1)
-            {
-                m_children.push_back(child);
-            }
-            else
-            {
-                m_children.insert(m_children.begin() + index, child);
-            }
+            // the index is an index of the editor list, which has no holes.
+            CompactChildren();
+            AttachChild(child);
+            MoveChildrenTo((uint32_t)m_children.size() - 1, index);
         }
     }
 
@@ -65,29 +101,92 @@ namespace LvEdEngine
     {
         if(child)
         {
-            child->SetParent(NULL);
-            auto it = std::find(m_children.begin(), m_children.end(), child);
-            m_children.erase(it);
+            bool inBounds = DetachChild(child);
+            if(inBounds)
+            {
+                m_remergeChildBounds = true;
+                InvalidateBounds();
+            }
         }
     }
-   
+
     // ----------------------------------------------------------------------------------
-    void GameObjectGroup::InvalidateWorld()
+    void GameObjectGroup::AttachChild(GameObject* child)
     {
-        // if the groups world is dirty, so are all the children's
-        m_worldDirty = true;
-        for( auto it = m_children.begin(); it != m_children.end(); ++it)
+        assert(child->m_parent == NULL && !IsGroupChild(child));
+        assert(m_firstHole == GameObject::NullIndex);
+        child->m_indexInParent = (uint32_t)m_children.size();
+        m_children.push_back(child);
+        child->SetParent(this); // queues the child for the bounds refit.
+        child->SetSpatialTree(GetChildSpatialTree());
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool GameObjectGroup::DetachChild(GameObject* child)
+    {
+        assert(child->m_parent == this && m_children[child->m_indexInParent] == child);
+        child->SetParent(NULL);
+        child->SetSpatialTree(NULL);
+
+        // the order of the refit queue doesn't matter, the child is swap removed from it.
+        uint32_t index = child->m_indexInParent;
+        m_children[index] = NULL;
+        if(index < m_firstHole)
+            m_firstHole = index;
+        child->m_indexInParent = GameObject::NullIndex;
+
+        if(child->m_refitIndex != GameObject::NullIndex)
         {
-            (*it)->InvalidateWorld();
+            index = child->m_refitIndex;
+            m_refitQueue[index] = m_refitQueue.back();
+            m_refitQueue[index]->m_refitIndex = index;
+            m_refitQueue.pop_back();
+            child->m_refitIndex = GameObject::NullIndex;
         }
+
+        bool inBounds = child->m_inParentBounds;
+        child->m_inParentBounds = false;
+        return inBounds;
     }
 
+    // ----------------------------------------------------------------------------------
+    void GameObjectGroup::MoveChildrenTo(uint32_t first, int index)
+    {
+        uint32_t count = (uint32_t)m_children.size();
+        if(index < 0 || (uint32_t)index >= first)
+            return; // already at the end.
+        std::rotate(m_children.begin() + index, m_children.begin() + first, m_children.end());
+        for(uint32_t i = (uint32_t)index; i < count; i++)
+        {
+            m_children[i]->m_indexInParent = i;
+        }
+    }
 
+    // ----------------------------------------------------------------------------------
+    void GameObjectGroup::CompactChildren()
+    {
+        if(m_firstHole == GameObject::NullIndex)
+            return;
+        uint32_t count = (uint32_t)m_children.size();
+        uint32_t dst = m_firstHole;
+        for(uint32_t i = m_firstHole; i < count; i++)
+        {
+            GameObject* child = m_children[i];
+            if(child == NULL)
+                continue;
+            child->m_indexInParent = dst;
+            m_children[dst++] = child;
+        }
+        m_children.resize(dst);
+        m_firstHole = GameObject::NullIndex;
+    }
+   
     void GameObjectGroup::Update(const FrameTime& fr, UpdateTypeEnum updateType)
     {
         bool boundDirty = m_boundsDirty;
         super::Update(fr,updateType);
-        m_boundsDirty = boundDirty;
+        m_boundsDirty = boundDirty || m_worldXformUpdated;
+        CompactChildren();
         for( auto it = m_children.begin(); it != m_children.end(); ++it)
         {
             (*it)->Update(fr,updateType);
@@ -97,23 +196,97 @@ namespace LvEdEngine
         // Update bounds
         if(m_boundsDirty)
         {            
-            bool usechildbounds = false;
-            AABB childbounds; // default ctor will set initial value of min and max.
-            // merge bounds for the the visibile children.
-            for (auto it = m_children.begin(); it != m_children.end(); ++it)
+            if(RefitChildBounds())
             {
-                if( (*it)->IsVisible())
-                {                    
-                    AABB local = (*it)->GetLocalBounds();
-                    local.Transform((*it)->GetTransform());
-                    childbounds.Extend( local );
-                    usechildbounds = true;
-                }
+                // the parent is updating its children, it refits this group after the loop.
+                InvalidateParentBounds();
+                s_refitPropagated++;
             }
-                 
-            // set local bounds 
-            m_localBounds = usechildbounds ? childbounds : AABB(float3(-0.5f,-0.5f,-0.5f), float3(0.5f,0.5f,0.5f));
             UpdateWorldAABB();                      
         }
     }
+
+    // ----------------------------------------------------------------------------------
+    void GameObjectGroup::OnChildBoundsChanged(GameObject* child)
+    {
+        if(child->m_refitIndex == GameObject::NullIndex)
+        {
+            child->m_refitIndex = (uint32_t)m_refitQueue.size();
+            m_refitQueue.push_back(child);
+        }
+        m_boundsDirty = true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool GameObjectGroup::RefitChildBounds()
+    {
+        // growing children extend the current bounds, a full re-merge of the cached
+        // child bounds is only needed when a child that touches the bounds shrank.
+        bool remerge = m_remergeChildBounds;
+        AABB childbounds = m_childBounds;
+        for(auto it = m_refitQueue.begin(); it != m_refitQueue.end(); ++it)
+        {
+            GameObject* child = (*it);
+            child->m_refitIndex = GameObject::NullIndex;
+
+            AABB bounds;
+            bool visible = child->IsVisible();
+            if(visible)
+            {
+                bounds = child->GetLocalBounds();
+                bounds.Transform(child->GetTransform());
+            }
+
+            if(child->m_inParentBounds && (!visible || !SameBounds(bounds, child->m_parentSpaceBounds))
+                && TouchesBounds(child->m_parentSpaceBounds, m_childBounds))
+            {
+                remerge = true;
+            }
+            if(visible)
+            {
+                childbounds.Extend(bounds);
+            }
+            child->m_parentSpaceBounds = bounds;
+            child->m_inParentBounds = visible;
+        }
+        s_refitQueued += (uint32_t)m_refitQueue.size();
+        m_refitQueue.clear();
+
+        if(remerge)
+        {
+            childbounds = AABB();
+            for(auto it = m_children.begin(); it != m_children.end(); ++it)
+            {
+                if((*it)->m_inParentBounds)
+                    childbounds.Extend((*it)->m_parentSpaceBounds);
+            }
+            s_refitMerged += (uint32_t)m_children.size();
+            m_remergeChildBounds = false;
+        }
+        m_childBounds = childbounds;
+
+        bool usechildbounds = childbounds.Min().x <= childbounds.Max().x;
+        AABB localBounds = usechildbounds ? childbounds : AABB(float3(-0.5f,-0.5f,-0.5f), float3(0.5f,0.5f,0.5f));
+        bool changed = !SameBounds(localBounds, m_localBounds);
+        m_localBounds = localBounds;
+        return changed;
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void GameObjectGroup::Debug_GetBoundsStats(uint32_t& queued, uint32_t& merged, uint32_t& propagated)
+    {
+        queued = s_refitQueued;
+        merged = s_refitMerged;
+        propagated = s_refitPropagated;
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void GameObjectGroup::Debug_ResetBoundsStats()
+    {
+        s_refitQueued = 0;
+        s_refitMerged = 0;
+        s_refitPropagated = 0;
+    }
 };
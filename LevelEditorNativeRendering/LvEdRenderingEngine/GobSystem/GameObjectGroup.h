@@ -15,24 +15,66 @@ class GameObjectGroup : public GameObject
         static const char* StaticClassName(){return "GameObjectGroup";}
 
         virtual void GetRenderables(RenderableNodeCollector* collector, RenderContext* context);
+        virtual void GetOwnRenderables(RenderableNodeCollector* collector, RenderContext* context);
+        virtual void SetSpatialTree(DynamicAABBTree* tree);
+
+        // the tree the children of this group are added to.
+        virtual DynamicAABBTree* GetChildSpatialTree() { return m_spatialTree; }
+
+        // the children are kept in the order of the editor, the child is
+        // inserted at index, or appended when index is -1.
         void AddChild(GameObject* child, int index);
+        // O(1), the slot of the child is cleared and the child list is compacted once
+        // by the next AddChild() or Update(), so removing many children stays linear.
         void RemoveChild(GameObject* child);
 
         virtual void Update(const FrameTime& fr, UpdateTypeEnum updateType);        
-        virtual void InvalidateWorld();
+
+        // queue the child, its bounds are merged in the bounds of this group on the next Update().
+        virtual void OnChildBoundsChanged(GameObject* child);
+
+        // bounds refit counters since the last reset, the refit of one edited child
+        // touches the child and the groups whose bounds actually changed.
+        // queued: children whose bounds were recomputed.
+        // merged: children merged by full re-merges, when a child shrank or was removed.
+        // propagated: groups whose bounds changed and were queued in their parent.
+        static void Debug_GetBoundsStats(uint32_t& queued, uint32_t& merged, uint32_t& propagated);
+        static void Debug_ResetBoundsStats();
 
         virtual void Query(QueryFunctor& func)
         {
             if(func(this))
             {
                 for(auto iter = m_children.begin(); iter != m_children.end(); iter++)
-                    if(!func(*iter)) return;
+                    if(*iter && !func(*iter)) return;
             }
         }
 
     protected:
+        // the slots of the removed children are NULL until CompactChildren().
         std::vector<GameObject*> m_children;
     private:
+        // link or unlink the child, the bounds of this group are not invalidated.
+        // DetachChild() returns true if the bounds of the child were merged in the bounds of this group.
+        // it leaves a NULL slot in m_children, CompactChildren() removes them.
+        void AttachChild(GameObject* child);
+        bool DetachChild(GameObject* child);
+
+        // moves the children at [first, end) of m_children to index and renumbers them.
+        // they stay at the end when index is -1 or past first.
+        void MoveChildrenTo(uint32_t first, int index);
+        // removes the NULL slots left by DetachChild(), keeping the order of the children.
+        void CompactChildren();
+
+        // merge the queued children in m_childBounds and set m_localBounds.
+        // returns true if m_localBounds changed.
+        bool RefitChildBounds();
+
+        std::vector<GameObject*> m_refitQueue; // children whose bounds changed, no duplicates.
+        AABB m_childBounds;                    // union of the parent space bounds of the visible children.
+        bool m_remergeChildBounds;             // a child was removed, m_childBounds must be rebuilt.
+        uint32_t m_firstHole;                  // first NULL slot of m_children, NullIndex if none.
+
         typedef GameObject super;
     };
 }
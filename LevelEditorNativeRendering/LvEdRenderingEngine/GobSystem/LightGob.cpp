@@ -14,6 +14,7 @@ namespace LvEdEngine
     SetCastsShadows( false );       // doesn't block the light
     SetReceivesShadows( false );    // no shadow is cast on it        
     m_mesh = ShapeLibGetMesh( RenderShape::Quad); 
+    m_material.textures[TextureType::DIFFUSE] =  TextureLib::Inst()->GetByName(L"Light.png");
     m_localBounds = AABB(float3(-0.5f,-0.5f,-0.5f), float3(0.5f,0.5f,0.5f));
 }
 
@@ -34,14 +35,15 @@ namespace LvEdEngine
     RenderableNode renderable;
     GameObject::SetupRenderable(&renderable,context);
     renderable.mesh = m_mesh;
-    renderable.textures[TextureType::DIFFUSE] =  TextureLib::Inst()->GetByName(L"Light.png");
+    renderable.material = &m_material;
     
-    float3 objectPos = &m_world.M41;
+    float3 objectPos = &GetWorldTransform().M41;
     Camera& cam = context->Cam();    
     Matrix billboard = Matrix::CreateBillboard(objectPos,cam.CamPos(),cam.CamUp(),cam.CamLook());       
-    float sx = length( float3(&m_local.M11) );
-    float sy = length( float3(&m_local.M21) );
-    float sz = length( float3(&m_local.M31) );    
+    const Matrix& local = GetTransform();
+    float sx = length( float3(&local.M11) );
+    float sy = length( float3(&local.M21) );
+    float sz = length( float3(&local.M31) );    
     Matrix scale = Matrix::CreateScale(sx,sy,sz);
     renderable.WorldXform = scale * billboard;
     
@@ -15,6 +15,7 @@ class LightGob : public GameObject
 
     protected:        
         Mesh* m_mesh;
+        NodeMaterial m_material; // material of the light icon.
     private:
         typedef GameObject super;
     };
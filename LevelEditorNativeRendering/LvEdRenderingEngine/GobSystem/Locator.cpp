@@ -38,6 +38,7 @@ namespace LvEdEngine
     void Locator::BuildRenderables()
     {
         m_renderables.clear();
+        m_materials.clear();
         Model* model = NULL;
         assert(m_resource);
         model = (Model*)m_resource->GetTarget();
@@ -61,20 +62,30 @@ namespace LvEdEngine
                 renderNode.bounds.Transform(renderNode.WorldXform);
                 renderNode.objectId = GetInstanceId();
                 renderNode.diffuse =  mat->diffuse;
-                renderNode.specular = mat->specular.xyz();
-                renderNode.specPower = mat->power;
                 renderNode.SetFlag( RenderableNode::kShadowCaster, GetCastsShadows() );
                 renderNode.SetFlag( RenderableNode::kShadowReceiver, GetReceivesShadows() );
 
-                LightingState::Inst()->UpdateLightEnvironment(renderNode);
-
+                NodeMaterial material;
+                material.specular = mat->specular.xyz();
+                material.specPower = mat->power;
                 for(unsigned int i = TextureType::MIN; i < TextureType::MAX; ++i)
                 {
-                    renderNode.textures[i] = geo->material->textures[i];
+                    material.textures[i] = geo->material->textures[i];
                 }
+                m_materials.push_back(material);
                 m_renderables.push_back(renderNode);
             }
         }
+
+        // the lists are complete, point the nodes to their shared data.
+        m_lighting.resize(m_renderables.size());
+        for(size_t i = 0; i < m_renderables.size(); i++)
+        {
+            RenderableNode& renderNode = m_renderables[i];
+            renderNode.material = &m_materials[i];
+            renderNode.lighting = &m_lighting[i];
+            LightingState::Inst()->UpdateLightEnvironment(m_lighting[i], renderNode.bounds);
+        }
     }
 
 
@@ -108,7 +119,7 @@ namespace LvEdEngine
                  m_modelTransforms.resize(matrices.size());
                  for( unsigned int i = 0; i < m_modelTransforms.size(); ++i)
                  {
-                     m_modelTransforms[i] = matrices[i] * m_world; // transform matrix array now holds complete world transform.
+                     m_modelTransforms[i] = matrices[i] * GetWorldTransform(); // transform matrix array now holds complete world transform.
                  }
                  BuildRenderables(); 
 				 updatedBound = true;
@@ -122,7 +133,7 @@ namespace LvEdEngine
             {                
                // assert(model && model->IsReady());
                 m_localBounds = model->GetBounds();                                
-                if(m_parent) m_parent->InvalidateBounds();                
+                InvalidateParentBounds();                
             }
             else
             {
@@ -131,12 +142,14 @@ namespace LvEdEngine
             this->UpdateWorldAABB();            
         }
 
-        if(RenderContext::Inst()->LightEnvDirty)
+        LightingState* lightState = LightingState::Inst();
+        if(lightState->IsInvalid(m_bounds))
         {
-            // update light env.
-            for(auto  renderNode = m_renderables.begin(); renderNode != m_renderables.end(); renderNode++)
+            // update light env of the renderables touched by the light changes.
+            for(size_t i = 0; i < m_renderables.size(); i++)
             {
-                LightingState::Inst()->UpdateLightEnvironment(*renderNode);
+                if(lightState->IsInvalid(m_renderables[i].bounds))
+                    lightState->UpdateLightEnvironment(m_lighting[i], m_renderables[i].bounds);
             }
         }         
     }
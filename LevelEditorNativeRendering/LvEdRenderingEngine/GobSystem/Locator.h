@@ -31,6 +31,9 @@ class Locator : public GameObject
         ResourceReference* m_resource;
         std::vector<Matrix> m_modelTransforms;        
         RenderNodeList m_renderables;
+        // shared data of m_renderables, one entry per node.
+        std::vector<NodeMaterial> m_materials;
+        std::vector<LightEnvironment> m_lighting;
     private:
         typedef GameObject super;
     };
@@ -179,9 +179,9 @@ namespace LvEdEngine
         r.mesh = mesh;
         r.diffuse = float4(0.0f,0.3f,0,1);
         r.objectId = GetInstanceId();
-        r.WorldXform = m_world;
+        r.WorldXform = GetWorldTransform();
         r.bounds = m_bounds;
-        LightingState::Inst()->UpdateLightEnvironment(r);
+        r.lighting = &m_cubeLighting;
         collector->Add(r, flags, Shaders::TexturedShader);
     }
 }
@@ -190,6 +190,7 @@ namespace LvEdEngine
 void OrcGob::BuildRenderables()
 {
     m_renderables.clear();
+    m_materials.clear();
     Model* model = NULL;
     assert(m_geometry);
     model = (Model*)m_geometry->GetTarget();
@@ -215,29 +216,38 @@ namespace LvEdEngine
             renderNode.bounds.Transform(renderNode.WorldXform);
             renderNode.objectId = GetInstanceId();
             renderNode.diffuse =  mat->diffuse;
-            renderNode.specular = mat->specular.xyz();
-            renderNode.specPower = mat->power;
             renderNode.SetFlag( RenderableNode::kShadowCaster, GetCastsShadows() );
             renderNode.SetFlag( RenderableNode::kShadowReceiver, GetReceivesShadows() );
 
-            LightingState::Inst()->UpdateLightEnvironment(renderNode);
-
+            NodeMaterial material;
+            material.specular = mat->specular.xyz();
+            material.specPower = mat->power;
             for(unsigned int i = TextureType::MIN; i < TextureType::MAX; ++i)
             {
-                renderNode.textures[i] = geo->material->textures[i];
+                material.textures[i] = geo->material->textures[i];
             }
+            m_materials.push_back(material);
             m_renderables.push_back(renderNode);
         }
     }
+
+    // the lists are complete, point the nodes to their shared data.
+    m_lighting.resize(m_renderables.size());
+    for(size_t i = 0; i < m_renderables.size(); i++)
+    {
+        RenderableNode& renderNode = m_renderables[i];
+        renderNode.material = &m_materials[i];
+        renderNode.lighting = &m_lighting[i];
+        LightingState::Inst()->UpdateLightEnvironment(m_lighting[i], renderNode.bounds);
+    }
 }
 
 
 void OrcGob::Update(const FrameTime& fr, UpdateTypeEnum updateType)
 {
     bool boundDirty = m_boundsDirty;
-    bool udpateXforms = m_worldDirty;
     super::Update(fr,updateType);
-	udpateXforms |= m_worldXformUpdated;
+    bool udpateXforms = m_worldXformUpdated;
     Model* model = m_geometry ? (Model*)m_geometry->GetTarget() : NULL;                     
     if( model && model->IsReady())
     {
@@ -247,7 +257,7 @@ namespace LvEdEngine
              m_modelTransforms.resize(matrices.size());
              for( unsigned int i = 0; i < m_modelTransforms.size(); ++i)
              {
-                 m_modelTransforms[i] = matrices[i] * m_world; // transform matrix array now holds complete world transform.
+                 m_modelTransforms[i] = matrices[i] * GetWorldTransform(); // transform matrix array now holds complete world transform.
              }
 
              BuildRenderables();
@@ -262,7 +272,7 @@ namespace LvEdEngine
         {                
            // assert(model && model->IsReady());
             m_localBounds = model->GetBounds();                                
-            if(m_parent) m_parent->InvalidateBounds();                
+            InvalidateParentBounds();                
         }
         else
         {
@@ -271,12 +281,19 @@ namespace LvEdEngine
         this->UpdateWorldAABB();            
     }
 
-    if(RenderContext::Inst()->LightEnvDirty)
+    LightingState* lightState = LightingState::Inst();
+    if(m_renderables.empty() && (m_worldBoundUpdated || lightState->IsInvalid(m_bounds)))
+    {
+        // light env of the placeholder cube drawn until the model is ready.
+        lightState->UpdateLightEnvironment(m_cubeLighting, m_bounds);
+    }
+    else if(lightState->IsInvalid(m_bounds))
     {
-        // update light env.
-        for(auto  renderNode = m_renderables.begin(); renderNode != m_renderables.end(); renderNode++)
+        // update light env of the renderables touched by the light changes.
+        for(size_t i = 0; i < m_renderables.size(); i++)
         {
-            LightingState::Inst()->UpdateLightEnvironment(*renderNode);
+            if(lightState->IsInvalid(m_renderables[i].bounds))
+                lightState->UpdateLightEnvironment(m_lighting[i], m_renderables[i].bounds);
         }
     }       
 
@@ -48,6 +48,10 @@ class OrcGob : public GameObject
         ResourceReference* m_animation;
         GameObjectReference* m_target;
         RenderNodeList m_renderables;
+        // shared data of m_renderables, one entry per node.
+        std::vector<NodeMaterial> m_materials;
+        std::vector<LightEnvironment> m_lighting;
+        LightEnvironment m_cubeLighting; // lighting of the placeholder cube.
 
         std::vector<GameObjectReference*> m_friends;
         std::vector<OrcGob*> m_children;
@@ -25,21 +25,25 @@ namespace LvEdEngine
 void PointLightGob::SetAmbient(int color)
 {
     ConvertColor(color, &m_light->ambient);
+    LightingState::Inst()->InvalidatePointLight(m_light);
 }
 
 void PointLightGob::SetDiffuse(int color)
 {
     ConvertColor(color, &m_light->diffuse);
+    LightingState::Inst()->InvalidatePointLight(m_light);
 }
 
 void PointLightGob::SetSpecular(int color)
 {
     ConvertColor(color, &m_light->specular);
+    LightingState::Inst()->InvalidatePointLight(m_light);
 }
 
 void PointLightGob::SetAttenuation(const float3& atten)
 {
     m_light->attenuation = float4(atten.x,atten.y,atten.z,1);
+    LightingState::Inst()->InvalidatePointLight(m_light);
 }
 
 void PointLightGob::SetRange(float r)
@@ -53,7 +57,7 @@ namespace LvEdEngine
     bool boundDirty = m_boundsDirty;
     super::Update(fr,updateType);
     
-    m_boundsDirty = boundDirty;
+    m_boundsDirty = boundDirty || m_worldXformUpdated;
     if(m_boundsDirty)
     {
         m_localBounds = m_mesh->bounds;        
@@ -61,8 +65,9 @@ namespace LvEdEngine
     }
 
     float range = m_light->position.w;
-    float3 pos(&m_world.M41);
+    float3 pos(&GetWorldTransform().M41);
     m_light->position = float4(pos, range);  
+    LightingState::Inst()->UpdatePointLight(m_light);
 }
 
 };
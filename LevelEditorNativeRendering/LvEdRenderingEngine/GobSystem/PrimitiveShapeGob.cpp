@@ -11,22 +11,26 @@
 PrimitiveShapeGob::PrimitiveShapeGob( RenderShapeEnum shape )
 {
     m_mesh = ShapeLibGetMesh( shape );
+    m_primitive = ShapeLibGetPrimitive( shape );
     m_color = float4(1,1,1,1);
     m_emissive = float3(0,0,0);
     m_specular = float3(0,0,0);
     m_specPower = 1;
+    m_renderableDirty = true;
 }
 
 void PrimitiveShapeGob::SetDiffuse(wchar_t* filename)
 {
     Texture* def  = TextureLib::Inst()->GetDefault(TextureType::DIFFUSE);
     m_diffuse.SetTarget(filename, def);
+    m_renderableDirty = true;
 }        
 
 void PrimitiveShapeGob::SetNormal(wchar_t* filename)
 {
     Texture* def  = TextureLib::Inst()->GetDefault(TextureType::NORMAL);
     m_normal.SetTarget(filename,def);
+    m_renderableDirty = true;
 }
 
 //---------------------------------------------------------------------------
@@ -43,17 +47,19 @@
     {
 		super::GetRenderables(collector, context);
 
-        RenderableNode r;
-        SetupRenderable(&r, context);
-        
+        // the packet is built by Update(), an object that has not been updated yet is not drawn.
+        // collection only reads it, so it can run on several threads.
+        const RenderableNode& r = m_renderable;
+        if(r.mesh == NULL)
+            return;
+
         RenderFlagsEnum flags = (RenderFlagsEnum) (RenderFlags::Textured | RenderFlags::Lit);
-        if(r.diffuse.w < 0.996f)   
+        if(r.diffuse.w < 0.996f)
         {
-            r.SetFlag(RenderableNode::kShadowCaster,false);
             flags  = (RenderFlagsEnum)(flags | RenderFlags::AlphaBlend | RenderFlags::DisableDepthWrite);
         }
 
-        collector->Add( r, flags, Shaders::TexturedShader );        
+        collector->AddRetained( &m_renderable, flags, Shaders::TexturedShader );        
     }    
 }
 
@@ -68,20 +74,41 @@
         m_localBounds = m_mesh->bounds;        
         UpdateWorldAABB();
     }
+
+    RenderableNode& r = m_renderable;
+    if(m_renderableDirty || m_worldBoundUpdated || m_worldXformUpdated || LightingState::Inst()->IsInvalid(m_bounds))
+    {
+        SetupRenderable(&r, NULL);
+        m_renderableDirty = false;
+    }
+    else
+    {
+        // textures can finish loading, and shadow flags change, without invalidating the packet.
+        m_material.textures[TextureType::DIFFUSE] = (Texture*)m_diffuse.GetTarget();
+        m_material.textures[TextureType::NORMAL] = (Texture*)m_normal.GetTarget();
+        r.SetFlag( RenderableNode::kShadowReceiver, GetReceivesShadows() );
+    }
+    bool alphaBlend = r.diffuse.w < 0.996f;
+    r.SetFlag(RenderableNode::kShadowCaster, GetCastsShadows() && !alphaBlend);
 }
 
 //---------------------------------------------------------------------------
+// called by Update() with a NULL context.
 // virtual
 void PrimitiveShapeGob::SetupRenderable(RenderableNode* r, RenderContext* context)
 {
     GameObject::SetupRenderable(r, context);
     r->mesh = m_mesh;
+    r->primitive = m_primitive;
     r->diffuse = m_color;  
-    r->specPower = m_specPower;
-    r->emissive = m_emissive;
-    r->specular = m_specular;
-    r->TextureXForm = m_textureTransform;
-    r->textures[TextureType::DIFFUSE] = (Texture*)m_diffuse.GetTarget();
-    r->textures[TextureType::NORMAL] = (Texture*)m_normal.GetTarget();
+    m_material.specPower = m_specPower;
+    m_material.emissive = m_emissive;
+    m_material.specular = m_specular;
+    m_material.TextureXForm = m_textureTransform;
+    m_material.textures[TextureType::DIFFUSE] = (Texture*)m_diffuse.GetTarget();
+    m_material.textures[TextureType::NORMAL] = (Texture*)m_normal.GetTarget();
+    r->material = &m_material;
+    LightingState::Inst()->UpdateLightEnvironment(m_lighting, r->bounds);
+    r->lighting = &m_lighting;
 }
 
@@ -18,14 +18,14 @@ class PrimitiveShapeGob : public GameObject
         PrimitiveShapeGob( RenderShapeEnum shape );
         virtual ~PrimitiveShapeGob();
 
-        void SetColor(int color) { ConvertColor(color, &m_color); }
-        void SetEmissive(int color) { ConvertColor(color, &m_emissive); }
-        void SetSpecular(int color) { ConvertColor(color, &m_specular); }
-        void SetSpecularPower(float specPower) { m_specPower = specPower; }
+        void SetColor(int color) { ConvertColor(color, &m_color); m_renderableDirty = true; }
+        void SetEmissive(int color) { ConvertColor(color, &m_emissive); m_renderableDirty = true; }
+        void SetSpecular(int color) { ConvertColor(color, &m_specular); m_renderableDirty = true; }
+        void SetSpecularPower(float specPower) { m_specPower = specPower; m_renderableDirty = true; }
 
         void SetDiffuse(wchar_t* filename);
         void SetNormal(wchar_t* filename);
-        void SetTextureTransform(const Matrix& xform){m_textureTransform = xform;}
+        void SetTextureTransform(const Matrix& xform){m_textureTransform = xform; m_renderableDirty = true;}
 
         virtual void Update(const FrameTime& fr, UpdateTypeEnum updateType);
       
@@ -42,6 +42,14 @@ class PrimitiveShapeGob : public GameObject
         ResourceReference m_normal;
         Matrix m_textureTransform;
         Mesh* m_mesh;
+        const PrimitiveShape* m_primitive;
+
+        // render packet kept between frames and referenced by the collectors,
+        // rebuilt by Update() when the material, transform, bounds or lights change.
+        RenderableNode m_renderable;
+        NodeMaterial m_material;
+        LightEnvironment m_lighting;
+        bool m_renderableDirty;
     private:
         typedef GameObject super;
       
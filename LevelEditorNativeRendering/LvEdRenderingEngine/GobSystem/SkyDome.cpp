@@ -37,10 +37,13 @@ namespace LvEdEngine
         if(IsVisible() == false) 
             return;
        
+        NodeMaterial material;
+        material.textures[TextureType::Cubemap] = m_texture ? m_texture : TextureLib::Inst()->GetDefault(TextureType::Cubemap);       
+
         RenderableNode r;        
         r.mesh = ShapeLibGetMesh(RenderShape::Sphere);
         r.objectId = GetInstanceId();    
-        r.textures[TextureType::Cubemap] = m_texture ? m_texture : TextureLib::Inst()->GetDefault(TextureType::Cubemap);       
+        r.material = &material;
         r.SetFlag( RenderableNode::kShadowCaster, false );
         r.SetFlag( RenderableNode::kShadowReceiver, false );
 
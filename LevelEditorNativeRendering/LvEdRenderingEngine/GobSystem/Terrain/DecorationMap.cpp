@@ -3,7 +3,6 @@
 #include "DecorationMap.h"
 #include "TerrainGob.h"
 #include "../../Core/ImageData.h"
-#include "../../Core/StringUtils.h"
 #include "../../Renderer/RenderBuffer.h"
 #include "../../Renderer/GpuResourceFactory.h"
 
@@ -30,11 +29,11 @@ namespace LvEdEngine
 }
 
 
- void DecorationMap::Invoke(wchar_t* fn, const void* arg, void** retVal)
+ void DecorationMap::Invoke(MemberFnEnum fn, const void* arg, void** retVal)
  {
      TerrainMap::Invoke(fn,arg,retVal);
 
-     if(StrUtils::Equal(fn,L"ApplyDirtyRegion"))
+     if(fn == MemberFn::ApplyDirtyRegion)
      {         
          bool valid = arg != NULL; 
          assert(valid);
@@ -22,7 +22,7 @@ class DecorationMap : public TerrainMap
     static const char* StaticClassName(){return "DecorationMap";}
     DecorationMap();
     ~DecorationMap();
-    void Invoke(wchar_t* fn, const void* arg, void** retVal);
+    void Invoke(MemberFnEnum fn, const void* arg, void** retVal);
 
     void SetUseBillboard(bool useBillboard){ m_useBillboard = useBillboard;}
     void SetScale(float scale)  { m_scale = scale; }            
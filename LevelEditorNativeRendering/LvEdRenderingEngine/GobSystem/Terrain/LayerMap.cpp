@@ -2,7 +2,6 @@
 
 #include "LayerMap.h"
 #include "../../Core/Utils.h"
-#include "../../Core/StringUtils.h"
 #include "../../Core/ImageData.h"
 #include "../../Renderer/Texture.h"
 #include "../../Renderer/RenderContext.h"
@@ -25,11 +24,11 @@ namespace LvEdEngine
         SAFE_DELETE(m_mask);
     }
 
-    void LayerMap::Invoke(wchar_t* fn, const void* arg, void** retVal)
+    void LayerMap::Invoke(MemberFnEnum fn, const void* arg, void** retVal)
     {
         TerrainMap::Invoke(fn,arg,retVal);
 
-        if(StrUtils::Equal(fn,L"ApplyDirtyRegion"))
+        if(fn == MemberFn::ApplyDirtyRegion)
         {
 
             m_tmpBrushdata.clear();
@@ -15,7 +15,7 @@ class LayerMap : public TerrainMap
     static const char* StaticClassName(){return "LayerMap";}
     LayerMap();
     ~LayerMap();
-    void Invoke(wchar_t* fn, const void* arg, void** retVal);
+    void Invoke(MemberFnEnum fn, const void* arg, void** retVal);
 
     void SetLodTexture(wchar_t* lodTexture);
     void SetMask(wchar_t* mask);
@@ -4,7 +4,6 @@
 #include <algorithm>
 #include "../../Core/Utils.h"
 #include "../../Core/FileUtils.h"
-#include "../../Core/StringUtils.h"
 #include "../../Core/ImageData.h"
 #include "../../VectorMath/MeshUtil.h"
 #include "../../Renderer/Texture.h"
@@ -106,9 +105,9 @@ struct RayPickRetVal
     float3 nvert;
 };
 
-void TerrainGob::Invoke(wchar_t* fn, const void* arg, void** retVal)
+void TerrainGob::Invoke(MemberFnEnum fn, const void* arg, void** retVal)
 {
-    if(StrUtils::Equal(fn,L"RayPick"))
+    if(fn == MemberFn::RayPick)
     {        
         bool valid = arg && retVal;                     
         assert(valid);
@@ -120,7 +119,7 @@ struct RayPickRetVal
         *retVal =  &retdata;
         
     }        
-    else if( StrUtils::Equal(fn,L"DrawBrush"))
+    else if(fn == MemberFn::DrawBrush)
     {
         bool valid = arg != NULL;            
         assert(valid);
@@ -133,7 +132,7 @@ struct RayPickRetVal
                  ,data->posW);
 
     }
-    else if( StrUtils::Equal(fn,L"ApplyDirtyRegion"))
+    else if(fn == MemberFn::ApplyDirtyRegion)
     {
         bool valid = arg != NULL;            
         assert(valid);
@@ -142,7 +141,7 @@ struct RayPickRetVal
         ApplyDirtyRegion(box);
 
     }    
-    else if( StrUtils::Equal(fn,L"GetHeightMapInstanceId"))
+    else if(fn == MemberFn::GetHeightMapInstanceId)
     {
         static ObjectGUID hmInstId = 0;
         hmInstId = m_heightMap ? m_heightMap->GetInstanceId() : 0;
@@ -208,6 +207,7 @@ struct RayPickRetVal
             }
             patch->boundsTr = bound;
         }        
+        m_heightPyramid.Update((float*)ptr, m_heightMap->GetRowPitch(), box.x1, box.y1, box.x2, box.y2);
         InvalidateBounds();        
     }
 }
@@ -219,7 +219,7 @@ struct RayPickRetVal
     assert(valid);
 
     // xform posW to heightmap space.
-    float3 trans(&m_world.M41);    
+    float3 trans(&GetWorldTransform().M41);    
     float3 posH = posw - trans; 
     posH.x /= m_cellSize;
     posH.z /= m_cellSize;    
@@ -285,76 +285,106 @@ struct RayPickRetVal
     
 }
 
+// used by RayPick(..) to test the cells visited by the height pyramid.
+// the cells are tested using the same triangles and the same patch culling
+// as testing the patches one by one, on equal distance the first triangle in
+// patch order wins.
+struct TerrainPickVisitor
+{
+    const Ray* ray;
+    const uint8_t* heights;
+    int32_t rowPitch;
+    float cellSize;
+    int32_t patchCell;
+    int32_t patchStride;
+    const TerrainPatchList* patches;
+
+    int32_t lastPatch;
+    bool lastPatchHit;
+
+    bool hit;
+    uint64_t hitOrder;
+    float hitDist;
+    float3 hitPos;
+    float3 hitNor;
+    float3 hitVertex;
+
+    void operator()(int32_t cx, int32_t cy, float* maxDist)
+    {
+        int32_t patchId = (cy / patchCell) * patchStride + cx / patchCell;
+        if(patchId != lastPatch)
+        {
+            float t;
+            float3 p,n;
+            lastPatch = patchId;
+            lastPatchHit = IntersectRayAABB(*ray, (*patches)[patchId].boundsTr, &t, &p, &n);
+        }
+        if(!lastPatchHit) return;
+
+        // cell vertices  A B C D, and its two triangles ACD and ADB.
+        static uint32_t cellIndices[6] = {0, 2, 3, 0, 3, 1};
+        const float* line0 = (const float*)(heights + cy * rowPitch);
+        const float* line1 = (const float*)(heights + (cy + 1) * rowPitch);
+        float3 pos[4];
+        pos[0] = float3(cx * cellSize, line0[cx], cy * cellSize);
+        pos[1] = float3((cx + 1) * cellSize, line0[cx + 1], cy * cellSize);
+        pos[2] = float3(cx * cellSize, line1[cx], (cy + 1) * cellSize);
+        pos[3] = float3((cx + 1) * cellSize, line1[cx + 1], (cy + 1) * cellSize);
+
+        float t;
+        float3 p,n, nearp;
+        if(MeshIntersects(*ray, pos, 4, cellIndices, 6, true, &t, &p, &n, &nearp))
+        {
+            uint64_t order = (uint64_t)patchId * (patchCell * patchCell)
+                           + (cy % patchCell) * patchCell + (cx % patchCell);
+            if(!hit || t < hitDist || (t == hitDist && order < hitOrder))
+            {
+                hit = true;
+                hitOrder = order;
+                hitDist = t;
+                hitPos = p;
+                hitNor = n;
+                hitVertex = nearp;
+                *maxDist = t;
+            }
+        }
+    }
+};
+
 // ray/terrain intersection.
 bool TerrainGob::RayPick(const Ray& rayw, float3& hitpos, float3& norm, float3& nearestVertex)
 {
-    if(m_renderableNodes.size() == 0) return false;
+    if(m_renderableNodes.size() == 0 || m_heightPyramid.IsEmpty()) return false;
 
     // transform ray to terrain space.
     Ray ray = rayw;
-    float3 trans(&m_world.M41);
+    float3 trans(&GetWorldTransform().M41);
     ray.pos = ray.pos - trans;
 
-    float t;
-    float3 p,n, nearp;
-               
-    m_pickPatchlist.clear();
-    for(int i = 0; i < m_renderableNodes.size(); i++)
+    // only visit the cells crossed by the ray whose height range can be hit.
+    TerrainPickVisitor visitor;
+    visitor.ray = &ray;
+    visitor.heights = (const uint8_t*)m_heightMap->GetBufferPointer();
+    visitor.rowPitch = m_heightMap->GetRowPitch();
+    visitor.cellSize = m_cellSize;
+    visitor.patchCell = m_patchDim - 1;
+    visitor.patchStride = (m_cols - 1) / visitor.patchCell;
+    visitor.patches = &m_renderableNodes;
+    visitor.lastPatch = -1;
+    visitor.lastPatchHit = false;
+    visitor.hit = false;
+    visitor.hitOrder = 0;
+    visitor.hitDist = FLT_MAX;
+
+    float maxDist = FLT_MAX;
+    m_heightPyramid.RayQuery(ray, m_cellSize, &maxDist, visitor);
+    if(visitor.hit)
     {
-        TerrainPatch* it = &m_renderableNodes[i];
-        if(IntersectRayAABB(ray, it->boundsTr, &t, &p, &n))
-        {
-            m_pickPatchlist.push_back(it);
-        }        
+        hitpos = visitor.hitPos + trans;
+        norm = visitor.hitNor;
+        nearestVertex = visitor.hitVertex + trans;
     }
-       
-    //perform  ray/tri intersection for the terrain patchs.
-    bool picked = false;
-    if(m_pickPatchlist.size() > 0)
-    {
-        int patchCell = m_patchDim - 1;
-        float minT = FLT_MAX;
-        uint8_t* ptr = (uint8_t*)m_heightMap->GetBufferPointer();
-        
-        for(auto it = m_pickPatchlist.begin(); it != m_pickPatchlist.end(); it++)
-        {
-            m_pickPosT.clear();
-            TerrainPatch* patch = *it;
-          
-            int yEnd = patch->y + patchCell;
-            int xEnd = patch->x + patchCell;
-            for(int y = patch->y;  y <= yEnd; y++)
-            {
-                float* scanline = (float*) (ptr + y * m_heightMap->GetRowPitch());
-                for(int x = patch->x; x <= xEnd; x++)
-                {                                       
-                    m_pickPosT.push_back( float3(x * m_cellSize, scanline[x], y * m_cellSize));                
-                }                
-            }// for (int y = .....
-
-            bool hit = MeshIntersects(ray,&m_pickPosT[0],
-                           (uint32_t)m_pickPosT.size(),
-                           &m_indices[0],
-                           (uint32_t)m_indices.size(),
-                           true,
-                           &t,
-                           &p,
-                           &n,
-                           &nearp);
-            if(hit)
-            {
-                picked = true;
-                if( t < minT)
-                {                    
-                    minT = t;
-                    hitpos = p + trans;
-                    norm = n;
-                    nearestVertex = nearp + trans;
-                }
-            }
-        }             
-    } // if ( patchList.size() > 0)
-    return picked;
+    return visitor.hit;
 }
 
 float TerrainGob::GetHeightAt(float2 posT) const
@@ -391,6 +421,7 @@ struct RayPickRetVal
     bool boundDirty = m_boundsDirty;
     super::Update(fr,updateType);
     m_boundsDirty = boundDirty || m_worldBoundUpdated;
+    bool patchesMoved = m_boundsDirty;
     if(m_boundsDirty)    
     {                
         if(m_renderableNodes.size() > 0)
@@ -400,7 +431,7 @@ struct RayPickRetVal
             {
                 local.Extend(it->boundsTr);
                 it->bounds = it->boundsTr;
-                it->bounds.Transform(m_world);
+                it->bounds.Transform(GetWorldTransform());
             }            
             m_localBounds = local;
         }
@@ -412,11 +443,14 @@ struct RayPickRetVal
         UpdateWorldAABB();
     }
     
-    if(RenderContext::Inst()->LightEnvDirty)
+    // the patches are relit when they move or when the lights around them change.
+    LightingState* lightState = LightingState::Inst();
+    if(patchesMoved || lightState->IsInvalid(m_bounds))
     {
         for(auto it = m_renderableNodes.begin(); it != m_renderableNodes.end(); it++)
         {
-            LightingState::Inst()->UpdateLightEnvironment(it->lighting,it->bounds);
+            if(patchesMoved || lightState->IsInvalid(it->bounds))
+                lightState->UpdateLightEnvironment(it->lighting,it->bounds);
         }
     }
 
@@ -443,6 +477,7 @@ struct RayPickRetVal
 void TerrainGob::SetHeightMap(wchar_t* file)
 {    
     SAFE_DELETE(m_heightMap);
+    m_heightPyramid.Clear();
     if(!FileUtils::Exists(file)) return;
 
     m_heightMap = new ImageData();
@@ -617,6 +652,8 @@ struct RayPickRetVal
         }
         it->boundsTr = bound;
     }      
+
+    m_heightPyramid.Build((float*)pixelptr, m_cols, m_rows, m_heightMap->GetRowPitch());
     InvalidateBounds();
 }
 
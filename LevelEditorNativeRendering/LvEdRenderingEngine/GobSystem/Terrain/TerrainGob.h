@@ -5,6 +5,7 @@
 #include "../GameObject.h"
 #include "LayerMap.h"
 #include "DecorationMap.h"
+#include "../../VectorMath/HeightPyramid.h"
 #include <vector>
 #include <set>
 namespace LvEdEngine
@@ -40,7 +41,7 @@ class TerrainGob : public GameObject
      TerrainGob();
      ~TerrainGob();
      
-     void Invoke(wchar_t* fn, const void* arg, void** retVal);
+     void Invoke(MemberFnEnum fn, const void* arg, void** retVal);
 
      
      void SetCellSize(float cellSize) 
@@ -103,9 +104,8 @@ void SetCellSize(float cellSize)
     TerrainPatchList m_visibleList; // visible list of renderable node.
     void BuildPatches();
 
-    // scratch lists used by RayPick(..) function.
-    std::vector<TerrainPatch*> m_pickPatchlist;
-    std::vector<float3> m_pickPosT;
+    // min/max height of the cells, used by RayPick(..) function.
+    HeightPyramid m_heightPyramid;
 
     std::vector<float> tempBrushdata;
     std::set<int32_t> m_tmpPatchSet;
@@ -4,7 +4,6 @@
 #include "../../Core/ImageData.h"
 #include "../../Core/Utils.h"
 #include "../../Core/FileUtils.h"
-#include "../../Core/StringUtils.h"
 #include "../../DirectX/DXUtil.h"
 #include "../../Renderer/Texture.h"
 #include "../../ResourceManager/ResourceManager.h"
@@ -41,9 +40,9 @@ void LoadTexture(wchar_t* file, Texture** tex)
     }
 
     
-    void TerrainMap::Invoke(wchar_t* fn, const void* arg, void** retVal)
+    void TerrainMap::Invoke(MemberFnEnum fn, const void* arg, void** retVal)
     {
-        if( StrUtils::Equal(fn,L"GetMaskMapInstanceId"))
+        if(fn == MemberFn::GetMaskMapInstanceId)
         {
             static ObjectGUID hmInstId = 0;
             hmInstId = m_maskData ? m_maskData->GetInstanceId() : 0;
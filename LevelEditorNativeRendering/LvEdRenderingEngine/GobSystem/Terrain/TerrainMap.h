@@ -20,7 +20,7 @@ class TerrainMap : public Object
         TerrainMap();
         ~TerrainMap();
 
-        void Invoke(wchar_t* fn, const void* arg, void** retVal);
+        void Invoke(MemberFnEnum fn, const void* arg, void** retVal);
         void SetName(wchar_t* name)  { m_name = name ? name : L""; }
         const wchar_t* const GetName() const { return m_name.c_str();}
         void SetMinHeight(float minHeight) { m_minHeight = minHeight;}
@@ -0,0 +1,351 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "TransformStore.h"
+#include <algorithm>
+#include "../Core/Utils.h"
+#include "../Core/WorkerPool.h"
+
+namespace LvEdEngine
+{
+    TransformStore* TransformStore::s_inst = NULL;
+
+    // number of nodes updated by a single job,
+    // levels smaller than this are updated on the calling thread.
+    static const uint32_t ChunkSize = 256;
+
+    // ----------------------------------------------------------------------------------
+    class TransformStore::LevelJob : public ParallelJob
+    {
+    public:
+        LevelJob(TransformStore* store, uint32_t first, uint32_t end, uint32_t stamp, uint32_t chunkCount)
+            : m_store(store), m_first(first), m_end(end), m_stamp(stamp), m_updated(chunkCount, 0)
+        {
+        }
+
+        virtual void Execute(uint32_t index)
+        {
+            uint32_t first = m_first + index * ChunkSize;
+            uint32_t end = std::min(first + ChunkSize, m_end);
+            m_updated[index] = m_store->UpdateRange(first, end, m_stamp) ? 1 : 0;
+        }
+
+        bool AnyUpdated() const
+        {
+            return std::find(m_updated.begin(), m_updated.end(), 1) != m_updated.end();
+        }
+
+    private:
+        TransformStore* m_store;
+        uint32_t m_first;
+        uint32_t m_end;
+        uint32_t m_stamp;
+        std::vector<uint8_t> m_updated; // one entry per chunk, so jobs don't share any state.
+    };
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void TransformStore::InitInstance()
+    {
+        assert(s_inst == NULL);
+        if(s_inst) return;
+        s_inst = new TransformStore();
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    void TransformStore::DestroyInstance()
+    {
+        assert(s_inst);
+        SAFE_DELETE(s_inst);
+    }
+
+    // ----------------------------------------------------------------------------------
+    TransformStore::TransformStore()
+        : m_freeList(NullHandle), m_count(0), m_orderDirty(false), m_changed(false), m_clock(0)
+    {
+    }
+
+    // ----------------------------------------------------------------------------------
+    TransformStore::~TransformStore()
+    {
+    }
+
+    // ----------------------------------------------------------------------------------
+    TransformHandle TransformStore::Create()
+    {
+        TransformHandle h;
+        if(m_freeList != NullHandle)
+        {
+            h = m_freeList;
+            m_freeList = m_nodes[h].nextFree;
+        }
+        else
+        {
+            h = (TransformHandle)m_nodes.size();
+            m_nodes.push_back(Node());
+        }
+
+        Node& node = m_nodes[h];
+        node.slot = (int32_t)m_handle.size();
+        node.parent = NullHandle;
+        node.nextFree = NullHandle;
+        node.depth = 0;
+
+        m_parentSlot.push_back(-1);
+        m_handle.push_back(h);
+        m_local.push_back(Matrix());
+        m_world.push_back(Matrix());
+        m_stamp.push_back(0);
+        m_dirty.push_back(1);
+
+        m_count++;
+        m_orderDirty = true;
+        m_changed = true;
+        return h;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::Destroy(TransformHandle h)
+    {
+        assert(IsValid(h));
+        Node& node = m_nodes[h];
+
+        // the slot is released on the next RebuildOrder().
+        m_handle[node.slot] = NullHandle;
+        m_dirty[node.slot] = 0;
+
+        node.slot = -1;
+        node.parent = NullHandle;
+        node.nextFree = m_freeList;
+        m_freeList = h;
+
+        m_count--;
+        m_orderDirty = true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::SetParent(TransformHandle h, TransformHandle parent)
+    {
+        assert(IsValid(h));
+        assert(parent == NullHandle || IsValid(parent));
+        Node& node = m_nodes[h];
+        if(node.parent == parent)
+            return;
+
+        node.parent = parent;
+        m_parentSlot[node.slot] = parent == NullHandle ? -1 : m_nodes[parent].slot;
+        m_dirty[node.slot] = 1;
+        m_orderDirty = true;
+        m_changed = true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::SetLocal(TransformHandle h, const Matrix& local)
+    {
+        assert(IsValid(h));
+        m_local[m_nodes[h].slot] = local;
+        Invalidate(h);
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::Invalidate(TransformHandle h)
+    {
+        assert(IsValid(h));
+        m_dirty[m_nodes[h].slot] = 1;
+        m_changed = true;
+        MarkLevelDirty(m_nodes[h].depth);
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool TransformStore::IsStale(TransformHandle h) const
+    {
+        assert(IsValid(h));
+        // UpdateWorld() left every node up to date.
+        if(!m_changed)
+            return false;
+
+        const Node& node = m_nodes[h];
+        if(m_dirty[node.slot])
+            return true;
+        return node.parent != NullHandle && m_stamp[m_nodes[node.parent].slot] > m_stamp[node.slot];
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::UpdateNode(TransformHandle h)
+    {
+        assert(IsValid(h));
+        const Node& node = m_nodes[h];
+        if(node.parent != NullHandle && IsStale(node.parent))
+            UpdateNode(node.parent);
+
+        int32_t slot = node.slot;
+        if(node.parent != NullHandle)
+            m_world[slot] = m_local[slot] * m_world[m_nodes[node.parent].slot];
+        else
+            m_world[slot] = m_local[slot];
+        m_dirty[slot] = 0;
+        m_stamp[slot] = ++m_clock;
+
+        // the children are now stale, make sure the next UpdateWorld() visits them.
+        MarkLevelDirty(node.depth + 1);
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::UpdateWorld()
+    {
+        if(m_orderDirty)
+            RebuildOrder();
+
+        // all the nodes updated by this pass get the same stamp,
+        // parents are done before their children so a child whose parent was
+        // updated in this pass always has an older stamp.
+        uint32_t stamp = m_clock + 1;
+        bool updated = false;
+        bool parentLevelUpdated = false;
+        uint32_t levelCount = (uint32_t)m_levelDirty.size();
+        for(uint32_t level = 0; level < levelCount; level++)
+        {
+            if(!m_levelDirty[level] && !parentLevelUpdated)
+                continue;
+            m_levelDirty[level] = 0;
+
+            uint32_t first = m_levelStart[level];
+            uint32_t end = m_levelStart[level + 1];
+            uint32_t chunkCount = (end - first + ChunkSize - 1) / ChunkSize;
+            if(chunkCount > 1 && WorkerPool::Inst())
+            {
+                LevelJob job(this, first, end, stamp, chunkCount);
+                WorkerPool::Inst()->ParallelFor(&job, chunkCount);
+                parentLevelUpdated = job.AnyUpdated();
+            }
+            else
+            {
+                parentLevelUpdated = UpdateRange(first, end, stamp);
+            }
+            updated |= parentLevelUpdated;
+        }
+
+        if(updated)
+            m_clock = stamp;
+        m_changed = false;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // update the stale nodes in [first, end), all the nodes must be in the same level.
+    // returns true if any node was updated.
+    bool TransformStore::UpdateRange(uint32_t first, uint32_t end, uint32_t stamp)
+    {
+        bool updated = false;
+        for(uint32_t i = first; i < end; i++)
+        {
+            int32_t parent = m_parentSlot[i];
+            if(!m_dirty[i] && (parent < 0 || m_stamp[parent] <= m_stamp[i]))
+                continue;
+
+            if(parent < 0)
+                m_world[i] = m_local[i];
+            else
+                m_world[i] = m_local[i] * m_world[parent];
+            m_dirty[i] = 0;
+            m_stamp[i] = stamp;
+            updated = true;
+        }
+        return updated;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void TransformStore::MarkLevelDirty(int32_t depth)
+    {
+        // when the order is dirty all the levels are visited after the rebuild.
+        if(!m_orderDirty && depth < (int32_t)m_levelDirty.size())
+            m_levelDirty[depth] = 1;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // depth of the node, also sets the depth of its ancestors that are not known yet.
+    int32_t TransformStore::ComputeDepth(TransformHandle h)
+    {
+        int32_t steps = 0;
+        TransformHandle cur = h;
+        while(m_nodes[cur].depth < 0 && m_nodes[cur].parent != NullHandle)
+        {
+            cur = m_nodes[cur].parent;
+            steps++;
+        }
+
+        int32_t depth = (m_nodes[cur].depth < 0 ? 0 : m_nodes[cur].depth) + steps;
+        int32_t d = depth;
+        for(cur = h; cur != NullHandle && m_nodes[cur].depth < 0; cur = m_nodes[cur].parent)
+        {
+            m_nodes[cur].depth = d--;
+        }
+        return depth;
+    }
+
+    // ----------------------------------------------------------------------------------
+    // sort the slots by depth and release the slots of the destroyed nodes.
+    void TransformStore::RebuildOrder()
+    {
+        for(auto it = m_nodes.begin(); it != m_nodes.end(); ++it)
+        {
+            it->depth = -1;
+        }
+
+        int32_t maxDepth = -1;
+        for(TransformHandle h = 0; h < (TransformHandle)m_nodes.size(); h++)
+        {
+            if(m_nodes[h].slot >= 0)
+                maxDepth = std::max(maxDepth, ComputeDepth(h));
+        }
+
+        // counting sort, keeps the relative order of the nodes within a level.
+        m_levelStart.assign(maxDepth + 2, 0);
+        for(auto it = m_nodes.begin(); it != m_nodes.end(); ++it)
+        {
+            if(it->slot >= 0)
+                m_levelStart[it->depth + 1]++;
+        }
+        for(size_t i = 1; i < m_levelStart.size(); i++)
+        {
+            m_levelStart[i] += m_levelStart[i - 1];
+        }
+
+        std::vector<uint32_t> next(m_levelStart.begin(), m_levelStart.end() - 1);
+        std::vector<TransformHandle> handle(m_count);
+        std::vector<Matrix> local(m_count);
+        std::vector<Matrix> world(m_count);
+        std::vector<uint32_t> stamp(m_count);
+        std::vector<uint8_t> dirty(m_count);
+        for(uint32_t s = 0; s < (uint32_t)m_handle.size(); s++)
+        {
+            TransformHandle h = m_handle[s];
+            if(h == NullHandle)
+                continue;
+            uint32_t ns = next[m_nodes[h].depth]++;
+            handle[ns] = h;
+            local[ns] = m_local[s];
+            world[ns] = m_world[s];
+            stamp[ns] = m_stamp[s];
+            dirty[ns] = m_dirty[s];
+            m_nodes[h].slot = (int32_t)ns;
+        }
+
+        std::vector<int32_t> parentSlot(m_count);
+        for(uint32_t s = 0; s < m_count; s++)
+        {
+            TransformHandle parent = m_nodes[handle[s]].parent;
+            parentSlot[s] = parent == NullHandle ? -1 : m_nodes[parent].slot;
+        }
+
+        m_parentSlot.swap(parentSlot);
+        m_handle.swap(handle);
+        m_local.swap(local);
+        m_world.swap(world);
+        m_stamp.swap(stamp);
+        m_dirty.swap(dirty);
+
+        // visit every level once after a hierarchy change.
+        m_levelDirty.assign(maxDepth + 1, 1);
+        m_orderDirty = false;
+    }
+}
@@ -0,0 +1,131 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "../Core/NonCopyable.h"
+#include "../VectorMath/V3dMath.h"
+
+namespace LvEdEngine
+{
+    typedef int32_t TransformHandle;
+
+    // local and world matrices of all the game objects.
+    // The matrices are stored in flat arrays sorted by depth in the hierarchy,
+    // so parents always come before their children. UpdateWorld() recomputes
+    // the world matrices one level at a time, splitting each level across
+    // the worker threads. Levels that have no dirty node and whose parent level
+    // did not change are skipped.
+    //
+    // Each node has a stamp that is set when its world matrix is recomputed,
+    // a node is stale if it is dirty or its parent has a newer stamp.
+    // IsStale() only looks at the node and its parent, so the nodes changed after
+    // UpdateWorld() must be visited parents first, as GameObjectGroup::Update() does.
+    // Handles are stable until destroyed, slots change whenever the hierarchy changes.
+    // references returned by GetLocal() and GetWorld() are valid until
+    // the next Create() or UpdateWorld().
+    class TransformStore : public NonCopyable
+    {
+    public:
+        static const TransformHandle NullHandle = -1;
+
+        static void            InitInstance();
+        static void            DestroyInstance();
+        static TransformStore* Inst() { return s_inst; }
+
+        // create a root node with identity local and world matrices.
+        TransformHandle Create();
+
+        // the children of the node must be re-parented or destroyed first.
+        void Destroy(TransformHandle h);
+
+        void SetParent(TransformHandle h, TransformHandle parent);
+        TransformHandle GetParent(TransformHandle h) const
+        {
+            assert(IsValid(h));
+            return m_nodes[h].parent;
+        }
+
+        void SetLocal(TransformHandle h, const Matrix& local);
+        const Matrix& GetLocal(TransformHandle h) const
+        {
+            assert(IsValid(h));
+            return m_local[m_nodes[h].slot];
+        }
+        const Matrix& GetWorld(TransformHandle h) const
+        {
+            assert(IsValid(h));
+            return m_world[m_nodes[h].slot];
+        }
+
+        // mark the world matrix of the node, and so of its whole subtree, as dirty.
+        void Invalidate(TransformHandle h);
+
+        // true if the world matrix of the node needs updating, assuming its parent is
+        // up to date. constant time, and a single test if nothing changed since UpdateWorld().
+        bool IsStale(TransformHandle h) const;
+
+        // recompute the world matrix of the node, and of its parent if stale.
+        // used for changes made after UpdateWorld(), for example by components.
+        void UpdateNode(TransformHandle h);
+
+        // changes whenever the world matrix of the node is recomputed.
+        uint32_t GetStamp(TransformHandle h) const
+        {
+            assert(IsValid(h));
+            return m_stamp[m_nodes[h].slot];
+        }
+
+        // recompute all the stale world matrices.
+        void UpdateWorld();
+
+        uint32_t GetCount() const { return m_count; }
+
+    private:
+        TransformStore();
+        ~TransformStore();
+
+        // per handle data.
+        struct Node
+        {
+            int32_t slot;            // index in the slot arrays, -1 if free.
+            TransformHandle parent;
+            TransformHandle nextFree;
+            int32_t depth;           // valid when the order is up to date.
+        };
+
+        // updates the nodes [first, end) of a level.
+        class LevelJob;
+
+        bool IsValid(TransformHandle h) const
+        {
+            return h >= 0 && h < (TransformHandle)m_nodes.size() && m_nodes[h].slot >= 0;
+        }
+
+        void RebuildOrder();
+        int32_t ComputeDepth(TransformHandle h);
+        bool UpdateRange(uint32_t first, uint32_t end, uint32_t stamp);
+        void MarkLevelDirty(int32_t depth);
+
+        static TransformStore* s_inst;
+
+        std::vector<Node> m_nodes;
+        TransformHandle m_freeList;
+        uint32_t m_count;
+
+        // per slot data, in parents first order.
+        std::vector<int32_t> m_parentSlot;    // -1 for roots.
+        std::vector<TransformHandle> m_handle; // NullHandle for destroyed nodes.
+        std::vector<Matrix> m_local;
+        std::vector<Matrix> m_world;
+        std::vector<uint32_t> m_stamp;
+        std::vector<uint8_t> m_dirty;
+
+        // first slot of each level, plus the end of the last level.
+        std::vector<uint32_t> m_levelStart;
+        std::vector<uint8_t> m_levelDirty;
+        bool m_orderDirty;
+        bool m_changed; // a node was created, invalidated or re-parented since UpdateWorld().
+
+        uint32_t m_clock;
+    };
+}
@@ -12,9 +12,13 @@
 #include "Core/ErrorHandler.h"
 #include "Core/PerfTimer.h"
 #include "Core/Utils.h"
+#include "Core/WorkerPool.h"
+#include "Core/ObjectPool.h"
+#include "Core/ObjectTable.h"
 #include "Core/WinHeaders.h"
 #include <mmsystem.h>
 #include "Bridge/GobBridge.h"
+#include "Bridge/CommandBuffer.h"
 #include "Bridge/RegisterSchemaObjects.h"
 #include "Bridge/RegisterRuntimeObjects.h"
 #include "Renderer/RenderContext.h"
@@ -39,6 +43,7 @@
 #include "ResourceManager/TextureFactory.h"
 #include "GobSystem/GameLevel.h"
 #include "GobSystem/SkyDome.h"
+#include "GobSystem/TransformStore.h"
 #include "LvEdUtils.h"
 #include "Renderer/RenderBuffer.h"
 #include "Renderer/Model.h"
@@ -53,6 +58,9 @@
 #include "Core\ImageData.h"
 #include "GobSystem\Terrain\TerrainGob.h"
 #include "Renderer\TerrainShader.h"
+#include "VectorMath/BVH.h"
+#include "VectorMath/AABBStream.h"
+#include "VectorMath/SegmentBVH.h"
 
 // Use the following primitive types
 //int8_t;
@@ -86,6 +94,21 @@ struct HitRecord
     char pad2;
 };
 
+// renderable hit by the ray bounds test, ordered by entry distance
+// in closest hit mode of LvEd_RayPick.
+struct PickCandidate
+{
+    float entryDist;
+    uint32_t index;
+};
+
+// hits of a group of consecutive rays picked by LvEd_RayPickBatch.
+struct RayPickBatchChunk
+{
+    std::vector<HitRecord> hits;
+    std::vector<int> counts; // number of hits of each ray.
+};
+
 
 
 
@@ -160,6 +183,19 @@ class EngineData : public NonCopyable
     RenderableNodeSorter    renderableSorter;
     RenderableNodeSet       pickCollector; 
     Font* AxisFont;
+
+    std::vector<PickCandidate> pickCandidates;
+
+    // used by LvEd_FrustumPick
+    AABBStream pickBoxes;
+    std::vector<uint8_t> pickBoxResults;
+
+    // used by LvEd_RayPickBatch
+    BVH pickBatchTree;
+    std::vector<AABB> pickBatchBounds;
+    std::vector<RayPickBatchChunk> pickBatchChunks;
+    std::vector<HitRecord> BatchHitRecords;
+    std::vector<int> BatchHitOffsets;
     
 };
 
@@ -174,6 +210,7 @@ class EngineData : public NonCopyable
     // Initialize the 'code generated' bridge.
     InitGobBridge(Bridge);
     RegisterRuntimeObjects(Bridge);
+    Bridge.BuildDispatchTables();
 
     basicRenderer   = new BasicRenderer(device);
     shadowMapShader = new ShadowMapGen(device);
@@ -196,7 +233,7 @@ class EngineData : public NonCopyable
 //=============================================================================================
 void MyResourceListener::OnResourceLoaded(Resource* /*r*/)
 {    
-    RenderContext::Inst()->LightEnvDirty = true;
+    LightingState::Inst()->InvalidateAll();
     if(m_callback) m_callback();   
 }
 
@@ -230,10 +267,12 @@ class EngineData : public NonCopyable
     TextureLib::InitInstance(gD3D11->GetDevice());
     ShapeLibStartup(gD3D11->GetDevice());
     ResourceManager::InitInstance();
+    WorkerPool::InitInstance();
     LineRenderer::InitInstance(gD3D11->GetDevice());
     ShadowMaps::InitInstance(gD3D11->GetDevice(),2048);
    
     RenderContext::InitInstance(gD3D11->GetDevice());
+    TransformStore::InitInstance();
     s_engineData = new EngineData( gD3D11->GetDevice() );
     s_engineData->resourceListener.SetCallback(invalidateCallback);
     RenderContext::Inst()->SetContext(gD3D11->GetImmediateContext());
@@ -279,10 +318,12 @@ class EngineData : public NonCopyable
     LineRenderer::DestroyInstance();
     RenderContext::DestroyInstance();    
     ResourceManager::DestroyInstance();
+    WorkerPool::DestroyInstance();
     ShadowMaps::DestroyInstance();
     RSCache::DestroyInstance();
     EngineInfo::DestroyInstance();
     SAFE_DELETE(s_engineData);
+    TransformStore::DestroyInstance(); // after the level, game objects release their transforms.
     SAFE_DELETE(gD3D11);
 }
 
@@ -291,9 +332,15 @@ class EngineData : public NonCopyable
 {
     ErrorHandler::ClearError();
     Logger::Log(OutputMessageType::Info, "SceneReset\n");    
-    RenderContext::Inst()->selection.clear();        
+    ObjectTable::Inst()->ClearSelection();
     ResourceManager * rm = ResourceManager::Inst();
     rm->GarbageCollect();
+
+    // the game objects are gone, release the slabs of the object pools.
+#ifdef _DEBUG
+    ObjectPool::Debug_LogStats("SceneReset");
+#endif
+    ObjectPool::TrimAll();
 }
 
 //===============================================================================
@@ -332,10 +379,19 @@ class EngineData : public NonCopyable
 LVEDRENDERINGENGINE_API void __stdcall LvEd_DestroyObject(ObjectTypeGUID typeId, ObjectGUID instanceId)
 {
     ErrorHandler::ClearError();
-    if(s_engineData->GameLevel && s_engineData->GameLevel->GetInstanceId() == instanceId)
+    bool isLevel = s_engineData->GameLevel && s_engineData->GameLevel->GetInstanceId() == instanceId;
+    if(isLevel)
         s_engineData->GameLevel = NULL;
 
+    PerfTimer timer;
+    timer.Start();
     s_engineData->Bridge.DestroyObject(typeId, instanceId);
+    if(isLevel)
+    {
+        // the level deletes all its game objects.
+        timer.Stop();
+        Logger::Log(OutputMessageType::Debug, "%d ms Destroyed level\n", timer.ElapsedMilliseconds());
+    }
 
     ResourceManager::Inst()->GarbageCollect();
 }
@@ -344,23 +400,38 @@ class EngineData : public NonCopyable
 
 LVEDRENDERINGENGINE_API void __stdcall LvEd_InvokeMemberFn(ObjectGUID instanceId, wchar_t* fn, const void* arg, void** retVal)
 {
-    if(instanceId == 0) return;
-    Object* obj = reinterpret_cast<Object*>(instanceId);
-    obj->Invoke(fn,arg,retVal);
+    MemberFnEnum fnId = GetMemberFnId(fn);
+    if(fnId == MemberFn::Invalid)
+    {
+        Logger::Log(OutputMessageType::Error, L"%s: unknown member function '%s'\n", __WFUNCTION__, fn ? fn : L"");
+        return;
+    }
+    LvEd_InvokeMemberFnById(instanceId, fnId, arg, retVal);
+}
+
+LVEDRENDERINGENGINE_API int __stdcall LvEd_GetMemberFnId(wchar_t* fn)
+{
+    return GetMemberFnId(fn);
+}
+
+LVEDRENDERINGENGINE_API void __stdcall LvEd_InvokeMemberFnById(ObjectGUID instanceId, int fnId, const void* arg, void** retVal)
+{
+    if(GetMemberFnName(fnId) == NULL)
+    {
+        Logger::Log(OutputMessageType::Error, "%s: invalid member function id %d\n", __FUNCTION__, fnId);
+        return;
+    }
+    Object* obj = ObjectTable::Inst()->Get(instanceId);
+    if(obj == NULL) return;
+    obj->Invoke((MemberFnEnum)fnId,arg,retVal);
 }
 
-static hash32_t swapchainTypeId = Hash32("SwapChain");
-static hash32_t renderStateTypeId = Hash32("RenderState");
 LVEDRENDERINGENGINE_API void __stdcall LvEd_SetObjectProperty(ObjectTypeGUID typeId, ObjectPropertyUID propId, ObjectGUID instanceId, void* data, int size)
 {
     ErrorHandler::ClearError();
     s_engineData->Bridge.SetProperty(typeId,propId,instanceId,data,size);
-    
-    // for certain objects, we don't want to update lighting.    
-    if(typeId == renderStateTypeId || typeId == swapchainTypeId)
-        return;
-
-    RenderContext::Inst()->LightEnvDirty = true;   
+    // no lighting update here, the lights invalidate the regions they
+    // affect and the objects relight themselves when they move.
 }
 
 LVEDRENDERINGENGINE_API void __stdcall LvEd_GetObjectProperty(ObjectTypeGUID typeId, ObjectPropertyUID propId, ObjectGUID instanceId, void** data, int* size)
@@ -369,44 +440,60 @@ class EngineData : public NonCopyable
     s_engineData->Bridge.GetProperty(typeId,propId,instanceId,data,size);
 }
 
-
-LVEDRENDERINGENGINE_API void __stdcall LvEd_ObjectAddChild(ObjectTypeGUID typeId, ObjectPropertyUID listId, ObjectGUID parentId, ObjectGUID  childId, int index)
+LVEDRENDERINGENGINE_API int __stdcall LvEd_ExecuteCommandBuffer(void* buffer, int size)
 {
     ErrorHandler::ClearError();
-    assert(listId != 0);
-    assert(parentId != 0);
-    
-    if(parentId == 0 || listId == 0 )
+    if(size < 0)
     {
-        ErrorHandler::SetError(ErrorType::UnknownError,
-                L"%s: parentId is %d and listId is %d but should both be non-zero\n",
-                __WFUNCTION__, parentId, listId);
-        return;
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: invalid size", __WFUNCTION__);
+        return -1;
     }
+    int applied = CommandBuffer::Execute(s_engineData->Bridge, buffer, (uint32_t)size);
+    if(applied < 0)
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: malformed command buffer", __WFUNCTION__);
+    return applied;
+}
 
-    if(parentId == s_engineData->GameLevel->GetInstanceId())
+
+// ------------------------------------------------------------------------------
+// level bookkeeping for the children added to or removed from any list.
+static void OnChildAdded(Object* obj)
+{
+    if(strcmp(obj->ClassName(),SkyDome::StaticClassName()) ==0)
     {
-        listId = Hash32("Child");
-        typeId = Hash32(gobGroup);
+        s_engineData->GameLevel->m_activeskyeDome =(SkyDome*)obj;
     }
-    s_engineData->Bridge.AddChild(typeId, listId, parentId, childId, index);
+    else if(strcmp(obj->ClassName(),TerrainGob::StaticClassName()) ==0)
+    {
+        s_engineData->GameLevel->Terrains.push_back((TerrainGob*)obj);
+    }
+}
 
-     Object* obj = (Object*)childId;
-     if(strcmp(obj->ClassName(),SkyDome::StaticClassName()) ==0)
-     {
-         s_engineData->GameLevel->m_activeskyeDome =(SkyDome*)obj;         
-     }
-     else if(strcmp(obj->ClassName(),TerrainGob::StaticClassName()) ==0)
-     {
-         s_engineData->GameLevel->Terrains.push_back((TerrainGob*)obj);         
-     }
-         
-    RenderContext::Inst()->LightEnvDirty = true;
+static void OnChildRemoved(Object* obj)
+{
+    GameLevel* level = s_engineData->GameLevel;
+    if(level->m_activeskyeDome == obj)
+    {
+        FindGobsByType query(SkyDome::StaticClassName());
+        level->Query(query);       
+        size_t count = query.Gobs.size();        
+        level->m_activeskyeDome = 
+            (count > 0)? (SkyDome*)query.Gobs[count-1] : NULL;
+    }
+    else if(strcmp(obj->ClassName(),TerrainGob::StaticClassName()) == 0)
+    {
+        auto it = std::find(level->Terrains.begin(), level->Terrains.end(), (TerrainGob*)obj);
+        if(it != level->Terrains.end())
+        {
+            level->Terrains.erase(it);
+        }
+    }
 }
 
-LVEDRENDERINGENGINE_API void __stdcall LvEd_ObjectRemoveChild(ObjectTypeGUID typeId, ObjectListUID listId, ObjectGUID parentId, ObjectGUID childId)
+// ------------------------------------------------------------------------------
+// returns false if the ids are not valid.
+static bool CheckParentAndList(const wchar_t* fn, ObjectGUID parentId, ObjectListUID listId)
 {
-    ErrorHandler::ClearError();
     assert(listId != 0);
     assert(parentId != 0);
     
@@ -414,36 +501,51 @@ class EngineData : public NonCopyable
     {
         ErrorHandler::SetError(ErrorType::UnknownError,
                 L"%s: parentId is %d and listId is %d but should both be non-zero\n",
-                __WFUNCTION__, parentId, listId);
-        return;
+                fn, parentId, listId);
+        return false;
     }
+    return true;
+}
 
+// ------------------------------------------------------------------------------
+// the children of the level are in the child list of its group.
+static void MapLevelList(ObjectGUID parentId, ObjectTypeGUID& typeId, ObjectListUID& listId)
+{
     if(parentId == s_engineData->GameLevel->GetInstanceId())
     {
         listId = Hash32("Child");
         typeId = Hash32(gobGroup);
     }
+}
+
+LVEDRENDERINGENGINE_API void __stdcall LvEd_ObjectAddChild(ObjectTypeGUID typeId, ObjectPropertyUID listId, ObjectGUID parentId, ObjectGUID  childId, int index)
+{
+    ErrorHandler::ClearError();
+    if(!CheckParentAndList(__WFUNCTION__, parentId, listId))
+        return;
+
+    MapLevelList(parentId, typeId, listId);
+    s_engineData->Bridge.AddChild(typeId, listId, parentId, childId, index);
+
+    Object* obj = ObjectTable::Inst()->Get(childId);
+    if(obj == NULL)
+        return; // rejected by the bridge.
+    OnChildAdded(obj);
+}
+
+LVEDRENDERINGENGINE_API void __stdcall LvEd_ObjectRemoveChild(ObjectTypeGUID typeId, ObjectListUID listId, ObjectGUID parentId, ObjectGUID childId)
+{
+    ErrorHandler::ClearError();
+    if(!CheckParentAndList(__WFUNCTION__, parentId, listId))
+        return;
+
+    MapLevelList(parentId, typeId, listId);
     s_engineData->Bridge.RemoveChild(typeId, listId, parentId, childId);
-    Object* obj = (Object*)childId;
-    if(s_engineData->GameLevel->m_activeskyeDome == obj)
-    {
-        FindGobsByType query(SkyDome::StaticClassName());
-        s_engineData->GameLevel->Query(query);       
-        size_t count = query.Gobs.size();        
-        s_engineData->GameLevel->m_activeskyeDome = 
-            (count > 0)? (SkyDome*)query.Gobs[count-1] : NULL;
-    }
-    else if(strcmp(obj->ClassName(),TerrainGob::StaticClassName()) == 0)
-    {
-        TerrainGob* terrain = (TerrainGob*)obj;        
-        auto it = std::find(s_engineData->GameLevel->Terrains.begin(),s_engineData->GameLevel->Terrains.end(),terrain);
-        if(it != s_engineData->GameLevel->Terrains.end())
-        {
-            s_engineData->GameLevel->Terrains.erase(it);
-        }                   
-    }
 
-    RenderContext::Inst()->LightEnvDirty = true;
+    Object* obj = ObjectTable::Inst()->Get(childId);
+    if(obj == NULL)
+        return; // rejected by the bridge.
+    OnChildRemoved(obj);
 }
 
 
@@ -458,7 +560,176 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
 }
 
 
-LVEDRENDERINGENGINE_API bool __stdcall LvEd_RayPick(float viewxform[], float projxform[],Ray* rayW, bool skipSelected, HitRecord** hits, int* count)
+// ray test of a single renderable, the ray and the hit are in world space.
+// returns true if the renderable is hit.
+// note: only reads the scene and the camera so it can run on any thread.
+static bool RayPickRenderable(const RenderableNode& r, const Ray& ray, bool backfaceCull, HitRecord* hit)
+{
+    float t;    // hit distance
+    float3 p;  // hit position
+    float3 n;  // hit normal
+    float3 nearestVertex;
+
+    // perform ray aabb intersection
+    // if passed then perform more complex intersection tests
+    if(!IntersectRayAABB(ray, r.bounds, &t, &p, &n))
+        return false;
+
+    if(r.GetFlag( RenderableNode::kTestAgainstBBoxOnly ))
+    {
+        hit->objectId = r.objectId;
+        hit->index = 0;
+        hit->hitPt = p;
+        hit->normal = n;
+        hit->nearestVertex = float3(0,0,0);
+        hit->distance = t;
+        hit->hasNearestVertex = false;
+        hit->hasNormal = true;
+        return true;
+    }
+
+    Mesh* mesh = r.mesh;
+    if(mesh == NULL)
+        return false;
+
+    Matrix invWorld;
+    Matrix::Invert(r.WorldXform,invWorld);
+
+    // ray in object space.
+    Ray lray;
+    lray.pos = float3::Transform(ray.pos,invWorld);                    
+    lray.direction = normalize( float3::TransformNormal(ray.direction,invWorld) );
+
+    if(mesh->primitiveType == PrimitiveType::TriangleList)
+    {                        
+        bool picked;
+        if(r.primitive != NULL)
+        {
+            // exact test of the shape, the nearest vertex is still taken
+            // from the mesh so vertex snapping works the same.
+            picked = IntersectRayPrimitive(lray, *r.primitive, backfaceCull, &t, &p, &n);
+            if(picked)
+            {
+                nearestVertex = mesh->vertexTree.IsEmpty() ? p
+                              : mesh->vertexTree.GetPoint(mesh->vertexTree.FindNearest(p));
+            }
+        }
+        else
+        {
+            // perform ray tri intersection and return
+            // the closest intersection distance a long lray.direction.
+            picked = MeshIntersects(lray,&mesh->pos[0],
+               (uint32_t)mesh->pos.size(),
+               &mesh->indices[0],
+               (uint32_t)mesh->indices.size(),
+               backfaceCull,
+               &t,
+               &p,
+               &n,
+               &nearestVertex,
+               &mesh->bvh);
+        }
+
+        if(picked)
+        {
+            // intersection point,nor in World space.
+            float3 posW = float3::Transform(p,r.WorldXform);
+            float3 nearestVertexW = float3::Transform(nearestVertex,r.WorldXform);
+            float3 norW = float3::TransformNormal(n, r.WorldXform);
+            // compute dist to intersection point.
+            float dist = length(posW - ray.pos);
+
+            hit->objectId = r.objectId;
+            hit->index = 0;
+            hit->hitPt = posW;
+            hit->normal = norW;
+            hit->nearestVertex = nearestVertexW;
+            hit->distance = dist;
+            hit->hasNormal = true;
+            hit->hasNearestVertex = true;
+        }
+        return picked;
+    }
+    else if(mesh->primitiveType == PrimitiveType::LineStrip)
+    {
+        const float pixelWidth = 5.f;
+
+        uint32_t hitIndex = 0;
+        float distTo, distBetween;
+
+        // we need to adjust distance for screen space calculations
+        // because the ray doesn't start at the camera position
+        float rayOffset = length(RenderContext::Inst()->Cam().CamPos() - ray.pos);
+        float viewportHeight = RenderContext::Inst()->ViewPort().y;
+        float nearRatio = RenderContext::Inst()->Cam().Proj().M22;
+
+        bool picked;
+        if(r.lineSegments != NULL)
+        {
+            // screenBetween < pixelWidth, rearranged so it doesn't depend on the segment.
+            float maxRatio = (2.f * pixelWidth) / (nearRatio * viewportHeight);
+            picked = r.lineSegments->Pick(ray, rayOffset, maxRatio, &distTo, &distBetween, &p, &n, &hitIndex);
+        }
+        else
+        {
+            bool infront = DistanceRayToLineStrip(ray, &mesh->pos[0], (uint32_t)mesh->pos.size(),r.WorldXform,                                         
+                            &distTo, &distBetween, &p, &n, &hitIndex);
+
+            float distCamCenter = distTo + rayOffset;
+            float distToScreenRatio = (nearRatio / distCamCenter) * viewportHeight / 2.f;
+            float screenBetween = distBetween * distToScreenRatio;
+            picked = infront && screenBetween < pixelWidth;
+        }
+
+        if (picked)
+        {
+            hit->objectId = r.objectId;
+            hit->index = hitIndex;
+            hit->hitPt = p;
+            hit->normal = n;
+            hit->distance = distTo;
+            hit->hasNearestVertex = false;
+            hit->hasNormal = true;
+            return true;
+        }
+        return false;
+    }
+
+    assert(0); // unhandled primitive type.
+    ErrorHandler::SetError(ErrorType::UnknownError, L"%s: Unhandled primitive type", __WFUNCTION__);
+    return false;
+}
+
+// ray test of a terrain, the ray and the hit are in world space.
+static bool RayPickTerrain(TerrainGob* terrain, const Ray& ray, HitRecord* hit)
+{
+    if(!terrain->RayPick(ray,hit->hitPt,hit->normal,hit->nearestVertex))
+        return false;
+
+    hit->index = 0;
+    hit->objectId = terrain->GetInstanceId();
+    hit->distance = length(ray.pos - hit->hitPt);
+    hit->hasNormal = true;
+    hit->hasNearestVertex = true;            
+    return true;
+}
+
+static bool PickCandidateSorting(const PickCandidate& c1, const PickCandidate& c2)
+{
+    return c1.entryDist < c2.entryDist;
+}
+
+// line strips are hit within a few pixels of the line,
+// which can be closer than the entry point of their bounds.
+static bool IsPickedByLineDistance(const RenderableNode& r)
+{
+    return r.mesh != NULL 
+        && r.mesh->primitiveType == PrimitiveType::LineStrip
+        && !r.GetFlag(RenderableNode::kTestAgainstBBoxOnly);
+}
+
+LVEDRENDERINGENGINE_API bool __stdcall LvEd_RayPick(float viewxform[], float projxform[],Ray* rayW, bool skipSelected,
+    bool closestHitOnly, float maxDist, HitRecord** hits, int* count)
 {
     ErrorHandler::ClearError();
     if(s_engineData->GameLevel == NULL)
@@ -482,148 +753,97 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
     s_engineData->pickCollector.SetFlags( RenderContext::Inst()->State()->GetGlobalRenderFlags() );
     s_engineData->pickCollector.SetSkipSelected(skipSelected);
 
-    s_engineData->GameLevel->GetRenderables(&s_engineData->pickCollector, RenderContext::Inst());
-    
+    // only collect the objects whose bounds are hit by the ray.
+    s_engineData->GameLevel->GetRenderables(ray, &s_engineData->pickCollector, RenderContext::Inst());
+    RenderNodeList& renderables = s_engineData->pickCollector.GetList();
 
-    s_engineData->HitRecords.clear();
-    for(auto it = s_engineData->pickCollector.GetList().begin(); it != s_engineData->pickCollector.GetList().end(); it++)
+    std::vector<HitRecord>& hitRecords = s_engineData->HitRecords;
+    hitRecords.clear();
+    if(closestHitOnly)
     {
-        RenderableNode& r = (*it);
-        AABB boundingBox = r.bounds;
-
-        float t;    // hit distance
-        float3 p;  // hit position
-        float3 n;  // hit normal
-        float3 nearestVertex;
+        // pick the terrains first, they usually clip most of the objects.
+        HitRecord best;
+        bool picked = false;
+        best.distance = maxDist;
+        for(auto it = s_engineData->GameLevel->Terrains.begin(); it != s_engineData->GameLevel->Terrains.end(); it++)
+        {
+            HitRecord hitrec;
+            if(RayPickTerrain(*it, ray, &hitrec) && hitrec.distance <= best.distance)
+            {
+                best = hitrec;
+                picked = true;
+            }
+        }
 
-        // perform ray aabb intersection
-        // if passed then perform more complex intersection tests
-        if(IntersectRayAABB(ray, boundingBox, &t, &p, &n))
+        // bounds entry distance is a lower bound of the hit distance.
+        // note: the distance of bbox only hits is in ray units, the distance of mesh hits
+        //       is in world units, so use the smallest of the two.
+        float distScale = minimize(length(ray.direction), 1.0f);
+        std::vector<PickCandidate>& candidates = s_engineData->pickCandidates;
+        candidates.clear();
+        for(uint32_t i = 0; i < (uint32_t)renderables.size(); i++)
         {
-            if(it->GetFlag( RenderableNode::kTestAgainstBBoxOnly ))
+            float t;
+            float3 p, n;
+            if(IntersectRayAABB(ray, renderables[i].bounds, &t, &p, &n))
             {
-                HitRecord hit;
-                hit.objectId = r.objectId;
-                hit.index = 0;
-                hit.hitPt = p;
-                hit.normal = n;
-                hit.nearestVertex = float3(0,0,0);
-                hit.distance = t;
-                hit.hasNearestVertex = false;
-                hit.hasNormal = true;
-
-                s_engineData->HitRecords.push_back(hit);
+                PickCandidate candidate;
+                candidate.entryDist = IsPickedByLineDistance(renderables[i]) ? 0.0f : t * distScale;
+                candidate.index = i;
+                candidates.push_back(candidate);
             }
-            else
+        }
+        std::sort(candidates.begin(), candidates.end(), PickCandidateSorting);
+
+        for(auto it = candidates.begin(); it != candidates.end(); it++)
+        {
+            // the remaining candidates can't be closer.
+            if(it->entryDist > best.distance)
+                break;
+
+            HitRecord hit;
+            if(RayPickRenderable(renderables[it->index], ray, backfaceCull, &hit) && hit.distance <= best.distance)
             {
-                Mesh* mesh = it->mesh;
-                if(mesh != NULL)
+                if(!picked || hit.distance < best.distance)
                 {
-                    Matrix invWorld;
-                    Matrix::Invert(it->WorldXform,invWorld);
-
-                    // ray in object space.
-                    Ray lray;
-                    lray.pos = float3::Transform(ray.pos,invWorld);                    
-                    lray.direction = normalize( float3::TransformNormal(ray.direction,invWorld) );
-
-                    if(mesh->primitiveType == PrimitiveType::TriangleList)
-                    {                        
-                        // perform ray tri intersection and return
-                        // the closest intersection distance a long lray.direction.
-                        bool picked = MeshIntersects(lray,&mesh->pos[0],
-                           (uint32_t)mesh->pos.size(),
-                           &mesh->indices[0],
-                           (uint32_t)mesh->indices.size(),
-                           backfaceCull,
-                           &t,
-                           &p,
-                           &n,
-                           &nearestVertex);
-
-                        if(picked)
-                        {
-                            // intersection point,nor in World space.
-                            float3 posW = float3::Transform(p,it->WorldXform);
-                            float3 nearestVertexW = float3::Transform(nearestVertex,it->WorldXform);
-                            float3 norW = float3::TransformNormal(n, it->WorldXform);
-                            // compute dist to intersection point.
-                            float dist = length(posW - ray.pos);
-
-                            HitRecord hit;
-                            hit.objectId = r.objectId;
-                            hit.index = 0;
-                            hit.hitPt = posW;
-                            hit.normal = norW;
-                            hit.nearestVertex = nearestVertexW;
-                            hit.distance = dist;
-                            hit.hasNormal = true;
-                            hit.hasNearestVertex = true;
-                            s_engineData->HitRecords.push_back(hit);
-                        }
-                    }
-                    else if(mesh->primitiveType == PrimitiveType::LineStrip)
-                    {
-                        const float pixelWidth = 5.f;
-
-                        uint32_t hitIndex = 0;
-                        float distTo, distBetween;
-                        bool infront = DistanceRayToLineStrip(ray, &mesh->pos[0], (uint32_t)mesh->pos.size(),it->WorldXform,                                         
-                                        &distTo, &distBetween, &p, &n, &hitIndex);
-
-                        // we need to adjust distance for screen space calculations
-                        // because the ray doesn't start at the camera position
-                        float distCamCenter = distTo + length(RenderContext::Inst()->Cam().CamPos() - ray.pos);
-
-                        float viewportHeight = RenderContext::Inst()->ViewPort().y;
-                        float nearRatio = RenderContext::Inst()->Cam().Proj().M22;
-                        float distToScreenRatio = (nearRatio / distCamCenter) * viewportHeight / 2.f;
-                        float screenBetween = distBetween * distToScreenRatio;
-
-                        if (infront && screenBetween < pixelWidth)
-                        {
-                            HitRecord hit;
-                            hit.objectId = r.objectId;
-                            hit.index = hitIndex;
-                            hit.hitPt = p;
-                            hit.normal = n;
-                            hit.distance = distTo;
-                            hit.hasNearestVertex = false;
-                            hit.hasNormal = true;
-                            s_engineData->HitRecords.push_back(hit);
-                        }
-                    }
-                    else
-                    {
-                        assert(0); // unhandled primitive type.
-                        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: Unhandled primitive type", __WFUNCTION__);
-                    }
+                    best = hit;
+                    picked = true;
                 }
             }
         }
-    }
 
-    
-    for(auto it = s_engineData->GameLevel->Terrains.begin(); it != s_engineData->GameLevel->Terrains.end(); it++)
-    {
-        HitRecord hitrec;
-        if((*it)->RayPick(ray,hitrec.hitPt,hitrec.normal,hitrec.nearestVertex))
+        if(picked)
         {
-            hitrec.index = 0;
-            hitrec.objectId = (*it)->GetInstanceId();
-            hitrec.distance = length(ray.pos - hitrec.hitPt);
-            hitrec.hasNormal = true;
-            hitrec.hasNearestVertex = true;            
-            s_engineData->HitRecords.push_back(hitrec);
+            hitRecords.push_back(best);
         }
     }
+    else
+    {
+        for(auto it = renderables.begin(); it != renderables.end(); it++)
+        {
+            HitRecord hit;
+            if(RayPickRenderable(*it, ray, backfaceCull, &hit) && hit.distance <= maxDist)
+            {
+                hitRecords.push_back(hit);
+            }
+        }
+
+        for(auto it = s_engineData->GameLevel->Terrains.begin(); it != s_engineData->GameLevel->Terrains.end(); it++)
+        {
+            HitRecord hitrec;
+            if(RayPickTerrain(*it, ray, &hitrec) && hitrec.distance <= maxDist)
+            {
+                hitRecords.push_back(hitrec);
+            }
+        }
 
+        std::sort(hitRecords.begin(), hitRecords.end(), HitRecordSorting);
+    }
 
-    if(s_engineData->HitRecords.size() > 0)
+    if(hitRecords.size() > 0)
     {
-        std::sort(s_engineData->HitRecords.begin(), s_engineData->HitRecords.end(), HitRecordSorting);
-        *hits = &s_engineData->HitRecords[0];
-        *count = (int)s_engineData->HitRecords.size();
+        *hits = &hitRecords[0];
+        *count = (int)hitRecords.size();
     }
     else
     {
@@ -636,6 +856,209 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
 }
 
 
+// finds the hits of a single ray for LvEd_RayPickBatch.
+// called by the bvh of the candidate renderables.
+struct RayPickBatchVisitor
+{
+    const RenderNodeList* candidates;
+    const Ray* ray;
+    bool backfaceCull;
+    bool closestHitOnly;
+    float maxDist;      // max hit distance.
+    float invDirLength; // converts hit distance to ray parameter.
+    std::vector<HitRecord>* hits;
+    size_t firstHit;    // first hit of this ray in hits.
+
+    void Add(const HitRecord& hit, float* maxT)
+    {
+        if(hit.distance > maxDist)
+            return;
+
+        if(!closestHitOnly)
+        {
+            hits->push_back(hit);
+            return;
+        }
+
+        if(hits->size() > firstHit)
+        {
+            if(hit.distance >= (*hits)[firstHit].distance)
+                return;
+            (*hits)[firstHit] = hit;
+        }
+        else
+        {
+            hits->push_back(hit);
+        }
+
+        // no need to visit the candidates that are farther.
+        maxDist = hit.distance;
+        if(maxT)
+            *maxT = hit.distance * invDirLength;
+    }
+
+    void operator()(uint32_t index, float* maxT)
+    {
+        HitRecord hit;
+        if(RayPickRenderable((*candidates)[index], *ray, backfaceCull, &hit))
+        {
+            Add(hit, maxT);
+        }
+    }
+};
+
+// picks a group of consecutive rays for LvEd_RayPickBatch.
+class RayPickBatchJob : public ParallelJob
+{
+public:
+    static const uint32_t RaysPerChunk = 16;
+
+    const Ray* rays;
+    const float* maxDists;
+    uint32_t rayCount;
+    bool closestHitOnly;
+    bool backfaceCull;
+    const RenderNodeList* candidates;
+    const BVH* candidateTree;
+    const std::vector<TerrainGob*>* terrains;
+    std::vector<RayPickBatchChunk>* chunks;
+
+    virtual void Execute(uint32_t chunkIndex)
+    {
+        RayPickBatchChunk& chunk = (*chunks)[chunkIndex];
+        chunk.hits.clear();
+        chunk.counts.clear();
+
+        uint32_t first = chunkIndex * RaysPerChunk;
+        uint32_t end = std::min(first + RaysPerChunk, rayCount);
+        for(uint32_t i = first; i < end; i++)
+        {
+            const Ray& ray = rays[i];
+            float dirLength = length(ray.direction);
+            if(dirLength == 0.0f)
+            {
+                chunk.counts.push_back(0);
+                continue;
+            }
+
+            RayPickBatchVisitor visitor;
+            visitor.candidates = candidates;
+            visitor.ray = &ray;
+            visitor.backfaceCull = backfaceCull;
+            visitor.closestHitOnly = closestHitOnly;
+            visitor.maxDist = maxDists ? maxDists[i] : FLT_MAX;
+            visitor.invDirLength = 1.0f / dirLength;
+            visitor.hits = &chunk.hits;
+            visitor.firstHit = chunk.hits.size();
+
+            // terrains first, so they can clip the objects behind them.
+            for(auto it = terrains->begin(); it != terrains->end(); it++)
+            {
+                HitRecord hit;
+                if(RayPickTerrain(*it, ray, &hit))
+                {
+                    visitor.Add(hit, NULL);
+                }
+            }
+
+            float maxT = visitor.maxDist < FLT_MAX ? visitor.maxDist * visitor.invDirLength : FLT_MAX;
+            candidateTree->RayQuery(ray, &maxT, visitor);
+
+            if(!closestHitOnly)
+            {
+                std::sort(chunk.hits.begin() + visitor.firstHit, chunk.hits.end(), HitRecordSorting);
+            }
+            chunk.counts.push_back((int)(chunk.hits.size() - visitor.firstHit));
+        }
+    }
+};
+
+LVEDRENDERINGENGINE_API bool __stdcall LvEd_RayPickBatch(float viewxform[], float projxform[], Ray* rays, float* maxDists, int rayCount,
+    bool closestHitOnly, bool skipSelected, HitRecord** hits, int** hitOffsets, int* hitCount)
+{
+    ErrorHandler::ClearError();
+    *hits = 0;
+    *hitOffsets = 0;
+    *hitCount = 0;
+    if(s_engineData->GameLevel == NULL)
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: no GameLevel set", __WFUNCTION__);
+        return false;
+    }
+    if(rayCount < 0 || (rayCount > 0 && rays == NULL))
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: invalid ray array", __WFUNCTION__);
+        return false;
+    }
+
+    Matrix view = viewxform;
+    Matrix proj = projxform;
+
+    GlobalRenderFlagsEnum flags = RenderContext::Inst()->State()->GetGlobalRenderFlags();
+    bool backfaceCull = !((flags & GlobalRenderFlags::RenderBackFace) == GlobalRenderFlags::RenderBackFace);
+
+    RenderContext::Inst()->Cam().SetViewProj(view,proj);
+
+    // collect the candidates once for all the rays,
+    // same renderables as LvEd_RayPick() before culling them by the ray.
+    RenderableNodeSet& collector = s_engineData->pickCollector;
+    collector.ClearLists();
+    collector.SetFlags( flags );
+    collector.SetSkipSelected(skipSelected);
+    s_engineData->GameLevel->GetRenderables(&collector, RenderContext::Inst());
+
+    RenderNodeList& candidates = collector.GetList();
+    std::vector<AABB>& bounds = s_engineData->pickBatchBounds;
+    bounds.resize(candidates.size());
+    for(size_t i = 0; i < candidates.size(); i++)
+    {
+        // empty bounds can't be hit, but they would break the tree.
+        const AABB& box = candidates[i].bounds;
+        bool empty = box.Min().x > box.Max().x || box.Min().y > box.Max().y || box.Min().z > box.Max().z;
+        bounds[i] = empty ? AABB(float3(0,0,0), float3(0,0,0)) : box;
+    }
+    s_engineData->pickBatchTree.Build(bounds.empty() ? NULL : &bounds[0], (uint32_t)bounds.size());
+
+    // split the rays across the worker threads.
+    uint32_t chunkCount = ((uint32_t)rayCount + RayPickBatchJob::RaysPerChunk - 1) / RayPickBatchJob::RaysPerChunk;
+    if(s_engineData->pickBatchChunks.size() < chunkCount)
+        s_engineData->pickBatchChunks.resize(chunkCount);
+
+    RayPickBatchJob job;
+    job.rays = rays;
+    job.maxDists = maxDists;
+    job.rayCount = (uint32_t)rayCount;
+    job.closestHitOnly = closestHitOnly;
+    job.backfaceCull = backfaceCull;
+    job.candidates = &candidates;
+    job.candidateTree = &s_engineData->pickBatchTree;
+    job.terrains = &s_engineData->GameLevel->Terrains;
+    job.chunks = &s_engineData->pickBatchChunks;
+    WorkerPool::Inst()->ParallelFor(&job, chunkCount);
+
+    // merge the hits of all the chunks in ray order.
+    std::vector<HitRecord>& hitRecords = s_engineData->BatchHitRecords;
+    std::vector<int>& offsets = s_engineData->BatchHitOffsets;
+    hitRecords.clear();
+    offsets.resize(rayCount + 1);
+    offsets[0] = 0;
+    for(uint32_t c = 0; c < chunkCount; c++)
+    {
+        RayPickBatchChunk& chunk = s_engineData->pickBatchChunks[c];
+        uint32_t firstRay = c * RayPickBatchJob::RaysPerChunk;
+        for(size_t r = 0; r < chunk.counts.size(); r++)
+        {
+            offsets[firstRay + r + 1] = offsets[firstRay + r] + chunk.counts[r];
+        }
+        hitRecords.insert(hitRecords.end(), chunk.hits.begin(), chunk.hits.end());
+    }
+
+    *hits = hitRecords.empty() ? 0 : &hitRecords[0];
+    *hitOffsets = &offsets[0];
+    *hitCount = (int)hitRecords.size();
+    return *hitCount > 0;
+}
+
 LVEDRENDERINGENGINE_API bool __stdcall LvEd_FrustumPick(ObjectGUID renderSurface, float viewxform[], float projxform[],float* rect, HitRecord** hits, int* count)
 {
     ErrorHandler::ClearError();
@@ -655,13 +1078,14 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
     Matrix proj = projxform;
     RenderContext::Inst()->Cam().SetViewProj(view,proj);  
     
-    // same code used for rendering.
-    s_engineData->pickCollector.ClearLists();
-    s_engineData->pickCollector.SetFlags( RenderContext::Inst()->State()->GetGlobalRenderFlags() );
-
-    s_engineData->GameLevel->GetRenderables(&s_engineData->pickCollector, RenderContext::Inst());
-   
-    RenderSurface* pRenderSurface = reinterpret_cast<RenderSurface*>(renderSurface);
+    RenderSurface* pRenderSurface = ObjectTable::Inst()->GetAs<RenderSurface>(renderSurface);
+    if(pRenderSurface == NULL || s_engineData->GameLevel == NULL)
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError,
+                L"%s: RenderSurface is 0x%x and GameLevel is 0x%x but they both must be non-NULL",
+                __WFUNCTION__, pRenderSurface, s_engineData->GameLevel);
+        return false;
+    }
 
     float3 corners[8];
     float x0 = rect[0];
@@ -670,32 +1094,65 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
     float y1 = y0 + h;       
            
     Matrix viewProj = view * proj;
-    Matrix invWVP; // inverse of world view projection matrix.
+
+    // frustum in world space, it is built once and transformed
+    // into the local space of the objects that need a mesh test.
+    {
+        Matrix invVP = viewProj;
+        invVP.Invert();
+        corners[0] = pRenderSurface->Unproject(float3(x0,y1,0),invVP);
+        corners[4] = pRenderSurface->Unproject(float3(x0,y1,1),invVP);
+        corners[1] = pRenderSurface->Unproject(float3(x1,y1,0),invVP);
+        corners[5] = pRenderSurface->Unproject(float3(x1,y1,1),invVP);
+        corners[2] = pRenderSurface->Unproject(float3(x1,y0,0),invVP);
+        corners[6] = pRenderSurface->Unproject(float3(x1,y0,1),invVP);
+        corners[3] = pRenderSurface->Unproject(float3(x0,y0,0),invVP);
+        corners[7] = pRenderSurface->Unproject(float3(x0,y0,1),invVP);
+    }
+    Frustum pickFrustumW;
+    pickFrustumW.InitFromCorners(corners);
+
+    // same code used for rendering.
+    s_engineData->pickCollector.ClearLists();
+    s_engineData->pickCollector.SetFlags( RenderContext::Inst()->State()->GetGlobalRenderFlags() );
+
+    s_engineData->GameLevel->GetRenderables(pickFrustumW, &s_engineData->pickCollector, RenderContext::Inst());
+    RenderNodeList& renderables = s_engineData->pickCollector.GetList();
+
+    // coarse test, the world bounds of all the meshes are tested at once.
+    AABBStream& boxes = s_engineData->pickBoxes;
+    boxes.Clear();
+    for(auto it = renderables.begin(); it != renderables.end(); it++)
+    {
+        RenderableNode& r = (*it);
+        if(r.mesh == NULL) continue;
+        AABB box = r.mesh->bounds;
+        box.Transform(r.WorldXform);
+        boxes.Add(box);
+    }
+    std::vector<uint8_t>& boxResults = s_engineData->pickBoxResults;
+    boxResults.resize(boxes.GetCount());
+    if(!boxes.IsEmpty())
+        boxes.FrustumIntersect(pickFrustumW, &boxResults[0]);
+
     s_engineData->HitRecords.clear();
     float3 zeroVector(0,0,0);
     Frustum fr; // frustum in local space.
-    for(auto it = s_engineData->pickCollector.GetList().begin(); it != s_engineData->pickCollector.GetList().end(); it++)
+    uint32_t boxIndex = 0;
+    for(auto it = renderables.begin(); it != renderables.end(); it++)
     {
         RenderableNode& r = (*it);
         if(r.mesh == NULL) continue;
 
-        invWVP = r.WorldXform * viewProj;
-        invWVP.Invert();
-
-        corners[0] = pRenderSurface->Unproject(float3(x0,y1,0),invWVP);
-        corners[4] = pRenderSurface->Unproject(float3(x0,y1,1),invWVP);
-
-        corners[1] = pRenderSurface->Unproject(float3(x1,y1,0),invWVP);
-        corners[5] = pRenderSurface->Unproject(float3(x1,y1,1),invWVP);
-
-        corners[2] = pRenderSurface->Unproject(float3(x1,y0,0),invWVP);
-        corners[6] = pRenderSurface->Unproject(float3(x1,y0,1),invWVP);
-
-        corners[3] = pRenderSurface->Unproject(float3(x0,y0,0),invWVP);
-        corners[7] = pRenderSurface->Unproject(float3(x0,y0,1),invWVP);
-        fr.InitFromCorners(corners);
+        // the local test is only needed when the world bounds intersect the frustum,
+        // if they are completely inside the mesh is inside too.
+        int test = boxResults[boxIndex++];
+        if(test == 1)
+        {
+            fr.InitFromWorld(pickFrustumW, r.WorldXform);
+            test = FrustumAABBIntersect(fr,r.mesh->bounds);
+        }
 
-        int test = FrustumAABBIntersect(fr,r.mesh->bounds);                
         if(test)
         {
             if(test == 1 
@@ -704,15 +1161,22 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
                 && r.mesh->primitiveType == PrimitiveType::TriangleList)
             {
                 Mesh* mesh = r.mesh;
-               
-                Triangle tr;                
-                bool triHit = FrustumMeshIntersect(fr, 
-                     &mesh->pos[0],
-                   (uint32_t)mesh->pos.size(),
-                   &mesh->indices[0],
-                   (uint32_t)mesh->indices.size());
-                
-                if( triHit == false) continue;               
+
+                // the analytic shape decides unless the test is not conclusive.
+                int shapeTest = r.primitive != NULL ? FrustumPrimitiveIntersect(fr, *r.primitive) : 1;
+                if(shapeTest == 0) continue;
+
+                if(shapeTest == 1)
+                {
+                    bool triHit = FrustumMeshIntersect(fr, 
+                         &mesh->pos[0],
+                       (uint32_t)mesh->pos.size(),
+                       &mesh->indices[0],
+                       (uint32_t)mesh->indices.size(),
+                       &mesh->bvh);
+
+                    if( triHit == false) continue;               
+                }
             }
             
             HitRecord hit;
@@ -737,15 +1201,167 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
     return *count > 0;
 }
 
-LVEDRENDERINGENGINE_API void __stdcall LvEd_SetSelection(ObjectGUID*  instanceIds, int count)
+// finds the vertex of a mesh that is the closest to the ray in screen space.
+// called by KdTree::RayQuery() with the vertices that are close enough to the ray in local space.
+struct NearestVertexVisitor
+{
+    const KdTree* tree;
+    const Matrix* world;
+    const Ray* ray;         // in world space with normalized direction.
+    const Camera* cam;
+    float viewportHeight;
+    float pixelRadius;
+
+    bool found;
+    float bestPixels;       // distance to the ray in pixels.
+    float bestDist;         // distance along the ray.
+    float3 bestVertex;
+    ObjectGUID bestObject;
+    ObjectGUID objectId;
+
+    void operator()(uint32_t index)
+    {
+        float3 posW = float3::Transform(tree->GetPoint(index), *world);
+        float3 v = posW - ray->pos;
+        float t = dot(v, ray->direction);
+        if(t < 0.0f) return;
+
+        float distToRay = sqrt(maximize(lengthsquared(v) - t * t, 0.0f));
+        float upp = cam->ComputeUnitPerPixel(posW, viewportHeight);
+        if(upp <= 0.0f) return;
+        float pixels = distToRay / upp;
+        if(pixels > pixelRadius) return;
+
+        if(!found || pixels < bestPixels || (pixels == bestPixels && t < bestDist))
+        {
+            found = true;
+            bestPixels = pixels;
+            bestDist = t;
+            bestVertex = posW;
+            bestObject = objectId;
+        }
+    }
+};
+
+LVEDRENDERINGENGINE_API bool __stdcall LvEd_FindNearestVertex(float viewxform[], float projxform[], Ray* rayW,
+    float pixelRadius, bool skipSelected, HitRecord* hit)
 {
     ErrorHandler::ClearError();
-    RenderContext::Inst()->selection.clear();
+    if(s_engineData->GameLevel == NULL)
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: no GameLevel set", __WFUNCTION__);
+        return false;
+    }
+
+    float4 viewport = RenderContext::Inst()->ViewPort();
+    if(pixelRadius <= 0 || viewport.x <= 0 || viewport.y <= 0)
+    {
+        return false;
+    }
+
+    Matrix view = viewxform;
+    Matrix proj = projxform;
+    Camera& cam = RenderContext::Inst()->Cam();
+    cam.SetViewProj(view,proj);
+
+    Ray ray;
+    ray.pos = rayW->pos;
+    ray.direction = normalize(rayW->direction);
 
-    for(int i = 0; i < count; i++)
+    // broad phase in screen space, the frustum of the square of pixelRadius around the ray.
+    Matrix viewProj = view * proj;
+    Matrix invVP = viewProj;
+    invVP.Invert();
+    float3 center = float3::Transform(ray.pos + ray.direction * (0.5f * cam.FarZ()), viewProj);
+    float rx = 2.0f * pixelRadius / viewport.x;
+    float ry = 2.0f * pixelRadius / viewport.y;
+    float3 corners[8];
+    corners[0] = float3::Transform(float3(center.x - rx, center.y - ry, 0), invVP);
+    corners[1] = float3::Transform(float3(center.x + rx, center.y - ry, 0), invVP);
+    corners[2] = float3::Transform(float3(center.x + rx, center.y + ry, 0), invVP);
+    corners[3] = float3::Transform(float3(center.x - rx, center.y + ry, 0), invVP);
+    corners[4] = float3::Transform(float3(center.x - rx, center.y - ry, 1), invVP);
+    corners[5] = float3::Transform(float3(center.x + rx, center.y - ry, 1), invVP);
+    corners[6] = float3::Transform(float3(center.x + rx, center.y + ry, 1), invVP);
+    corners[7] = float3::Transform(float3(center.x - rx, center.y + ry, 1), invVP);
+    Frustum snapFrustum;
+    snapFrustum.InitFromCorners(corners);
+
+    s_engineData->pickCollector.ClearLists();
+    s_engineData->pickCollector.SetFlags( RenderContext::Inst()->State()->GetGlobalRenderFlags() );
+    s_engineData->pickCollector.SetSkipSelected(skipSelected);
+    s_engineData->GameLevel->GetRenderables(snapFrustum, &s_engineData->pickCollector, RenderContext::Inst());
+    RenderNodeList& renderables = s_engineData->pickCollector.GetList();
+
+    NearestVertexVisitor visitor;
+    visitor.ray = &ray;
+    visitor.cam = &cam;
+    visitor.viewportHeight = viewport.y;
+    visitor.pixelRadius = pixelRadius;
+    visitor.found = false;
+    visitor.bestPixels = FLT_MAX;
+    visitor.bestDist = FLT_MAX;
+    visitor.bestObject = 0;
+
+    for(auto it = renderables.begin(); it != renderables.end(); it++)
     {
-        RenderContext::Inst()->selection.insert(instanceIds[i]);
+        RenderableNode& r = (*it);
+        if(r.mesh == NULL 
+            || r.mesh->vertexTree.IsEmpty()
+            || r.GetFlag(RenderableNode::kTestAgainstBBoxOnly))
+        {
+            continue;
+        }
+
+        // pixelRadius in world units at the farthest point of the bounds.
+        AABB box = r.mesh->bounds;
+        box.Transform(r.WorldXform);
+        float3 boxCorners[8];
+        box.Corners(boxCorners);
+        float upp = 0;
+        for(int i = 0; i < 8; i++)
+        {
+            upp = maximize(upp, cam.ComputeUnitPerPixel(boxCorners[i], viewport.y));
+        }
+        float radiusW = pixelRadius * upp;
+
+        // a world space distance is at most scaled by the norm of invWorld in local space.
+        Matrix invWorld;
+        Matrix::Invert(r.WorldXform,invWorld);
+        float norm = sqrt(invWorld.M11 * invWorld.M11 + invWorld.M12 * invWorld.M12 + invWorld.M13 * invWorld.M13
+                        + invWorld.M21 * invWorld.M21 + invWorld.M22 * invWorld.M22 + invWorld.M23 * invWorld.M23
+                        + invWorld.M31 * invWorld.M31 + invWorld.M32 * invWorld.M32 + invWorld.M33 * invWorld.M33);
+
+        // ray in object space, the direction is not normalized
+        // so the ray covers the same points as in world space.
+        Ray lray;
+        lray.pos = float3::Transform(ray.pos,invWorld);
+        lray.direction = float3::TransformNormal(ray.direction,invWorld);
+
+        visitor.tree = &r.mesh->vertexTree;
+        visitor.world = &r.WorldXform;
+        visitor.objectId = r.objectId;
+        r.mesh->vertexTree.RayQuery(lray, radiusW * norm, visitor);
     }
+
+    if(!visitor.found)
+        return false;
+
+    hit->objectId = visitor.bestObject;
+    hit->index = 0;
+    hit->hitPt = visitor.bestVertex;
+    hit->normal = float3(0,0,0);
+    hit->nearestVertex = visitor.bestVertex;
+    hit->distance = visitor.bestDist;
+    hit->hasNormal = false;
+    hit->hasNearestVertex = true;
+    return true;
+}
+
+LVEDRENDERINGENGINE_API void __stdcall LvEd_SetSelection(ObjectGUID*  instanceIds, int count)
+{
+    ErrorHandler::ClearError();
+    ObjectTable::Inst()->SetSelection(instanceIds, count);
 }
 
 //===============================================================================
@@ -755,7 +1371,12 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
 LVEDRENDERINGENGINE_API void __stdcall LvEd_SetRenderState(ObjectGUID instId)
 {
     ErrorHandler::ClearError();
-    RenderState* renderState = reinterpret_cast<RenderState*>(instId);    
+    RenderState* renderState = ObjectTable::Inst()->GetAs<RenderState>(instId);
+    if(renderState == NULL)
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: 0x%llx is not a RenderState", __WFUNCTION__, instId);
+        return;
+    }
     RenderContext::Inst()->SetState(renderState);
 }
 
@@ -764,7 +1385,11 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
     ErrorHandler::ClearError();
     if(instId != 0)
     {
-        GameLevel* gameLevel = reinterpret_cast<GameLevel*>(instId);
+        GameLevel* gameLevel = ObjectTable::Inst()->GetAs<GameLevel>(instId);
+        if(gameLevel == NULL)
+        {
+            ErrorHandler::SetError(ErrorType::UnknownError, L"%s: 0x%llx is not a GameLevel", __WFUNCTION__, instId);
+        }
         s_engineData->GameLevel = gameLevel;
     }
     else
@@ -787,7 +1412,20 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
 LVEDRENDERINGENGINE_API void __stdcall LvEd_Update(FrameTime* ft, UpdateTypeEnum updateType)
 {    
     ErrorHandler::ClearError();    
+    TransformStore::Inst()->UpdateWorld();
+    LightingState::Inst()->BeginUpdate();
+    GameObjectGroup::Debug_ResetBoundsStats();
     s_engineData->GameLevel->Update(*ft, updateType);  
+#ifdef _DEBUG
+    // nodes touched by the bounds refit of the edits since the last update.
+    uint32_t queued, merged, propagated;
+    GameObjectGroup::Debug_GetBoundsStats(queued, merged, propagated);
+    if(queued > 0)
+    {
+        Logger::Log(OutputMessageType::Debug, "bounds refit: %u children queued, %u merged, %u groups propagated\n",
+            queued, merged, propagated);
+    }
+#endif
 	ShaderLib::Inst()->Update(*ft, updateType);
 }
 
@@ -795,7 +1433,12 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
 {
     ErrorHandler::ClearError();
     
-    s_engineData->pRenderSurface = reinterpret_cast<RenderSurface*>(renderSurface);
+    s_engineData->pRenderSurface = ObjectTable::Inst()->GetAs<RenderSurface>(renderSurface);
+    if(s_engineData->pRenderSurface == NULL)
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: 0x%llx is not a RenderSurface", __WFUNCTION__, renderSurface);
+        return;
+    }
 
     RenderContext* rc = RenderContext::Inst();
 
@@ -837,7 +1480,7 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
     light.dir = float3(0.258819073f, -0.965925932f, 0.0f);
     
     d3dcontext->ClearDepthStencilView( s_engineData->pRenderSurface->GetDepthStencilView(), D3D11_CLEAR_DEPTH, 1.0f, 0 );
-    if(s_engineData->GameLevel->m_activeskyeDome && s_engineData->GameLevel->m_activeskyeDome->GetVisible())
+    if(s_engineData->GameLevel && s_engineData->GameLevel->m_activeskyeDome && s_engineData->GameLevel->m_activeskyeDome->GetVisible())
     {
         s_engineData->GameLevel->m_activeskyeDome->Render(RenderContext::Inst());
     }
@@ -854,11 +1497,6 @@ bool HitRecordSorting(const HitRecord& n1, const HitRecord& n2)
         RenderContext::Inst()->Cam().Proj());
 }
 
-bool NodeSortGreater(const RenderableNode& n1, const RenderableNode& n2)
-{    
-    return n1.Distance > n2.Distance;
-}
-
 
 // ---------------------------------------------------------------------------------------------------------
 LVEDRENDERINGENGINE_API void __stdcall LvEd_RenderGame()
@@ -882,24 +1520,9 @@ bool NodeSortGreater(const RenderableNode& n1, const RenderableNode& n2)
     s_engineData->renderableSorter.SetFlags( flags );
     s_engineData->GameLevel->GetRenderables(&s_engineData->renderableSorter, RenderContext::Inst());
    
-    // sort semi-transparent objects back to front
-     for(unsigned int i = 0; i < s_engineData->renderableSorter.GetBucketCount(); ++i)
-     {
-         RenderableNodeSorter::Bucket& bucket = *s_engineData->renderableSorter.GetBucket(i);         
-         if (bucket.renderables.size() > 0  && (bucket.renderFlags & RenderFlags::AlphaBlend))
-         {
-             // compute dist along camera's view vector.         
-             float3 camLook  = RenderContext::Inst()->Cam().CamLook();
-             float3 camPos   = RenderContext::Inst()->Cam().CamPos();
-             for(auto it = bucket.renderables.begin(); it != bucket.renderables.end(); it++)
-             {
-                  RenderableNode& r = (*it);
-                  float3 viewVec = r.bounds.GetCenter() - camPos;
-                  r.Distance =  dot(camLook, viewVec);                  
-             }             
-             std::sort(bucket.renderables.begin(),bucket.renderables.end(),NodeSortGreater);             
-         }
-     }          
+    // group the nodes into buckets and sort the semi-transparent objects back to front
+    s_engineData->renderableSorter.Sort();
+
      bool renderShadows = (flags & GlobalRenderFlags::Shadows) != 0;
      ShadowMaps::Inst()->SetEnabled(renderShadows);
     //  Pre-Pass For Shadow Maps    
@@ -1057,6 +1680,12 @@ static void RenderWorldAxis()
 {
     RenderContext* rc = RenderContext::Inst();
     RenderSurface* surface = s_engineData->pRenderSurface;
+    if(surface == NULL)
+    {
+        // LvEd_Begin() failed and has set the error, there is nothing to present.
+        s_engineData->renderableSorter.ClearLists();
+        return;
+    }
 
     s_engineData->basicRenderer->End();    
     LineRenderer::Inst()->RenderAll(rc);
@@ -1073,7 +1702,6 @@ static void RenderWorldAxis()
 
     s_engineData->renderableSorter.ClearLists();    
     s_engineData->pRenderSurface = NULL;    
-    RenderContext::Inst()->LightEnvDirty = false; 
 }
 
 LVEDRENDERINGENGINE_API bool __stdcall LvEd_SaveRenderSurfaceToFile(ObjectGUID renderSurfaceId, wchar_t *fileName)
@@ -1087,8 +1715,13 @@ static void RenderWorldAxis()
     }
 
     DirectX::ScratchImage scratchImg; 
-    RenderSurface* renderSurface = reinterpret_cast<RenderSurface*>(renderSurfaceId);
-    
+    RenderSurface* renderSurface = ObjectTable::Inst()->GetAs<RenderSurface>(renderSurfaceId);
+    if(renderSurface == NULL)
+    {
+        ErrorHandler::SetError(ErrorType::UnknownError, L"%s: invalid render surface id", __WFUNCTION__);
+        return false;
+    }
+
     HRESULT hr = CaptureTexture(gD3D11->GetDevice(),::gD3D11->GetImmediateContext(),
         (ID3D11Resource*)renderSurface->GetColorBuffer()->GetTex(),scratchImg);
     if(FAILED(hr)) return false;
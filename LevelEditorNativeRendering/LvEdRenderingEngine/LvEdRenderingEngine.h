@@ -144,7 +144,12 @@ class Ray;
  * Creates a new instance of the specified object type.
  *
  * @param typeId Type GUID of the object
- * @param data (Optional) Object's factory; you can use data to initialize the object
+ * @param data (Optional) Object's factory; you can use data to initialize the object.
+ *             For the schema types, data is the initial state of the object, laid out
+ *             like the buffers of LvEd_ExecuteCommandBuffer(). The instance ids of
+ *             the writes are ignored, all the writes are applied to the new object
+ *             before it is returned, so the object is created with its properties
+ *             set and its bounds are computed once by the next update.
  * @param size Size of data, in bytes
  *
  * @return Instance GUID of the object, or zero if it failed to create the object
@@ -177,6 +182,27 @@ class Ray;
 extern "C" LVEDRENDERINGENGINE_API void __stdcall LvEd_InvokeMemberFn(ObjectGUID instanceId, wchar_t* fn, const void* arg, void** retVal);
 
 
+/**
+ * Gets the id of a member function, for LvEd_InvokeMemberFnById().
+ *
+ * @param fn function name.
+ *
+ * @return The function id, -1 if there is no member function with that name
+ */
+extern "C" LVEDRENDERINGENGINE_API int __stdcall LvEd_GetMemberFnId(wchar_t* fn);
+
+
+/**
+ * Invoke member function of the specified object, without the name lookup of LvEd_InvokeMemberFn().
+ *
+ * @param instanceId Instance GUID of the object
+ * @param fnId function id returned by LvEd_GetMemberFnId().
+ * @param arg function arguments.
+ * @param retVal return value.
+ */
+extern "C" LVEDRENDERINGENGINE_API void __stdcall LvEd_InvokeMemberFnById(ObjectGUID instanceId, int fnId, const void* arg, void** retVal);
+
+
 
 /**
  * Sets a property for the specified object and property ID.
@@ -204,6 +230,24 @@ class Ray;
 extern "C" LVEDRENDERINGENGINE_API void __stdcall LvEd_GetObjectProperty(ObjectTypeGUID typeId, ObjectPropertyUID propId, ObjectGUID instanceId, void** data, int* size);
 
 
+/**
+ * Sets the properties packed in a command buffer, in one call.
+ *
+ * @param buffer The property writes, each write is a 24 byte header followed by its data:
+ *               instanceId (8 bytes), typeId (4 bytes), propId (4 bytes), data size in bytes (4 bytes)
+ *               and flags (4 bytes). The next write starts at the next multiple of 8 bytes.
+ *               With flag 1 the data is the instance GUID of a referenced object, it is passed
+ *               in place of the data pointer as with LvEd_SetObjectProperty().
+ * @param size Size of the buffer, in bytes, a multiple of 8
+ *
+ * @remark Only the last write to each property of each object is applied, in the order of the buffer.
+ *         The bounds, transforms and lighting of the objects are updated once, by the next update.
+ *
+ * @return The number of writes applied, -1 if the buffer is malformed and nothing was applied
+ */
+extern "C" LVEDRENDERINGENGINE_API int __stdcall LvEd_ExecuteCommandBuffer(void* buffer, int size);
+
+
 /**
  * Adds the specified child object to its parent under the specified list at the specified index.
  *
@@ -245,6 +289,10 @@ class Ray;
  * @param viewxform View transform
  * @param projxform Projection of the transform
  * @param rayW Picking ray in world space
+ * @param skipSelected If TRUE the selected objects are ignored
+ * @param closestHitOnly If TRUE only the closest hit is returned, the objects are tested 
+ *                       in the order the ray enters their bounds and the ones behind the closest hit are skipped.
+ * @param maxDist Hits farther than maxDist are ignored, use FLT_MAX for no limit
  * @param hits An array of HitRecord 
  * @param count Number of picked objects
  *
@@ -253,7 +301,36 @@ class Ray;
  * @return TRUE if one or more objects picked, FALSE otherwise
  *
  */
-extern "C" LVEDRENDERINGENGINE_API bool __stdcall LvEd_RayPick(float viewxform[], float projxform[],Ray* rayW, bool skipSelected, HitRecord** hits, int* count);
+extern "C" LVEDRENDERINGENGINE_API bool __stdcall LvEd_RayPick(float viewxform[], float projxform[],Ray* rayW, bool skipSelected,
+    bool closestHitOnly, float maxDist, HitRecord** hits, int* count);
+
+
+/**
+ * Picks many rays in one call.
+ *
+ * The candidate objects are collected once for all the rays
+ * and the rays are split across worker threads. Terrains are included.
+ *
+ * @param viewxform View transform
+ * @param projxform Projection of the transform
+ * @param rays Array of picking rays in world space
+ * @param maxDists Max hit distance of each ray, can be NULL for no limit
+ * @param rayCount Number of rays
+ * @param closestHitOnly If TRUE only the closest hit of each ray is returned
+ * @param skipSelected If TRUE the selected objects are ignored
+ * @param hits Flat array of HitRecord for all the rays
+ * @param hitOffsets Array of rayCount + 1 offsets into hits, 
+ *                   the hits of ray i are hits[hitOffsets[i]] to hits[hitOffsets[i+1] - 1]
+ * @param hitCount Total number of hits
+ *
+ * @remark The HitRecords of each ray are sorted along the ray.
+ *         The arrays are valid until the next call.
+ *
+ * @return TRUE if any of the rays hit something, FALSE otherwise
+ *
+ */
+extern "C" LVEDRENDERINGENGINE_API bool __stdcall LvEd_RayPickBatch(float viewxform[], float projxform[], Ray* rays, float* maxDists, int rayCount,
+    bool closestHitOnly, bool skipSelected, HitRecord** hits, int** hitOffsets, int* hitCount);
 
 
 /**
@@ -271,6 +348,25 @@ class Ray;
  */
 extern "C" LVEDRENDERINGENGINE_API bool __stdcall LvEd_FrustumPick(ObjectGUID renderSurface, float viewxform[], float projxform[],float* rect, HitRecord** hits, int* count);
 
+/**
+ * Finds the mesh vertex that is the closest to the ray in screen space, used for vertex snapping.
+ *
+ * @param viewxform View transform
+ * @param projxform Projection transform
+ * @param rayW Picking ray in world space
+ * @param pixelRadius Vertices farther than this number of pixels from the ray are ignored
+ * @param skipSelected If TRUE the selected objects are ignored
+ * @param hit Receives the owning object, the vertex in world space (hitPt and nearestVertex)
+ *            and the distance along the ray
+ *
+ * @remark The pixel size is taken from the viewport of the last rendered surface.
+ *
+ * @return TRUE if a vertex is found, FALSE otherwise
+ *
+ */
+extern "C" LVEDRENDERINGENGINE_API bool __stdcall LvEd_FindNearestVertex(float viewxform[], float projxform[], Ray* rayW,
+    float pixelRadius, bool skipSelected, HitRecord* hit);
+
 
 /**
  * Sets the selection.
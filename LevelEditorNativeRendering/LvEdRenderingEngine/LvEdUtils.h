@@ -3,12 +3,10 @@
 #pragma once
 
 #include "Renderer\RenderableNodeSet.h"
-#include <set>
 #include "Core/Object.h"
 
 using namespace LvEdEngine;
 
-typedef std::set<ObjectGUID> Selection;
 typedef std::vector<Object*> ObjectList;
 
 class FindGobsByType : public QueryFunctor
@@ -55,13 +55,13 @@
 }
 
 // ------------------------------------------------------------------------------------------------
-void BasicShader::DrawNodes(const RenderNodeList& renderNodes)
+void BasicShader::DrawNodes(const RenderNodeRefList& renderNodes)
 {
     ID3D11DeviceContext* d3dContext = m_rc->Context();
     
     for ( auto it = renderNodes.begin(); it != renderNodes.end(); ++it )
     {
-        const RenderableNode& r = (*it);
+        const RenderableNode& r = *(*it);
         
         Matrix::Transpose(r.WorldXform,m_cbPerObject.Data.worldXform);
         m_cbPerObject.Data.color = r.diffuse;        
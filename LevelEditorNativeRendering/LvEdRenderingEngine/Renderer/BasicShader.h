@@ -22,7 +22,7 @@ class BasicShader : public Shader
         virtual void Begin(RenderContext* rc);
         virtual void End();
         virtual void SetRenderFlag(RenderFlagsEnum rf);
-        virtual void DrawNodes(const RenderNodeList& renderNodes);
+        virtual void DrawNodes(const RenderNodeRefList& renderNodes);
 
 
     private:
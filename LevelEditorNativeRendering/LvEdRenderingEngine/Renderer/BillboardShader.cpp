@@ -117,11 +117,11 @@ namespace LvEdEngine
 }
 
 // --------------------------------------------------------------------------------------------------
-void BillboardShader::DrawNodes(const RenderNodeList& renderNodes)
+void BillboardShader::DrawNodes(const RenderNodeRefList& renderNodes)
 {
     for(auto it = renderNodes.begin(); it != renderNodes.end(); it++)
     {
-        const RenderableNode& renderable = (*it);
+        const RenderableNode& renderable = *(*it);
         Draw( renderable );
     }
 }
@@ -130,21 +130,22 @@ namespace LvEdEngine
 void BillboardShader::Draw(const RenderableNode& r)
 {
     ID3D11DeviceContext* dc = m_rc->Context();
+    const NodeMaterial& mat = r.GetMaterial();
 
     // verify lighting
-    assert(r.lighting.numDirLights <= MAX_DIR_LIGHTS);
-    assert(r.lighting.numBoxLights <= MAX_BOX_LIGHTS);
-    assert(r.lighting.numPointLights <= MAX_POINT_LIGHTS);
+    assert(!r.lighting || r.lighting->numDirLights <= MAX_DIR_LIGHTS);
+    assert(!r.lighting || r.lighting->numBoxLights <= MAX_BOX_LIGHTS);
+    assert(!r.lighting || r.lighting->numPointLights <= MAX_POINT_LIGHTS);
 
     Matrix::Transpose(r.WorldXform,m_cbPerDraw.Data.worldXform);
-    Matrix::Transpose(r.TextureXForm, m_cbPerDraw.Data.textureXForm);
+    Matrix::Transpose(mat.TextureXForm, m_cbPerDraw.Data.textureXForm);
     m_cbPerDraw.Data.color = r.diffuse;
     m_cbPerDraw.Update(dc);
     
     ID3D11ShaderResourceView* diffuseMap[1] = {NULL};    
-    if( (m_renderFlags & RenderFlags::Textured) && r.textures[TextureType::DIFFUSE])
+    if( (m_renderFlags & RenderFlags::Textured) && mat.textures[TextureType::DIFFUSE])
     {
-        diffuseMap[0] = r.textures[TextureType::DIFFUSE]->GetView();
+        diffuseMap[0] = mat.textures[TextureType::DIFFUSE]->GetView();
     }
     else
     {
@@ -30,7 +30,7 @@ class BillboardShader : public Shader
     // set fill mode
     virtual void SetRenderFlag(RenderFlagsEnum rf);    
 
-    virtual void DrawNodes(const RenderNodeList& renderNodes);
+    virtual void DrawNodes(const RenderNodeRefList& renderNodes);
     
 private:    
     void Draw(const RenderableNode& r);  
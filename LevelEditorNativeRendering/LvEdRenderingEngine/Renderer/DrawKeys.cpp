@@ -0,0 +1,96 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "DrawKeys.h"
+#include <assert.h>
+#include <cstring>
+#include <algorithm>
+
+using namespace LvEdEngine;
+
+static const uint32_t BucketShift = DrawKeys::IndexBits + DrawKeys::DepthBits;
+static const uint32_t BucketCount = 1 << ( 64 - BucketShift );
+static const uint64_t BlendedPass = (uint64_t)1 << 63;
+static_assert(BucketShift + DrawKeys::ShaderBits + DrawKeys::FlagsBits == 63, "sort key layout must use all the bits");
+
+//---------------------------------------------------------------------------
+// the top bits of the float, mapped so that the unsigned order matches the float order.
+static uint32_t QuantizeDepth(float depth)
+{
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    bits = ( bits & 0x80000000 ) ? ~bits : ( bits | 0x80000000 );
+    return bits >> ( 32 - DrawKeys::DepthBits );
+}
+
+//---------------------------------------------------------------------------
+uint64_t DrawKeys::MakeEntry( uint32_t renderFlags, uint32_t shaderId, bool blended, float depth, uint32_t index )
+{
+    assert( renderFlags < ( 1u << FlagsBits ) );
+    assert( shaderId < ( 1u << ShaderBits ) );
+    assert( index < MaxEntries );
+    uint64_t entry = (uint64_t)( ( renderFlags << ShaderBits ) | shaderId ) << BucketShift;
+    if ( blended )
+    {
+        uint32_t backToFront = ~QuantizeDepth( depth ) & ( ( 1 << DepthBits ) - 1 );
+        entry |= BlendedPass | ( (uint64_t)backToFront << IndexBits );
+    }
+    return entry | index;
+}
+
+//---------------------------------------------------------------------------
+uint32_t DrawKeys::GetIndex( uint64_t entry )
+{
+    return (uint32_t)( entry & ( MaxEntries - 1 ) );
+}
+
+//---------------------------------------------------------------------------
+uint32_t DrawKeys::GetBucket( uint64_t entry )
+{
+    return (uint32_t)( ( entry & ~BlendedPass ) >> BucketShift );
+}
+
+//---------------------------------------------------------------------------
+// a single counting sort pass on the bucket bits, then a sort of the blended
+// entries alone. the opaque nodes are not sorted by texture or depth, the
+// shaders bind the textures of every node anyway and the extra passes over
+// all the nodes made the sort slower than the std::map buckets it replaced.
+void DrawKeys::Sort( std::vector<uint64_t>& entries )
+{
+    uint32_t count = (uint32_t)entries.size();
+    if ( count == 0 )
+        return;
+
+    m_offsets.assign( BucketCount, 0 );
+    uint32_t blendedCount = 0;
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        m_offsets[ (uint32_t)( entries[i] >> BucketShift ) ]++;
+        if ( entries[i] & BlendedPass )
+            blendedCount++;
+    }
+
+    // skip the pass when all the entries are in the same bucket.
+    if ( m_offsets[ (uint32_t)( entries[0] >> BucketShift ) ] != count )
+    {
+        uint32_t offset = 0;
+        for ( uint32_t v = 0; v < BucketCount; ++v )
+        {
+            uint32_t bucketSize = m_offsets[v];
+            m_offsets[v] = offset;
+            offset += bucketSize;
+        }
+        m_sortTemp.resize( count );
+        for ( uint32_t i = 0; i < count; ++i )
+        {
+            m_sortTemp[ m_offsets[ (uint32_t)( entries[i] >> BucketShift ) ]++ ] = entries[i];
+        }
+        entries.swap( m_sortTemp );
+    }
+
+    // the blended buckets come last. the index in the low bits keeps
+    // the nodes with the same depth in the order they were added.
+    if ( blendedCount > 1 )
+    {
+        std::sort( entries.end() - blendedCount, entries.end() );
+    }
+}
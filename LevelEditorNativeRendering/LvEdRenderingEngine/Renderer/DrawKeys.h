@@ -0,0 +1,47 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace LvEdEngine
+{
+    // ----------------------------------------------------------------------------
+    // the draw order of RenderableNodeSorter.
+    // each entry is a single 64 bit value, the sort key in the top bits
+    // and the index of the node in the low IndexBits.
+    // sort key layout, from the most significant bit:
+    //   63      pass, 0 for opaque and 1 for blended nodes.
+    //   57..62  render flags.
+    //   53..56  shader.
+    //   29..52  blended: depth back to front (24 bits). 0 for opaque nodes,
+    //           they are drawn in the order they were added.
+    // the pass, flags and shader bits give the buckets the same order as the
+    // old (flags << 10 | shader) bucket keys.
+    class DrawKeys
+    {
+    public:
+        static const uint32_t IndexBits  = 29;
+        static const uint32_t MaxEntries = 1 << IndexBits;
+        static const uint32_t DepthBits  = 24;
+        static const uint32_t ShaderBits = 4;
+        static const uint32_t FlagsBits  = 6;
+
+        // depth is the view space distance of the node, only blended nodes use it.
+        static uint64_t MakeEntry( uint32_t renderFlags, uint32_t shaderId, bool blended, float depth, uint32_t index );
+
+        static uint32_t GetIndex( uint64_t entry );
+
+        // (flags << ShaderBits) | shader, all the entries of a bucket have the same value.
+        static uint32_t GetBucket( uint64_t entry );
+
+        // sorts the entries by bucket, then the blended entries back to front.
+        // the sort is stable, nodes with equal keys keep the order they were added in.
+        void Sort( std::vector<uint64_t>& entries );
+
+    private:
+        std::vector<uint64_t> m_sortTemp;
+        std::vector<uint32_t> m_offsets;
+    };
+}
@@ -0,0 +1,232 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "LightGrid.h"
+#include <algorithm>
+#include <math.h>
+
+namespace LvEdEngine
+{
+    // cell coordinates are packed in 21 bits per axis.
+    static const int32_t MinCellCoord = -(1 << 20);
+    static const int32_t MaxCellCoord = (1 << 20) - 1;
+
+    // lights that cover more cells than this are not stored in the cells.
+    static const uint64_t MaxCellsPerLight = 512;
+
+    // queries that cover more cells than this scan all the lights instead.
+    static const uint64_t MaxCellsPerQuery = 512;
+
+    // ----------------------------------------------------------------------------------
+    static int32_t CellCoord(float v, float invCellSize)
+    {
+        float c = floorf(v * invCellSize);
+        if(!(c >= (float)MinCellCoord)) return MinCellCoord; // also catches NaN.
+        if(c > (float)MaxCellCoord) return MaxCellCoord;
+        return (int32_t)c;
+    }
+
+    // ----------------------------------------------------------------------------------
+    LightGrid::LightGrid(float cellSize)
+        : m_cellSize(cellSize), m_invCellSize(1.0f / cellSize)
+    {
+        assert(cellSize > 0.0f);
+    }
+
+    // ----------------------------------------------------------------------------------
+    //static
+    uint64_t LightGrid::CellKey(int32_t x, int32_t y, int32_t z)
+    {
+        const uint64_t mask = (1 << 21) - 1;
+        return ((uint64_t)(x - MinCellCoord) & mask)
+            | (((uint64_t)(y - MinCellCoord) & mask) << 21)
+            | (((uint64_t)(z - MinCellCoord) & mask) << 42);
+    }
+
+    // ----------------------------------------------------------------------------------
+    LightGrid::CellRange LightGrid::ComputeRange(const AABB& bounds) const
+    {
+        const float3& bmin = bounds.Min();
+        const float3& bmax = bounds.Max();
+        CellRange range;
+        if(!(bmin.x <= bmax.x && bmin.y <= bmax.y && bmin.z <= bmax.z))
+        {
+            // empty or invalid bounds, the light is not in any cell.
+            range.min[0] = range.min[1] = range.min[2] = 0;
+            range.max[0] = range.max[1] = range.max[2] = -1;
+            return range;
+        }
+
+        range.min[0] = CellCoord(bmin.x, m_invCellSize);
+        range.min[1] = CellCoord(bmin.y, m_invCellSize);
+        range.min[2] = CellCoord(bmin.z, m_invCellSize);
+        range.max[0] = CellCoord(bmax.x, m_invCellSize);
+        range.max[1] = CellCoord(bmax.y, m_invCellSize);
+        range.max[2] = CellCoord(bmax.z, m_invCellSize);
+        return range;
+    }
+
+    // ----------------------------------------------------------------------------------
+    bool LightGrid::Update(Light* light, const AABB& bounds)
+    {
+        assert(light);
+        CellRange range = ComputeRange(bounds);
+        auto it = m_records.find(light);
+        if(it != m_records.end())
+        {
+            it->second.bounds = bounds;
+            if(it->second.range == range)
+                return false;
+            RemoveFromCells(light, it->second);
+        }
+        else
+        {
+            it = m_records.insert(std::make_pair(light, LightRecord())).first;
+        }
+
+        LightRecord& record = it->second;
+        record.bounds = bounds;
+        record.range = range;
+        record.large = !range.IsEmpty() && range.CellCount() > MaxCellsPerLight;
+        AddToCells(light, record);
+        return true;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void LightGrid::Remove(Light* light)
+    {
+        auto it = m_records.find(light);
+        if(it == m_records.end())
+            return;
+        RemoveFromCells(light, it->second);
+        m_records.erase(it);
+    }
+
+    // ----------------------------------------------------------------------------------
+    const AABB* LightGrid::GetBounds(Light* light) const
+    {
+        auto it = m_records.find(light);
+        return it != m_records.end() ? &it->second.bounds : NULL;
+    }
+
+    // ----------------------------------------------------------------------------------
+    void LightGrid::AddToCells(Light* light, const LightRecord& record)
+    {
+        const CellRange& range = record.range;
+        if(range.IsEmpty())
+            return;
+
+        if(record.large)
+        {
+            m_largeLights.push_back(light);
+            return;
+        }
+
+        CellEntry entry;
+        entry.light = light;
+        entry.min[0] = range.min[0];
+        entry.min[1] = range.min[1];
+        entry.min[2] = range.min[2];
+        for(int32_t z = range.min[2]; z <= range.max[2]; z++)
+        {
+            for(int32_t y = range.min[1]; y <= range.max[1]; y++)
+            {
+                for(int32_t x = range.min[0]; x <= range.max[0]; x++)
+                {
+                    m_cells[CellKey(x, y, z)].push_back(entry);
+                }
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    void LightGrid::RemoveFromCells(Light* light, const LightRecord& record)
+    {
+        const CellRange& range = record.range;
+        if(range.IsEmpty())
+            return;
+
+        if(record.large)
+        {
+            auto it = std::find(m_largeLights.begin(), m_largeLights.end(), light);
+            assert(it != m_largeLights.end());
+            *it = m_largeLights.back();
+            m_largeLights.pop_back();
+            return;
+        }
+
+        for(int32_t z = range.min[2]; z <= range.max[2]; z++)
+        {
+            for(int32_t y = range.min[1]; y <= range.max[1]; y++)
+            {
+                for(int32_t x = range.min[0]; x <= range.max[0]; x++)
+                {
+                    auto cellIt = m_cells.find(CellKey(x, y, z));
+                    assert(cellIt != m_cells.end());
+                    CellEntryList& entries = cellIt->second;
+                    for(size_t i = 0; i < entries.size(); i++)
+                    {
+                        if(entries[i].light == light)
+                        {
+                            entries[i] = entries.back();
+                            entries.pop_back();
+                            break;
+                        }
+                    }
+                    if(entries.empty())
+                        m_cells.erase(cellIt);
+                }
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------------------
+    void LightGrid::Query(const AABB& bounds, std::vector<Light*>& lights) const
+    {
+        CellRange range = ComputeRange(bounds);
+        if(range.IsEmpty())
+            return;
+
+        lights.insert(lights.end(), m_largeLights.begin(), m_largeLights.end());
+
+        if(range.CellCount() > MaxCellsPerQuery || range.CellCount() > m_cells.size())
+        {
+            // cheaper to test all the lights than to look up the cells.
+            for(auto it = m_records.begin(); it != m_records.end(); ++it)
+            {
+                const LightRecord& record = it->second;
+                if(record.large || record.range.IsEmpty())
+                    continue;
+                if(record.range.min[0] > range.max[0] || record.range.max[0] < range.min[0]
+                    || record.range.min[1] > range.max[1] || record.range.max[1] < range.min[1]
+                    || record.range.min[2] > range.max[2] || record.range.max[2] < range.min[2])
+                    continue;
+                lights.push_back(it->first);
+            }
+            return;
+        }
+
+        for(int32_t z = range.min[2]; z <= range.max[2]; z++)
+        {
+            for(int32_t y = range.min[1]; y <= range.max[1]; y++)
+            {
+                for(int32_t x = range.min[0]; x <= range.max[0]; x++)
+                {
+                    auto cellIt = m_cells.find(CellKey(x, y, z));
+                    if(cellIt == m_cells.end())
+                        continue;
+                    const CellEntryList& entries = cellIt->second;
+                    for(auto it = entries.begin(); it != entries.end(); ++it)
+                    {
+                        // report the light only from the first cell it shares with the query.
+                        if(std::max(it->min[0], range.min[0]) == x
+                            && std::max(it->min[1], range.min[1]) == y
+                            && std::max(it->min[2], range.min[2]) == z)
+                        {
+                            lights.push_back(it->light);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "../VectorMath/V3dMath.h"
+#include "../VectorMath/CollisionPrimitives.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    class Light;
+
+    // sparse uniform grid of light influence volumes.
+    // each light is stored in every cell its influence bounds overlap,
+    // only the cells that hold at least one light are allocated.
+    // a light is moved to other cells only when its cell range changes.
+    // lights that cover too many cells are kept in a separate list and
+    // returned by every query.
+    class LightGrid : public NonCopyable
+    {
+    public:
+        LightGrid(float cellSize);
+
+        // insert or move the light, bounds is the volume the light can influence.
+        // returns true if the cells of the light changed.
+        bool Update(Light* light, const AABB& bounds);
+
+        void Remove(Light* light);
+
+        // bounds given to the last Update() of the light, NULL if the light is not in the grid.
+        const AABB* GetBounds(Light* light) const;
+
+        // gathers the lights whose cells overlap the bounds, each light is added once.
+        // the lights must still be tested against the bounds by the caller.
+        // the grid is not modified so queries can run concurrently.
+        void Query(const AABB& bounds, std::vector<Light*>& lights) const;
+
+        uint32_t GetLightCount() const { return (uint32_t)m_records.size(); }
+        uint32_t GetCellCount() const { return (uint32_t)m_cells.size(); }
+
+    private:
+        // inclusive range of cells.
+        struct CellRange
+        {
+            int32_t min[3];
+            int32_t max[3];
+
+            bool operator==(const CellRange& other) const
+            {
+                return min[0] == other.min[0] && min[1] == other.min[1] && min[2] == other.min[2]
+                    && max[0] == other.max[0] && max[1] == other.max[1] && max[2] == other.max[2];
+            }
+            bool operator!=(const CellRange& other) const { return !(*this == other); }
+            bool IsEmpty() const { return min[0] > max[0] || min[1] > max[1] || min[2] > max[2]; }
+            uint64_t CellCount() const
+            {
+                return (uint64_t)(max[0] - min[0] + 1) * (uint64_t)(max[1] - min[1] + 1) * (uint64_t)(max[2] - min[2] + 1);
+            }
+        };
+
+        // a light in a cell, min is the first cell of the light. a query visits
+        // the light only in the first cell shared by the light and the query range,
+        // so no light is reported twice.
+        struct CellEntry
+        {
+            Light* light;
+            int32_t min[3];
+        };
+        typedef std::vector<CellEntry> CellEntryList;
+
+        struct LightRecord
+        {
+            AABB bounds;
+            CellRange range;
+            bool large;
+        };
+
+        CellRange ComputeRange(const AABB& bounds) const;
+        static uint64_t CellKey(int32_t x, int32_t y, int32_t z);
+        void AddToCells(Light* light, const LightRecord& record);
+        void RemoveFromCells(Light* light, const LightRecord& record);
+
+        float m_cellSize;
+        float m_invCellSize;
+        std::unordered_map<uint64_t, CellEntryList> m_cells;
+        std::unordered_map<Light*, LightRecord> m_records;
+        std::vector<Light*> m_largeLights;
+    };
+}
@@ -2,6 +2,9 @@
 
 #include "Lights.h"
 #include <set>
+#include <vector>
+#include <algorithm>
+#include <math.h>
 #include "../VectorMath/V3dMath.h"
 #include "../VectorMath/CollisionPrimitives.h"
 #include "Renderable.h"
@@ -9,8 +12,106 @@
 namespace LvEdEngine
 {
 
+// size of the light grid cells in world units,
+// about the range of a typical point light.
+static const float LightCellSize = 16.0f;
+
+// past this many invalid regions the whole level is invalidated.
+static const size_t MaxInvalidRegions = 64;
+
+//-------------------------------------------------------------------------------------------------
+static bool SameBounds(const AABB& a, const AABB& b)
+{
+    return a.Min() == b.Min() && a.Max() == b.Max();
+}
+
+//-------------------------------------------------------------------------------------------------
+static float Luminance(const float3& color)
+{
+    return dot(color, float3(0.299f, 0.587f, 0.114f));
+}
+
+//-------------------------------------------------------------------------------------------------
+// same attenuation as the shader, t is 1 at the light and 0 at the edge of its range.
+static float Attenuate(const float4& attenuation, float t)
+{
+    float att = attenuation.x + attenuation.y * t + attenuation.z * t * t;
+    return att > 0.0f ? att : 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+static AABB PointLightBounds(const PointLight& light)
+{
+    float3 pos(light.position.x, light.position.y, light.position.z);
+    float radius = light.position.w;
+    float3 ll(pos.x - radius, pos.y - radius, pos.z - radius);
+    float3 ur(pos.x + radius, pos.y + radius, pos.z + radius);
+    return AABB(ll, ur);
+}
+
+//-------------------------------------------------------------------------------------------------
+// estimated contribution of the light at the point of the bounds closest to the light.
+static float PointLightContribution(const PointLight& light, const AABB& bounds)
+{
+    float3 pos(light.position.x, light.position.y, light.position.z);
+    float range = light.position.w;
+    if(range <= 0.0f)
+        return 0.0f;
+    float3 closest = maximize(bounds.Min(), minimize(bounds.Max(), pos));
+    float t = 1.0f - length(pos - closest) / range;
+    if(t <= 0.0f)
+        return 0.0f;
+    return (Luminance(light.diffuse) + Luminance(light.ambient)) * Attenuate(light.attenuation, t);
+}
+
+//-------------------------------------------------------------------------------------------------
+// estimated contribution of the light at the point of the bounds closest to the light center.
+static float BoxLightContribution(const BoxLight& light, const AABB& bounds)
+{
+    float3 center = (light.min + light.max) * 0.5f;
+    float3 range = (light.max - light.min) * 0.5f;
+    float3 closest = maximize(bounds.Min(), minimize(bounds.Max(), center));
+    float t = 1.0f;
+    for(int i = 0; i < 3; i++)
+    {
+        float ti = range[i] > 0.0f ? 1.0f - fabsf(center[i] - closest[i]) / range[i] : 0.0f;
+        t = minimize(t, ti);
+    }
+    if(t <= 0.0f)
+        return 0.0f;
+    return (Luminance(light.diffuse) + Luminance(light.ambient)) * Attenuate(light.attenuation, t);
+}
+
+//-------------------------------------------------------------------------------------------------
+// keeps the 'maxCount' lights with the highest contribution, sorted by contribution.
+template<typename LightType>
+static void InsertRanked(LightType* light, float contribution, LightType** ranked, float* rankedContribution,
+                         uint32_t* count, uint32_t maxCount)
+{
+    uint32_t i = *count;
+    if(i == maxCount)
+    {
+        if(contribution <= rankedContribution[maxCount - 1])
+            return;
+        i--;
+    }
+    else
+    {
+        (*count)++;
+    }
+
+    for(; i > 0 && rankedContribution[i - 1] < contribution; i--)
+    {
+        ranked[i] = ranked[i - 1];
+        rankedContribution[i] = rankedContribution[i - 1];
+    }
+    ranked[i] = light;
+    rankedContribution[i] = contribution;
+}
+
 //-------------------------------------------------------------------------------------------------
 LightingState::LightingState()
+    : m_boxLightGrid(LightCellSize), m_pointLightGrid(LightCellSize), m_readOnly(false)
 {
     //
     // The HLSL shader does not use light counts (i.e., it doesn't loop through the array),
@@ -49,14 +150,17 @@ namespace LvEdEngine
 //-------------------------------------------------------------------------------------------------
 DirLight* LightingState::CreateDirLight()
 {
+    assert(!m_readOnly);
     DirLight * light = new DirLight();
     m_dirLights.insert(light);
+    InvalidateAll();
     return light;
 }
 
 //-------------------------------------------------------------------------------------------------
 BoxLight* LightingState::CreateBoxLight()
 {
+    assert(!m_readOnly);
     BoxLight * light = new BoxLight();
     m_boxLights.insert(light);
     return light;
@@ -65,6 +169,7 @@ namespace LvEdEngine
 //-------------------------------------------------------------------------------------------------
 PointLight* LightingState::CreatePointLight()
 {
+    assert(!m_readOnly);
     PointLight * light = new PointLight();
     m_pointLights.insert(light);
     return light;
@@ -73,33 +178,137 @@ namespace LvEdEngine
 //-------------------------------------------------------------------------------------------------
 void LightingState::DestroyDirLight(DirLight* light)
 {
+    assert(!m_readOnly);
     m_dirLights.erase(light);
     delete light;
+    InvalidateAll();
 }
 
 //-------------------------------------------------------------------------------------------------
 void LightingState::DestroyBoxLight(BoxLight* light)
 {
+    assert(!m_readOnly);
     m_boxLights.erase(light);
+    InvalidateBoxLight(light);
+    m_boxLightGrid.Remove(light);
     delete light;
 }
 
 //-------------------------------------------------------------------------------------------------
 void LightingState::DestroyPointLight(PointLight* light)
 {
+    assert(!m_readOnly);
     m_pointLights.erase(light);
+    InvalidatePointLight(light);
+    m_pointLightGrid.Remove(light);
     delete light;
 }
 
-void LightingState::UpdateLightEnvironment( RenderableNode& r )
-{    
-    UpdateLightEnvironment(r.lighting,r.bounds);
+//-------------------------------------------------------------------------------------------------
+void LightingState::UpdateBoxLight(BoxLight* light)
+{
+    assert(!m_readOnly);
+    assert(m_boxLights.find(light) != m_boxLights.end());
+    AABB bounds(light->min, light->max);
+    const AABB* oldBounds = m_boxLightGrid.GetBounds(light);
+    if(oldBounds && SameBounds(*oldBounds, bounds))
+        return;
+
+    // the objects lit at the old and at the new position are affected.
+    if(oldBounds)
+        InvalidateRegion(*oldBounds);
+    InvalidateRegion(bounds);
+    m_boxLightGrid.Update(light, bounds);
+}
+
+//-------------------------------------------------------------------------------------------------
+void LightingState::UpdatePointLight(PointLight* light)
+{
+    assert(!m_readOnly);
+    assert(m_pointLights.find(light) != m_pointLights.end());
+    AABB bounds = PointLightBounds(*light);
+    const AABB* oldBounds = m_pointLightGrid.GetBounds(light);
+    if(oldBounds && SameBounds(*oldBounds, bounds))
+        return;
+
+    if(oldBounds)
+        InvalidateRegion(*oldBounds);
+    InvalidateRegion(bounds);
+    m_pointLightGrid.Update(light, bounds);
+}
+
+//-------------------------------------------------------------------------------------------------
+void LightingState::InvalidateAll()
+{
+    assert(!m_readOnly);
+    m_invalid.all = true;
+    m_invalid.regions.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+void LightingState::InvalidateRegion(const AABB& region)
+{
+    assert(!m_readOnly);
+    if(m_invalid.all)
+        return;
+    if(m_invalid.regions.size() >= MaxInvalidRegions)
+    {
+        InvalidateAll();
+        return;
+    }
+    m_invalid.regions.push_back(region);
+}
+
+//-------------------------------------------------------------------------------------------------
+void LightingState::InvalidateBoxLight(BoxLight* light)
+{
+    // a light that was never updated has not lit anything yet.
+    const AABB* bounds = m_boxLightGrid.GetBounds(light);
+    if(bounds)
+        InvalidateRegion(*bounds);
+}
+
+//-------------------------------------------------------------------------------------------------
+void LightingState::InvalidatePointLight(PointLight* light)
+{
+    const AABB* bounds = m_pointLightGrid.GetBounds(light);
+    if(bounds)
+        InvalidateRegion(*bounds);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool LightingState::IsInvalid(const AABB& bounds) const
+{
+    if(m_invalid.all || m_prevInvalid.all)
+        return true;
+    for(auto it = m_invalid.regions.begin(); it != m_invalid.regions.end(); ++it)
+    {
+        if(TestAABBAABB(bounds, *it))
+            return true;
+    }
+    for(auto it = m_prevInvalid.regions.begin(); it != m_prevInvalid.regions.end(); ++it)
+    {
+        if(TestAABBAABB(bounds, *it))
+            return true;
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+void LightingState::BeginUpdate()
+{
+    assert(!m_readOnly);
+    // a light can be updated after the objects it lights, so the regions
+    // invalidated during an update are kept until the end of the next one.
+    std::swap(m_prevInvalid, m_invalid);
+    m_invalid.regions.clear();
+    m_invalid.all = false;
 }
 
 //-------------------------------------------------------------------------------------------------
 void LightingState::UpdateLightEnvironment(LightEnvironment& env, const AABB& bounds)
 {
-    
+    assert(!m_readOnly);
     env.numDirLights = 0;
     env.numBoxLights = 0;
     env.numPointLights = 0;
@@ -121,42 +330,49 @@ namespace LvEdEngine
         env.dir[env.numDirLights++] = m_defaultDirLight;
     }
 
+    // only the lights in the grid cells overlapped by the bounds are candidates,
+    // keep the ones that contribute the most. the list is local, the grids are
+    // only read so several threads can update light environments at once.
+    std::vector<Light*> candidates;
+
     // gather box lights
-    for(auto it = m_boxLights.begin(); it != m_boxLights.end(); ++it)
+    candidates.clear();
+    m_boxLightGrid.Query(bounds, candidates);
+    BoxLight* boxLights[MAX_BOX_LIGHTS];
+    float boxContribution[MAX_BOX_LIGHTS];
+    for(auto it = candidates.begin(); it != candidates.end(); ++it)
     {
-        BoxLight  light = *(*it);
-        AABB lightBounds(light.min, light.max);
-
+        BoxLight* light = static_cast<BoxLight*>(*it);
+        AABB lightBounds(light->min, light->max);
         if(TestAABBAABB(bounds, lightBounds))
         {
-            env.box[env.numBoxLights++] = light;
-            if(env.numBoxLights >= MAX_BOX_LIGHTS )
-            {
-                break;
-            }
+            InsertRanked(light, BoxLightContribution(*light, bounds), boxLights, boxContribution,
+                &env.numBoxLights, MAX_BOX_LIGHTS);
         }
     }
+    for(unsigned int i = 0; i < env.numBoxLights; ++i)
+    {
+        env.box[i] = *boxLights[i];
+    }
 
     // gather point lights
-    for(auto it = m_pointLights.begin(); it != m_pointLights.end(); ++it)
+    candidates.clear();
+    m_pointLightGrid.Query(bounds, candidates);
+    PointLight* pointLights[MAX_POINT_LIGHTS];
+    float pointContribution[MAX_POINT_LIGHTS];
+    for(auto it = candidates.begin(); it != candidates.end(); ++it)
     {
-        PointLight  light = *(*it);
-
-        // build an AABB for the sphere and test.
-        float3 pos = float3(light.position.x, light.position.y, light.position.z);
-        float radius = light.position.w;
-        float3 ll(pos.x - radius, pos.y - radius, pos.z - radius);
-        float3 ur(pos.x + radius, pos.y + radius, pos.z + radius);
-        AABB sphereBounds(ll, ur);
-        if(TestAABBAABB(bounds, sphereBounds))
+        PointLight* light = static_cast<PointLight*>(*it);
+        if(TestAABBAABB(bounds, PointLightBounds(*light)))
         {
-            env.point[env.numPointLights++] = light;
-            if(env.numPointLights >= MAX_POINT_LIGHTS)
-            {
-                break;
-            }
+            InsertRanked(light, PointLightContribution(*light, bounds), pointLights, pointContribution,
+                &env.numPointLights, MAX_POINT_LIGHTS);
         }
     }
+    for(unsigned int i = 0; i < env.numPointLights; ++i)
+    {
+        env.point[i] = *pointLights[i];
+    }
 
     //
     //  Set any unused lights slots to the empty light structs. The HLSL shader
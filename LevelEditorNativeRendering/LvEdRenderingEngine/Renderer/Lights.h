@@ -4,7 +4,9 @@
 #include "../VectorMath/V3dMath.h"
 #include "../VectorMath/CollisionPrimitives.h"
 #include "../Core/NonCopyable.h"
+#include "LightGrid.h"
 #include <set>
+#include <vector>
 
 namespace LvEdEngine
 {
@@ -12,8 +14,6 @@ namespace LvEdEngine
     static const unsigned int MAX_BOX_LIGHTS = 2;
     static const unsigned int MAX_POINT_LIGHTS = 4;
 
-    class RenderableNode;
-
     struct ExpFog
     {
         int    enabled;
@@ -87,13 +87,35 @@ class LightingState : public NonCopyable
 
         BoxLight*   CreateBoxLight();
         void        DestroyBoxLight(BoxLight* light);
+        // must be called after the bounds of the light are changed.
+        void        UpdateBoxLight(BoxLight* light);
 
         PointLight* CreatePointLight();
         void        DestroyPointLight(PointLight* light);
+        // must be called after the position or the range of the light are changed.
+        void        UpdatePointLight(PointLight* light);
 
-        void        UpdateLightEnvironment( RenderableNode& r );
         void        UpdateLightEnvironment(LightEnvironment& env, const AABB& bounds);
 
+        // light invalidation.
+        // objects must update the light environment of the renderables
+        // whose bounds are invalid. the regions stay invalid for one
+        // full update after the update in which they were invalidated.
+        void        InvalidateAll();
+        void        InvalidateRegion(const AABB& region);
+        // must be called after the color or the attenuation of the light are changed.
+        void        InvalidateBoxLight(BoxLight* light);
+        void        InvalidatePointLight(PointLight* light);
+        bool        IsInvalid(const AABB& bounds) const;
+        // called at the beginning of each update.
+        void        BeginUpdate();
+
+        // the lighting state must not change, and the light environments must not be
+        // updated, between the calls. renderables are collected between them, on several
+        // threads, so objects relight in Update(). checked with asserts.
+        void        BeginReadOnly() { m_readOnly = true; }
+        void        EndReadOnly()   { m_readOnly = false; }
+
     private:
         LightingState();
 
@@ -102,8 +124,22 @@ class LightingState : public NonCopyable
         std::set<BoxLight*>     m_boxLights;
         std::set<PointLight*>   m_pointLights;
 
+        // influence volumes of the box and point lights.
+        LightGrid               m_boxLightGrid;
+        LightGrid               m_pointLightGrid;
+
+        struct InvalidRegions
+        {
+            InvalidRegions() : all(false) {}
+            std::vector<AABB> regions;
+            bool all;
+        };
+        InvalidRegions          m_invalid;      // invalidated since the last BeginUpdate().
+        InvalidRegions          m_prevInvalid;  // invalidated before the last BeginUpdate().
+
         DirLight                m_noDirLight;
         BoxLight                m_noBoxLight;
         PointLight              m_noPointLight;
+        bool                    m_readOnly;
     };
 }
@@ -169,6 +169,35 @@ namespace LvEdEngine
 
     FreeVectorMemory(tex);
     FreeVectorMemory(tan);    
+
+    // Construct() is called from the resource loader thread for models,
+    // so the cost of building the bvh is not paid on the first pick.
+    BuildBVH();
+    BuildVertexTree();
+}
+
+void Mesh::BuildBVH()
+{
+    if(primitiveType == PrimitiveType::TriangleList && pos.size() > 0 && indices.size() >= 3)
+    {
+        bvh.BuildFromTriangles(&pos[0], &indices[0], (uint32_t)indices.size());
+    }
+    else
+    {
+        bvh.Clear();
+    }
+}
+
+void Mesh::BuildVertexTree()
+{
+    if(pos.size() > 0)
+    {
+        vertexTree.Build(&pos[0], (uint32_t)pos.size());
+    }
+    else
+    {
+        vertexTree.Clear();
+    }
 }
 
 void Mesh::ComputeBound()
@@ -10,6 +10,8 @@
 #include "../Core/NonCopyable.h"
 #include "../VectorMath/V3dMath.h"
 #include "../VectorMath/CollisionPrimitives.h"
+#include "../VectorMath/BVH.h"
+#include "../VectorMath/KdTree.h"
 #include "../Renderer/RenderEnums.h"
 #include "../Renderer/Resource.h"
 
@@ -58,6 +60,8 @@ class Mesh : public NonCopyable
     std::vector<float2> tex;
     std::vector<unsigned int> indices;
     AABB bounds;
+    BVH bvh;                          // built over the triangles for picking, see BuildBVH().
+    KdTree vertexTree;                // built over the positions for vertex snapping, see BuildVertexTree().
     VertexBuffer* vertexBuffer;       // from RenderBuffer.h
     IndexBuffer* indexBuffer;         // from RenderBuffer.h
     PrimitiveTypeEnum primitiveType;
@@ -75,6 +79,14 @@ class Mesh : public NonCopyable
     void ComputeTangents();
     void Construct(ID3D11Device* d3dDevice);
 
+    // build bvh from pos and indices. 
+    // it is called by Construct(), call it again if pos or indices are modified afterward.
+    void BuildBVH();
+
+    // build vertexTree from pos.
+    // it is called by Construct(), call it again if pos is modified afterward.
+    void BuildVertexTree();
+
 private:
     bool BoundsCheck(long index, long max);
     bool SizeCheck(size_t s1, size_t s2, const char * n1, const char * n2);
@@ -55,12 +55,12 @@
 }
 
 
-void NormalsShader::DrawNodes(const RenderNodeList& renderNodes)
+void NormalsShader::DrawNodes(const RenderNodeRefList& renderNodes)
 {    
     ID3D11DeviceContext* d3dContext = m_rcntx->Context();
     for ( auto it = renderNodes.begin(); it != renderNodes.end(); ++it )
     {        
-        const RenderableNode& r = (*it);
+        const RenderableNode& r = *(*it);
         
         if(r.mesh->nor.size() == 0) continue;
         Matrix::Transpose(r.WorldXform,m_cbPerObject.Data.worldXform);    
@@ -16,7 +16,6 @@ namespace LvEdEngine
         s_inst = new RenderContext();
 
     s_inst->m_device = device;    
-    s_inst->LightEnvDirty = true;
 }
 
 RenderContext::~RenderContext()
@@ -10,9 +10,6 @@
 #include <map>
 #include "Lights.h"
 #include "../VectorMath/Camera.h"
-#include <set>
-
-typedef std::set<ObjectGUID> Selection;
 
 namespace LvEdEngine
 {
@@ -39,9 +36,7 @@ class RenderContext : public NonCopyable
         void  SetFog(ExpFog fog) { m_fog = fog;}
         // Setting Context State        
         void SetContext(ID3D11DeviceContext* context){m_context = context;}
-        // Object Ids of any items currently selected.
-        Selection selection;
-        bool LightEnvDirty;
+        // the selection is kept in the ObjectTable.
 
     private:
         RenderContext() {}
@@ -10,9 +10,6 @@
 #include <map>
 #include "Lights.h"
 #include "../VectorMath/Camera.h"
-#include <set>
-
-typedef std::set<ObjectGUID> Selection;
 
 namespace LvEdEngine
 {
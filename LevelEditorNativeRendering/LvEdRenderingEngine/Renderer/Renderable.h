@@ -18,6 +18,36 @@ class VertexBuffer;
     class IndexBuffer;
     class Texture;
     class Mesh;
+    class SegmentBVH;
+
+    // surface properties of a RenderableNode that are not needed for sorting,
+    // culling or picking. owned by the game object that creates the node and
+    // shared by reference, so copying a node does not copy its material.
+    class NodeMaterial
+    {
+    public:
+        NodeMaterial()
+        {
+            specular = float3(0,0,0);
+            emissive = float4(0,0,0,0);
+            specPower = 1;
+            for(int t = TextureType::MIN; t < TextureType::MAX; t++)
+                textures[t] = NULL;
+        }
+
+        // used by the shaders for nodes without a material.
+        static const NodeMaterial& Default()
+        {
+            static NodeMaterial s_default;
+            return s_default;
+        }
+
+        Matrix TextureXForm;
+        float4 emissive;
+        float3 specular;
+        float specPower;
+        Texture* textures[TextureType::MAX];
+    };
               
     class RenderableNode
     {
@@ -39,42 +69,53 @@ enum Flags
             
             objectId = 0;
             diffuse.x = diffuse.y = diffuse.z = diffuse.w = 1.0f;
-            specular.x = specular.y = specular.z = 0.0f;
-            emissive = float4(0,0,0,0);
-            specPower = 1;
-            for(int t = TextureType::MIN; t < TextureType::MAX; t++)
-                textures[t] = NULL;
             
             mesh = NULL;
-            lighting.numDirLights = 0;
-            lighting.numBoxLights = 0;
-            lighting.numPointLights = 0;
+            lineSegments = NULL;
+            primitive = NULL;
+            material = NULL;
+            lighting = NULL;
         }
 
         // The mesh to draw.
         Mesh* mesh;
+
+        // optional world space segments of a line strip mesh, used for picking.
+        const SegmentBVH* lineSegments;
+
+        // optional analytic shape of the mesh in local space,
+        // picking tests it instead of the triangles.
+        const PrimitiveShape* primitive;
         
         // world transform matrix
         Matrix WorldXform;
-        Matrix TextureXForm;
         AABB bounds;
-        float4 emissive;
+
+        // kept in the node, the collectors override it for selected and wireframe nodes.
         float4 diffuse;
-        float3 specular;
-        float specPower;
         uint32_t flags;
-        LightEnvironment lighting;
 
         // the handle of the game object that created this node.
         ObjectGUID objectId;
 
-        float Distance;
+        // shared data, owned by the game object that created this node.
+        // they must stay valid as long as the node is in a collector.
+        const NodeMaterial* material;       // NULL for the default material.
+        const LightEnvironment* lighting;   // NULL for no lights.
 
-        Texture*        textures[TextureType::MAX];
+        const NodeMaterial& GetMaterial() const { return material ? *material : NodeMaterial::Default(); }
 
         void    SetFlag( Flags flagBit, bool bON )      { if ( bON ) { flags |= flagBit; } else { flags &= ~flagBit; } }
         bool    GetFlag( Flags flagBit ) const          { return (( flags & flagBit ) != 0 ); }
     };
+
+    // the collectors copy the nodes they don't reference, the pick set all of them,
+    // keep anything that is not needed to sort, cull or pick in NodeMaterial.
+    static_assert(sizeof(RenderableNode) <= 160, "RenderableNode is copied by the collectors, keep it small");
+
     typedef std::vector<RenderableNode> RenderNodeList;
+
+    // nodes drawn by the shaders, owned by the game objects or by the collector.
+    typedef std::vector<RenderableNode*> RenderNodeRefList;
 }
 
@@ -16,12 +16,30 @@ class RenderableNodeCollector : public NonCopyable
           : m_globalRenderFlags(GlobalRenderFlags::None)  {}
         virtual ~RenderableNodeCollector() {}
 
+        // add a temporary node, the collector keeps a copy of it.
         virtual void    Add( RenderableNode& r, RenderFlagsEnum rf, ShadersEnum shaderIdPref) = 0;
+
+        // add nodes owned by the caller, such as the render packets kept by game objects.
+        // the nodes must not be modified or destroyed until ClearLists() is called,
+        // the collector may reference them instead of copying them.
         virtual void    Add( const RenderNodeList::iterator& listBegin, const RenderNodeList::iterator& listEnd, RenderFlagsEnum rf, ShadersEnum shaderIdPref) = 0;
+        virtual void    AddRetained( RenderableNode* r, RenderFlagsEnum rf, ShadersEnum shaderIdPref)
+        {
+            Add( *r, rf, shaderIdPref);
+        }
 
         // Remove any renderables we have stored.
         virtual void ClearLists() = 0;
 
+        // split the collection across count jobs that may run on different threads.
+        // returns false if the collector must be filled by a single thread,
+        // otherwise each job adds its nodes to GetParallelCollector(index)
+        // and EndParallel() appends them to this collector in index order,
+        // so the result is the same as adding them from one thread.
+        virtual bool    BeginParallel( uint32_t /*count*/ ) { return false; }
+        virtual RenderableNodeCollector* GetParallelCollector( uint32_t /*index*/ ) { return NULL; }
+        virtual void    EndParallel() {}
+
         GlobalRenderFlagsEnum GetFlags()                          { return m_globalRenderFlags; }
         void            SetFlags( GlobalRenderFlagsEnum flags )   { m_globalRenderFlags = flags; }
 
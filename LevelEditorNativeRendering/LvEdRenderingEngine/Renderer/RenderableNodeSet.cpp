@@ -6,6 +6,7 @@
 ****************************************************************************/
 #include "RenderableNodeSet.h"
 #include "../Renderer/RenderContext.h"
+#include "../Core/ObjectTable.h"
 
 using namespace LvEdEngine;
 
@@ -26,9 +27,8 @@
         return;
     if(m_skipSelected)
     {
-        RenderContext* context = RenderContext::Inst();
-        if( context->selection.find( r.objectId ) != context->selection.end() )
-            return;        
+        if( ObjectTable::Inst()->IsSelected( r.objectId ) )
+            return;
     }
 
     m_renderNodes.push_back( r ); 
@@ -40,8 +40,7 @@
     if(m_skipSelected && listBegin != listEnd)
     {
         ObjectGUID gobId = listBegin->objectId;
-        RenderContext* context = RenderContext::Inst();
-        if( context->selection.find( gobId ) != context->selection.end() )
+        if( ObjectTable::Inst()->IsSelected( gobId ) )
             return;
 
     }
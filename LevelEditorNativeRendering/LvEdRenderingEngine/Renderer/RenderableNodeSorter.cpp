@@ -10,81 +10,232 @@
 #include <algorithm>
 #include "Model.h"
 #include "RenderContext.h"
+#include "../Core/ObjectTable.h"
+#include "../Core/Logger.h"
 
 
 using namespace LvEdEngine;
 
-#define GetBucketKey( _RenderFlagsEnum_, _ShadersEnum_ )   (( _RenderFlagsEnum_ << 10 ) | _ShadersEnum_ )
-
+static_assert(Shaders::COUNT <= (1 << DrawKeys::ShaderBits), "shader id must fit in the sort key");
 
 //---------------------------------------------------------------------------
-RenderableNodeSorter::RenderableNodeSorter()
+RenderableNodeSorter::RenderableNodeSorter() : m_bucketCount(0), m_droppedCount(0), m_droppedLogged(false),
+    m_parallelFirst(0), m_parallelCount(0), m_copyCount(0)
 {
 }
 
 //---------------------------------------------------------------------------
 RenderableNodeSorter::~RenderableNodeSorter()
 {
+    for ( auto it = m_pages.begin(); it != m_pages.end(); ++it )
+    {
+        delete[] (*it);
+    }
+    for ( auto it = m_parallel.begin(); it != m_parallel.end(); ++it )
+    {
+        delete (*it);
+    }
 }
 
 //---------------------------------------------------------------------------
 void RenderableNodeSorter::ClearLists()
 {
-    for ( auto it=m_buckets.begin(); it != m_buckets.end(); ++it )
+    // keep the capacity of the lists and the pages, they are reused by the next frame.
+    m_nodes.clear();
+    m_entries.clear();
+    for ( uint32_t i = 0; i < m_bucketCount; ++i )
     {
-        it->second.renderables.clear();
+        m_buckets[i].renderables.clear();
     }
+    m_bucketCount = 0;
+    m_droppedCount = 0;
+    m_copyCount = 0;
+    for ( uint32_t i = 0; i < m_parallelCount; ++i )
+    {
+        m_parallel[i]->ClearLists();
+    }
+    m_parallelCount = 0;
     ClearBounds();
 }
 
+//---------------------------------------------------------------------------
+bool RenderableNodeSorter::BeginParallel( uint32_t count )
+{
+    // the jobs of a previous call may still own nodes referenced by this sorter,
+    // use the sorters after them.
+    uint32_t first = m_parallelCount;
+    m_parallelCount += count;
+    while ( m_parallel.size() < m_parallelCount )
+    {
+        m_parallel.push_back( new RenderableNodeSorter() );
+    }
+    for ( uint32_t i = first; i < m_parallelCount; ++i )
+    {
+        m_parallel[i]->SetFlags( GetFlags() );
+    }
+    m_parallelFirst = first;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+RenderableNodeCollector* RenderableNodeSorter::GetParallelCollector( uint32_t index )
+{
+    assert( m_parallelFirst + index < m_parallelCount );
+    return m_parallel[ m_parallelFirst + index ];
+}
+
+//---------------------------------------------------------------------------
+void RenderableNodeSorter::EndParallel()
+{
+    for ( uint32_t i = m_parallelFirst; i < m_parallelCount; ++i )
+    {
+        RenderableNodeSorter* job = m_parallel[i];
+        uint32_t base = (uint32_t)m_nodes.size();
+        uint32_t count = (uint32_t)job->m_nodes.size();
+        m_droppedCount += job->m_droppedCount;
+        if ( base + count > DrawKeys::MaxEntries )
+        {
+            // the nodes past the last index are dropped, as in AddEntry().
+            m_droppedCount += base + count - DrawKeys::MaxEntries;
+            count = DrawKeys::MaxEntries - base;
+        }
+        m_nodes.insert( m_nodes.end(), job->m_nodes.begin(), job->m_nodes.begin() + count );
+        for ( uint32_t e = 0; e < count; ++e )
+        {
+            // the index is in the low bits, adding the base doesn't touch the key.
+            m_entries.push_back( job->m_entries[e] + base );
+        }
+        m_bounds.Extend( job->GetBounds() );
+
+        // the copies made by the job stay in its pages until ClearLists().
+        job->m_nodes.clear();
+        job->m_entries.clear();
+        job->m_droppedCount = 0;
+    }
+}
+
 //---------------------------------------------------------------------------
 unsigned int RenderableNodeSorter::GetBucketCount()
 {
-    return (unsigned int)m_bucketKeys.size();
+    return m_bucketCount;
 }
 
 //---------------------------------------------------------------------------
 RenderableNodeSorter::Bucket* RenderableNodeSorter::GetBucket(uint32_t index)
 {
-    assert(index < m_bucketKeys.size());
-    unsigned int key = m_bucketKeys[index];
-    return &m_buckets[key];
+    assert(index < m_bucketCount);
+    return &m_buckets[index];
 }
 
 //---------------------------------------------------------------------------
-static bool BucketKeySorting(const uint32_t n1, const uint32_t n2)
+void RenderableNodeSorter::AddEntry( RenderableNode* r, uint32_t rf, ShadersEnum shaderId )
 {
-    return n1 < n2;
+    if ( m_nodes.size() >= DrawKeys::MaxEntries )
+    {
+        // the index doesn't fit in the entry, the node is not drawn. Sort() logs it.
+        m_droppedCount++;
+        return;
+    }
+
+    // only the blended nodes are sorted by depth.
+    bool blended = ( rf & RenderFlags::AlphaBlend ) != 0;
+    float depth = 0.0f;
+    if ( blended )
+    {
+        Camera& cam = RenderContext::Inst()->Cam();
+        depth = dot( cam.CamLook(), r->bounds.GetCenter() - cam.CamPos() );
+    }
+    m_entries.push_back( DrawKeys::MakeEntry( rf, shaderId, blended, depth, (uint32_t)m_nodes.size() ) );
+    m_nodes.push_back( r );
 }
 
 //---------------------------------------------------------------------------
-RenderableNodeSorter::Bucket& RenderableNodeSorter::GetOrMakeBucket( uint32_t rf, ShadersEnum shaderId )
+// sort the entries, then split them into buckets.
+void RenderableNodeSorter::Sort()
 {
-    uint32_t bucketKey = GetBucketKey(rf, shaderId );
+    for ( uint32_t i = 0; i < m_bucketCount; ++i )
+    {
+        m_buckets[i].renderables.clear();
+    }
+    m_bucketCount = 0;
 
-    BucketMap::iterator it = m_buckets.find( bucketKey );
-    if ( it == m_buckets.end() )
+    if ( m_droppedCount > 0 && !m_droppedLogged )
     {
-        std::pair<uint32_t,Bucket> newVal;
-        newVal.first = bucketKey;
-        newVal.second.renderFlags  = (RenderFlagsEnum)rf;
-        newVal.second.shaderId     = shaderId;
+        Logger::Log( OutputMessageType::Warning, "RenderableNodeSorter: more than %u nodes, %u nodes are not drawn\n",
+            DrawKeys::MaxEntries, m_droppedCount );
+        m_droppedLogged = true;
+    }
+
+    m_keys.Sort( m_entries );
 
-        std::pair<BucketMap::iterator, bool> insRslt = m_buckets.insert( newVal );
-        it = insRslt.first;
-        m_bucketKeys.push_back(bucketKey);
-        std::sort(m_bucketKeys.begin(), m_bucketKeys.end(), BucketKeySorting);
+    // consecutive entries with the same flags and shader form a bucket.
+    uint32_t count = (uint32_t)m_entries.size();
+    uint32_t bucketKey = ~0u;
+    Bucket* bucket = NULL;
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        uint32_t key = DrawKeys::GetBucket( m_entries[i] );
+        if ( key != bucketKey )
+        {
+            bucketKey = key;
+            if ( m_bucketCount == m_buckets.size() )
+            {
+                m_buckets.push_back( Bucket() );
+            }
+            bucket = &m_buckets[m_bucketCount++];
+            bucket->shaderId = (ShadersEnum)( key & ( ( 1 << DrawKeys::ShaderBits ) - 1 ) );
+            bucket->renderFlags = (RenderFlagsEnum)( key >> DrawKeys::ShaderBits );
+        }
+        bucket->renderables.push_back( m_nodes[ DrawKeys::GetIndex( m_entries[i] ) ] );
     }
-    return it->second;
+}
+
+//---------------------------------------------------------------------------
+uint32_t RenderableNodeSorter::Debug_GetCopyCount() const
+{
+    uint32_t count = m_copyCount;
+    for ( uint32_t i = 0; i < m_parallelCount; ++i )
+    {
+        count += m_parallel[i]->Debug_GetCopyCount();
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------
+// copy the node to the frame storage, the copy is valid until ClearLists().
+RenderableNode* RenderableNodeSorter::CopyNode( const RenderableNode& r )
+{
+    uint32_t page = m_copyCount / PageSize;
+    if ( page == m_pages.size() )
+    {
+        m_pages.push_back( new RenderableNode[PageSize] );
+    }
+    RenderableNode* node = &m_pages[page][m_copyCount % PageSize];
+    m_copyCount++;
+    *node = r;
+    return node;
 }
 
 //---------------------------------------------------------------------------
 void RenderableNodeSorter::Add(RenderableNode& r, RenderFlagsEnum rf, ShadersEnum shaderId)
 {
-    
+    AddNode( &r, false, rf, shaderId );
+}
+
+//---------------------------------------------------------------------------
+void RenderableNodeSorter::AddRetained(RenderableNode* r, RenderFlagsEnum rf, ShadersEnum shaderId)
+{
+    AddNode( r, true, rf, shaderId );
+}
+
+//---------------------------------------------------------------------------
+// retained nodes are referenced as they are, the others are copied.
+void RenderableNodeSorter::AddNode(RenderableNode* rn, bool retained, RenderFlagsEnum rf, ShadersEnum shaderId)
+{
+    const RenderableNode& r = *rn;
     assert(shaderId != Shaders::NONE);
     RenderContext* context = RenderContext::Inst();
-    bool selected = ( context->selection.find( r.objectId ) != context->selection.end() );    
+    bool selected = ObjectTable::Inst()->IsSelected( r.objectId );
          
     PrimitiveTypeEnum primtype = r.mesh->primitiveType;
     GlobalRenderFlagsEnum gflags = this->GetFlags();
@@ -99,35 +250,32 @@ static bool BucketKeySorting(const uint32_t n1, const uint32_t n2)
     {
          if(gflags & GlobalRenderFlags::Solid) 
          {
-             Bucket& bucket = GetOrMakeBucket(flags, shaderId);
-             bucket.renderables.push_back( r );
+             AddEntry( retained ? rn : CopyNode(r), flags, shaderId );
              if(r.GetFlag(RenderableNode::kShadowCaster))
                  m_bounds.Extend(r.bounds);    
          }
 
          if(selected || wireflagset)
          {
-             RenderableNode node = r;
-             node.diffuse = selected ? context->State()->GetSelectionColor() : context->State()->GetWireframeColor();
+             RenderableNode* node = CopyNode(r);
+             node->diffuse = selected ? context->State()->GetSelectionColor() : context->State()->GetWireframeColor();
              flags &= ~RenderFlags::AlphaBlend;             
-             Bucket& bucket = GetOrMakeBucket(flags, Shaders::WireFrameShader );
-             bucket.renderables.push_back( node );
+             AddEntry( node, flags, Shaders::WireFrameShader );
          }         
     }
     else
     {
         flags &= ~RenderFlags::AlphaBlend;
-        Bucket& bucket = GetOrMakeBucket(flags, shaderId);
 
         if(selected)
         {
-            RenderableNode node = r;
-            node.diffuse = context->State()->GetSelectionColor();
-            bucket.renderables.push_back( node);
+            RenderableNode* node = CopyNode(r);
+            node->diffuse = context->State()->GetSelectionColor();
+            AddEntry( node, flags, shaderId );
         }
         else
         {
-            bucket.renderables.push_back( r );
+            AddEntry( retained ? rn : CopyNode(r), flags, shaderId );
         }               
     }
 }
@@ -142,7 +290,7 @@ static bool BucketKeySorting(const uint32_t n1, const uint32_t n2)
     assert(shaderId != Shaders::NONE);
     ObjectGUID gobId = listBegin->objectId;
     RenderContext* context = RenderContext::Inst();
-    bool selected = ( context->selection.find( gobId ) != context->selection.end() );
+    bool selected = ObjectTable::Inst()->IsSelected( gobId );
     //bool isShadowCaster = listBegin->GetFlag( RenderableNode::kShadowCaster );
     GlobalRenderFlagsEnum gflags = this->GetFlags();
 
@@ -158,10 +306,9 @@ static bool BucketKeySorting(const uint32_t n1, const uint32_t n2)
     {
          if(gflags & GlobalRenderFlags::Solid)
          {
-             Bucket& bucket = GetOrMakeBucket(flags, shaderId);
-             bucket.renderables.insert( bucket.renderables.end(), listBegin, listEnd );
              for ( auto it = listBegin; it != listEnd; ++it )      
              {
+                 AddEntry( &(*it), flags, shaderId );
                  if(it->GetFlag(RenderableNode::kShadowCaster))
                      m_bounds.Extend(it->bounds);  
              }
@@ -171,34 +318,35 @@ static bool BucketKeySorting(const uint32_t n1, const uint32_t n2)
          {
              float4 color = selected ? context->State()->GetSelectionColor() : context->State()->GetWireframeColor();
              flags &= ~RenderFlags::AlphaBlend;             
-             Bucket& bucket = GetOrMakeBucket(flags, Shaders::WireFrameShader );
 
              for ( auto it = listBegin; it != listEnd; ++it )      
              {
-                 RenderableNode node = (*it);
-                 node.diffuse = color;
-                 bucket.renderables.push_back(node);
+                 RenderableNode* node = CopyNode(*it);
+                 node->diffuse = color;
+                 AddEntry( node, flags, Shaders::WireFrameShader );
              }
          }
     }
     else
     {
         flags &= ~RenderFlags::AlphaBlend;
-        Bucket& bucket = GetOrMakeBucket(flags, shaderId );
 
         if(wireflagset || selected)
         {
             float4 color = context->State()->GetSelectionColor();
              for ( auto it = listBegin; it != listEnd; ++it )      
              {
-                 RenderableNode node = *it;
-                 node.diffuse = color;
-                 bucket.renderables.push_back(node);
+                 RenderableNode* node = CopyNode(*it);
+                 node->diffuse = color;
+                 AddEntry( node, flags, shaderId );
              }
         }
         else
         {
-            bucket.renderables.insert( bucket.renderables.end(), listBegin, listEnd );      
+            for ( auto it = listBegin; it != listEnd; ++it )      
+            {
+                AddEntry( &(*it), flags, shaderId );
+            }
         }        
     }
 }
@@ -206,15 +354,6 @@ static bool BucketKeySorting(const uint32_t n1, const uint32_t n2)
 //---------------------------------------------------------------------------
 void RenderableNodeSorter::Debug_GetStats( uint32_t& numBuckets, uint32_t& numItems )
 {
-    numBuckets = 0;
-    numItems = 0;
-    for ( auto it = m_buckets.begin(); it != m_buckets.end(); ++it )
-    {
-        uint32_t bucketItems = (uint32_t)it->second.renderables.size();
-        numItems += bucketItems;
-        if ( bucketItems > 0 )
-        {
-            numBuckets++;
-        }
-    }
+    numBuckets = m_bucketCount;
+    numItems = (uint32_t)m_entries.size();
 }
@@ -5,7 +5,8 @@
 #include "Renderable.h"
 #include "RenderableNodeCollector.h"
 #include "Shader.h"
-#include <map>
+#include "DrawKeys.h"
+#include <vector>
 
 namespace LvEdEngine
 {
@@ -21,17 +22,35 @@ class RenderableNodeSorter : public RenderableNodeCollector
         // using the combination of the global render flags and
         // the given render flags.
         // this method assumes the this class have access to global render flags.
+        // the buckets reference the retained nodes and the nodes of the range Add(),
+        // temporary nodes, and the copies made to override the color of selected
+        // and wireframe nodes, are stored in pages that are reused every frame.
         virtual void Add( const RenderNodeList::iterator& listBegin, const RenderNodeList::iterator& listEnd, RenderFlagsEnum rf, ShadersEnum shaderIdPref);
         virtual void Add(RenderableNode& r, RenderFlagsEnum rf, ShadersEnum shaderIdPref);
+        virtual void AddRetained(RenderableNode* r, RenderFlagsEnum rf, ShadersEnum shaderIdPref);
+
+        // sort the nodes by pass, render flags and shader, and group them into buckets.
+        // call after adding the nodes of the frame and before GetBucketCount() and GetBucket().
+        // opaque nodes are drawn in the order they were added and blended nodes back to front.
+        // the nodes over DrawKeys::MaxEntries are dropped, the first frame that drops some logs it.
+        void Sort();
+
+        // each job fills its own sorter, with its own frame storage and shadow caster bounds.
+        virtual bool BeginParallel( uint32_t count );
+        virtual RenderableNodeCollector* GetParallelCollector( uint32_t index );
+        virtual void EndParallel();
 
         virtual void Debug_GetStats( uint32_t& numBuckets, uint32_t& numItems );
 
+        // number of nodes copied since the last ClearLists().
+        uint32_t Debug_GetCopyCount() const;
+
         class Bucket
         {
         public:
             ShadersEnum     shaderId;
             RenderFlagsEnum renderFlags;
-            RenderNodeList  renderables;
+            RenderNodeRefList renderables;
 
             Bucket() : renderFlags((RenderFlagsEnum)0) {}
         };
@@ -40,11 +59,28 @@ class Bucket
         Bucket* GetBucket(uint32_t index);
 
     private:
-        typedef std::map<uint32_t,Bucket> BucketMap;
-        typedef std::vector<uint32_t> BucketKeys;
-        BucketMap       m_buckets;
-        BucketKeys      m_bucketKeys;
-        Bucket&         GetOrMakeBucket( uint32_t rf, ShadersEnum shaderId);
+        // the nodes in the order they were added, and one sort entry
+        // per node that packs the sort key with the index of the node.
+        std::vector<RenderableNode*> m_nodes;
+        std::vector<uint64_t> m_entries;
+        DrawKeys        m_keys;
+        std::vector<Bucket> m_buckets;    // reused between frames, only the first m_bucketCount are valid.
+        uint32_t        m_bucketCount;
+        uint32_t        m_droppedCount;   // nodes not added since the last ClearLists().
+        bool            m_droppedLogged;
+        void            AddEntry( RenderableNode* r, uint32_t rf, ShadersEnum shaderId);
+        void            AddNode( RenderableNode* r, bool retained, RenderFlagsEnum rf, ShadersEnum shaderId);
+        RenderableNode* CopyNode( const RenderableNode& r );
+
+        // sorters of the parallel jobs, kept until ClearLists() because
+        // this sorter references the nodes they copied.
+        std::vector<RenderableNodeSorter*> m_parallel;
+        uint32_t        m_parallelFirst;  // first sorter of the current BeginParallel().
+        uint32_t        m_parallelCount;
+
+        static const uint32_t PageSize = 256;
+        std::vector<RenderableNode*> m_pages; // arrays of PageSize nodes.
+        uint32_t        m_copyCount;
     };
 
 }
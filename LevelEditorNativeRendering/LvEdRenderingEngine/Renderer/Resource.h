@@ -3,6 +3,7 @@
 #pragma once
 #include "../Core/WinHeaders.h"
 #include "../Core/Object.h"
+#include "../Core/ObjectPool.h"
 #include "RenderEnums.h"
 
 namespace LvEdEngine
@@ -37,6 +38,9 @@ class ResourceReference  : public Object
         ~ResourceReference();
         virtual const char* ClassName() const {return StaticClassName();}
         static const char* StaticClassName(){return "ResourceReference";}
+        // allocated from the object pools, see ObjectPool.
+        static void* operator new(size_t size) { return ObjectPool::AllocateObject(size); }
+        static void operator delete(void* p, size_t size) { ObjectPool::FreeObject(p, size); }
         Resource * GetTarget();       
         void SetTarget(const wchar_t* fileName, Resource* def = NULL);
     protected:
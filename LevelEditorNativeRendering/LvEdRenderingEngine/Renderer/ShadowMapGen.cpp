@@ -110,12 +110,12 @@
 }
 
 //---------------------------------------------------------------------------
-void ShadowMapGen::DrawNodes(const RenderNodeList& renderNodes)
+void ShadowMapGen::DrawNodes(const RenderNodeRefList& renderNodes)
 {  
     // Render the scene into the shadow map
     for(auto it = renderNodes.begin(); it != renderNodes.end(); it++)
     {        
-        const RenderableNode& renderable = (*it);
+        const RenderableNode& renderable = *(*it);
         DrawRenderable(renderable);        
     }        
 }
@@ -25,7 +25,7 @@ class ShadowMapGen : public NonCopyable
 
         //  Do the drawing.
         //  Connect resources, vertex and index buffers, and draw the world.
-        void DrawNodes(const RenderNodeList& renderNodes);
+        void DrawNodes(const RenderNodeRefList& renderNodes);
 
         //  Called after drawing.
         //  Perform any needed post-drawing cleanup.
@@ -11,6 +11,7 @@ namespace LvEdEngine
 {
 
 static Mesh* s_meshes[RenderShape::MAX];
+static PrimitiveShape s_primitives[RenderShape::MAX];
 
 
 // declarations
@@ -94,6 +95,13 @@ void ShapeLibStartup(ID3D11Device* device)
     s_meshes[RenderShape::Cone]             = CreateUnitCone(device);
     s_meshes[RenderShape::AsteriskQuads]    = CreateStarUnitQuads(device);
 
+    // same dimensions as the meshes.
+    s_primitives[RenderShape::Quad]         = PrimitiveShape(PrimitiveShape::Quad, float3(0.5f, 0.5f, 0.0f));
+    s_primitives[RenderShape::Sphere]       = PrimitiveShape(PrimitiveShape::Sphere, float3(0.5f, 0.0f, 0.0f));
+    s_primitives[RenderShape::Cylinder]     = PrimitiveShape(PrimitiveShape::Cylinder, float3(0.5f, 0.5f, 0.0f));
+    s_primitives[RenderShape::Torus]        = PrimitiveShape(PrimitiveShape::Torus, float3(0.4f, 0.1f, 0.0f));
+    s_primitives[RenderShape::Cube]         = PrimitiveShape(PrimitiveShape::Box, float3(0.5f, 0.5f, 0.5f));
+    s_primitives[RenderShape::Cone]         = PrimitiveShape(PrimitiveShape::Cone, float3(0.5f, 0.5f, 0.0f));
 }
     
 //-------------------------------------------------------------------------------------------------
@@ -114,6 +122,14 @@ void ShapeLibShutdown()
     return s_meshes[shape];
 }
 
+//-------------------------------------------------------------------------------------------------
+const PrimitiveShape* ShapeLibGetPrimitive(RenderShapeEnum shape)
+{
+    if(s_primitives[shape].type == PrimitiveShape::None)
+        return NULL;
+    return &s_primitives[shape];
+}
+
 
 // ----------------------------------------------------------------------------------------------
 // UTILITY FUNCTIONS
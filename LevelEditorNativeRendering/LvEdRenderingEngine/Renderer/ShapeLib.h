@@ -46,4 +46,9 @@ enum RenderShape
 
     // Get a mesh for one of the shape enum's.
     Mesh* ShapeLibGetMesh(RenderShapeEnum shape);    
+
+    // Get the analytic form of a shape, in the local space of its mesh.
+    // it is used to pick the shape without testing its triangles.
+    // returns NULL if the shape can only be picked using its mesh.
+    const PrimitiveShape* ShapeLibGetPrimitive(RenderShapeEnum shape);
 };
\ No newline at end of file
@@ -110,11 +110,11 @@
 }
 
 //---------------------------------------------------------------------------
-void SkyDomeShader::DrawNodes(const RenderNodeList& nodes)
+void SkyDomeShader::DrawNodes(const RenderNodeRefList& nodes)
 {
     for(auto it = nodes.begin(); it != nodes.end(); it++)
     {
-        const RenderableNode& renderable = (*it);            
+        const RenderableNode& renderable = *(*it);            
         Draw( renderable );
     }
 }
@@ -125,9 +125,10 @@
     ID3D11DeviceContext*  d3dcontext = m_rc->Context();
     
     ID3D11ShaderResourceView* cubemap[1] = {NULL};
-    if(r.textures[TextureType::Cubemap])
+    const NodeMaterial& mat = r.GetMaterial();
+    if(mat.textures[TextureType::Cubemap])
     {
-        cubemap[0] =r.textures[TextureType::Cubemap]->GetView();               
+        cubemap[0] =mat.textures[TextureType::Cubemap]->GetView();               
     }   
     d3dcontext->PSSetShaderResources( 0, 1, cubemap );    
 
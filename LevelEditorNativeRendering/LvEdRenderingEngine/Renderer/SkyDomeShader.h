@@ -17,7 +17,7 @@ class SkyDomeShader : public Shader
         virtual void Begin(RenderContext* rc);
         virtual void End();
         virtual void SetRenderFlag(RenderFlagsEnum rf);
-        virtual void DrawNodes(const RenderNodeList& renderNodes);
+        virtual void DrawNodes(const RenderNodeRefList& renderNodes);
         void Draw( const RenderableNode& r );  
 
     private:
@@ -11,6 +11,7 @@
 #include "Model.h"
 #include "RenderBuffer.h"
 #include "RenderContext.h"
+#include "../Core/ObjectTable.h"
 #include "RenderUtil.h"
 #include "Texture.h"
 #include "TextureLib.h"
@@ -287,7 +288,7 @@
     flags |= (gflags & GlobalRenderFlags::Lit) ? RenderFlags::Lit : 0;
     flags |= (gflags & GlobalRenderFlags::RenderBackFace) ? RenderFlags::RenderBackFace : 0;
     
-    bool selected = ( m_rc->selection.find( terrain->GetInstanceId() ) != m_rc->selection.end() );    
+    bool selected = ObjectTable::Inst()->IsSelected( terrain->GetInstanceId() );
     bool wireframe = selected || (gflags & GlobalRenderFlags::WireFrame);
               
     Matrix world = terrain->GetWorldTransform();
@@ -478,7 +479,7 @@
 }
 
 //---------------------------------------------------------------------------
-void TerrainShader::DrawNodes(const RenderNodeList& /*renderNodes*/)
+void TerrainShader::DrawNodes(const RenderNodeRefList& /*renderNodes*/)
 {
     // use RenderTerrain() instead of this function.
     assert(0);   
@@ -45,7 +45,7 @@ class TerrainShader : public Shader
 
     //  Do the drawing.
     //  Connect resources, vertex and index buffers, and draw the world.
-    virtual void DrawNodes(const RenderNodeList& renderNodes);
+    virtual void DrawNodes(const RenderNodeRefList& renderNodes);
 
     //  Called after drawing.
     //  Perform any needed post-drawing cleanup.
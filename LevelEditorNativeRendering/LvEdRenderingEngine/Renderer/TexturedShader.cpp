@@ -137,11 +137,11 @@
 }
 
 //---------------------------------------------------------------------------
-void TexturedShader::DrawNodes(const RenderNodeList& renderNodes)
+void TexturedShader::DrawNodes(const RenderNodeRefList& renderNodes)
 {               
     for(auto it = renderNodes.begin(); it != renderNodes.end(); it++)
     {        
-        const RenderableNode& renderable = (*it);
+        const RenderableNode& renderable = *(*it);
         DrawRenderable( renderable );
     }
 }
@@ -153,31 +153,41 @@
     // update per draw cb.
     ID3D11DeviceContext*  dc = m_rc->Context();
     ID3D11ShaderResourceView* textures[] = {NULL, NULL, NULL};
+    const NodeMaterial& mat = r.GetMaterial();
     
     Matrix::Transpose(r.WorldXform, m_perDrawCb.Data.cb_world );
     m_perDrawCb.Data.cb_hasDiffuseMap = 0;
     m_perDrawCb.Data.cb_hasNormalMap = 0;
     m_perDrawCb.Data.cb_hasSpecularMap = 0;
-    m_perDrawCb.Data.cb_lighting =  r.lighting;
+    if(r.lighting)
+    {
+        m_perDrawCb.Data.cb_lighting =  *r.lighting;
+    }
+    else
+    {
+        m_perDrawCb.Data.cb_lighting.numDirLights = 0;
+        m_perDrawCb.Data.cb_lighting.numBoxLights = 0;
+        m_perDrawCb.Data.cb_lighting.numPointLights = 0;
+    }
 
     Matrix w = r.WorldXform;        
     w.M41 = w.M42 = w.M43 = 0; w.M44 = 1;
     Matrix::Invert(w,m_perDrawCb.Data.cb_worldInvTrans);
-    Matrix::Transpose(r.TextureXForm, m_perDrawCb.Data.cb_textureTrans);
+    Matrix::Transpose(mat.TextureXForm, m_perDrawCb.Data.cb_textureTrans);
     m_perDrawCb.Data.cb_matDiffuse     = r.diffuse;
-    m_perDrawCb.Data.cb_matEmissive    = r.emissive;
-    m_perDrawCb.Data.cb_matSpecular    = float4(r.specular.x,r.specular.y, r.specular.z, r.specPower);
+    m_perDrawCb.Data.cb_matEmissive    = mat.emissive;
+    m_perDrawCb.Data.cb_matSpecular    = float4(mat.specular.x,mat.specular.y, mat.specular.z, mat.specPower);
 
-    if(r.textures[TextureType::DIFFUSE])
+    if(mat.textures[TextureType::DIFFUSE])
     {
         m_perDrawCb.Data.cb_hasDiffuseMap = 1;
-        textures[0] = r.textures[TextureType::DIFFUSE]->GetView();
+        textures[0] = mat.textures[TextureType::DIFFUSE]->GetView();
     }
 
-    if(r.textures[TextureType::NORMAL])
+    if(mat.textures[TextureType::NORMAL])
     {
         m_perDrawCb.Data.cb_hasNormalMap = 1;
-        textures[1] = r.textures[TextureType::NORMAL]->GetView();
+        textures[1] = mat.textures[TextureType::NORMAL]->GetView();
     }
         
     m_perDrawCb.Update(dc);
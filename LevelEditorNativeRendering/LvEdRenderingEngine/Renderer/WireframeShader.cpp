@@ -9,6 +9,7 @@
 #include "../Core/Utils.h"
 #include "RenderContext.h"
 #include "RenderState.h"
+#include "../Core/ObjectTable.h"
 #include "Model.h"
 #include "GpuResourceFactory.h"
 
@@ -73,14 +74,14 @@
 }
 
 
-void WireFrameShader::DrawNodes(const RenderNodeList& renderNodes)
+void WireFrameShader::DrawNodes(const RenderNodeRefList& renderNodes)
 {        
     ID3D11DeviceContext* d3dContext = m_rcntx->Context();
     for ( auto it = renderNodes.begin(); it != renderNodes.end(); ++it )
     {
         
-        const RenderableNode& r = (*it);
-		bool selected = (m_rcntx->selection.find(r.objectId) != m_rcntx->selection.end());
+        const RenderableNode& r = *(*it);
+		bool selected = ObjectTable::Inst()->IsSelected(r.objectId);
 		
         Matrix::Transpose(r.WorldXform,m_cbPerObject.Data.worldXform);   
 		m_cbPerObject.Data.color = r.diffuse;
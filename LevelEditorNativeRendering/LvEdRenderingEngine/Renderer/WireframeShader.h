@@ -33,7 +33,7 @@ class WireFrameShader : public Shader
         virtual void Begin(RenderContext* rc);
         virtual void End();
         virtual void SetRenderFlag(RenderFlagsEnum rf);
-        virtual void DrawNodes(const RenderNodeList& renderNodes);
+        virtual void DrawNodes(const RenderNodeRefList& renderNodes);
     private:
 		typedef Shader super;
         struct CbPerFrame
@@ -0,0 +1,131 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "AABBStream.h"
+#include "TriangleStream.h"
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define AABBSTREAM_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace LvEdEngine
+{
+    // -------------------------------------------------------------------------------------
+    void AABBStream::Add(const AABB& box)
+    {
+        uint32_t lane = m_count % 4;
+        if(lane == 0)
+        {
+            // padding lanes are empty boxes at the origin.
+            AABBBlock b;
+            for(int i = 0; i < 4; i++)
+            {
+                b.cx[i] = b.cy[i] = b.cz[i] = 0.0f;
+                b.rx[i] = b.ry[i] = b.rz[i] = 0.0f;
+            }
+            m_blocks.push_back(b);
+        }
+
+        float3 c = box.GetCenter();
+        float3 r = box.Max() - c;
+        AABBBlock& b = m_blocks.back();
+        b.cx[lane] = c.x; b.cy[lane] = c.y; b.cz[lane] = c.z;
+        b.rx[lane] = r.x; b.ry[lane] = r.y; b.rz[lane] = r.z;
+        m_count++;
+    }
+
+    // -------------------------------------------------------------------------------------
+    void AABBStream::Clear()
+    {
+        m_blocks.clear();
+        m_count = 0;
+    }
+
+#ifdef AABBSTREAM_SSE
+    // plane/box test of 4 boxes against the 6 planes of the frustum.
+    // the operations are done in the same order as in FrustumAABBIntersect().
+    // returns the mask of the boxes that are outside in the low 4 bits
+    // and the mask of the boxes that intersect a plane in the high 4 bits.
+    static uint32_t FrustumBlockMaskSSE(const AABBBlock& b, const Frustum& fr)
+    {
+        const __m128 cx = _mm_loadu_ps(b.cx);
+        const __m128 cy = _mm_loadu_ps(b.cy);
+        const __m128 cz = _mm_loadu_ps(b.cz);
+        const __m128 rx = _mm_loadu_ps(b.rx);
+        const __m128 ry = _mm_loadu_ps(b.ry);
+        const __m128 rz = _mm_loadu_ps(b.rz);
+        const __m128 zero = _mm_setzero_ps();
+
+        __m128 outside = zero;
+        __m128 intersect = zero;
+        for(int i = 0; i < Frustum::NumPlanes; i++)
+        {
+            const Plane& plane = fr[i];
+            __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, _mm_set1_ps(abs(plane.normal.x))),
+                                             _mm_mul_ps(ry, _mm_set1_ps(abs(plane.normal.y)))),
+                                  _mm_mul_ps(rz, _mm_set1_ps(abs(plane.normal.z))));
+            __m128 s = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.x), cx),
+                                                        _mm_mul_ps(_mm_set1_ps(plane.normal.y), cy)),
+                                             _mm_mul_ps(_mm_set1_ps(plane.normal.z), cz)),
+                                  _mm_set1_ps(plane.d));
+
+            // the box is not completely in the positive half-space
+            // and it is either outside or intersecting the plane.
+            __m128 notInside = _mm_cmpnlt_ps(zero, _mm_sub_ps(s, e));
+            outside = _mm_or_ps(outside, _mm_and_ps(notInside, _mm_cmplt_ps(_mm_add_ps(s, e), zero)));
+            intersect = _mm_or_ps(intersect, notInside);
+        }
+        return (uint32_t)_mm_movemask_ps(outside) | ((uint32_t)_mm_movemask_ps(intersect) << 4);
+    }
+#endif
+
+    // -------------------------------------------------------------------------------------
+    static uint8_t FrustumBlockLaneScalar(const AABBBlock& b, uint32_t lane, const Frustum& fr)
+    {
+        float3 c(b.cx[lane], b.cy[lane], b.cz[lane]);
+        float3 r(b.rx[lane], b.ry[lane], b.rz[lane]);
+        bool intersects = false;
+        for(int i = 0; i < Frustum::NumPlanes; i++)
+        {
+            const Plane& plane = fr[i];
+            float e = r.x * abs(plane.normal.x)
+                + r.y * abs(plane.normal.y)
+                + r.z * abs(plane.normal.z);
+            float s = plane.Eval(c);
+            if((s - e) > 0) continue;
+            if((s + e) < 0) return 0;
+            intersects = true;
+        }
+        return intersects ? 1 : 2;
+    }
+
+    // -------------------------------------------------------------------------------------
+    void AABBStream::FrustumIntersect(const Frustum& frustum, uint8_t* results) const
+    {
+        for(uint32_t bi = 0; bi < m_blocks.size(); bi++)
+        {
+            const AABBBlock& b = m_blocks[bi];
+            uint32_t laneCount = std::min(4u, m_count - bi * 4);
+            uint8_t* out = results + bi * 4;
+#ifdef AABBSTREAM_SSE
+            if(TriangleStream::UseSIMD())
+            {
+                uint32_t mask = FrustumBlockMaskSSE(b, frustum);
+                for(uint32_t lane = 0; lane < laneCount; lane++)
+                {
+                    if(mask & (1 << lane))
+                        out[lane] = 0;
+                    else
+                        out[lane] = (mask & (16 << lane)) ? 1 : 2;
+                }
+                continue;
+            }
+#endif
+            for(uint32_t lane = 0; lane < laneCount; lane++)
+            {
+                out[lane] = FrustumBlockLaneScalar(b, lane, frustum);
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+
+namespace LvEdEngine
+{
+    // center and half extent of 4 boxes in structure of arrays layout.
+    struct AABBBlock
+    {
+        float cx[4]; float cy[4]; float cz[4];
+        float rx[4]; float ry[4]; float rz[4];
+    };
+
+    // list of boxes packed in blocks of 4 for SIMD culling.
+    // the center and extent are computed the same way as in FrustumAABBIntersect()
+    // so the results are identical to the scalar code path.
+    class AABBStream
+    {
+    public:
+        AABBStream() : m_count(0) {}
+
+        void Add(const AABB& box);
+        void Clear();
+
+        bool IsEmpty() const { return m_count == 0; }
+        uint32_t GetCount() const { return m_count; }
+
+        // classify all the boxes against the frustum.
+        // results must have room for GetCount() entries, results[i] is the
+        // same as FrustumAABBIntersect(frustum, box i):
+        // 0 = no intersection, 1 = intersection, 2 = box is completely inside frustum.
+        void FrustumIntersect(const Frustum& frustum, uint8_t* results) const;
+
+    private:
+        std::vector<AABBBlock> m_blocks;
+        uint32_t m_count;
+    };
+}
@@ -0,0 +1,216 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "BVH.h"
+#include <algorithm>
+#include <float.h>
+
+namespace LvEdEngine
+{
+    static const uint32_t BVHBinCount = 16;
+    static const uint32_t BVHMinLeafSize = 2;
+    static const uint32_t BVHMaxLeafSize = 8;
+
+    // relative traversal cost vs primitive intersection cost used by SAH.
+    static const float BVHTraversalCost = 1.0f;
+
+    static float HalfSurfaceArea(const float3& min, const float3& max)
+    {
+        float3 e = max - min;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    // true if the centroid of the primitive falls in a bin left of the split.
+    struct BVH::BinPredicate
+    {
+        const BuildPrim* prims;
+        int axis;
+        float cmin;
+        float scale;
+        uint32_t split;
+        bool operator()(uint32_t p) const
+        {
+            uint32_t b = std::min(BVHBinCount - 1, (uint32_t)((prims[p].centroid[axis] - cmin) * scale));
+            return b < split;
+        }
+    };
+
+    void BVH::Clear()
+    {
+        m_nodes.clear();
+        m_primIndices.clear();
+        m_buildPrims.clear();
+        m_triangles.Clear();
+    }
+
+    void BVH::BuildFromTriangles(const float3* pos, const uint32_t* indices, uint32_t indicesCount)
+    {
+        uint32_t triCount = indicesCount / 3;
+        std::vector<AABB> triBounds(triCount);
+        for(uint32_t t = 0; t < triCount; t++)
+        {
+            const float3& A = pos[indices[3*t]];
+            const float3& B = pos[indices[3*t+1]];
+            const float3& C = pos[indices[3*t+2]];
+            triBounds[t] = AABB(minimize(minimize(A, B), C), maximize(maximize(A, B), C));
+        }
+        Build(triCount ? &triBounds[0] : NULL, triCount);
+        if(triCount)
+            m_triangles.Build(pos, indices, indicesCount, &m_primIndices[0]);
+    }
+
+    void BVH::Build(const AABB* primBounds, uint32_t primCount)
+    {
+        Clear();
+        if(primCount == 0) return;
+
+        m_buildPrims.resize(primCount);
+        m_primIndices.resize(primCount);
+        for(uint32_t i = 0; i < primCount; i++)
+        {
+            // pad the bounds a little so that rays grazing an edge
+            // that lies on the box face are not rejected due to rounding.
+            float3 min = primBounds[i].Min();
+            float3 max = primBounds[i].Max();
+            float3 pad = (max - min) * 1e-4f + float3(1e-6f, 1e-6f, 1e-6f);
+            BuildPrim& prim = m_buildPrims[i];
+            prim.min = min - pad;
+            prim.max = max + pad;
+            prim.centroid = (min + max) * 0.5f;
+            m_primIndices[i] = i;
+        }
+
+        m_nodes.reserve(2 * primCount);
+        m_nodes.resize(1);
+        BuildRecursive(0, 0, primCount, 0);
+
+        // release build data.
+        std::vector<BuildPrim>().swap(m_buildPrims);
+    }
+
+    void BVH::BuildRecursive(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth)
+    {
+        // compute node bounds and centroid bounds.
+        float3 nmin(FLT_MAX, FLT_MAX, FLT_MAX);
+        float3 nmax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        float3 cmin(FLT_MAX, FLT_MAX, FLT_MAX);
+        float3 cmax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for(uint32_t i = first; i < first + count; i++)
+        {
+            const BuildPrim& prim = m_buildPrims[m_primIndices[i]];
+            nmin = minimize(nmin, prim.min);
+            nmax = maximize(nmax, prim.max);
+            cmin = minimize(cmin, prim.centroid);
+            cmax = maximize(cmax, prim.centroid);
+        }
+
+        // note: m_nodes may grow in the recursion below,
+        //       always access the node by index.
+        m_nodes[nodeIndex].min = nmin;
+        m_nodes[nodeIndex].max = nmax;
+        m_nodes[nodeIndex].start = first;
+        m_nodes[nodeIndex].count = count;
+
+        if(count <= BVHMinLeafSize || depth >= MaxDepth)
+            return;
+
+        // find the best split using binned SAH.
+        float bestCost = FLT_MAX;
+        int bestAxis = -1;
+        uint32_t bestSplit = 0;
+        float3 cext = cmax - cmin;
+        for(int axis = 0; axis < 3; axis++)
+        {
+            if(cext[axis] <= 0.0f) continue;
+
+            float3 bmin[BVHBinCount];
+            float3 bmax[BVHBinCount];
+            uint32_t bcount[BVHBinCount];
+            for(uint32_t b = 0; b < BVHBinCount; b++)
+            {
+                bmin[b] = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+                bmax[b] = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+                bcount[b] = 0;
+            }
+
+            float scale = (float)BVHBinCount / cext[axis];
+            for(uint32_t i = first; i < first + count; i++)
+            {
+                const BuildPrim& prim = m_buildPrims[m_primIndices[i]];
+                uint32_t b = std::min(BVHBinCount - 1, (uint32_t)((prim.centroid[axis] - cmin[axis]) * scale));
+                bmin[b] = minimize(bmin[b], prim.min);
+                bmax[b] = maximize(bmax[b], prim.max);
+                bcount[b]++;
+            }
+
+            // sweep from the right to accumulate the right side areas.
+            float rightArea[BVHBinCount];
+            uint32_t rightCount[BVHBinCount];
+            float3 rmin(FLT_MAX, FLT_MAX, FLT_MAX);
+            float3 rmax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+            uint32_t rcount = 0;
+            for(uint32_t b = BVHBinCount - 1; b > 0; b--)
+            {
+                rmin = minimize(rmin, bmin[b]);
+                rmax = maximize(rmax, bmax[b]);
+                rcount += bcount[b];
+                rightArea[b] = rcount ? HalfSurfaceArea(rmin, rmax) : 0.0f;
+                rightCount[b] = rcount;
+            }
+
+            // sweep from the left and evaluate the split between bin b-1 and b.
+            float3 lmin(FLT_MAX, FLT_MAX, FLT_MAX);
+            float3 lmax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+            uint32_t lcount = 0;
+            for(uint32_t b = 1; b < BVHBinCount; b++)
+            {
+                lmin = minimize(lmin, bmin[b-1]);
+                lmax = maximize(lmax, bmax[b-1]);
+                lcount += bcount[b-1];
+                if(lcount == 0 || rightCount[b] == 0) continue;
+                float cost = HalfSurfaceArea(lmin, lmax) * lcount + rightArea[b] * rightCount[b];
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        uint32_t mid;
+        if(bestAxis < 0)
+        {
+            // all the centroids are at the same point,
+            // split in the middle of the list if the leaf would be too large.
+            if(count <= BVHMaxLeafSize)
+                return;
+            mid = first + count / 2;
+        }
+        else
+        {
+            float parentArea = HalfSurfaceArea(nmin, nmax);
+            float splitCost = BVHTraversalCost + (parentArea > 0.0f ? bestCost / parentArea : (float)count);
+            if(splitCost >= (float)count && count <= BVHMaxLeafSize)
+                return;
+
+            BinPredicate pred;
+            pred.prims = &m_buildPrims[0];
+            pred.axis = bestAxis;
+            pred.cmin = cmin[bestAxis];
+            pred.scale = (float)BVHBinCount / cext[bestAxis];
+            pred.split = bestSplit;
+            uint32_t* split = std::partition(&m_primIndices[0] + first, &m_primIndices[0] + first + count, pred);
+            mid = (uint32_t)(split - &m_primIndices[0]);
+            if(mid == first || mid == first + count)
+                mid = first + count / 2;
+        }
+
+        uint32_t left = (uint32_t)m_nodes.size();
+        m_nodes.resize(left + 2);
+        m_nodes[nodeIndex].start = left;
+        m_nodes[nodeIndex].count = 0;
+
+        BuildRecursive(left, first, mid - first, depth + 1);
+        BuildRecursive(left + 1, mid, first + count - mid, depth + 1);
+    }
+}
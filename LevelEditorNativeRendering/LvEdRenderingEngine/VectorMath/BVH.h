@@ -0,0 +1,221 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+#include "TriangleStream.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    // node of a flattened bounding volume hierarchy.
+    // interior node: 'start' is the index of the first child, the second child is at start+1
+    //                and 'count' is zero.
+    // leaf node:     'start' is the offset into the primitive index list
+    //                and 'count' is the number of primitives in the leaf.
+    struct BVHNode
+    {
+        float3 min;
+        uint32_t start;
+        float3 max;
+        uint32_t count;
+
+        bool IsLeaf() const { return count != 0; }
+    };
+
+    // static bounding volume hierarchy built using binned surface area heuristic.
+    // The tree only stores primitive indices, the primitives are owned by the caller.
+    // all the nodes are stored in a single array, the root is at index zero.
+    class BVH : public NonCopyable
+    {
+    public:
+        static const uint32_t MaxDepth = 60;
+
+        BVH(){}
+
+        // build the tree from the bounds of the primitives.
+        // primitive i is refered by index i in the leaves.
+        void Build(const AABB* primBounds, uint32_t primCount);
+
+        // build the tree for indexed triangle list.
+        // primitive i is the triangle formed by indices[3*i], indices[3*i+1], indices[3*i+2]
+        // the triangles are also packed in leaf order, see Triangles().
+        void BuildFromTriangles(const float3* pos, const uint32_t* indices, uint32_t indicesCount);
+
+        void Clear();
+        bool IsEmpty() const { return m_nodes.empty(); }
+
+        const std::vector<BVHNode>& Nodes() const { return m_nodes; }
+        const std::vector<uint32_t>& PrimIndices() const { return m_primIndices; }
+
+        // triangles packed in the same order as PrimIndices(),
+        // so the primitives of a leaf are the range [node.start, node.start + node.count) of the stream.
+        // empty if the tree was not built using BuildFromTriangles().
+        const TriangleStream& Triangles() const { return m_triangles; }
+
+        // ray slab test against node bounds.
+        // invDir is the component-wise reciprocal of the ray direction.
+        static bool IntersectNode(const BVHNode& node, const float3& org, const float3& invDir, float maxDist, float* out_tmin)
+        {
+            float tx1 = (node.min.x - org.x) * invDir.x;
+            float tx2 = (node.max.x - org.x) * invDir.x;
+            float tmin = minimize(tx1, tx2);
+            float tmax = maximize(tx1, tx2);
+
+            float ty1 = (node.min.y - org.y) * invDir.y;
+            float ty2 = (node.max.y - org.y) * invDir.y;
+            tmin = maximize(tmin, minimize(ty1, ty2));
+            tmax = minimize(tmax, maximize(ty1, ty2));
+
+            float tz1 = (node.min.z - org.z) * invDir.z;
+            float tz2 = (node.max.z - org.z) * invDir.z;
+            tmin = maximize(tmin, minimize(tz1, tz2));
+            tmax = minimize(tmax, maximize(tz1, tz2));
+
+            *out_tmin = tmin;
+            return tmax >= tmin && tmax >= 0.0f && tmin <= maxDist;
+        }
+
+        // closest hit ray query.
+        // visits the leaves front to back and calls visitor(primIndex, maxDist) for each primitive
+        // of a leaf that the ray enters before *maxDist.
+        // The visitor must lower *maxDist when it finds a closer hit, subtrees that
+        // are entirely farther than *maxDist are skipped.
+        template<typename Visitor>
+        void RayQuery(const Ray& ray, float* maxDist, Visitor& visitor) const
+        {
+            LeafVisitor<Visitor> leafVisitor(m_primIndices, visitor);
+            RayQueryLeaves(ray, maxDist, leafVisitor);
+        }
+
+        // same as RayQuery() but calls visitor(first, count, maxDist) once per leaf,
+        // where [first, first + count) is the range of the leaf in PrimIndices().
+        template<typename Visitor>
+        void RayQueryLeaves(const Ray& ray, float* maxDist, Visitor& visitor) const
+        {
+            if(m_nodes.empty()) return;
+
+            const float3& org = ray.pos;
+            float3 invDir;
+            invDir.x = ray.direction.x != 0.0f ? 1.0f / ray.direction.x : FLT_MAX;
+            invDir.y = ray.direction.y != 0.0f ? 1.0f / ray.direction.y : FLT_MAX;
+            invDir.z = ray.direction.z != 0.0f ? 1.0f / ray.direction.z : FLT_MAX;
+
+            float tmin;
+            if(!IntersectNode(m_nodes[0], org, invDir, *maxDist, &tmin))
+                return;
+
+            uint32_t stack[MaxDepth + 4];
+            uint32_t stackSize = 0;
+            stack[stackSize++] = 0;
+            while(stackSize > 0)
+            {
+                const BVHNode& node = m_nodes[stack[--stackSize]];
+                if(node.IsLeaf())
+                {
+                    visitor(node.start, node.count, maxDist);
+                    continue;
+                }
+
+                float t1, t2;
+                bool hit1 = IntersectNode(m_nodes[node.start], org, invDir, *maxDist, &t1);
+                bool hit2 = IntersectNode(m_nodes[node.start + 1], org, invDir, *maxDist, &t2);
+                if(hit1 && hit2)
+                {
+                    // push the far child first so the near one is visited first.
+                    if(t1 <= t2)
+                    {
+                        stack[stackSize++] = node.start + 1;
+                        stack[stackSize++] = node.start;
+                    }
+                    else
+                    {
+                        stack[stackSize++] = node.start;
+                        stack[stackSize++] = node.start + 1;
+                    }
+                }
+                else if(hit1)
+                {
+                    stack[stackSize++] = node.start;
+                }
+                else if(hit2)
+                {
+                    stack[stackSize++] = node.start + 1;
+                }
+            }
+        }
+
+        // calls visitor(first, count, inside) for the leaves whose bounds intersect the frustum,
+        // inside is true if the leaf bounds are completely inside the frustum.
+        // the visitor returns true to stop the query, in which case this function returns true.
+        template<typename Visitor>
+        bool FrustumQueryLeaves(const Frustum& frustum, Visitor& visitor) const
+        {
+            if(m_nodes.empty()) return false;
+
+            // stack entries are node index * 2 + 1 if the node is known to be inside the frustum.
+            uint32_t stack[MaxDepth + 4];
+            uint32_t stackSize = 0;
+            stack[stackSize++] = 0;
+            while(stackSize > 0)
+            {
+                uint32_t entry = stack[--stackSize];
+                const BVHNode& node = m_nodes[entry >> 1];
+                uint32_t inside = entry & 1;
+                if(!inside)
+                {
+                    int test = FrustumAABBIntersect(frustum, AABB(node.min, node.max));
+                    if(test == 0)
+                        continue;
+                    inside = test == 2 ? 1 : 0;
+                }
+
+                if(node.IsLeaf())
+                {
+                    if(visitor(node.start, node.count, inside != 0))
+                        return true;
+                }
+                else
+                {
+                    stack[stackSize++] = (node.start + 1) * 2 + inside;
+                    stack[stackSize++] = node.start * 2 + inside;
+                }
+            }
+            return false;
+        }
+
+    private:
+        // adapts a per primitive visitor for RayQueryLeaves().
+        template<typename Visitor>
+        struct LeafVisitor
+        {
+            LeafVisitor(const std::vector<uint32_t>& primIndices, Visitor& visitor)
+                : primIndices(primIndices), visitor(visitor) {}
+            void operator()(uint32_t first, uint32_t count, float* maxDist)
+            {
+                for(uint32_t i = first; i < first + count; i++)
+                {
+                    visitor(primIndices[i], maxDist);
+                }
+            }
+            const std::vector<uint32_t>& primIndices;
+            Visitor& visitor;
+        };
+
+        struct BuildPrim
+        {
+            float3 min;
+            float3 max;
+            float3 centroid;
+        };
+        struct BinPredicate;
+
+        void BuildRecursive(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth);
+
+        std::vector<BVHNode> m_nodes;
+        std::vector<uint32_t> m_primIndices;
+        std::vector<BuildPrim> m_buildPrims; // only used while building.
+        TriangleStream m_triangles;
+    };
+}
@@ -1,6 +1,8 @@
 //Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
 
 #include "CollisionPrimitives.h"
+#include "BVH.h"
+#include "TriangleStream.h"
 #include <algorithm>
 #include <float.h>
 
@@ -243,6 +245,42 @@ void CreateUnitCube(Cube &cube)
 
 
 
+    // point common to the three planes.
+    static float3 IntersectPlanes(const Plane& p1, const Plane& p2, const Plane& p3)
+    {
+        float3 n23 = cross(p2.normal, p3.normal);
+        float3 n31 = cross(p3.normal, p1.normal);
+        float3 n12 = cross(p1.normal, p2.normal);
+        float denom = dot(p1.normal, n23);
+        return (n23 * -p1.d + n31 * -p2.d + n12 * -p3.d) / denom;
+    }
+
+    void Frustum::InitFromWorld(const Frustum& frustumW, const Matrix& world)
+    {
+        // a point P in local space is P * world in world space, so
+        // plane . (P * world) = (world * plane) . P
+        for(int i = 0; i < NumPlanes; i++)
+        {
+            const Plane& pw = frustumW[i];
+            float4 v;
+            v.x = world.M11 * pw.normal.x + world.M12 * pw.normal.y + world.M13 * pw.normal.z + world.M14 * pw.d;
+            v.y = world.M21 * pw.normal.x + world.M22 * pw.normal.y + world.M23 * pw.normal.z + world.M24 * pw.d;
+            v.z = world.M31 * pw.normal.x + world.M32 * pw.normal.y + world.M33 * pw.normal.z + world.M34 * pw.d;
+            v.w = world.M41 * pw.normal.x + world.M42 * pw.normal.y + world.M43 * pw.normal.z + world.M44 * pw.d;
+            m_planes[i] = Plane(v);
+            m_planes[i].Normalize();
+        }
+
+        m_corners[NearBottonLeft]  = IntersectPlanes(m_planes[Near], m_planes[Bottom], m_planes[Left]);
+        m_corners[NearBottomRight] = IntersectPlanes(m_planes[Near], m_planes[Bottom], m_planes[Right]);
+        m_corners[NearTopRight]    = IntersectPlanes(m_planes[Near], m_planes[Top], m_planes[Right]);
+        m_corners[NearTopLeft]     = IntersectPlanes(m_planes[Near], m_planes[Top], m_planes[Left]);
+        m_corners[FarBottonLeft]   = IntersectPlanes(m_planes[Far], m_planes[Bottom], m_planes[Left]);
+        m_corners[FarBottomRight]  = IntersectPlanes(m_planes[Far], m_planes[Bottom], m_planes[Right]);
+        m_corners[FarTopRight]     = IntersectPlanes(m_planes[Far], m_planes[Top], m_planes[Right]);
+        m_corners[FarTopLeft]      = IntersectPlanes(m_planes[Far], m_planes[Top], m_planes[Left]);
+    }
+
     // extract frustum plane in world space.
     // the normals facing inward.
     // pass in view * projection matrix.
@@ -580,12 +618,150 @@ float IntersectionRayPlane(const Ray &r, const Plane &p)
     }
 
 
+    // the vertex of the triangle that is closest to the hit point.
+    static float3 NearestTriangleVertex(const Triangle& tri, const float3& hit_pos)
+    {
+        float distA = lengthsquared(hit_pos - tri.A);
+        float distB = lengthsquared(hit_pos - tri.B);
+        float distC = lengthsquared(hit_pos - tri.C);
+
+        if(distA <= distB && distA <= distC)
+            return tri.A;
+        else if( distB < distC)
+            return tri.B;
+        else
+            return tri.C;
+    }
+
+    // used by MeshIntersects() for BVH traversal.
+    // on equal distance the triangle with lower index wins, 
+    // this gives the same result as testing the triangles in order.
+    struct MeshRayVisitor
+    {
+        const Ray* ray;
+        const float3* pos;
+        const uint32_t* indices;
+        uint32_t posCount;
+        bool backfaceCull;
+
+        bool hit;
+        uint32_t hitTri;
+        float hitDist;
+        float3 hitPos;
+        float3 hitNor;
+        Triangle tri;
+
+        void operator()(uint32_t triIndex, float* maxDist)
+        {
+            uint32_t i = triIndex * 3;
+            assert(indices[i] < posCount);
+            assert(indices[i+1] < posCount);
+            assert(indices[i+2] < posCount);
+
+            Triangle t;
+            t.A = pos[ indices[i]];
+            t.B = pos[ indices[i+1]];
+            t.C = pos[ indices[i+2]];
+
+            float dist;
+            float3 p, n;
+            if(IntersectionRayTriangle(*ray, t, backfaceCull, &dist, &p, &n))
+            {
+                if(!hit || dist < hitDist || (dist == hitDist && triIndex < hitTri))
+                {
+                    hit = true;
+                    hitTri = triIndex;
+                    hitDist = dist;
+                    hitPos = p;
+                    hitNor = n;
+                    tri = t;
+                    *maxDist = dist;
+                }
+            }
+        }
+    };
+
+    // used by MeshIntersects() to test the packed triangles of the BVH leaves.
+    struct MeshLeafVisitor
+    {
+        const Ray* ray;
+        const TriangleStream* tris;
+        bool backfaceCull;
+        TriangleHit hit;
+
+        void operator()(uint32_t first, uint32_t count, float* maxDist)
+        {
+            tris->IntersectRay(*ray, backfaceCull, first, count, &hit);
+            if(hit.hit)
+                *maxDist = hit.dist;
+        }
+    };
+
     bool MeshIntersects(const Ray& ray, float3* pos, uint32_t posCount, uint32_t* indices, uint32_t indicesCount,
-                        bool backfaceCull, float* out_tmin, float3* out_pos, float3* out_nor, float3* nearestVertex)
+                        bool backfaceCull, float* out_tmin, float3* out_pos, float3* out_nor, float3* nearestVertex,
+                        const BVH* bvh, const TriangleStream* tris)
     {        
         if(posCount == 0) 
             return false;
 
+        if(bvh && !bvh->IsEmpty() && !bvh->Triangles().IsEmpty())
+        {
+            MeshLeafVisitor visitor;
+            visitor.ray = &ray;
+            visitor.tris = &bvh->Triangles();
+            visitor.backfaceCull = backfaceCull;
+
+            float maxDist = FLT_MAX;
+            bvh->RayQueryLeaves(ray, &maxDist, visitor);
+            if(visitor.hit.hit)
+            {
+                *out_tmin = visitor.hit.dist;
+                *out_pos = visitor.hit.pos;
+                *out_nor = visitor.hit.nor;
+                *nearestVertex = NearestTriangleVertex(visitor.hit.triangle, visitor.hit.pos);
+            }
+            return visitor.hit.hit;
+        }
+
+        if(bvh && !bvh->IsEmpty())
+        {
+            MeshRayVisitor visitor;
+            visitor.ray = &ray;
+            visitor.pos = pos;
+            visitor.indices = indices;
+            visitor.posCount = posCount;
+            visitor.backfaceCull = backfaceCull;
+            visitor.hit = false;
+            visitor.hitTri = 0;
+            visitor.hitDist = FLT_MAX;
+
+            float maxDist = FLT_MAX;
+            bvh->RayQuery(ray, &maxDist, visitor);
+            if(visitor.hit)
+            {
+                *out_tmin = visitor.hitDist;
+                *out_pos = visitor.hitPos;
+                *out_nor = visitor.hitNor;
+                *nearestVertex = NearestTriangleVertex(visitor.tri, visitor.hitPos);
+            }
+            return visitor.hit;
+        }
+
+        if(tris && !tris->IsEmpty())
+        {
+            assert(tris->GetTriangleCount() == indicesCount / 3);
+            TriangleHit hit;
+            tris->IntersectRay(ray, backfaceCull, &hit);
+            if(hit.hit)
+            {
+                *out_tmin = hit.dist;
+                *out_pos = hit.pos;
+                *out_nor = hit.nor;
+                *nearestVertex = NearestTriangleVertex(hit.triangle, hit.pos);
+            }
+            return hit.hit;
+        }
+
         uint32_t LastTri = indicesCount -3;
         bool hit = false;
         bool tri_hit = false;
@@ -615,18 +791,7 @@ float IntersectionRayPlane(const Ray &r, const Plane &p)
                     *out_tmin = hit_dist;
                     *out_pos = hit_pos;
                     *out_nor = hit_nor;
-
-                    float distA = lengthsquared(hit_pos - tri.A);
-                    float distB = lengthsquared(hit_pos - tri.B);
-                    float distC = lengthsquared(hit_pos - tri.C);
-                    
-                    if(distA <= distB && distA <= distC)
-                        *nearestVertex = tri.A;
-                    else if( distB < distC)
-                        *nearestVertex = tri.B;
-                    else
-                        *nearestVertex = tri.C;
-
+                    *nearestVertex = NearestTriangleVertex(tri, hit_pos);
                 }
             }
            
@@ -986,16 +1151,44 @@ bool FrustumTriangleIntersect(const Frustum& fr, const Triangle& tri)
 
 
     
+    // used by FrustumMeshIntersect() to test the packed triangles of the BVH leaves.
+    struct MeshFrustumLeafVisitor
+    {
+        const Frustum* fr;
+        const TriangleStream* tris;
+
+        bool operator()(uint32_t first, uint32_t count, bool inside)
+        {
+            // all the triangles of the leaf are inside the frustum.
+            if(inside)
+                return true;
+            return tris->IntersectFrustum(*fr, first, count);
+        }
+    };
+
     // loop over all the triagle in the mesh and use frustum triangle intersection.
     // note: the frustum and the mesh must be in the same space.    
     bool FrustumMeshIntersect(const Frustum& fr,
                               float3* pos, 
                               uint32_t posCount,
                               uint32_t* indices, 
-                              uint32_t indicesCount)
+                              uint32_t indicesCount,
+                              const BVH* bvh,
+                              const TriangleStream* tris)
     {      
 
         if(posCount == 0) return false;        
+        if(bvh && !bvh->IsEmpty() && !bvh->Triangles().IsEmpty())
+        {
+            MeshFrustumLeafVisitor visitor;
+            visitor.fr = &fr;
+            visitor.tris = &bvh->Triangles();
+            return bvh->FrustumQueryLeaves(fr, visitor);
+        }
+
+        if(tris && !tris->IsEmpty())
+            return tris->IntersectFrustum(fr);
+
         uint32_t LastTri = indicesCount -3;        
         Triangle tri;
 
@@ -1017,4 +1210,721 @@ bool FrustumTriangleIntersect(const Frustum& fr, const Triangle& tri)
         return false;
     }
 
+    //======================= primitive shapes ========================
+
+    // returns the hit of a ray with a convex shape that it crosses during [tEnter, tExit].
+    static bool ConvexShapeHit(const Ray& r, float tEnter, const float3& norEnter, float tExit, const float3& norExit,
+                               bool backfaceCull, float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        if(tEnter > tExit || tExit <= 0.0f)
+            return false;
+
+        if(tEnter > 0.0f)
+        {
+            *out_tmin = tEnter;
+            *out_nor = norEnter;
+        }
+        else
+        {
+            // the ray starts inside the shape.
+            if(backfaceCull)
+                return false;
+            *out_tmin = tExit;
+            *out_nor = norExit;
+        }
+        *out_pos = r.pos + r.direction * (*out_tmin);
+        return true;
+    }
+
+    // clips [tEnter, tExit] to the part of the ray where lo <= p[axis] <= hi.
+    static bool ClipRaySlab(const Ray& r, int axis, float lo, float hi,
+                            float* tEnter, float3* norEnter, float* tExit, float3* norExit)
+    {
+        float p = r.pos[axis];
+        float d = r.direction[axis];
+        if(abs(d) < Epsilon)
+        {
+            // ray is parallel to slab, no hit if origin not within slab
+            return p >= lo && p <= hi;
+        }
+
+        float ood = 1.0f / d;
+        float t1 = (lo - p) * ood;
+        float t2 = (hi - p) * ood;
+        float3 n1(0,0,0);
+        float3 n2(0,0,0);
+        n1[axis] = -1.0f;
+        n2[axis] = 1.0f;
+        if(t1 > t2)
+        {
+            std::swap(t1, t2);
+            std::swap(n1, n2);
+        }
+        if(t1 > *tEnter)
+        {
+            *tEnter = t1;
+            *norEnter = n1;
+        }
+        if(t2 < *tExit)
+        {
+            *tExit = t2;
+            *norExit = n2;
+        }
+        return *tEnter <= *tExit;
+    }
+
+    // roots of a*t*t + 2*b*t + c = 0 with a != 0, in increasing order.
+    // uses the stable form of the quadratic formula so a can be small.
+    static bool SolveQuadratic(float a, float b, float c, float* t0, float* t1)
+    {
+        float disc = b * b - a * c;
+        if(disc < 0.0f)
+            return false;
+        float q = -(b + (b < 0.0f ? -sqrt(disc) : sqrt(disc)));
+        if(q == 0.0f)
+        {
+            *t0 = *t1 = 0.0f;
+            return true;
+        }
+        *t0 = q / a;
+        *t1 = c / q;
+        if(*t0 > *t1)
+            std::swap(*t0, *t1);
+        return true;
+    }
+
+    bool IntersectRaySphere(const Ray& r, const Sphere& sphere, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        const float3& d = r.direction;
+        float3 m = r.pos - sphere.Center;
+        float a = dot(d, d);
+        float b = dot(m, d);
+        float c = dot(m, m) - sphere.Radius * sphere.Radius;
+
+        // origin outside and pointing away from the sphere.
+        if(a == 0.0f || (c > 0.0f && b > 0.0f))
+            return false;
+
+        float t0, t1;
+        if(!SolveQuadratic(a, b, c, &t0, &t1))
+            return false;
+
+        float3 n0 = normalize(m + d * t0);
+        float3 n1 = normalize(m + d * t1);
+        return ConvexShapeHit(r, t0, n0, t1, n1, backfaceCull, out_tmin, out_pos, out_nor);
+    }
+
+    bool IntersectRayBox(const Ray& r, const float3& halfExtents, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        float tEnter = -FLT_MAX;
+        float tExit = FLT_MAX;
+        float3 norEnter, norExit;
+        for(int i = 0; i < 3; ++i)
+        {
+            if(!ClipRaySlab(r, i, -halfExtents[i], halfExtents[i], &tEnter, &norEnter, &tExit, &norExit))
+                return false;
+        }
+        return ConvexShapeHit(r, tEnter, norEnter, tExit, norExit, backfaceCull, out_tmin, out_pos, out_nor);
+    }
+
+    bool IntersectRayCylinder(const Ray& r, float radius, float halfHeight, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        // caps.
+        float tEnter = -FLT_MAX;
+        float tExit = FLT_MAX;
+        float3 norEnter, norExit;
+        if(!ClipRaySlab(r, 1, -halfHeight, halfHeight, &tEnter, &norEnter, &tExit, &norExit))
+            return false;
+
+        // side: x*x + z*z = radius*radius
+        const float3& o = r.pos;
+        const float3& d = r.direction;
+        float a = d.x * d.x + d.z * d.z;
+        float b = o.x * d.x + o.z * d.z;
+        float c = o.x * o.x + o.z * o.z - radius * radius;
+        if(a < Epsilon)
+        {
+            // ray is parallel to the axis.
+            if(c > 0.0f)
+                return false;
+        }
+        else
+        {
+            float t0, t1;
+            if(!SolveQuadratic(a, b, c, &t0, &t1))
+                return false;
+            if(t0 > tEnter)
+            {
+                tEnter = t0;
+                norEnter = normalize(float3(o.x + d.x * t0, 0.0f, o.z + d.z * t0));
+            }
+            if(t1 < tExit)
+            {
+                tExit = t1;
+                norExit = normalize(float3(o.x + d.x * t1, 0.0f, o.z + d.z * t1));
+            }
+        }
+        return ConvexShapeHit(r, tEnter, norEnter, tExit, norExit, backfaceCull, out_tmin, out_pos, out_nor);
+    }
+
+    bool IntersectRayCone(const Ray& r, float radius, float halfHeight, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        // base and the plane of the apex.
+        float tEnter = -FLT_MAX;
+        float tExit = FLT_MAX;
+        float3 norEnter, norExit;
+        if(!ClipRaySlab(r, 1, -halfHeight, halfHeight, &tEnter, &norEnter, &tExit, &norExit))
+            return false;
+
+        // side: x*x + z*z = k*k*(halfHeight - y)^2
+        // this is a double cone, but only the lower half is between the two planes.
+        float k = radius / (2.0f * halfHeight);
+        float kk = k * k;
+        const float3& o = r.pos;
+        const float3& d = r.direction;
+        float q = halfHeight - o.y;
+        float a = d.x * d.x + d.z * d.z - kk * d.y * d.y;
+        float b = o.x * d.x + o.z * d.z + kk * q * d.y;
+        float c = o.x * o.x + o.z * o.z - kk * q * q;
+
+        // the ray is inside the double cone where a*t*t + 2*b*t + c <= 0,
+        // it is either [t0, t1] or the two half lines out of it.
+        float t0 = -FLT_MAX;
+        float t1 = FLT_MAX;
+        bool between = true;
+        if(abs(a) < Epsilon)
+        {
+            if(abs(b) < Epsilon)
+            {
+                if(c > 0.0f)
+                    return false;
+            }
+            else if(b > 0.0f)
+            {
+                t1 = -c / (2.0f * b);
+            }
+            else
+            {
+                t0 = -c / (2.0f * b);
+            }
+        }
+        else if(SolveQuadratic(a, b, c, &t0, &t1))
+        {
+            between = a > 0.0f;
+        }
+        else if(a > 0.0f)
+        {
+            return false;
+        }
+
+        if(!between)
+        {
+            // keep the half line that crosses the slab.
+            float len0 = minimize(tExit, t0) - tEnter;
+            float len1 = tExit - maximize(tEnter, t1);
+            if(len0 >= len1)
+            {
+                t1 = t0;
+                t0 = -FLT_MAX;
+            }
+            else
+            {
+                t0 = t1;
+                t1 = FLT_MAX;
+            }
+        }
+
+        if(t0 > tEnter)
+        {
+            tEnter = t0;
+            float3 p = o + d * t0;
+            norEnter = normalize(float3(p.x, kk * (halfHeight - p.y), p.z));
+        }
+        if(t1 < tExit)
+        {
+            tExit = t1;
+            float3 p = o + d * t1;
+            norExit = normalize(float3(p.x, kk * (halfHeight - p.y), p.z));
+        }
+        return ConvexShapeHit(r, tEnter, norEnter, tExit, norExit, backfaceCull, out_tmin, out_pos, out_nor);
+    }
+
+    // value of the polynomial c[0] + c[1]*x + ... + c[degree]*x^degree
+    static double EvalPolynomial(const double* c, int degree, double x)
+    {
+        double v = c[degree];
+        for(int i = degree - 1; i >= 0; --i)
+            v = v * x + c[i];
+        return v;
+    }
+
+    // real roots of a polynomial in [lo, hi] in increasing order, returns the number of roots.
+    // the roots of the derivative split the range in intervals where the polynomial
+    // is monotonic, each of them contains at most one root that is found by bisection.
+    // roots where the polynomial touches zero without crossing it are only found
+    // when they are at the end of an interval.
+    static int FindPolynomialRoots(const double* c, int degree, double lo, double hi, double* roots)
+    {
+        if(degree == 1)
+        {
+            if(c[1] == 0.0)
+                return 0;
+            double x = -c[0] / c[1];
+            if(x < lo || x > hi)
+                return 0;
+            roots[0] = x;
+            return 1;
+        }
+
+        double deriv[4];
+        for(int i = 0; i < degree; ++i)
+            deriv[i] = c[i + 1] * (i + 1);
+
+        double bounds[6];
+        bounds[0] = lo;
+        int boundCount = 1 + FindPolynomialRoots(deriv, degree - 1, lo, hi, bounds + 1);
+        bounds[boundCount++] = hi;
+
+        int count = 0;
+        double x0 = bounds[0];
+        double f0 = EvalPolynomial(c, degree, x0);
+        if(f0 == 0.0)
+            roots[count++] = x0;
+        for(int i = 1; i < boundCount; ++i)
+        {
+            double x1 = bounds[i];
+            double f1 = EvalPolynomial(c, degree, x1);
+            if(f1 == 0.0)
+            {
+                if(count == 0 || roots[count - 1] != x1)
+                    roots[count++] = x1;
+            }
+            else if(f0 != 0.0 && (f0 < 0.0) != (f1 < 0.0))
+            {
+                double a = x0;
+                double b = x1;
+                double fa = f0;
+                for(int iter = 0; iter < 60 && a < b; ++iter)
+                {
+                    double m = 0.5 * (a + b);
+                    if(m <= a || m >= b)
+                        break;
+                    double fm = EvalPolynomial(c, degree, m);
+                    if((fm < 0.0) == (fa < 0.0))
+                    {
+                        a = m;
+                        fa = fm;
+                    }
+                    else
+                    {
+                        b = m;
+                    }
+                }
+                roots[count++] = 0.5 * (a + b);
+            }
+            x0 = x1;
+            f0 = f1;
+        }
+        return count;
+    }
+
+    bool IntersectRayTorus(const Ray& r, float ringRadius, float tubeRadius, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        // surface: (|p|^2 + R^2 - r^2)^2 = 4 * R^2 * (x*x + z*z)
+        // the quartic is solved for a ray that starts at the point closest to the center
+        // and has a unit direction, so the roots are small numbers.
+        // doubles are used because the coefficients lose too much precision with floats.
+        float len = length(r.direction);
+        if(len == 0.0f)
+            return false;
+        float3 dir = r.direction / len;
+        float s = -dot(r.pos, dir);
+        float3 o = r.pos + dir * s;
+
+        // the bounding sphere is padded so the polynomial is positive at the ends
+        // of the range, it touches the torus along its outer equator.
+        double R = ringRadius;
+        double radius = (ringRadius + tubeRadius) * 1.01;
+        double distSq = (double)o.x * o.x + (double)o.y * o.y + (double)o.z * o.z;
+        if(distSq >= radius * radius)
+            return false;
+
+        // the roots we want are after the origin of the ray and inside the bounding sphere.
+        double halfChord = sqrt(radius * radius - distSq);
+        double lo = maximize(-halfChord, -s);
+        double hi = halfChord;
+        if(lo >= hi)
+            return false;
+
+        double e = distSq + R * R - (double)tubeRadius * tubeRadius;
+        double f = (double)o.x * dir.x + (double)o.y * dir.y + (double)o.z * dir.z;
+        double a2 = (double)dir.x * dir.x + (double)dir.z * dir.z;
+        double b2 = (double)o.x * dir.x + (double)o.z * dir.z;
+        double c2 = (double)o.x * o.x + (double)o.z * o.z;
+        double coeffs[5];
+        coeffs[4] = 1.0;
+        coeffs[3] = 4.0 * f;
+        coeffs[2] = 4.0 * f * f + 2.0 * e - 4.0 * R * R * a2;
+        coeffs[1] = 4.0 * e * f - 8.0 * R * R * b2;
+        coeffs[0] = e * e - 4.0 * R * R * c2;
+
+        double roots[4];
+        int count = FindPolynomialRoots(coeffs, 4, lo, hi, roots);
+        int i = 0;
+        while(i < count && roots[i] <= -s)
+            ++i;
+        if(i == count)
+            return false;
+
+        // the first hit leaves the torus when the ray starts inside it.
+        if(backfaceCull && EvalPolynomial(coeffs, 4, -s) < 0.0)
+            return false;
+
+        float3 p = o + dir * (float)roots[i];
+        float g = dot(p, p) + ringRadius * ringRadius - tubeRadius * tubeRadius;
+        float rr2 = 2.0f * ringRadius * ringRadius;
+        *out_tmin = ((float)roots[i] + s) / len;
+        *out_pos = p;
+        *out_nor = normalize(float3(p.x * (g - rr2), p.y * g, p.z * (g - rr2)));
+        return true;
+    }
+
+    bool IntersectRayQuad(const Ray& r, float halfWidth, float halfHeight, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        const float3& o = r.pos;
+        const float3& d = r.direction;
+        // the front face is toward +Z.
+        if(d.z > -Epsilon && (backfaceCull || d.z < Epsilon))
+            return false;
+
+        float t = -o.z / d.z;
+        if(t <= 0.0f)
+            return false;
+        float3 p = o + d * t;
+        if(abs(p.x) > halfWidth || abs(p.y) > halfHeight)
+            return false;
+
+        *out_tmin = t;
+        *out_pos = p;
+        *out_nor = float3(0.0f, 0.0f, 1.0f);
+        return true;
+    }
+
+    bool IntersectRayPrimitive(const Ray& r, const PrimitiveShape& shape, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor)
+    {
+        const float3& size = shape.size;
+        switch(shape.type)
+        {
+        case PrimitiveShape::Sphere:
+            return IntersectRaySphere(r, Sphere(float3(0,0,0), size.x), backfaceCull, out_tmin, out_pos, out_nor);
+        case PrimitiveShape::Box:
+            return IntersectRayBox(r, size, backfaceCull, out_tmin, out_pos, out_nor);
+        case PrimitiveShape::Cylinder:
+            return IntersectRayCylinder(r, size.x, size.y, backfaceCull, out_tmin, out_pos, out_nor);
+        case PrimitiveShape::Cone:
+            return IntersectRayCone(r, size.x, size.y, backfaceCull, out_tmin, out_pos, out_nor);
+        case PrimitiveShape::Torus:
+            return IntersectRayTorus(r, size.x, size.y, backfaceCull, out_tmin, out_pos, out_nor);
+        case PrimitiveShape::Quad:
+            return IntersectRayQuad(r, size.x, size.y, backfaceCull, out_tmin, out_pos, out_nor);
+        default:
+            return false;
+        }
+    }
+
+    // farthest point of the shape in direction d.
+    // the torus is replaced by its convex hull.
+    static float3 SupportPoint(const PrimitiveShape& shape, const float3& d)
+    {
+        const float3& size = shape.size;
+        float lenXZ = sqrt(d.x * d.x + d.z * d.z);
+        float3 radial(0,0,0);
+        if(lenXZ > 0.0f)
+            radial = float3(d.x / lenXZ, 0.0f, d.z / lenXZ);
+
+        switch(shape.type)
+        {
+        case PrimitiveShape::Sphere:
+            {
+                float len = length(d);
+                return len > 0.0f ? d * (size.x / len) : float3(size.x, 0.0f, 0.0f);
+            }
+        case PrimitiveShape::Box:
+            return float3(d.x >= 0.0f ? size.x : -size.x,
+                          d.y >= 0.0f ? size.y : -size.y,
+                          d.z >= 0.0f ? size.z : -size.z);
+        case PrimitiveShape::Quad:
+            return float3(d.x >= 0.0f ? size.x : -size.x,
+                          d.y >= 0.0f ? size.y : -size.y,
+                          0.0f);
+        case PrimitiveShape::Cylinder:
+            return radial * size.x + float3(0.0f, d.y >= 0.0f ? size.y : -size.y, 0.0f);
+        case PrimitiveShape::Cone:
+            {
+                float3 apex(0.0f, size.y, 0.0f);
+                float3 rim = radial * size.x + float3(0.0f, -size.y, 0.0f);
+                return dot(apex, d) >= dot(rim, d) ? apex : rim;
+            }
+        case PrimitiveShape::Torus:
+            {
+                float len = length(d);
+                float3 p = radial * size.x;
+                if(len > 0.0f)
+                    p = p + d * (size.y / len);
+                return p;
+            }
+        default:
+            return float3(0,0,0);
+        }
+    }
+
+    // farthest corner of the frustum in direction d.
+    static float3 SupportPoint(const Frustum& fr, const float3& d)
+    {
+        int best = 0;
+        float bestDot = dot(fr.Corner(0), d);
+        for(int i = 1; i < 8; ++i)
+        {
+            float v = dot(fr.Corner(i), d);
+            if(v > bestDot)
+            {
+                bestDot = v;
+                best = i;
+            }
+        }
+        return fr.Corner(best);
+    }
+
+    // updates the GJK simplex and the search direction for the new point simplex[count - 1].
+    // returns true if the simplex contains the origin.
+    static bool UpdateSimplex(float3* simplex, int* count, float3* dir)
+    {
+        float3 a = simplex[*count - 1];
+        float3 ao = -a;
+
+        if(*count == 2)
+        {
+            float3 ab = simplex[0] - a;
+            if(dot(ab, ao) > 0.0f)
+            {
+                *dir = cross(cross(ab, ao), ab);
+                // the origin is on the segment.
+                if(lengthsquared(*dir) == 0.0f)
+                    return true;
+            }
+            else
+            {
+                simplex[0] = a;
+                *count = 1;
+                *dir = ao;
+            }
+            return false;
+        }
+
+        if(*count == 3)
+        {
+            float3 b = simplex[1];
+            float3 c = simplex[0];
+            float3 ab = b - a;
+            float3 ac = c - a;
+            float3 abc = cross(ab, ac);
+
+            if(dot(cross(abc, ac), ao) > 0.0f)
+            {
+                if(dot(ac, ao) > 0.0f)
+                {
+                    // closest to edge ac.
+                    simplex[0] = c;
+                    simplex[1] = a;
+                    *count = 2;
+                    *dir = cross(cross(ac, ao), ac);
+                    return lengthsquared(*dir) == 0.0f;
+                }
+                simplex[0] = b;
+                simplex[1] = a;
+                *count = 2;
+                return UpdateSimplex(simplex, count, dir);
+            }
+            if(dot(cross(ab, abc), ao) > 0.0f)
+            {
+                simplex[0] = b;
+                simplex[1] = a;
+                *count = 2;
+                return UpdateSimplex(simplex, count, dir);
+            }
+
+            // the origin is above or below the triangle,
+            // keep the winding so the search direction is the triangle normal.
+            float side = dot(abc, ao);
+            if(side == 0.0f)
+                return true;
+            if(side > 0.0f)
+            {
+                *dir = abc;
+            }
+            else
+            {
+                simplex[0] = b;
+                simplex[1] = c;
+                *dir = -abc;
+            }
+            return false;
+        }
+
+        // tetrahedron, the triangle bcd is wound so that its normal points toward a.
+        float3 b = simplex[2];
+        float3 c = simplex[1];
+        float3 d = simplex[0];
+        float3 ab = b - a;
+        float3 ac = c - a;
+        float3 ad = d - a;
+        float3 abc = cross(ab, ac);
+        float3 acd = cross(ac, ad);
+        float3 adb = cross(ad, ab);
+
+        if(dot(abc, ao) > 0.0f)
+        {
+            simplex[0] = c;
+            simplex[1] = b;
+            simplex[2] = a;
+            *count = 3;
+            return UpdateSimplex(simplex, count, dir);
+        }
+        if(dot(acd, ao) > 0.0f)
+        {
+            simplex[0] = d;
+            simplex[1] = c;
+            simplex[2] = a;
+            *count = 3;
+            return UpdateSimplex(simplex, count, dir);
+        }
+        if(dot(adb, ao) > 0.0f)
+        {
+            simplex[0] = b;
+            simplex[1] = d;
+            simplex[2] = a;
+            *count = 3;
+            return UpdateSimplex(simplex, count, dir);
+        }
+        return true;
+    }
+
+    // GJK intersection test of a convex shape and the frustum.
+    // the origin is inside their Minkowski difference if they overlap.
+    static bool GJKIntersect(const Frustum& fr, const PrimitiveShape& shape)
+    {
+        const int MaxIterations = 32;
+
+        float3 dir = -(fr.Corner(0) + fr.Corner(6)) * 0.5f;
+        if(lengthsquared(dir) == 0.0f)
+            dir = float3(1.0f, 0.0f, 0.0f);
+
+        float3 simplex[4];
+        simplex[0] = SupportPoint(shape, dir) - SupportPoint(fr, -dir);
+        int count = 1;
+        dir = -simplex[0];
+
+        for(int i = 0; i < MaxIterations; ++i)
+        {
+            if(lengthsquared(dir) == 0.0f)
+                return true;
+            float3 p = SupportPoint(shape, dir) - SupportPoint(fr, -dir);
+            // the new point doesn't pass the origin, dir is a separating axis.
+            if(dot(p, dir) < 0.0f)
+                return false;
+            simplex[count++] = p;
+            if(UpdateSimplex(simplex, &count, &dir))
+                return true;
+        }
+
+        // no separating axis found, the shapes are touching.
+        return true;
+    }
+
+    // true if p is inside the torus.
+    static bool TorusContains(float ringRadius, float tubeRadius, const float3& p)
+    {
+        float distXZ = sqrt(p.x * p.x + p.z * p.z) - ringRadius;
+        return distXZ * distXZ + p.y * p.y <= tubeRadius * tubeRadius;
+    }
+
+    // true if p is inside all the planes of the frustum.
+    static bool FrustumContains(const Frustum& fr, const float3& p)
+    {
+        for(int i = 0; i < Frustum::NumPlanes; ++i)
+        {
+            if(fr[i].Eval(p) < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    int FrustumPrimitiveIntersect(const Frustum& fr, const PrimitiveShape& shape)
+    {
+        if(shape.type == PrimitiveShape::None)
+            return 0;
+
+        // the shape is outside if its farthest point along a plane normal is outside,
+        // and inside if its farthest point in the opposite direction is inside all the planes.
+        bool inside = true;
+        for(int i = 0; i < Frustum::NumPlanes; ++i)
+        {
+            const Plane& plane = fr[i];
+            if(plane.Eval(SupportPoint(shape, plane.normal)) < 0.0f)
+                return 0;
+            if(inside && plane.Eval(SupportPoint(shape, -plane.normal)) < 0.0f)
+                inside = false;
+        }
+        if(inside)
+            return 2;
+
+        if(!GJKIntersect(fr, shape))
+            return 0;
+
+        if(shape.type != PrimitiveShape::Torus)
+            return 2;
+
+        // the frustum crosses the convex hull of the torus.
+        float ringRadius = shape.size.x;
+        float tubeRadius = shape.size.y;
+
+        // a corner of the frustum is inside the torus.
+        for(int i = 0; i < 8; ++i)
+        {
+            if(TorusContains(ringRadius, tubeRadius, fr.Corner(i)))
+                return 2;
+        }
+
+        // an edge of the frustum crosses the torus.
+        static const int edges[12][2] = { {0,1}, {1,2}, {2,3}, {3,0},
+                                          {4,5}, {5,6}, {6,7}, {7,4},
+                                          {0,4}, {1,5}, {2,6}, {3,7} };
+        for(int i = 0; i < 12; ++i)
+        {
+            Ray edge;
+            edge.pos = fr.Corner(edges[i][0]);
+            edge.direction = fr.Corner(edges[i][1]) - edge.pos;
+            float t;
+            float3 p, n;
+            if(IntersectRayTorus(edge, ringRadius, tubeRadius, false, &t, &p, &n) && t <= 1.0f)
+                return 2;
+        }
+
+        // a point of the center circle of the tube is inside the frustum.
+        float3 ring[4] = { float3(ringRadius, 0.0f, 0.0f), float3(-ringRadius, 0.0f, 0.0f),
+                           float3(0.0f, 0.0f, ringRadius), float3(0.0f, 0.0f, -ringRadius) };
+        for(int i = 0; i < 4; ++i)
+        {
+            if(FrustumContains(fr, ring[i]))
+                return 2;
+        }
+        return 1;
+    }
 }
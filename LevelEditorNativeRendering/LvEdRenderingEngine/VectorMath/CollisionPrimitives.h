@@ -7,6 +7,9 @@
 
 namespace LvEdEngine
 {
+    class BVH;
+    class TriangleStream;
+
     class Plane
     {
     public:
@@ -212,6 +215,12 @@ enum corner {NearBottonLeft = 0, NearBottomRight, NearTopRight, NearTopLeft,
         const float3& Corner(int i ) const { return m_corners[i];}        
         void InitFromMatrix(const Matrix &viewproj);
         void InitFromCorners(float3* corners);
+
+        // init this frustum in the local space of an object from a frustum in world space.
+        // world is the object to world matrix, the planes are transformed by its
+        // transpose (the inverse transpose of world to local) so no inversion is needed.
+        // the corners are found by intersecting the transformed planes.
+        void InitFromWorld(const Frustum& frustumW, const Matrix& world);
         const void GetCorners( float3* out_points) const;		
         
     private:
@@ -225,6 +234,26 @@ enum corner {NearBottonLeft = 0, NearBottomRight, NearTopRight, NearTopLeft,
         Matrix m_matrix;
     };
 
+    // analytic shape centered at the origin of its local space.
+    // cylinder, cone and torus are symmetric around the Y axis, the apex of the cone
+    // is at +Y and the quad lies in the XY plane with its front face toward +Z.
+    class PrimitiveShape
+    {
+    public:
+        enum Type { None = 0, Sphere, Box, Cylinder, Cone, Torus, Quad };
+
+        PrimitiveShape() : type(None), size(0,0,0) {}
+        PrimitiveShape(Type t, const float3& sz) : type(t), size(sz) {}
+
+        Type type;
+
+        // Sphere: x is the radius.
+        // Box, Quad: half extents.
+        // Cylinder, Cone: x is the radius and y the half height.
+        // Torus: x is the radius of the ring and y the radius of the tube.
+        float3 size;
+    };
+
      void CreateUnitCube(Cube &cube);
 
      
@@ -244,11 +273,19 @@ enum corner {NearBottonLeft = 0, NearBottomRight, NearTopRight, NearTopLeft,
     
      //================= Intersect and collision test functions =================     
      bool TestAABBAABB(const AABB& a, const AABB& b);
+     bool FrustumTriangleIntersect(const Frustum& fr, const Triangle& tri);
+
+     // if bvh is not NULL it must be built by BVH::BuildFromTriangles() over the given indices,
+     // only the leaves that intersect the frustum are tested.
+     // if tris is not NULL it must contain the triangles of the given indices
+     // and it is used instead of the indices.
      bool FrustumMeshIntersect(const Frustum& fr,
                                float3* pos, 
                                uint32_t posCount,
                                uint32_t* indices, 
-                               uint32_t indicesCount);
+                               uint32_t indicesCount,
+                               const BVH* bvh = NULL,
+                               const TriangleStream* tris = NULL);
                                
 	 bool TestFrustumAABB(const Frustum& frustum, const AABB& box);
      int FrustumAABBIntersect(const Frustum& frustum, const AABB& box);
@@ -262,11 +299,50 @@ enum corner {NearBottonLeft = 0, NearBottomRight, NearTopRight, NearTopLeft,
 
      float IntersectionRayPlane(const Ray &r, const Plane &p);
 
+     // find the closest triangle hit by the ray.
+     // if bvh is not NULL it must be built over the triangles of the given indices (see BVH::BuildFromTriangles)
+     // and it is used to skip the triangles that the ray can't hit.
+     // if tris is not NULL it must contain the triangles of the given indices in their original order
+     // and they are tested using SIMD. A bvh built by BuildFromTriangles() has its own packed triangles.
      bool MeshIntersects(const Ray& ray, float3* pos, uint32_t posCount, uint32_t* indices, uint32_t indicesCount,
-                bool backfaceCull, float* out_tmin, float3* out_pos, float3* out_nor, float3* nearestVertex);
+                bool backfaceCull, float* out_tmin, float3* out_pos, float3* out_nor, float3* nearestVertex,
+                const BVH* bvh = NULL, const TriangleStream* tris = NULL);
+
+    // distTo is the distance along the ray of the closest point and distBetween
+    // the distance between the ray and the segment at that point.
+    void DistanceRayToSegment(const Ray& ray, const LineSeg& segment,
+                float* out_distTo, float* out_distBetween, float3* out_pos, float3* out_nor);
 
     bool DistanceRayToLineStrip(const Ray& ray, float3* pos,uint32_t posCount, const Matrix& worldXform,                 
                 float* out_distTo, float* out_distBetween, float3* out_pos, float3* out_nor, uint32_t* out_hitIndex);
 
+    //================= primitive shapes =================
+    // exact ray tests, the shapes are in the same space as the ray.
+    // the hit normal points out of the shape. When the ray starts inside a closed shape
+    // the exit point is hit, unless backfaceCull is true.
+    bool IntersectRaySphere(const Ray& r, const Sphere& sphere, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+    bool IntersectRayBox(const Ray& r, const float3& halfExtents, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+    bool IntersectRayCylinder(const Ray& r, float radius, float halfHeight, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+    bool IntersectRayCone(const Ray& r, float radius, float halfHeight, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+    bool IntersectRayTorus(const Ray& r, float ringRadius, float tubeRadius, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+    bool IntersectRayQuad(const Ray& r, float halfWidth, float halfHeight, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+
+    // ray test of a shape in its local space.
+    bool IntersectRayPrimitive(const Ray& r, const PrimitiveShape& shape, bool backfaceCull,
+                float* out_tmin, float3* out_pos, float3* out_nor);
+
+    // frustum test of a shape in its local space.
+    // returns 0 if the shape is outside, 2 if it intersects or is inside the frustum.
+    // returns 1 if the test is not conclusive, only happens with the torus
+    // when the frustum crosses its bounds but none of the exact tests decide,
+    // the caller must then test the tessellated shape.
+    int FrustumPrimitiveIntersect(const Frustum& fr, const PrimitiveShape& shape);
+
 
 }
@@ -0,0 +1,377 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "DynamicAABBTree.h"
+#include <algorithm>
+
+namespace LvEdEngine
+{
+    // fat bounds are extended by this fraction of their size on each side,
+    // plus a small absolute margin for flat and point like objects.
+    static const float FatBoundsScale = 0.1f;
+    static const float FatBoundsMargin = 0.01f;
+
+    static float SurfaceArea(const AABB& box)
+    {
+        float3 e = box.Max() - box.Min();
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    static AABB Combine(const AABB& a, const AABB& b)
+    {
+        return AABB(minimize(a.Min(), b.Min()), maximize(a.Max(), b.Max()));
+    }
+
+    static bool ContainsBox(const AABB& outer, const AABB& inner)
+    {
+        return outer.Min().x <= inner.Min().x && outer.Min().y <= inner.Min().y && outer.Min().z <= inner.Min().z
+            && outer.Max().x >= inner.Max().x && outer.Max().y >= inner.Max().y && outer.Max().z >= inner.Max().z;
+    }
+
+    static AABB FattenBounds(const AABB& box)
+    {
+        float3 margin = (box.Max() - box.Min()) * FatBoundsScale
+                      + float3(FatBoundsMargin, FatBoundsMargin, FatBoundsMargin);
+        return AABB(box.Min() - margin, box.Max() + margin);
+    }
+
+    // -------------------------------------------------------------------------------------
+    DynamicAABBTree::DynamicAABBTree()
+        : m_root(NullNode), m_freeList(NullNode), m_proxyCount(0)
+    {
+    }
+
+    // -------------------------------------------------------------------------------------
+    void DynamicAABBTree::Clear()
+    {
+        m_nodes.clear();
+        m_root = NullNode;
+        m_freeList = NullNode;
+        m_proxyCount = 0;
+    }
+
+    // -------------------------------------------------------------------------------------
+    int32_t DynamicAABBTree::AllocateNode()
+    {
+        int32_t nodeId;
+        if(m_freeList != NullNode)
+        {
+            nodeId = m_freeList;
+            m_freeList = m_nodes[nodeId].next;
+        }
+        else
+        {
+            nodeId = (int32_t)m_nodes.size();
+            m_nodes.push_back(TreeNode());
+        }
+
+        TreeNode& node = m_nodes[nodeId];
+        node.parent = NullNode;
+        node.child1 = NullNode;
+        node.child2 = NullNode;
+        node.height = 0;
+        node.userData = 0;
+        return nodeId;
+    }
+
+    // -------------------------------------------------------------------------------------
+    void DynamicAABBTree::FreeNode(int32_t nodeId)
+    {
+        assert(nodeId >= 0 && nodeId < (int32_t)m_nodes.size());
+        m_nodes[nodeId].next = m_freeList;
+        m_nodes[nodeId].height = -1;
+        m_freeList = nodeId;
+    }
+
+    // -------------------------------------------------------------------------------------
+    int32_t DynamicAABBTree::CreateProxy(const AABB& bounds, uint64_t userData)
+    {
+        int32_t proxyId = AllocateNode();
+        m_nodes[proxyId].bounds = FattenBounds(bounds);
+        m_nodes[proxyId].userData = userData;
+        InsertLeaf(proxyId);
+        m_proxyCount++;
+        return proxyId;
+    }
+
+    // -------------------------------------------------------------------------------------
+    void DynamicAABBTree::DestroyProxy(int32_t proxyId)
+    {
+        assert(proxyId >= 0 && proxyId < (int32_t)m_nodes.size());
+        assert(m_nodes[proxyId].IsLeaf());
+        RemoveLeaf(proxyId);
+        FreeNode(proxyId);
+        m_proxyCount--;
+    }
+
+    // -------------------------------------------------------------------------------------
+    bool DynamicAABBTree::MoveProxy(int32_t proxyId, const AABB& bounds)
+    {
+        assert(proxyId >= 0 && proxyId < (int32_t)m_nodes.size());
+        assert(m_nodes[proxyId].IsLeaf());
+
+        if(ContainsBox(m_nodes[proxyId].bounds, bounds))
+        {
+            // re-insert if the object shrunk a lot, so the fat bounds stay tight.
+            if(SurfaceArea(m_nodes[proxyId].bounds) <= 4.0f * SurfaceArea(FattenBounds(bounds)))
+                return false;
+        }
+
+        RemoveLeaf(proxyId);
+        m_nodes[proxyId].bounds = FattenBounds(bounds);
+        InsertLeaf(proxyId);
+        return true;
+    }
+
+    // -------------------------------------------------------------------------------------
+    void DynamicAABBTree::InsertLeaf(int32_t leaf)
+    {
+        if(m_root == NullNode)
+        {
+            m_root = leaf;
+            m_nodes[m_root].parent = NullNode;
+            return;
+        }
+
+        // find the best sibling using surface area heuristic.
+        AABB leafBounds = m_nodes[leaf].bounds;
+        int32_t index = m_root;
+        while(!m_nodes[index].IsLeaf())
+        {
+            int32_t child1 = m_nodes[index].child1;
+            int32_t child2 = m_nodes[index].child2;
+
+            float area = SurfaceArea(m_nodes[index].bounds);
+            float combinedArea = SurfaceArea(Combine(m_nodes[index].bounds, leafBounds));
+
+            // cost of creating a new parent for this node and the new leaf
+            float cost = 2.0f * combinedArea;
+
+            // minimum cost of pushing the leaf further down the tree
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float cost1 = SurfaceArea(Combine(leafBounds, m_nodes[child1].bounds));
+            if(!m_nodes[child1].IsLeaf())
+                cost1 -= SurfaceArea(m_nodes[child1].bounds);
+            cost1 += inheritanceCost;
+
+            float cost2 = SurfaceArea(Combine(leafBounds, m_nodes[child2].bounds));
+            if(!m_nodes[child2].IsLeaf())
+                cost2 -= SurfaceArea(m_nodes[child2].bounds);
+            cost2 += inheritanceCost;
+
+            if(cost < cost1 && cost < cost2)
+                break;
+
+            index = cost1 < cost2 ? child1 : child2;
+        }
+
+        int32_t sibling = index;
+
+        // create a new parent.
+        // note: AllocateNode() may grow m_nodes, don't keep references across the call.
+        int32_t oldParent = m_nodes[sibling].parent;
+        int32_t newParent = AllocateNode();
+        m_nodes[newParent].parent = oldParent;
+        m_nodes[newParent].bounds = Combine(leafBounds, m_nodes[sibling].bounds);
+        m_nodes[newParent].height = m_nodes[sibling].height + 1;
+        m_nodes[newParent].child1 = sibling;
+        m_nodes[newParent].child2 = leaf;
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+
+        if(oldParent != NullNode)
+        {
+            if(m_nodes[oldParent].child1 == sibling)
+                m_nodes[oldParent].child1 = newParent;
+            else
+                m_nodes[oldParent].child2 = newParent;
+        }
+        else
+        {
+            m_root = newParent;
+        }
+
+        // walk back up the tree fixing heights and bounds.
+        index = m_nodes[leaf].parent;
+        while(index != NullNode)
+        {
+            index = Balance(index);
+
+            int32_t child1 = m_nodes[index].child1;
+            int32_t child2 = m_nodes[index].child2;
+            m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+            m_nodes[index].bounds = Combine(m_nodes[child1].bounds, m_nodes[child2].bounds);
+
+            index = m_nodes[index].parent;
+        }
+    }
+
+    // -------------------------------------------------------------------------------------
+    void DynamicAABBTree::RemoveLeaf(int32_t leaf)
+    {
+        if(leaf == m_root)
+        {
+            m_root = NullNode;
+            return;
+        }
+
+        int32_t parent = m_nodes[leaf].parent;
+        int32_t grandParent = m_nodes[parent].parent;
+        int32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+        if(grandParent != NullNode)
+        {
+            // destroy parent and connect sibling to grandParent.
+            if(m_nodes[grandParent].child1 == parent)
+                m_nodes[grandParent].child1 = sibling;
+            else
+                m_nodes[grandParent].child2 = sibling;
+            m_nodes[sibling].parent = grandParent;
+            FreeNode(parent);
+
+            // adjust ancestor bounds.
+            int32_t index = grandParent;
+            while(index != NullNode)
+            {
+                index = Balance(index);
+
+                int32_t child1 = m_nodes[index].child1;
+                int32_t child2 = m_nodes[index].child2;
+                m_nodes[index].bounds = Combine(m_nodes[child1].bounds, m_nodes[child2].bounds);
+                m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+
+                index = m_nodes[index].parent;
+            }
+        }
+        else
+        {
+            m_root = sibling;
+            m_nodes[sibling].parent = NullNode;
+            FreeNode(parent);
+        }
+        m_nodes[leaf].parent = NullNode;
+    }
+
+    // -------------------------------------------------------------------------------------
+    // perform a left or right rotation if node A is imbalanced.
+    // returns the new root index of the subtree.
+    int32_t DynamicAABBTree::Balance(int32_t iA)
+    {
+        assert(iA != NullNode);
+
+        TreeNode* A = &m_nodes[iA];
+        if(A->IsLeaf() || A->height < 2)
+        {
+            return iA;
+        }
+
+        int32_t iB = A->child1;
+        int32_t iC = A->child2;
+        TreeNode* B = &m_nodes[iB];
+        TreeNode* C = &m_nodes[iC];
+
+        int32_t balance = C->height - B->height;
+
+        // rotate C up
+        if(balance > 1)
+        {
+            int32_t iF = C->child1;
+            int32_t iG = C->child2;
+            TreeNode* F = &m_nodes[iF];
+            TreeNode* G = &m_nodes[iG];
+
+            // swap A and C
+            C->child1 = iA;
+            C->parent = A->parent;
+            A->parent = iC;
+
+            // A's old parent should point to C
+            if(C->parent != NullNode)
+            {
+                if(m_nodes[C->parent].child1 == iA)
+                    m_nodes[C->parent].child1 = iC;
+                else
+                    m_nodes[C->parent].child2 = iC;
+            }
+            else
+            {
+                m_root = iC;
+            }
+
+            // rotate
+            if(F->height > G->height)
+            {
+                C->child2 = iF;
+                A->child2 = iG;
+                G->parent = iA;
+                A->bounds = Combine(B->bounds, G->bounds);
+                C->bounds = Combine(A->bounds, F->bounds);
+                A->height = 1 + std::max(B->height, G->height);
+                C->height = 1 + std::max(A->height, F->height);
+            }
+            else
+            {
+                C->child2 = iG;
+                A->child2 = iF;
+                F->parent = iA;
+                A->bounds = Combine(B->bounds, F->bounds);
+                C->bounds = Combine(A->bounds, G->bounds);
+                A->height = 1 + std::max(B->height, F->height);
+                C->height = 1 + std::max(A->height, G->height);
+            }
+            return iC;
+        }
+
+        // rotate B up
+        if(balance < -1)
+        {
+            int32_t iD = B->child1;
+            int32_t iE = B->child2;
+            TreeNode* D = &m_nodes[iD];
+            TreeNode* E = &m_nodes[iE];
+
+            // swap A and B
+            B->child1 = iA;
+            B->parent = A->parent;
+            A->parent = iB;
+
+            // A's old parent should point to B
+            if(B->parent != NullNode)
+            {
+                if(m_nodes[B->parent].child1 == iA)
+                    m_nodes[B->parent].child1 = iB;
+                else
+                    m_nodes[B->parent].child2 = iB;
+            }
+            else
+            {
+                m_root = iB;
+            }
+
+            // rotate
+            if(D->height > E->height)
+            {
+                B->child2 = iD;
+                A->child1 = iE;
+                E->parent = iA;
+                A->bounds = Combine(C->bounds, E->bounds);
+                B->bounds = Combine(A->bounds, D->bounds);
+                A->height = 1 + std::max(C->height, E->height);
+                B->height = 1 + std::max(A->height, D->height);
+            }
+            else
+            {
+                B->child2 = iE;
+                A->child1 = iD;
+                D->parent = iA;
+                A->bounds = Combine(C->bounds, D->bounds);
+                B->bounds = Combine(A->bounds, E->bounds);
+                A->height = 1 + std::max(C->height, D->height);
+                B->height = 1 + std::max(A->height, E->height);
+            }
+            return iB;
+        }
+
+        return iA;
+    }
+}
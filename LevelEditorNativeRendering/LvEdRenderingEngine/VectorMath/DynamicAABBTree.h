@@ -0,0 +1,205 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    // dynamic bounding volume hierarchy for moving objects.
+    // each proxy stores a 'fat' AABB that is larger than the bounds of the object,
+    // so small movements don't require the tree to be updated.
+    // The tree is kept balanced using rotations on insertion and removal.
+    // proxy ids are stable until the proxy is destroyed.
+    class DynamicAABBTree : public NonCopyable
+    {
+    public:
+        static const int32_t NullNode = -1;
+
+        DynamicAABBTree();
+
+        // create a proxy for the given bounds. returns the proxy id.
+        int32_t CreateProxy(const AABB& bounds, uint64_t userData);
+
+        void DestroyProxy(int32_t proxyId);
+
+        // update the bounds of the proxy.
+        // returns true if the proxy was re-inserted, false if the new bounds
+        // still fit in the fat bounds.
+        bool MoveProxy(int32_t proxyId, const AABB& bounds);
+
+        uint64_t GetUserData(int32_t proxyId) const
+        {
+            assert(proxyId >= 0 && proxyId < (int32_t)m_nodes.size());
+            return m_nodes[proxyId].userData;
+        }
+
+        const AABB& GetFatBounds(int32_t proxyId) const
+        {
+            assert(proxyId >= 0 && proxyId < (int32_t)m_nodes.size());
+            return m_nodes[proxyId].bounds;
+        }
+
+        uint32_t GetProxyCount() const { return m_proxyCount; }
+        int32_t GetHeight() const { return m_root == NullNode ? 0 : m_nodes[m_root].height; }
+
+        // remove all the proxies.
+        void Clear();
+
+        // visits all the proxies whose fat bounds are hit by the ray before *maxDist.
+        // calls visitor(userData, maxDist) for each of them.
+        // the visitor can lower *maxDist to skip the proxies that are farther.
+        template<typename Visitor>
+        void RayQuery(const Ray& ray, float* maxDist, Visitor& visitor) const
+        {
+            if(m_root == NullNode) return;
+
+            float3 invDir;
+            invDir.x = ray.direction.x != 0.0f ? 1.0f / ray.direction.x : FLT_MAX;
+            invDir.y = ray.direction.y != 0.0f ? 1.0f / ray.direction.y : FLT_MAX;
+            invDir.z = ray.direction.z != 0.0f ? 1.0f / ray.direction.z : FLT_MAX;
+
+            NodeStack stack;
+            stack.Push(m_root);
+            while(!stack.IsEmpty())
+            {
+                int32_t nodeId = stack.Pop();
+                const TreeNode& node = m_nodes[nodeId];
+                float tmin;
+                if(!IntersectRay(node.bounds, ray.pos, invDir, *maxDist, &tmin))
+                    continue;
+
+                if(node.IsLeaf())
+                {
+                    visitor(node.userData, maxDist);
+                }
+                else
+                {
+                    stack.Push(node.child2);
+                    stack.Push(node.child1);
+                }
+            }
+        }
+
+        // visits all the proxies whose fat bounds intersect or are inside the frustum.
+        // calls visitor(userData) for each of them.
+        // subtrees that are completely inside the frustum are reported without further tests.
+        template<typename Visitor>
+        void FrustumQuery(const Frustum& frustum, Visitor& visitor) const
+        {
+            if(m_root == NullNode) return;
+
+            // stack entries are node id * 2 + 1 if the node is known to be inside the frustum.
+            NodeStack stack;
+            stack.Push(m_root * 2);
+            while(!stack.IsEmpty())
+            {
+                int32_t entry = stack.Pop();
+                const TreeNode& node = m_nodes[entry >> 1];
+                int inside = entry & 1;
+                if(!inside)
+                {
+                    int test = FrustumAABBIntersect(frustum, node.bounds);
+                    if(test == 0)
+                        continue;
+                    inside = test == 2 ? 1 : 0;
+                }
+
+                if(node.IsLeaf())
+                {
+                    visitor(node.userData);
+                }
+                else
+                {
+                    stack.Push(node.child2 * 2 + inside);
+                    stack.Push(node.child1 * 2 + inside);
+                }
+            }
+        }
+
+    private:
+        // traversal stack, uses the heap only for very deep trees.
+        // queries don't share any state so they can run concurrently.
+        class NodeStack
+        {
+        public:
+            NodeStack() : m_count(0) {}
+            bool IsEmpty() const { return m_count == 0 && m_overflow.empty(); }
+            void Push(int32_t v)
+            {
+                if(m_count < FixedSize)
+                    m_fixed[m_count++] = v;
+                else
+                    m_overflow.push_back(v);
+            }
+            int32_t Pop()
+            {
+                if(!m_overflow.empty())
+                {
+                    int32_t v = m_overflow.back();
+                    m_overflow.pop_back();
+                    return v;
+                }
+                return m_fixed[--m_count];
+            }
+        private:
+            static const int32_t FixedSize = 128;
+            int32_t m_fixed[FixedSize];
+            int32_t m_count;
+            std::vector<int32_t> m_overflow;
+        };
+
+        struct TreeNode
+        {
+            AABB bounds;
+            uint64_t userData;
+            union
+            {
+                int32_t parent;
+                int32_t next; // next free node.
+            };
+            int32_t child1;
+            int32_t child2;
+            int32_t height;   // leaf = 0, free node = -1
+
+            bool IsLeaf() const { return child1 == NullNode; }
+        };
+
+        // ray slab test, same as IntersectRayAABB() but without computing hit point.
+        static bool IntersectRay(const AABB& box, const float3& org, const float3& invDir, float maxDist, float* out_tmin)
+        {
+            const float3& bmin = box.Min();
+            const float3& bmax = box.Max();
+            float tx1 = (bmin.x - org.x) * invDir.x;
+            float tx2 = (bmax.x - org.x) * invDir.x;
+            float tmin = minimize(tx1, tx2);
+            float tmax = maximize(tx1, tx2);
+
+            float ty1 = (bmin.y - org.y) * invDir.y;
+            float ty2 = (bmax.y - org.y) * invDir.y;
+            tmin = maximize(tmin, minimize(ty1, ty2));
+            tmax = minimize(tmax, maximize(ty1, ty2));
+
+            float tz1 = (bmin.z - org.z) * invDir.z;
+            float tz2 = (bmax.z - org.z) * invDir.z;
+            tmin = maximize(tmin, minimize(tz1, tz2));
+            tmax = minimize(tmax, maximize(tz1, tz2));
+
+            *out_tmin = tmin;
+            return tmax >= tmin && tmax >= 0.0f && tmin <= maxDist;
+        }
+
+        int32_t AllocateNode();
+        void FreeNode(int32_t nodeId);
+        void InsertLeaf(int32_t leaf);
+        void RemoveLeaf(int32_t leaf);
+        int32_t Balance(int32_t nodeId);
+
+        std::vector<TreeNode> m_nodes;
+        int32_t m_root;
+        int32_t m_freeList;
+        uint32_t m_proxyCount;
+    };
+}
@@ -0,0 +1,96 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "HeightPyramid.h"
+#include <float.h>
+
+namespace LvEdEngine
+{
+    // -------------------------------------------------------------------------------------
+    void HeightPyramid::Build(const float* heights, int32_t cols, int32_t rows, int32_t rowPitch)
+    {
+        Clear();
+        if(cols < 2 || rows < 2) return;
+
+        Level level;
+        level.cols = cols - 1;
+        level.rows = rows - 1;
+        m_levels.push_back(level);
+        while(level.cols > 1 || level.rows > 1)
+        {
+            level.cols = (level.cols + 1) / 2;
+            level.rows = (level.rows + 1) / 2;
+            m_levels.push_back(level);
+        }
+        assert(m_levels.size() <= MaxLevels);
+
+        for(auto it = m_levels.begin(); it != m_levels.end(); it++)
+        {
+            it->ranges.resize(it->cols * it->rows);
+        }
+
+        Update(heights, rowPitch, 0, 0, cols, rows);
+    }
+
+    // -------------------------------------------------------------------------------------
+    void HeightPyramid::Update(const float* heights, int32_t rowPitch, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+    {
+        if(m_levels.empty()) return;
+
+        // cell (x,y) uses vertices x..x+1 and y..y+1
+        Level& cells = m_levels[0];
+        x1 = std::max(x1 - 1, 0);
+        y1 = std::max(y1 - 1, 0);
+        x2 = std::min(x2, cells.cols);
+        y2 = std::min(y2, cells.rows);
+        if(x1 >= x2 || y1 >= y2) return;
+
+        const uint8_t* ptr = (const uint8_t*)heights;
+        for(int32_t y = y1; y < y2; y++)
+        {
+            const float* line0 = (const float*)(ptr + y * rowPitch);
+            const float* line1 = (const float*)(ptr + (y + 1) * rowPitch);
+            for(int32_t x = x1; x < x2; x++)
+            {
+                HeightRange& range = cells.ranges[y * cells.cols + x];
+                range.minH = minimize(minimize(line0[x], line0[x+1]), minimize(line1[x], line1[x+1]));
+                range.maxH = maximize(maximize(line0[x], line0[x+1]), maximize(line1[x], line1[x+1]));
+            }
+        }
+
+        for(int32_t level = 1; level < (int32_t)m_levels.size(); level++)
+        {
+            x1 = x1 / 2;
+            y1 = y1 / 2;
+            x2 = (x2 + 1) / 2;
+            y2 = (y2 + 1) / 2;
+            UpdateLevel(level, x1, y1, x2, y2);
+        }
+    }
+
+    // -------------------------------------------------------------------------------------
+    // recompute nodes [x1,x2) x [y1,y2) of the level from the level below.
+    void HeightPyramid::UpdateLevel(int32_t level, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+    {
+        const Level& child = m_levels[level - 1];
+        Level& lv = m_levels[level];
+        for(int32_t y = y1; y < y2; y++)
+        {
+            for(int32_t x = x1; x < x2; x++)
+            {
+                HeightRange range;
+                range.minH = FLT_MAX;
+                range.maxH = -FLT_MAX;
+                for(int32_t cy = y * 2; cy < y * 2 + 2 && cy < child.rows; cy++)
+                {
+                    for(int32_t cx = x * 2; cx < x * 2 + 2 && cx < child.cols; cx++)
+                    {
+                        const HeightRange& c = child.ranges[cy * child.cols + cx];
+                        range.minH = minimize(range.minH, c.minH);
+                        range.maxH = maximize(range.maxH, c.maxH);
+                    }
+                }
+                lv.ranges[y * lv.cols + x] = range;
+            }
+        }
+    }
+}
@@ -0,0 +1,178 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    // height range of a heightfield cell or of a group of cells.
+    struct HeightRange
+    {
+        float minH;
+        float maxH;
+    };
+
+    // min/max height pyramid (maximum mipmap) of a regular heightfield.
+    // The heightfield is a grid of cols x rows vertices in the XZ plane,
+    // vertex (x,y) is at (x * cellSize, height, y * cellSize).
+    // level 0 stores the height range of each cell, cell (x,y) is the quad
+    // formed by vertices (x,y) and (x+1,y+1). each level above stores
+    // the range of 2x2 nodes of the level below, the top level has a single node.
+    class HeightPyramid : public NonCopyable
+    {
+    public:
+        static const int32_t MaxLevels = 32;
+
+        HeightPyramid(){}
+
+        // build the pyramid for all the cells.
+        // heights points to the first row, rowPitch is the size of a row in bytes.
+        void Build(const float* heights, int32_t cols, int32_t rows, int32_t rowPitch);
+
+        // recompute the cells that use any of the vertices in [x1,x2) x [y1,y2)
+        // and their ancestors. The grid must have the same size as in Build().
+        void Update(const float* heights, int32_t rowPitch, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+        void Clear() { m_levels.clear(); }
+        bool IsEmpty() const { return m_levels.empty(); }
+
+        int32_t GetLevelCount() const { return (int32_t)m_levels.size(); }
+        int32_t GetCellCols() const { return m_levels.empty() ? 0 : m_levels[0].cols; }
+        int32_t GetCellRows() const { return m_levels.empty() ? 0 : m_levels[0].rows; }
+
+        const HeightRange& GetRange(int32_t level, int32_t x, int32_t y) const
+        {
+            const Level& lv = m_levels[level];
+            assert(x >= 0 && x < lv.cols && y >= 0 && y < lv.rows);
+            return lv.ranges[y * lv.cols + x];
+        }
+
+        // visits the cells whose height range box is crossed by the ray before *maxDist,
+        // in front to back order, and calls visitor(cellX, cellY, maxDist) for each of them.
+        // The node boxes are padded, so a cell is visited if any of its triangles can be hit.
+        // The visitor must lower *maxDist when it finds a hit, nodes that the ray
+        // enters farther than *maxDist are skipped.
+        template<typename Visitor>
+        void RayQuery(const Ray& ray, float cellSize, float* maxDist, Visitor& visitor) const
+        {
+            if(m_levels.empty()) return;
+
+            const float3& org = ray.pos;
+            float3 invDir;
+            invDir.x = ray.direction.x != 0.0f ? 1.0f / ray.direction.x : FLT_MAX;
+            invDir.y = ray.direction.y != 0.0f ? 1.0f / ray.direction.y : FLT_MAX;
+            invDir.z = ray.direction.z != 0.0f ? 1.0f / ray.direction.z : FLT_MAX;
+
+            // pad the boxes to cover the rounding errors of the ray/triangle test.
+            int32_t top = (int32_t)m_levels.size() - 1;
+            const HeightRange& rootRange = m_levels[top].ranges[0];
+            float scale = abs(org.x) + abs(org.y) + abs(org.z)
+                        + (float)(m_levels[0].cols + m_levels[0].rows) * cellSize
+                        + maximize(abs(rootRange.minH), abs(rootRange.maxH));
+            float pad = cellSize * 0.01f + scale * 1e-5f;
+
+            StackEntry stack[4 * MaxLevels];
+            int32_t stackSize = 0;
+            float tmin;
+            if(!IntersectNode(top, 0, 0, cellSize, pad, org, invDir, *maxDist, &tmin))
+                return;
+            stack[stackSize].level = top;
+            stack[stackSize].x = 0;
+            stack[stackSize].y = 0;
+            stack[stackSize].tmin = tmin;
+            stackSize++;
+
+            while(stackSize > 0)
+            {
+                StackEntry entry = stack[--stackSize];
+                if(entry.tmin > *maxDist)
+                    continue;
+
+                if(entry.level == 0)
+                {
+                    visitor(entry.x, entry.y, maxDist);
+                    continue;
+                }
+
+                // test the children and sort them front to back.
+                const Level& child = m_levels[entry.level - 1];
+                StackEntry children[4];
+                int32_t childCount = 0;
+                for(int32_t cy = entry.y * 2; cy < entry.y * 2 + 2 && cy < child.rows; cy++)
+                {
+                    for(int32_t cx = entry.x * 2; cx < entry.x * 2 + 2 && cx < child.cols; cx++)
+                    {
+                        if(!IntersectNode(entry.level - 1, cx, cy, cellSize, pad, org, invDir, *maxDist, &tmin))
+                            continue;
+                        StackEntry e;
+                        e.level = entry.level - 1;
+                        e.x = cx;
+                        e.y = cy;
+                        e.tmin = tmin;
+                        int32_t i = childCount++;
+                        for(; i > 0 && children[i - 1].tmin < tmin; i--)
+                            children[i] = children[i - 1];
+                        children[i] = e;
+                    }
+                }
+
+                // children are sorted far to near, push them so the nearest is popped first.
+                for(int32_t i = 0; i < childCount; i++)
+                    stack[stackSize++] = children[i];
+            }
+        }
+
+    private:
+        struct Level
+        {
+            int32_t cols;
+            int32_t rows;
+            std::vector<HeightRange> ranges;
+        };
+
+        struct StackEntry
+        {
+            int32_t level;
+            int32_t x;
+            int32_t y;
+            float tmin;
+        };
+
+        // ray slab test against the padded box of the node.
+        bool IntersectNode(int32_t level, int32_t x, int32_t y, float cellSize, float pad,
+                           const float3& org, const float3& invDir, float maxDist, float* out_tmin) const
+        {
+            const HeightRange& range = m_levels[level].ranges[y * m_levels[level].cols + x];
+            int32_t x0 = x << level;
+            int32_t y0 = y << level;
+            int32_t x1 = std::min((x + 1) << level, m_levels[0].cols);
+            int32_t y1 = std::min((y + 1) << level, m_levels[0].rows);
+
+            float tx1 = ((float)x0 * cellSize - pad - org.x) * invDir.x;
+            float tx2 = ((float)x1 * cellSize + pad - org.x) * invDir.x;
+            float tmin = minimize(tx1, tx2);
+            float tmax = maximize(tx1, tx2);
+
+            float ty1 = (range.minH - pad - org.y) * invDir.y;
+            float ty2 = (range.maxH + pad - org.y) * invDir.y;
+            tmin = maximize(tmin, minimize(ty1, ty2));
+            tmax = minimize(tmax, maximize(ty1, ty2));
+
+            float tz1 = ((float)y0 * cellSize - pad - org.z) * invDir.z;
+            float tz2 = ((float)y1 * cellSize + pad - org.z) * invDir.z;
+            tmin = maximize(tmin, minimize(tz1, tz2));
+            tmax = minimize(tmax, maximize(tz1, tz2));
+
+            *out_tmin = tmin;
+            return tmax >= tmin && tmax >= 0.0f && tmin <= maxDist;
+        }
+
+        void UpdateLevel(int32_t level, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+        std::vector<Level> m_levels;
+    };
+}
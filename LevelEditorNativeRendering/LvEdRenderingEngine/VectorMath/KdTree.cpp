@@ -0,0 +1,157 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "KdTree.h"
+#include <algorithm>
+
+namespace LvEdEngine
+{
+    // lexicographic order, used to remove the duplicated positions.
+    static bool PositionLess(const float3& a, const float3& b)
+    {
+        if(a.x != b.x) return a.x < b.x;
+        if(a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    }
+
+    static bool PositionEqual(const float3& a, const float3& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    struct AxisLess
+    {
+        int axis;
+        bool operator()(const float3& a, const float3& b) const
+        {
+            return a[axis] < b[axis];
+        }
+    };
+
+    // -------------------------------------------------------------------------------------
+    void KdTree::Clear()
+    {
+        m_points.clear();
+        m_axis.clear();
+        m_bounds = AABB();
+    }
+
+    // -------------------------------------------------------------------------------------
+    void KdTree::Build(const float3* pos, uint32_t count)
+    {
+        Clear();
+        if(count == 0) return;
+
+        m_points.assign(pos, pos + count);
+        std::sort(m_points.begin(), m_points.end(), PositionLess);
+        m_points.erase(std::unique(m_points.begin(), m_points.end(), PositionEqual), m_points.end());
+        std::vector<float3>(m_points).swap(m_points);
+
+        for(auto it = m_points.begin(); it != m_points.end(); it++)
+            m_bounds.Extend(*it);
+
+        m_axis.resize(m_points.size(), 0);
+        BuildRecursive(0, (uint32_t)m_points.size(), 0);
+    }
+
+    // -------------------------------------------------------------------------------------
+    void KdTree::BuildRecursive(uint32_t first, uint32_t last, uint32_t depth)
+    {
+        uint32_t count = last - first;
+        if(count <= MaxLeafSize)
+            return;
+        assert(depth < MaxDepth);
+
+        // split along the longest axis of the points.
+        float3 pmin = m_points[first];
+        float3 pmax = pmin;
+        for(uint32_t i = first + 1; i < last; i++)
+        {
+            pmin = minimize(pmin, m_points[i]);
+            pmax = maximize(pmax, m_points[i]);
+        }
+        float3 extent = pmax - pmin;
+        int axis = 0;
+        if(extent.y > extent[axis]) axis = 1;
+        if(extent.z > extent[axis]) axis = 2;
+
+        uint32_t mid = first + count / 2;
+        AxisLess pred;
+        pred.axis = axis;
+        std::nth_element(m_points.begin() + first, m_points.begin() + mid, m_points.begin() + last, pred);
+        m_axis[mid] = (uint8_t)axis;
+
+        BuildRecursive(first, mid, depth + 1);
+        BuildRecursive(mid + 1, last, depth + 1);
+    }
+
+    // -------------------------------------------------------------------------------------
+    uint32_t KdTree::FindNearest(const float3& p) const
+    {
+        assert(!m_points.empty());
+        uint32_t best = 0;
+        float bestDistSq = lengthsquared(m_points[0] - p);
+
+        StackEntry stack[MaxDepth + 4];
+        uint32_t stackSize = 0;
+        stack[stackSize].first = 0;
+        stack[stackSize].last = (uint32_t)m_points.size();
+        stack[stackSize].min = m_bounds.Min();
+        stack[stackSize].max = m_bounds.Max();
+        stackSize++;
+
+        while(stackSize > 0)
+        {
+            StackEntry entry = stack[--stackSize];
+
+            // skip the node if its box is farther than the best point.
+            float3 closest = minimize(maximize(p, entry.min), entry.max);
+            if(lengthsquared(closest - p) > bestDistSq)
+                continue;
+
+            uint32_t count = entry.last - entry.first;
+            if(count <= MaxLeafSize)
+            {
+                for(uint32_t i = entry.first; i < entry.last; i++)
+                {
+                    float distSq = lengthsquared(m_points[i] - p);
+                    if(distSq < bestDistSq)
+                    {
+                        bestDistSq = distSq;
+                        best = i;
+                    }
+                }
+                continue;
+            }
+
+            uint32_t mid = entry.first + count / 2;
+            uint32_t axis = m_axis[mid];
+            float split = m_points[mid][axis];
+            float distSq = lengthsquared(m_points[mid] - p);
+            if(distSq < bestDistSq)
+            {
+                bestDistSq = distSq;
+                best = mid;
+            }
+
+            StackEntry low = entry;
+            low.last = mid;
+            low.max[axis] = split;
+            StackEntry high = entry;
+            high.first = mid + 1;
+            high.min[axis] = split;
+
+            // visit the side that contains p first.
+            if(p[axis] < split)
+            {
+                stack[stackSize++] = high;
+                stack[stackSize++] = low;
+            }
+            else
+            {
+                stack[stackSize++] = low;
+                stack[stackSize++] = high;
+            }
+        }
+        return best;
+    }
+}
@@ -0,0 +1,144 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    // balanced k-d tree over the unique positions of a point set.
+    // the tree is implicit: the points of a node are the range [first, last) of the
+    // point array, the splitting point is at the middle of the range and the points
+    // before it are on the low side of the splitting plane.
+    class KdTree : public NonCopyable
+    {
+    public:
+        static const uint32_t MaxLeafSize = 8;
+        static const uint32_t MaxDepth = 40; // enough for 2^32 points, the tree is balanced.
+
+        KdTree(){}
+
+        // build the tree, duplicated positions are only stored once.
+        void Build(const float3* pos, uint32_t count);
+        void Clear();
+
+        bool IsEmpty() const { return m_points.empty(); }
+        uint32_t GetPointCount() const { return (uint32_t)m_points.size(); }
+        const float3& GetPoint(uint32_t index) const { return m_points[index]; }
+
+        // calls visitor(pointIndex) for each point that is closer than radius
+        // to the half line starting at ray.pos.
+        // the ray direction doesn't need to be normalized.
+        template<typename Visitor>
+        void RayQuery(const Ray& ray, float radius, Visitor& visitor) const
+        {
+            if(m_points.empty()) return;
+
+            const float3& org = ray.pos;
+            const float3& dir = ray.direction;
+            float dirLenSq = lengthsquared(dir);
+            if(dirLenSq == 0.0f) return;
+            float radiusSq = radius * radius;
+
+            float3 invDir;
+            invDir.x = dir.x != 0.0f ? 1.0f / dir.x : FLT_MAX;
+            invDir.y = dir.y != 0.0f ? 1.0f / dir.y : FLT_MAX;
+            invDir.z = dir.z != 0.0f ? 1.0f / dir.z : FLT_MAX;
+            float3 pad(radius, radius, radius);
+
+            StackEntry stack[MaxDepth + 4];
+            uint32_t stackSize = 0;
+            stack[stackSize].first = 0;
+            stack[stackSize].last = (uint32_t)m_points.size();
+            stack[stackSize].min = m_bounds.Min();
+            stack[stackSize].max = m_bounds.Max();
+            stackSize++;
+
+            while(stackSize > 0)
+            {
+                StackEntry entry = stack[--stackSize];
+
+                // the node box padded by radius contains all the points that can be reported.
+                if(!IntersectBox(entry.min - pad, entry.max + pad, org, invDir))
+                    continue;
+
+                uint32_t count = entry.last - entry.first;
+                if(count <= MaxLeafSize)
+                {
+                    for(uint32_t i = entry.first; i < entry.last; i++)
+                    {
+                        if(DistanceSqToRay(m_points[i], org, dir, dirLenSq) <= radiusSq)
+                            visitor(i);
+                    }
+                    continue;
+                }
+
+                uint32_t mid = entry.first + count / 2;
+                uint32_t axis = m_axis[mid];
+                float split = m_points[mid][axis];
+                if(DistanceSqToRay(m_points[mid], org, dir, dirLenSq) <= radiusSq)
+                    visitor(mid);
+
+                StackEntry low = entry;
+                low.last = mid;
+                low.max[axis] = split;
+                StackEntry high = entry;
+                high.first = mid + 1;
+                high.min[axis] = split;
+                stack[stackSize++] = high;
+                stack[stackSize++] = low;
+            }
+        }
+
+        // index of the point that is the closest to p, the tree must not be empty.
+        uint32_t FindNearest(const float3& p) const;
+
+        // squared distance between p and the half line org + t * dir, t >= 0
+        static float DistanceSqToRay(const float3& p, const float3& org, const float3& dir, float dirLenSq)
+        {
+            float3 v = p - org;
+            float t = dot(v, dir);
+            if(t <= 0.0f)
+                return lengthsquared(v);
+            return maximize(lengthsquared(v) - t * t / dirLenSq, 0.0f);
+        }
+
+    private:
+        struct StackEntry
+        {
+            uint32_t first;
+            uint32_t last;
+            float3 min;
+            float3 max;
+        };
+
+        // slab test of the half line against the box.
+        static bool IntersectBox(const float3& bmin, const float3& bmax, const float3& org, const float3& invDir)
+        {
+            float tx1 = (bmin.x - org.x) * invDir.x;
+            float tx2 = (bmax.x - org.x) * invDir.x;
+            float tmin = minimize(tx1, tx2);
+            float tmax = maximize(tx1, tx2);
+
+            float ty1 = (bmin.y - org.y) * invDir.y;
+            float ty2 = (bmax.y - org.y) * invDir.y;
+            tmin = maximize(tmin, minimize(ty1, ty2));
+            tmax = minimize(tmax, maximize(ty1, ty2));
+
+            float tz1 = (bmin.z - org.z) * invDir.z;
+            float tz2 = (bmax.z - org.z) * invDir.z;
+            tmin = maximize(tmin, minimize(tz1, tz2));
+            tmax = minimize(tmax, maximize(tz1, tz2));
+
+            return tmax >= tmin && tmax >= 0.0f;
+        }
+
+        void BuildRecursive(uint32_t first, uint32_t last, uint32_t depth);
+
+        std::vector<float3> m_points;
+        std::vector<uint8_t> m_axis;  // splitting axis of the node whose middle point is at the same index.
+        AABB m_bounds;
+    };
+}
@@ -0,0 +1,123 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "SegmentBVH.h"
+#include <float.h>
+
+namespace LvEdEngine
+{
+    // -------------------------------------------------------------------------------------
+    void SegmentBVH::Clear()
+    {
+        m_points.clear();
+        m_bvh.Clear();
+    }
+
+    // -------------------------------------------------------------------------------------
+    void SegmentBVH::Build(const float3* pos, uint32_t posCount, const Matrix& world)
+    {
+        Clear();
+        if(posCount < 2) return;
+
+        m_points.resize(posCount);
+        for(uint32_t i = 0; i < posCount; i++)
+        {
+            m_points[i] = float3::Transform(pos[i], world);
+        }
+
+        uint32_t segCount = posCount - 1;
+        std::vector<AABB> segBounds(segCount);
+        for(uint32_t i = 0; i < segCount; i++)
+        {
+            segBounds[i] = AABB(minimize(m_points[i], m_points[i+1]), maximize(m_points[i], m_points[i+1]));
+        }
+        m_bvh.Build(&segBounds[0], segCount);
+    }
+
+    // -------------------------------------------------------------------------------------
+    // true if the ray hits the node bounds padded by the largest distance
+    // a picked segment of the node can be from the ray.
+    static bool IntersectPaddedNode(const BVHNode& node, const Ray& ray, const float3& invDir,
+                                    float rayOffset, float maxRatio)
+    {
+        // distance along the ray of the farthest point of the node.
+        float3 c = (node.min + node.max) * 0.5f;
+        float3 e = node.max - c;
+        float tFar = dot(c - ray.pos, ray.direction)
+                   + abs(ray.direction.x) * e.x + abs(ray.direction.y) * e.y + abs(ray.direction.z) * e.z;
+
+        // distBetween < maxRatio * (distTo + rayOffset), distTo is at most tFar
+        // or distBetween itself for the points behind the ray.
+        float pad = maxRatio * (maximize(tFar, 0.0f) + rayOffset) / (1.0f - maxRatio);
+
+        BVHNode padded = node;
+        padded.min = node.min - float3(pad, pad, pad);
+        padded.max = node.max + float3(pad, pad, pad);
+        float tmin;
+        return BVH::IntersectNode(padded, ray.pos, invDir, FLT_MAX, &tmin);
+    }
+
+    // -------------------------------------------------------------------------------------
+    bool SegmentBVH::Pick(const Ray& ray, float rayOffset, float maxRatio,
+                          float* out_distTo, float* out_distBetween, float3* out_pos, float3* out_nor, uint32_t* out_hitIndex) const
+    {
+        if(IsEmpty() || m_bvh.IsEmpty() || maxRatio <= 0.0f) return false;
+
+        // with a very wide pick the tree can't reject anything.
+        bool prune = maxRatio < 1.0f;
+
+        float3 invDir;
+        invDir.x = ray.direction.x != 0.0f ? 1.0f / ray.direction.x : FLT_MAX;
+        invDir.y = ray.direction.y != 0.0f ? 1.0f / ray.direction.y : FLT_MAX;
+        invDir.z = ray.direction.z != 0.0f ? 1.0f / ray.direction.z : FLT_MAX;
+
+        const std::vector<BVHNode>& nodes = m_bvh.Nodes();
+        const std::vector<uint32_t>& primIndices = m_bvh.PrimIndices();
+
+        bool picked = false;
+        float bestRatio = FLT_MAX;
+        uint32_t bestIndex = 0;
+        float distTo, distBetween;
+        float3 pos, nor;
+
+        uint32_t stack[BVH::MaxDepth + 4];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while(stackSize > 0)
+        {
+            const BVHNode& node = nodes[stack[--stackSize]];
+            if(prune && !IntersectPaddedNode(node, ray, invDir, rayOffset, maxRatio))
+                continue;
+
+            if(!node.IsLeaf())
+            {
+                stack[stackSize++] = node.start + 1;
+                stack[stackSize++] = node.start;
+                continue;
+            }
+
+            for(uint32_t i = node.start; i < node.start + node.count; i++)
+            {
+                uint32_t seg = primIndices[i];
+                LineSeg segment(m_points[seg], m_points[seg + 1]);
+                DistanceRayToSegment(ray, segment, &distTo, &distBetween, &pos, &nor);
+                float ratio = distBetween / (distTo + rayOffset);
+                if(!(ratio >= 0.0f && ratio < maxRatio))
+                    continue;
+
+                // on equal ratio the first segment of the strip wins.
+                if(!picked || ratio < bestRatio || (ratio == bestRatio && seg < bestIndex))
+                {
+                    picked = true;
+                    bestRatio = ratio;
+                    bestIndex = seg;
+                    *out_distTo = distTo;
+                    *out_distBetween = distBetween;
+                    *out_pos = pos;
+                    *out_nor = nor;
+                    *out_hitIndex = seg;
+                }
+            }
+        }
+        return picked;
+    }
+}
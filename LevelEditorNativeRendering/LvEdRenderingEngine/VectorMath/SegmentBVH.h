@@ -0,0 +1,40 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+#include "BVH.h"
+#include "../Core/NonCopyable.h"
+
+namespace LvEdEngine
+{
+    // line strip in world space with a bounding volume hierarchy over its segments.
+    // segment i is formed by points i and i+1.
+    class SegmentBVH : public NonCopyable
+    {
+    public:
+        SegmentBVH(){}
+
+        // transform the points of the line strip by world and build the tree.
+        void Build(const float3* pos, uint32_t posCount, const Matrix& world);
+        void Clear();
+
+        bool IsEmpty() const { return m_points.size() < 2; }
+        uint32_t GetSegmentCount() const { return IsEmpty() ? 0 : (uint32_t)m_points.size() - 1; }
+        const std::vector<float3>& Points() const { return m_points; }
+
+        // screen space pick of the line strip.
+        // a segment is picked if distBetween / (distTo + rayOffset) < maxRatio, where distTo and distBetween
+        // are given by DistanceRayToSegment() and rayOffset is the distance from the eye to ray.pos.
+        // maxRatio is the pick width in pixels divided by the pixels per world unit at unit distance.
+        // returns the picked segment with the smallest ratio, only the segments that are near the ray
+        // are tested.
+        bool Pick(const Ray& ray, float rayOffset, float maxRatio,
+                  float* out_distTo, float* out_distBetween, float3* out_pos, float3* out_nor, uint32_t* out_hitIndex) const;
+
+    private:
+        std::vector<float3> m_points;
+        BVH m_bvh;
+    };
+}
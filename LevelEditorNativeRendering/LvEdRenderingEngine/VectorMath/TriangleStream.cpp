@@ -0,0 +1,274 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#include "TriangleStream.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define TRIANGLESTREAM_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+namespace LvEdEngine
+{
+    // -------------------------------------------------------------------------------------
+    static bool DetectSSE2()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return true; // always available on x64.
+#elif defined(_MSC_VER) && defined(_M_IX86)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#elif defined(TRIANGLESTREAM_SSE)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static const bool s_useSSE = DetectSSE2();
+
+    bool TriangleStream::UseSIMD()
+    {
+        return s_useSSE;
+    }
+
+    // -------------------------------------------------------------------------------------
+    static Triangle GetTriangle(const TriangleBlock& b, uint32_t lane)
+    {
+        Triangle tri;
+        tri.A = float3(b.ax[lane], b.ay[lane], b.az[lane]);
+        tri.B = float3(b.bx[lane], b.by[lane], b.bz[lane]);
+        tri.C = float3(b.cx[lane], b.cy[lane], b.cz[lane]);
+        return tri;
+    }
+
+    // mask of the lanes of block 'blockIndex' that are in range [first, end)
+    static uint32_t LaneRangeMask(uint32_t blockIndex, uint32_t first, uint32_t end)
+    {
+        uint32_t base = blockIndex * 4;
+        uint32_t mask = 0xF;
+        if(base < first)
+            mask &= (0xF << (first - base)) & 0xF;
+        if(base + 4 > end)
+            mask &= 0xF >> (base + 4 - end);
+        return mask;
+    }
+
+#ifdef TRIANGLESTREAM_SSE
+    // Mller-Trumbore test of one ray against 4 triangles.
+    // returns the mask of the triangles that may be hit before maxDist.
+    // the test is slightly conservative, the hits are confirmed by IntersectionRayTriangle()
+    static uint32_t RayBlockMaskSSE(const TriangleBlock& b, const __m128 org[3], const __m128 dir[3],
+                                    bool backfaceCull, float maxDist)
+    {
+        const __m128 ax = _mm_loadu_ps(b.ax);
+        const __m128 ay = _mm_loadu_ps(b.ay);
+        const __m128 az = _mm_loadu_ps(b.az);
+
+        // edges
+        const __m128 e1x = _mm_sub_ps(_mm_loadu_ps(b.bx), ax);
+        const __m128 e1y = _mm_sub_ps(_mm_loadu_ps(b.by), ay);
+        const __m128 e1z = _mm_sub_ps(_mm_loadu_ps(b.bz), az);
+        const __m128 e2x = _mm_sub_ps(_mm_loadu_ps(b.cx), ax);
+        const __m128 e2y = _mm_sub_ps(_mm_loadu_ps(b.cy), ay);
+        const __m128 e2z = _mm_sub_ps(_mm_loadu_ps(b.cz), az);
+
+        // P = cross(dir, E2)
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dir[1], e2z), _mm_mul_ps(dir[2], e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dir[2], e2x), _mm_mul_ps(dir[0], e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dir[0], e2y), _mm_mul_ps(dir[1], e2x));
+
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, e1x), _mm_mul_ps(py, e1y)), _mm_mul_ps(pz, e1z));
+
+        // K = org - A
+        const __m128 kx = _mm_sub_ps(org[0], ax);
+        const __m128 ky = _mm_sub_ps(org[1], ay);
+        const __m128 kz = _mm_sub_ps(org[2], az);
+
+        // Q = cross(K, E1)
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(ky, e1z), _mm_mul_ps(kz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(kz, e1x), _mm_mul_ps(kx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(kx, e1y), _mm_mul_ps(ky, e1x));
+
+        // barycentric coords and distance, not yet divided by det.
+        const __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, kx), _mm_mul_ps(py, ky)), _mm_mul_ps(pz, kz));
+        const __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, dir[0]), _mm_mul_ps(qy, dir[1])), _mm_mul_ps(qz, dir[2]));
+        const __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, e2x), _mm_mul_ps(qy, e2y)), _mm_mul_ps(qz, e2z));
+
+        // flip the signs by the sign of det so all the compares are against |det|
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        const __m128 detSign = _mm_and_ps(det, signBit);
+        const __m128 absDet = _mm_andnot_ps(signBit, det);
+        const __m128 us = _mm_xor_ps(u, detSign);
+        const __m128 vs = _mm_xor_ps(v, detSign);
+        const __m128 ts = _mm_xor_ps(t, detSign);
+
+        const __m128 halfEpsilon = _mm_set1_ps(0.5f * Epsilon);
+        const __m128 tol = _mm_mul_ps(absDet, _mm_set1_ps(1e-4f));
+        const __m128 negTol = _mm_sub_ps(_mm_setzero_ps(), tol);
+
+        __m128 ok = backfaceCull ? _mm_cmpgt_ps(det, halfEpsilon) : _mm_cmpgt_ps(absDet, halfEpsilon);
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(us, negTol));
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(vs, negTol));
+        ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_add_ps(us, vs), _mm_add_ps(absDet, tol)));
+        ok = _mm_and_ps(ok, _mm_cmpgt_ps(ts, negTol));
+        ok = _mm_and_ps(ok, _mm_cmple_ps(ts, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(maxDist), absDet), tol)));
+        return (uint32_t)_mm_movemask_ps(ok);
+    }
+
+    // returns the mask of the triangles that are not completely outside one of the frustum planes.
+    // uses the same plane evaluation as Plane::Eval()
+    static uint32_t FrustumBlockMaskSSE(const TriangleBlock& b, const Frustum& fr)
+    {
+        const __m128 ax = _mm_loadu_ps(b.ax);
+        const __m128 ay = _mm_loadu_ps(b.ay);
+        const __m128 az = _mm_loadu_ps(b.az);
+        const __m128 bx = _mm_loadu_ps(b.bx);
+        const __m128 by = _mm_loadu_ps(b.by);
+        const __m128 bz = _mm_loadu_ps(b.bz);
+        const __m128 cx = _mm_loadu_ps(b.cx);
+        const __m128 cy = _mm_loadu_ps(b.cy);
+        const __m128 cz = _mm_loadu_ps(b.cz);
+        const __m128 zero = _mm_setzero_ps();
+
+        __m128 outside = zero;
+        for(int i = 0; i < Frustum::NumPlanes; ++i)
+        {
+            const Plane& plane = fr[i];
+            const __m128 nx = _mm_set1_ps(plane.normal.x);
+            const __m128 ny = _mm_set1_ps(plane.normal.y);
+            const __m128 nz = _mm_set1_ps(plane.normal.z);
+            const __m128 d = _mm_set1_ps(plane.d);
+
+            __m128 da = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ax), _mm_mul_ps(ny, ay)), _mm_mul_ps(nz, az)), d);
+            __m128 db = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, bx), _mm_mul_ps(ny, by)), _mm_mul_ps(nz, bz)), d);
+            __m128 dc = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)), d);
+            __m128 allOut = _mm_and_ps(_mm_cmplt_ps(da, zero), _mm_and_ps(_mm_cmplt_ps(db, zero), _mm_cmplt_ps(dc, zero)));
+            outside = _mm_or_ps(outside, allOut);
+        }
+        return (uint32_t)(~_mm_movemask_ps(outside)) & 0xF;
+    }
+#endif
+
+    // -------------------------------------------------------------------------------------
+    void TriangleStream::Clear()
+    {
+        m_blocks.clear();
+        m_triCount = 0;
+    }
+
+    // -------------------------------------------------------------------------------------
+    void TriangleStream::Build(const float3* pos, const uint32_t* indices, uint32_t indicesCount, const uint32_t* order)
+    {
+        m_triCount = indicesCount / 3;
+        m_blocks.resize((m_triCount + 3) / 4);
+        for(uint32_t i = 0; i < m_blocks.size() * 4; i++)
+        {
+            TriangleBlock& b = m_blocks[i / 4];
+            uint32_t lane = i % 4;
+            if(i < m_triCount)
+            {
+                uint32_t tri = order ? order[i] : i;
+                const float3& A = pos[indices[3*tri]];
+                const float3& B = pos[indices[3*tri+1]];
+                const float3& C = pos[indices[3*tri+2]];
+                b.ax[lane] = A.x; b.ay[lane] = A.y; b.az[lane] = A.z;
+                b.bx[lane] = B.x; b.by[lane] = B.y; b.bz[lane] = B.z;
+                b.cx[lane] = C.x; b.cy[lane] = C.y; b.cz[lane] = C.z;
+                b.tri[lane] = tri;
+            }
+            else
+            {
+                // padding, degenerate triangle that is never reported.
+                b.ax[lane] = b.ay[lane] = b.az[lane] = 0.0f;
+                b.bx[lane] = b.by[lane] = b.bz[lane] = 0.0f;
+                b.cx[lane] = b.cy[lane] = b.cz[lane] = 0.0f;
+                b.tri[lane] = 0xFFFFFFFF;
+            }
+        }
+    }
+
+    // -------------------------------------------------------------------------------------
+    void TriangleStream::IntersectRay(const Ray& ray, bool backfaceCull, uint32_t first, uint32_t count, TriangleHit* hit) const
+    {
+        uint32_t end = first + count;
+        assert(end <= m_triCount);
+        if(count == 0) return;
+
+#ifdef TRIANGLESTREAM_SSE
+        __m128 org[3];
+        __m128 dir[3];
+        if(s_useSSE)
+        {
+            org[0] = _mm_set1_ps(ray.pos.x);
+            org[1] = _mm_set1_ps(ray.pos.y);
+            org[2] = _mm_set1_ps(ray.pos.z);
+            dir[0] = _mm_set1_ps(ray.direction.x);
+            dir[1] = _mm_set1_ps(ray.direction.y);
+            dir[2] = _mm_set1_ps(ray.direction.z);
+        }
+#endif
+
+        float dist;
+        float3 p, n;
+        uint32_t lastBlock = (end - 1) / 4;
+        for(uint32_t bi = first / 4; bi <= lastBlock; bi++)
+        {
+            const TriangleBlock& b = m_blocks[bi];
+            uint32_t mask = LaneRangeMask(bi, first, end);
+#ifdef TRIANGLESTREAM_SSE
+            if(s_useSSE)
+                mask &= RayBlockMaskSSE(b, org, dir, backfaceCull, hit->dist);
+#endif
+            for(uint32_t lane = 0; mask != 0; lane++, mask >>= 1)
+            {
+                if((mask & 1) == 0) continue;
+
+                Triangle tri = GetTriangle(b, lane);
+                if(IntersectionRayTriangle(ray, tri, backfaceCull, &dist, &p, &n))
+                {
+                    uint32_t triIndex = b.tri[lane];
+                    if(!hit->hit || dist < hit->dist || (dist == hit->dist && triIndex < hit->tri))
+                    {
+                        hit->hit = true;
+                        hit->tri = triIndex;
+                        hit->dist = dist;
+                        hit->pos = p;
+                        hit->nor = n;
+                        hit->triangle = tri;
+                    }
+                }
+            }
+        }
+    }
+
+    // -------------------------------------------------------------------------------------
+    bool TriangleStream::IntersectFrustum(const Frustum& fr, uint32_t first, uint32_t count) const
+    {
+        uint32_t end = first + count;
+        assert(end <= m_triCount);
+        if(count == 0) return false;
+
+        uint32_t lastBlock = (end - 1) / 4;
+        for(uint32_t bi = first / 4; bi <= lastBlock; bi++)
+        {
+            const TriangleBlock& b = m_blocks[bi];
+            uint32_t mask = LaneRangeMask(bi, first, end);
+#ifdef TRIANGLESTREAM_SSE
+            if(s_useSSE)
+                mask &= FrustumBlockMaskSSE(b, fr);
+#endif
+            for(uint32_t lane = 0; mask != 0; lane++, mask >>= 1)
+            {
+                if((mask & 1) == 0) continue;
+                if(FrustumTriangleIntersect(fr, GetTriangle(b, lane)))
+                    return true;
+            }
+        }
+        return false;
+    }
+}
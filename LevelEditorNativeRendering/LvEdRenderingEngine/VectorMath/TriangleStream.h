@@ -0,0 +1,73 @@
+//Copyright  2014 Sony Computer Entertainment America LLC. See License.txt.
+
+#pragma once
+#include <vector>
+#include "V3dMath.h"
+#include "CollisionPrimitives.h"
+
+namespace LvEdEngine
+{
+    // 4 triangles in structure of arrays layout.
+    // the vertices are copied as-is so the scalar tests give the same result
+    // as when they are done on the source mesh.
+    struct TriangleBlock
+    {
+        float ax[4]; float ay[4]; float az[4];
+        float bx[4]; float by[4]; float bz[4];
+        float cx[4]; float cy[4]; float cz[4];
+        uint32_t tri[4]; // triangle index in the source index list (first index / 3).
+    };
+
+    // closest hit found by TriangleStream::IntersectRay()
+    struct TriangleHit
+    {
+        TriangleHit() : hit(false), tri(0), dist(FLT_MAX) {}
+        bool hit;
+        uint32_t tri;     // triangle index in the source index list.
+        float dist;
+        float3 pos;
+        float3 nor;
+        Triangle triangle;
+    };
+
+    // triangles of a mesh packed in blocks of 4 for SIMD intersection tests.
+    // the SSE kernels are only used to reject triangles,
+    // the remaining ones are tested using the scalar functions
+    // so the results are identical to the scalar code path.
+    class TriangleStream
+    {
+    public:
+        TriangleStream() : m_triCount(0) {}
+
+        // pack the triangles of indexed triangle list.
+        // if order is not NULL, triangle order[i] is stored at position i.
+        void Build(const float3* pos, const uint32_t* indices, uint32_t indicesCount, const uint32_t* order = NULL);
+        void Clear();
+
+        bool IsEmpty() const { return m_triCount == 0; }
+        uint32_t GetTriangleCount() const { return m_triCount; }
+
+        // find the closest hit for triangles [first, first + count) of the stream.
+        // hit is only updated when a closer triangle is found. On equal distance
+        // the triangle with lower index wins, same as testing them in order.
+        void IntersectRay(const Ray& ray, bool backfaceCull, uint32_t first, uint32_t count, TriangleHit* hit) const;
+        void IntersectRay(const Ray& ray, bool backfaceCull, TriangleHit* hit) const
+        {
+            IntersectRay(ray, backfaceCull, 0, m_triCount, hit);
+        }
+
+        // true if any of the triangles [first, first + count) intersects the frustum.
+        bool IntersectFrustum(const Frustum& fr, uint32_t first, uint32_t count) const;
+        bool IntersectFrustum(const Frustum& fr) const
+        {
+            return IntersectFrustum(fr, 0, m_triCount);
+        }
+
+        // true if the SSE kernels are used, false if the cpu doesn't support them.
+        static bool UseSIMD();
+
+    private:
+        std::vector<TriangleBlock> m_blocks;
+        uint32_t m_triCount;
+    };
+}
@@ -202,7 +202,6 @@ private void m_gameDocumentRegistry_DocumentAdded(object sender, ItemInsertedEve
                 NativeObjectAdapter gameLevel = document.Cast<NativeObjectAdapter>();
                 GameEngine.CreateObject(gameLevel);
                 GameEngine.SetGameLevel(gameLevel);
-                gameLevel.UpdateNativeOjbect();
 
                 //create vertex buffer for grid.
                 IGrid grid = document.As<IGame>().Grid;
@@ -0,0 +1,93 @@
+﻿//Copyright © 2014 Sony Computer Entertainment America LLC. See License.txt.
+
+using System;
+using System.Runtime.InteropServices;
+
+namespace RenderingInterop
+{
+    /// <summary>
+    /// Packs property writes that are sent to the native side in one call
+    /// by GameEngine.ExecuteCommandBuffer().
+    /// Each write is a 24 byte header followed by the data padded to 8 bytes,
+    /// see LvEd_ExecuteCommandBuffer in LvEdRenderingEngine.h</summary>
+    public unsafe class CommandBuffer
+    {
+        /// <summary>
+        /// Gets the number of writes in the buffer</summary>
+        public int Count
+        {
+            get { return m_count; }
+        }
+
+        /// <summary>
+        /// Appends a write of size bytes copied from data</summary>
+        public void SetProperty(uint typeId, ulong instanceId, uint propId, IntPtr data, int size)
+        {
+            if (data == IntPtr.Zero)
+                size = 0;
+            int offset = AddHeader(typeId, instanceId, propId, size, 0);
+            if (size > 0)
+                Marshal.Copy(data, m_buffer, offset, size);
+        }
+
+        /// <summary>
+        /// Appends a write of an object reference, the native set function gets
+        /// the instance id of the target in place of the data pointer</summary>
+        public void SetReference(uint typeId, ulong instanceId, uint propId, ulong targetId)
+        {
+            int size = targetId != 0 ? sizeof(ulong) : 0;
+            int offset = AddHeader(typeId, instanceId, propId, size, ReferenceFlag);
+            if (size > 0)
+            {
+                fixed (byte* ptr = &m_buffer[offset])
+                    *(ulong*)ptr = targetId;
+            }
+        }
+
+        public void Clear()
+        {
+            m_size = 0;
+            m_count = 0;
+        }
+
+        internal byte[] Buffer
+        {
+            get { return m_buffer; }
+        }
+
+        internal int Size
+        {
+            get { return m_size; }
+        }
+
+        // returns the offset of the data.
+        private int AddHeader(uint typeId, ulong instanceId, uint propId, int size, uint flags)
+        {
+            int offset = m_size + HeaderSize;
+            int end = offset + ((size + 7) & ~7);
+            if (end > m_buffer.Length)
+                Array.Resize(ref m_buffer, Math.Max(end, m_buffer.Length * 2));
+
+            fixed (byte* ptr = &m_buffer[m_size])
+            {
+                *(ulong*)ptr = instanceId;
+                *(uint*)(ptr + 8) = typeId;
+                *(uint*)(ptr + 12) = propId;
+                *(uint*)(ptr + 16) = (uint)size;
+                *(uint*)(ptr + 20) = flags;
+            }
+
+            // zero the padding, the recorded buffers do not depend on old data.
+            Array.Clear(m_buffer, offset + size, end - offset - size);
+            m_size = end;
+            m_count++;
+            return offset;
+        }
+
+        private const int HeaderSize = 24;
+        private const uint ReferenceFlag = 1;
+        private byte[] m_buffer = new byte[4096];
+        private int m_size;
+        private int m_count;
+    }
+}
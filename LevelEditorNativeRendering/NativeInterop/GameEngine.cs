@@ -57,6 +57,9 @@ public void SetGameWorld(IGame game)
         /// <param name="updateType">Update type</param>        
         public void Update(FrameTime ft, UpdateType updateType)
         {
+            // the edits of a transaction that lasts several frames, such as a drag,
+            // are visible while it lasts.
+            FlushPropertyBatch();
             NativeUpdate(&ft, updateType);
         }
 
@@ -202,6 +205,7 @@ public static string FullDllName
         /// </summary>
         public static void Clear()
         {
+            s_propertyBatch.Clear();
             s_idToDomNode.Clear();
             NativeClear();
         }
@@ -349,7 +353,18 @@ public static ulong CreateObject(uint typeId, IntPtr data, int size)
 
         public static ulong CreateObject(NativeObjectAdapter gob)
         {
-            ulong instanceId = CreateObject(gob.TypeId, IntPtr.Zero, 0);
+            // the object is created with its properties set. the buffer is cleared even
+            // if packing or creating throws, its writes must not go to the next object.
+            ulong instanceId;
+            try
+            {
+                gob.PackInitialState(s_initialState);
+                instanceId = NativeCreateObject(gob.TypeId, s_initialState.Buffer, s_initialState.Size);
+            }
+            finally
+            {
+                s_initialState.Clear();
+            }
             if (instanceId != 0)
             {
                 s_idToDomNode.Add(instanceId, gob);
@@ -368,6 +383,8 @@ public static void DestroyObject(NativeObjectAdapter gob)
         {
             if (gob.InstanceId == 0)
                 return;
+            // the batched writes can go to the object or reference it.
+            FlushPropertyBatch();
             NativeDestroyObject(gob.TypeId, gob.InstanceId);
             ResetIds(gob);
 
@@ -428,9 +445,30 @@ public static void ObjectRemoveChild(NativeObjectAdapter parent, NativeObjectAda
 
         public static void InvokeMemberFn(ulong instanceId, string fn, IntPtr arg, out IntPtr retVal)
         {
-           NativeInvokeMemberFn(instanceId, fn, arg, out retVal);
+            InvokeMemberFn(instanceId, GetMemberFnId(fn), arg, out retVal);
         }
 
+        public static void InvokeMemberFn(ulong instanceId, int fnId, IntPtr arg, out IntPtr retVal)
+        {
+            FlushPropertyBatch();
+            NativeInvokeMemberFnById(instanceId, fnId, arg, out retVal);
+        }
+
+        // the names are resolved once, the native ids do not change.
+        // returns -1 for unknown names.
+        public static int GetMemberFnId(string fn)
+        {
+            if (string.IsNullOrEmpty(fn)) return -1;
+            int fnId;
+            if (!s_memberFnIds.TryGetValue(fn, out fnId))
+            {
+                fnId = NativeGetMemberFnId(fn);
+                s_memberFnIds.Add(fn, fnId);
+            }
+            return fnId;
+        }
+        private static Dictionary<string, int> s_memberFnIds = new Dictionary<string, int>();
+
         public static void SetObjectProperty(uint typeid, ulong instanceId, uint propId, Color color)
         {
             Vec4F val = new Vec4F(color.R/255.0f, color.G/255.0f, color.B/255.0f, color.A/255.0f);
@@ -464,6 +502,47 @@ public static void SetObjectProperty(uint typeid, ulong instanceId, uint propId,
             NativeSetObjectProperty(typeid, propId, instanceId, data, size);
         }
 
+        // sets the properties packed in the command buffer in one call and clears the buffer.
+        // only the last write to each property of each object is applied.
+        public static void ExecuteCommandBuffer(CommandBuffer commands)
+        {
+            if (commands.Count == 0) return;
+            NativeExecuteCommandBuffer(commands.Buffer, commands.Size);
+            commands.Clear();
+        }
+
+        /// <summary>
+        /// Starts batching the property writes of the native objects, they are sent
+        /// in one call by the matching EndPropertyBatch(). The batches can be nested,
+        /// the writes are sent when the outermost one ends.
+        /// NativeGameWorldAdapter batches the writes of each DOM transaction.</summary>
+        public static void BeginPropertyBatch()
+        {
+            s_propertyBatchDepth++;
+        }
+
+        public static void EndPropertyBatch()
+        {
+            if (s_propertyBatchDepth == 0) return;
+            s_propertyBatchDepth--;
+            if (s_propertyBatchDepth == 0)
+                FlushPropertyBatch();
+        }
+
+        /// <summary>
+        /// Sends the batched writes now, the batch stays open.
+        /// Called before the calls that can depend on the writes.</summary>
+        public static void FlushPropertyBatch()
+        {
+            ExecuteCommandBuffer(s_propertyBatch);
+        }
+
+        // the buffer of the open batch, null if there is none.
+        internal static CommandBuffer PropertyBatch
+        {
+            get { return s_propertyBatchDepth > 0 ? s_propertyBatch : null; }
+        }
+
         public static void GetObjectProperty(uint typeId, uint propId, ulong instanceId, out int data)
         {
             int datasize = 0;
@@ -497,6 +576,7 @@ public static void GetObjectProperty(uint typeId, uint propId, ulong instanceId,
         }
         public static void GetObjectProperty(uint typeId, uint propId, ulong instanceId, out IntPtr data, out int size)
         {
+            FlushPropertyBatch();
             NativeGetObjectProperty(typeId,propId,instanceId, out data,out size);
         }
         public static NativeObjectAdapter GetAdapterFromId(ulong instanceId)
@@ -507,7 +587,10 @@ public static NativeObjectAdapter GetAdapterFromId(ulong instanceId)
         #endregion
 
         #region picking and selection
-        public static bool RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, bool skipSelected, out HitRecord hit)
+        /// <summary>
+        /// Finds the closest hit along the ray, hits farther than maxDistance are ignored.</summary>
+        public static bool RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, bool skipSelected, out HitRecord hit,
+            float maxDistance = float.MaxValue)
         {
             HitRecord* nativeHits = null;
             int count;
@@ -520,6 +603,8 @@ public static bool RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, b
                 ptr2,
                 &rayW,
                 skipSelected,
+                true,
+                maxDistance,
                 &nativeHits,
                 out count);
             }
@@ -536,7 +621,10 @@ public static bool RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, b
             return count > 0;
 
         }
-        public static HitRecord[] RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, bool skipSelected)
+        /// <summary>
+        /// Finds all the hits along the ray sorted by distance, hits farther than maxDistance are ignored.</summary>
+        public static HitRecord[] RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, bool skipSelected,
+            float maxDistance = float.MaxValue)
         {
             HitRecord* nativeHits = null;
             int count;
@@ -548,6 +636,8 @@ public static HitRecord[] RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F
                 ptr2,
                 &rayW,
                 skipSelected,
+                false,
+                maxDistance,
                 &nativeHits,
                 out count);                
             }
@@ -563,7 +653,72 @@ public static HitRecord[] RayPick(Matrix4F viewxform, Matrix4F projxfrom, Ray3F
 
         }
 
+        /// <summary>
+        /// Picks many rays in one call, returns the hits of each ray sorted along the ray.
+        /// maxDists can be null for no distance limit.</summary>
+        public static HitRecord[][] RayPickBatch(Matrix4F viewxform, Matrix4F projxfrom, Ray3F[] rays, float[] maxDists,
+            bool closestHitOnly, bool skipSelected)
+        {
+            if (maxDists != null && maxDists.Length != rays.Length)
+                throw new ArgumentException("maxDists must have one entry per ray");
+
+            HitRecord* nativeHits = null;
+            int* offsets = null;
+            int count;
+
+            fixed (float* ptr1 = &viewxform.M11, ptr2 = &projxfrom.M11)
+            fixed (Ray3F* rayPtr = rays)
+            fixed (float* maxDistPtr = maxDists)
+            {
+                NativeRayPickBatch(
+                ptr1,
+                ptr2,
+                rayPtr,
+                maxDistPtr,
+                rays.Length,
+                closestHitOnly,
+                skipSelected,
+                &nativeHits,
+                &offsets,
+                out count);
+            }
+
+            var result = new HitRecord[rays.Length][];
+            for (int r = 0; r < rays.Length; r++)
+            {
+                int first = offsets != null ? offsets[r] : 0;
+                int rayHitCount = offsets != null ? offsets[r + 1] - first : 0;
+                result[r] = new HitRecord[rayHitCount];
+                for (int k = 0; k < rayHitCount; k++)
+                    result[r][k] = nativeHits[first + k];
+            }
+            return result;
+        }
+
         private static float[] s_rect = new float[4];
+        /// <summary>
+        /// Finds the mesh vertex closest to the ray in screen space, for vertex snapping.
+        /// Vertices farther than pixelRadius pixels from the ray are ignored.
+        /// hit.nearestVertex is the vertex in world space and hit.instanceId its owner.</summary>
+        public static bool FindNearestVertex(Matrix4F viewxform, Matrix4F projxfrom, Ray3F rayW, float pixelRadius,
+            bool skipSelected, out HitRecord hit)
+        {
+            HitRecord nativeHit;
+            bool found;
+            fixed (float* ptr1 = &viewxform.M11, ptr2 = &projxfrom.M11)
+            {
+                found = NativeFindNearestVertex(
+                    ptr1,
+                    ptr2,
+                    &rayW,
+                    pixelRadius,
+                    skipSelected,
+                    &nativeHit);
+            }
+            hit = found ? nativeHit : new HitRecord();
+            return found;
+        }
+
         public static HitRecord[] FrustumPick(ulong renderSurface, Matrix4F viewxform,
                                                Matrix4F projxfrom,
                                                RectangleF rect)
@@ -752,12 +907,18 @@ public static void DrawText2D(string text, ulong fontId, int x, int y, Color col
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_CreateObject", CallingConvention = CallingConvention.StdCall)]
         private static extern ulong NativeCreateObject(uint typeId, IntPtr data, int size);
 
+        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_CreateObject", CallingConvention = CallingConvention.StdCall)]
+        private static extern ulong NativeCreateObject(uint typeId, byte[] data, int size);
+
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_DestroyObject", CallingConvention = CallingConvention.StdCall)]
         private static extern void NativeDestroyObject(uint typeId, ulong instanceId);
 
         
-        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_InvokeMemberFn", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.StdCall)]
-        private static extern void NativeInvokeMemberFn(ulong instanceId, string fn, IntPtr arg, out IntPtr retVal);
+        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_GetMemberFnId", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.StdCall)]
+        private static extern int NativeGetMemberFnId(string fn);
+
+        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_InvokeMemberFnById", CallingConvention = CallingConvention.StdCall)]
+        private static extern void NativeInvokeMemberFnById(ulong instanceId, int fnId, IntPtr arg, out IntPtr retVal);
         
         
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_SetObjectProperty", CallingConvention = CallingConvention.StdCall)]
@@ -766,6 +927,9 @@ public static void DrawText2D(string text, ulong fontId, int x, int y, Color col
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_GetObjectProperty", CallingConvention = CallingConvention.StdCall)]
         private static extern void NativeGetObjectProperty(uint typeId, uint propId, ulong instanceId, out IntPtr data, out int size);
 
+        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_ExecuteCommandBuffer", CallingConvention = CallingConvention.StdCall)]
+        private static extern int NativeExecuteCommandBuffer(byte[] buffer, int size);
+
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_ObjectAddChild", CallingConvention = CallingConvention.StdCall)]
         private static extern void NativeObjectAddChild(uint typeid, uint listId, ulong parentId, ulong childId, int index);
 
@@ -779,10 +943,25 @@ public static void DrawText2D(string text, ulong fontId, int x, int y, Color col
             [In] float* projxfrom,
             [In] Ray3F* rayW,
             [In] bool skipSelected,
+            [In] bool closestHitOnly,
+            [In] float maxDist,
             [Out] HitRecord** instanceIds,
             [Out] out int count);
 
 
+        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_RayPickBatch", CallingConvention = CallingConvention.StdCall)]
+        private static extern bool NativeRayPickBatch(
+            [In] float* viewxform,
+            [In] float* projxfrom,
+            [In] Ray3F* rays,
+            [In] float* maxDists,
+            [In] int rayCount,
+            [In] bool closestHitOnly,
+            [In] bool skipSelected,
+            [Out] HitRecord** hits,
+            [Out] int** hitOffsets,
+            [Out] out int hitCount);
+
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_FrustumPick", CallingConvention = CallingConvention.StdCall)]
         private static extern bool NativeFrustumPick(
             [In]ulong renderSurface,
@@ -792,6 +971,15 @@ public static void DrawText2D(string text, ulong fontId, int x, int y, Color col
             [Out]HitRecord** instanceIds, 
             [Out]out int count);
 
+        [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_FindNearestVertex", CallingConvention = CallingConvention.StdCall)]
+        private static extern bool NativeFindNearestVertex(
+            [In] float* viewxform,
+            [In] float* projxfrom,
+            [In] Ray3F* rayW,
+            [In] float pixelRadius,
+            [In] bool skipSelected,
+            [Out] HitRecord* hit);
+
         [DllImportAttribute("LvEdRenderingEngine", EntryPoint = "LvEd_SetSelection", CallingConvention = CallingConvention.StdCall)]
         private static extern void NativeSetSelection(ulong[] instanceIds, int count);
         
@@ -887,6 +1075,11 @@ private static void ThrowExceptionForLastError()
         private static IntPtr s_libHandle;
 
         private static Dictionary<ulong, NativeObjectAdapter> s_idToDomNode = new Dictionary<ulong, NativeObjectAdapter>();
+        // the initial state of the object being created by CreateObject(NativeObjectAdapter).
+        private static readonly CommandBuffer s_initialState = new CommandBuffer();
+        // the writes of the open property batch.
+        private static readonly CommandBuffer s_propertyBatch = new CommandBuffer();
+        private static int s_propertyBatchDepth;
         private static class NativeMethods
         {
             [DllImport("kernel32", CharSet = CharSet.Auto, SetLastError = true)]
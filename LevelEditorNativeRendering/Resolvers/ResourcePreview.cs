@@ -96,7 +96,6 @@ private void Init()
                 NativeObjectAdapter gameLevel = rootNode.Cast<NativeObjectAdapter>();
                 GameEngine.CreateObject(gameLevel);
                 GameEngine.SetGameLevel(gameLevel);
-                gameLevel.UpdateNativeOjbect();
                 NativeGameWorldAdapter gworld = rootNode.Cast<NativeGameWorldAdapter>();
                 m_game = rootNode.Cast<IGame>();
                 IGameObjectFolder rootFolder = m_game.RootGameObjectFolder;